@@ -0,0 +1,68 @@
+#include <iostream>
+#include <cstdlib>
+#include <cstring>
+#include "Benchmarks.h"
+
+using namespace std;
+using namespace Numero::Benchmark;
+
+// usage: Numero.Benchmark [--json path] [--filter text] [--max-size n] [--samples n] [--quick] [--full]
+//   --json      write the results as JSON, for comparing runs between versions
+//   --filter    only run cases whose name contains text, e.g. dense.mul or simd.
+//   --max-size  skip sizes above n
+//   --samples   measured samples per case
+//   --quick     fewer samples and shorter budgets, for smoke runs
+//   --full      ignore the per-operation size limits and run every size up to --max-size
+int main(int argc, char* argv[])
+{
+	BenchmarkOptions options;
+
+	for (int i(1); i < argc; i++)
+	{
+		bool hasValue = (i + 1 < argc);
+
+		if (strcmp(argv[i], "--json") == 0 && hasValue)
+			options.jsonPath = argv[++i];
+		else if (strcmp(argv[i], "--filter") == 0 && hasValue)
+			options.filter = argv[++i];
+		else if (strcmp(argv[i], "--max-size") == 0 && hasValue)
+			options.maxSize = static_cast<unsigned int>(atoi(argv[++i]));
+		else if (strcmp(argv[i], "--samples") == 0 && hasValue)
+			options.samples = static_cast<unsigned int>(atoi(argv[++i]));
+		else if (strcmp(argv[i], "--quick") == 0)
+		{
+			options.warmupSamples = 1;
+			options.samples = 5;
+			options.minSampleSecs = 0.002;
+			options.maxCaseSecs = 0.2;
+		}
+		else if (strcmp(argv[i], "--full") == 0)
+			options.full = true;
+		else
+		{
+			cerr << "unknown argument " << argv[i] << endl;
+			return 1;
+		}
+	}
+
+	if (options.samples == 0)
+		options.samples = 1;
+	if (options.minSamples > options.samples)
+		options.minSamples = options.samples;
+
+	BenchmarkRunner runner(options);
+
+	RunDenseBenchmarks(runner);
+	RunFixedBenchmarks(runner);
+	RunSimdBenchmarks(runner);
+	RunParallelBenchmarks(runner);
+	RunSparseBenchmarks(runner);
+	RunKrylovBenchmarks(runner);
+	RunCholeskyBenchmarks(runner);
+	RunIoBenchmarks(runner);
+
+	if (!options.jsonPath.empty())
+		runner.WriteJson(options.jsonPath);
+
+	return 0;
+}
@@ -0,0 +1,140 @@
+#include <algorithm>
+#include <fstream>
+#include <iostream>
+#include <iomanip>
+#include <ctime>
+#include "BenchmarkHarness.h"
+#include "../Numero/Simd.h"
+#include "../Numero/ThreadPool.h"
+
+using namespace Numero;
+using namespace Numero::Benchmark;
+using namespace Numero::DataTypes;
+
+#pragma region HELPERS
+void Numero::Benchmark::UseCharPointer(const volatile char*)
+{
+}
+
+namespace
+{
+	// linear interpolation between the closest ranks of sorted values
+	double Percentile(const vector<double>& sorted, double fraction)
+	{
+		if (sorted.empty())
+			return 0;
+
+		double position = fraction * (sorted.size() - 1);
+		size_t lower = static_cast<size_t>(position);
+		size_t upper = (lower + 1 < sorted.size()) ? lower + 1 : lower;
+		double weight = position - lower;
+
+		return sorted[lower] * (1 - weight) + sorted[upper] * weight;
+	}
+
+	string JsonString(const string& value)
+	{
+		string escaped = "\"";
+		for (char character : value)
+		{
+			if (character == '"' || character == '\\')
+				escaped += '\\';
+			escaped += character;
+		}
+		return escaped + "\"";
+	}
+}
+#pragma endregion
+
+
+#pragma region RUNNER
+BenchmarkRunner::BenchmarkRunner(const BenchmarkOptions& options) : options(options)
+{
+	cout << left << setw(40) << "case" << setw(8) << "type" << right << setw(8) << "size"
+		<< setw(14) << "median" << setw(14) << "p10" << setw(14) << "p90"
+		<< setw(12) << "GFLOP/s" << setw(10) << "GB/s" << setw(12) << "Mitems/s" << endl;
+}
+
+bool BenchmarkRunner::Selected(const string& name, unsigned int size, unsigned int operationLimit) const
+{
+	if (!options.filter.empty() && name.find(options.filter) == string::npos)
+		return false;
+
+	if (size > options.maxSize)
+		return false;
+
+	return options.full || size <= operationLimit;
+}
+
+void BenchmarkRunner::Record(const string& name, const string& type, unsigned int size, double flops, double bytes, double items,
+	unsigned long long iterations, vector<double>& sampleSecs)
+{
+	sort(sampleSecs.begin(), sampleSecs.end());
+
+	BenchmarkResult result;
+	result.name = name;
+	result.type = type;
+	result.size = size;
+	result.samples = static_cast<unsigned int>(sampleSecs.size());
+	result.iterationsPerSample = iterations;
+	result.minSecs = sampleSecs.front();
+	result.p10Secs = Percentile(sampleSecs, 0.1);
+	result.medianSecs = Percentile(sampleSecs, 0.5);
+	result.p90Secs = Percentile(sampleSecs, 0.9);
+	result.maxSecs = sampleSecs.back();
+	result.flops = flops;
+	result.bytes = bytes;
+	result.items = items;
+	results.push_back(result);
+
+	cout << left << setw(40) << name << setw(8) << type << right << setw(8) << size
+		<< setw(14) << setprecision(4) << result.medianSecs
+		<< setw(14) << result.p10Secs << setw(14) << result.p90Secs
+		<< setw(12) << (flops > 0 ? flops / result.medianSecs / 1e9 : 0)
+		<< setw(10) << (bytes > 0 ? bytes / result.medianSecs / 1e9 : 0)
+		<< setw(12) << (items > 0 ? items / result.medianSecs / 1e6 : 0) << endl;
+}
+
+void BenchmarkRunner::WriteJson(const string& path) const
+{
+	ofstream out(path.c_str());
+	if (!out)
+	{
+		cerr << "cannot write " << path << endl;
+		return;
+	}
+
+	out << setprecision(9);
+	out << "{" << endl;
+	out << "  \"format\": 1," << endl;
+	out << "  \"timestamp\": " << static_cast<long long>(time(nullptr)) << "," << endl;
+	out << "  \"simd\": " << JsonString(Simd::LevelName(Simd::Detected())) << "," << endl;
+	out << "  \"threads\": " << ThreadPool::Global().ThreadCount() << "," << endl;
+	out << "  \"results\": [" << endl;
+
+	for (size_t i(0); i < results.size(); i++)
+	{
+		const BenchmarkResult& result = results[i];
+		out << "    {\"name\": " << JsonString(result.name)
+			<< ", \"type\": " << JsonString(result.type)
+			<< ", \"size\": " << result.size
+			<< ", \"samples\": " << result.samples
+			<< ", \"iterations_per_sample\": " << result.iterationsPerSample
+			<< ", \"min_s\": " << result.minSecs
+			<< ", \"p10_s\": " << result.p10Secs
+			<< ", \"median_s\": " << result.medianSecs
+			<< ", \"p90_s\": " << result.p90Secs
+			<< ", \"max_s\": " << result.maxSecs
+			<< ", \"flops\": " << result.flops
+			<< ", \"bytes\": " << result.bytes
+			<< ", \"items\": " << result.items
+			<< ", \"gflops_per_s\": " << (result.flops > 0 ? result.flops / result.medianSecs / 1e9 : 0)
+			<< ", \"gbytes_per_s\": " << (result.bytes > 0 ? result.bytes / result.medianSecs / 1e9 : 0)
+			<< ", \"items_per_s\": " << (result.items > 0 ? result.items / result.medianSecs : 0)
+			<< "}" << (i + 1 < results.size() ? "," : "") << endl;
+	}
+
+	out << "  ]" << endl;
+	out << "}" << endl;
+}
+#pragma endregion
@@ -0,0 +1,138 @@
+#ifndef _BENCHMARK_HARNESS_H_
+#define _BENCHMARK_HARNESS_H_
+
+#include <string>
+#include <vector>
+#include <chrono>
+
+namespace Numero
+{
+	using namespace std;
+
+	namespace Benchmark
+	{
+		// settings of a benchmark run, see Benchmark.cpp for the command line that fills them
+		struct BenchmarkOptions
+		{
+			unsigned int warmupSamples;		// samples run and discarded before measuring
+			unsigned int samples;			// measured samples per case
+			unsigned int minSamples;		// samples kept even when the time budget runs out
+			double minSampleSecs;			// a sample repeats the body until it takes at least this long
+			double maxCaseSecs;				// time budget of a case, excluding calibration
+			unsigned int maxSize;			// cases above this size are skipped
+			bool full;						// run cases above their per-operation size limits
+			string filter;					// only cases whose name contains this
+			string jsonPath;				// results are written here when not empty
+
+			BenchmarkOptions()
+				: warmupSamples(2), samples(15), minSamples(3), minSampleSecs(0.01), maxCaseSecs(2.0),
+				maxSize(1u << 24), full(false)
+			{
+			}
+		};
+
+		// statistics of one case - all times are per call of the measured body
+		struct BenchmarkResult
+		{
+			string name;
+			string type;
+			unsigned int size;
+			unsigned int samples;
+			unsigned long long iterationsPerSample;
+			double minSecs;
+			double p10Secs;
+			double medianSecs;
+			double p90Secs;
+			double maxSecs;
+			double flops;			// floating point operations per call, 0 when not meaningful
+			double bytes;			// bytes read and written per call, 0 when not meaningful
+			double items;			// elements processed per call - triplets, nonzeros - 0 when not meaningful
+		};
+
+		// keeps the compiler from discarding the computation of value
+		void UseCharPointer(const volatile char* pointer);
+
+		template <class T>
+		inline void DoNotOptimize(const T& value)
+		{
+#if defined(__GNUC__)
+			__asm__ volatile("" : : "r"(&value) : "memory");
+#else
+			UseCharPointer(&reinterpret_cast<const volatile char&>(value));
+#endif
+		}
+
+		// BenchmarkRunner class
+		// times cases with a monotonic clock - calibrates the number of calls per sample,
+		// runs warm-up samples, then measured samples until the count or the time budget is reached,
+		// prints one line per case and collects the results for the JSON report
+		class BenchmarkRunner
+		{
+		private:
+			typedef chrono::steady_clock Clock;
+
+			BenchmarkOptions options;
+			vector<BenchmarkResult> results;
+
+			void Record(const string& name, const string& type, unsigned int size, double flops, double bytes, double items,
+				unsigned long long iterations, vector<double>& sampleSecs);
+
+		public:
+			explicit BenchmarkRunner(const BenchmarkOptions& options);
+
+			const BenchmarkOptions& Options() const { return options; }
+			const vector<BenchmarkResult>& Results() const { return results; }
+
+			// true when a case passes the name filter, the size limit of the run and its own size limit
+			bool Selected(const string& name, unsigned int size, unsigned int operationLimit) const;
+
+			// measures body(), which performs one call of the operation
+			template <class Body>
+			void Run(const string& name, const string& type, unsigned int size, double flops, double bytes, const Body& body)
+			{
+				Run(name, type, size, flops, bytes, 0, body);
+			}
+
+			// as above, also reporting items per second
+			template <class Body>
+			void Run(const string& name, const string& type, unsigned int size, double flops, double bytes, double items, const Body& body)
+			{
+				// calibration - the first call also warms caches and the allocator
+				Clock::time_point begin = Clock::now();
+				body();
+				double firstSecs = chrono::duration<double>(Clock::now() - begin).count();
+
+				unsigned long long iterations = 1;
+				if (firstSecs < options.minSampleSecs)
+					iterations = static_cast<unsigned long long>(options.minSampleSecs / (firstSecs > 1e-9 ? firstSecs : 1e-9)) + 1;
+
+				vector<double> sampleSecs;
+				sampleSecs.reserve(options.samples);
+				Clock::time_point caseBegin = Clock::now();
+
+				for (unsigned int sample(0); sample < options.warmupSamples + options.samples; sample++)
+				{
+					Clock::time_point sampleBegin = Clock::now();
+					for (unsigned long long i(0); i < iterations; i++)
+					{
+						body();
+					}
+					Clock::time_point sampleEnd = Clock::now();
+
+					if (sample >= options.warmupSamples)
+						sampleSecs.push_back(chrono::duration<double>(sampleEnd - sampleBegin).count() / iterations);
+
+					double caseSecs = chrono::duration<double>(sampleEnd - caseBegin).count();
+					if (sampleSecs.size() >= options.minSamples && caseSecs > options.maxCaseSecs)
+						break;
+				}
+
+				Record(name, type, size, flops, bytes, items, iterations, sampleSecs);
+			}
+
+			void WriteJson(const string& path) const;
+		};
+	}
+}
+
+#endif // !_BENCHMARK_HARNESS_H_
@@ -0,0 +1,47 @@
+#ifndef _BENCHMARKS_H_
+#define _BENCHMARKS_H_
+
+#include "BenchmarkHarness.h"
+
+namespace Numero
+{
+	namespace Benchmark
+	{
+		// matrix sizes every suite draws from, cases are further limited per operation
+		const unsigned int BenchmarkSizes[] = { 2, 4, 8, 16, 32, 64, 128, 256, 512, 1024, 2048, 4096 };
+
+		// default per-operation size limits, lifted by --full
+		const unsigned int NoLimit = 4096;
+		const unsigned int CubicLimit = 1024;			// blocked products and factorizations
+		const unsigned int NaiveCubicLimit = 512;		// triple loop products
+		const unsigned int ElementCallLimit = 1024;		// one virtual call per element
+		const unsigned int IoLimit = 256;				// string formatting
+		const unsigned int CofactorLimit = 8;			// O(n!) cofactor expansion
+		const unsigned int CofactorInverseLimit = 6;
+
+		// sparse suites are sized by rows, with a few nonzeros per row
+		const unsigned int SparseSizes[] = { 1024, 16384, 131072, 1048576 };
+		const unsigned int SparseLimit = 1048576;
+		const unsigned int MatrixMarketLimit = 131072;	// text files of about 20 bytes per nonzero
+
+		// --- suites, see DenseBenchmarks.cpp
+		void RunDenseBenchmarks(BenchmarkRunner& runner);
+		void RunFixedBenchmarks(BenchmarkRunner& runner);
+		void RunSimdBenchmarks(BenchmarkRunner& runner);
+		void RunParallelBenchmarks(BenchmarkRunner& runner);
+
+		// --- suites, see SparseBenchmarks.cpp
+		void RunSparseBenchmarks(BenchmarkRunner& runner);
+
+		// --- suites, see KrylovBenchmarks.cpp
+		void RunKrylovBenchmarks(BenchmarkRunner& runner);
+
+		// --- suites, see CholeskyBenchmarks.cpp
+		void RunCholeskyBenchmarks(BenchmarkRunner& runner);
+
+		// --- suites, see IoBenchmarks.cpp
+		void RunIoBenchmarks(BenchmarkRunner& runner);
+	}
+}
+
+#endif // !_BENCHMARKS_H_
@@ -0,0 +1,122 @@
+#include <iostream>
+#include "../Numero/SparseCholesky.cpp"
+#include "Benchmarks.h"
+
+using namespace Numero;
+using namespace Numero::Benchmark;
+using namespace Numero::DataTypes;
+
+#pragma region HELPERS
+namespace
+{
+	// Laplacian on a side^dimensions grid - 5 points in two dimensions, 7 in three - slightly shifted to stay definite
+	Sparse<double> LaplacianMatrix(unsigned int side, unsigned int dimensions)
+	{
+		unsigned int n = (dimensions == 2) ? side * side : side * side * side;
+		vector<SparseValueTriplet<double> > triplets;
+		triplets.reserve(static_cast<size_t>(n) * (2 * dimensions + 1));
+
+		for (unsigned int row(0); row < n; row++)
+		{
+			triplets.push_back(SparseValueTriplet<double>(row, row, 2.0 * dimensions + 1e-3));
+			unsigned int stride = 1;
+			for (unsigned int d(0); d < dimensions; d++, stride *= side)
+			{
+				unsigned int coordinate = (row / stride) % side;
+				if (coordinate > 0)
+					triplets.push_back(SparseValueTriplet<double>(row, row - stride, -1));
+				if (coordinate + 1 < side)
+					triplets.push_back(SparseValueTriplet<double>(row, row + stride, -1));
+			}
+		}
+
+		return Sparse<double>(n, n, triplets);
+	}
+
+	const char* OrderingName(CholeskyOrdering ordering)
+	{
+		switch (ordering)
+		{
+		case CholeskyOrdering::Natural: return "natural";
+		case CholeskyOrdering::MinimumDegree: return "md";
+		default: return "nd";
+		}
+	}
+
+	// analysis, numeric refactorization and a solve of one matrix - the fill and flops of the analysis
+	// and the time of the first factorization are printed below the cases
+	void FactorCases(BenchmarkRunner& runner, const string& grid, const Sparse<double>& matrix, CholeskyOrdering ordering)
+	{
+		unsigned int n = matrix.Rows();
+		string prefix = "cholesky." + grid + "." + OrderingName(ordering);
+		if (!runner.Selected(prefix + ".analyze", n, SparseLimit) && !runner.Selected(prefix + ".factor", n, SparseLimit)
+			&& !runner.Selected(prefix + ".solve", n, SparseLimit))
+			return;
+
+		SparseCholesky<double> cholesky(matrix, ordering);
+		cholesky.Factorize(matrix);
+
+		if (runner.Selected(prefix + ".analyze", n, SparseLimit))
+		{
+			runner.Run(prefix + ".analyze", "double", n, 0, 0, [&]() {
+				SparseCholesky<double> analysis(matrix, ordering);
+				DoNotOptimize(analysis);
+			});
+		}
+
+		if (runner.Selected(prefix + ".factor", n, SparseLimit))
+		{
+			runner.Run(prefix + ".factor", "double", n, cholesky.Flops(), cholesky.StoredEntries() * sizeof(double), [&]() {
+				cholesky.Factorize(matrix);
+			});
+		}
+
+		if (runner.Selected(prefix + ".solve", n, SparseLimit))
+		{
+			Dense<double> rhs(n, 1);
+			rhs.ResetToConstant(1);
+			runner.Run(prefix + ".solve", "double", n, 4.0 * cholesky.FactorNonZeros(), 2.0 * cholesky.StoredEntries() * sizeof(double), [&]() {
+				Dense<double> x = cholesky.Solve(rhs);
+				DoNotOptimize(x);
+			});
+		}
+
+		cout << "  nnz(A) " << matrix.NonZeros() << ", nnz(L) " << cholesky.FactorNonZeros() << " (fill " << static_cast<double>(cholesky.FactorNonZeros()) / matrix.NonZeros()
+			<< "x), stored " << cholesky.StoredEntries() << ", " << cholesky.Supernodes() << " supernodes, " << cholesky.Flops() << " flops, analysis "
+			<< cholesky.AnalysisSeconds() * 1e3 << " ms, factor " << cholesky.FactorSeconds() * 1e3 << " ms" << endl;
+	}
+}
+#pragma endregion
+
+
+#pragma region SUITE
+// every ordering on two and three dimensional grids - the natural ordering, whose band fills in completely,
+// and minimum degree, whose analysis is far slower than the dissection on grids, only up to about 16k unknowns
+void Numero::Benchmark::RunCholeskyBenchmarks(BenchmarkRunner& runner)
+{
+	for (unsigned int side : { 32u, 128u, 362u })
+	{
+		if (side * side > runner.Options().maxSize)
+			break;
+
+		Sparse<double> laplacian = LaplacianMatrix(side, 2);
+		if (side <= 128)
+		{
+			FactorCases(runner, "grid2d", laplacian, CholeskyOrdering::Natural);
+			FactorCases(runner, "grid2d", laplacian, CholeskyOrdering::MinimumDegree);
+		}
+		FactorCases(runner, "grid2d", laplacian, CholeskyOrdering::NestedDissection);
+	}
+
+	for (unsigned int side : { 10u, 25u, 40u })
+	{
+		if (side * side * side > runner.Options().maxSize)
+			break;
+
+		Sparse<double> laplacian = LaplacianMatrix(side, 3);
+		if (side <= 25)
+			FactorCases(runner, "grid3d", laplacian, CholeskyOrdering::MinimumDegree);
+		FactorCases(runner, "grid3d", laplacian, CholeskyOrdering::NestedDissection);
+	}
+}
+#pragma endregion
@@ -0,0 +1,540 @@
+#include "../Numero/Dense.cpp"
+#include "../Numero/QR.cpp"
+#include "../Numero/SymmetricEigen.cpp"
+#include "../Numero/SVD.cpp"
+#include "Benchmarks.h"
+
+using namespace Numero;
+using namespace Numero::Benchmark;
+using namespace Numero::DataTypes;
+
+#pragma region HELPERS
+namespace
+{
+	// small integers so that every element type represents them exactly and repeated
+	// in-place updates stay far from overflow - the diagonal keeps square matrices invertible
+	template <class T>
+	Dense<T> Filled(unsigned int rows, unsigned int cols, unsigned int seed)
+	{
+		Dense<T> matrix(rows, cols, Uninitialized);
+		T* data = matrix.Data();
+
+		for (unsigned int i(0); i < rows; i++)
+		{
+			for (unsigned int j(0); j < cols; j++)
+			{
+				int value = static_cast<int>((i * 7 + j * 3 + seed) % 11) - 5;
+				if (i == j)
+					value += 2 * static_cast<int>(rows) + 1;
+				data[i*cols + j] = static_cast<T>(value);
+			}
+		}
+
+		return matrix;
+	}
+
+	// unit lower triangular with the entries of Filled below the diagonal - the determinant is 1 at every size, so
+	// exact integral determinants fit every element type
+	template <class T>
+	Dense<T> UnitTriangular(unsigned int n, unsigned int seed)
+	{
+		Dense<T> matrix = Filled<T>(n, n, seed);
+		T* data = matrix.Data();
+
+		for (unsigned int i(0); i < n; i++)
+		{
+			data[i*n + i] = static_cast<T>(1);
+			for (unsigned int j(i + 1); j < n; j++)
+				data[i*n + j] = static_cast<T>(0);
+		}
+
+		return matrix;
+	}
+
+	template <class T> const char* TypeName();
+	template <> const char* TypeName<int>() { return "int"; }
+	template <> const char* TypeName<float>() { return "float"; }
+	template <> const char* TypeName<double>() { return "double"; }
+
+	// runs a case when the runner selects it
+	template <class Body>
+	void Case(BenchmarkRunner& runner, const char* name, const char* type, unsigned int size, unsigned int limit,
+		double flops, double bytes, const Body& body)
+	{
+		if (runner.Selected(name, size, limit))
+			runner.Run(name, type, size, flops, bytes, body);
+	}
+}
+#pragma endregion
+
+
+#pragma region DENSE
+namespace
+{
+	// every Dense<T> operation at every size up to its limit
+	// bytes count the elements each call reads and writes once
+	template <class T>
+	void DenseSuite(BenchmarkRunner& runner)
+	{
+		const char* type = TypeName<T>();
+		const double e = sizeof(T);
+		const bool floating = is_floating_point<T>::value;
+
+		for (unsigned int n : BenchmarkSizes)
+		{
+			if (n > runner.Options().maxSize)
+				break;
+
+			const double n2 = double(n) * n;
+			const double n3 = n2 * n;
+			const unsigned int half = (n > 1) ? n / 2 : 1;
+
+			Dense<T> a = Filled<T>(n, n, 1);
+			Dense<T> b = Filled<T>(n, n, 4);
+			Dense<T> out(n, n);
+			Dense<T> moveSource(a);
+
+			// --- storage
+			Case(runner, "dense.construct_zeroed", type, n, NoLimit, 0, n2*e, [&]() { Dense<T> m(n, n); DoNotOptimize(m); });
+			Case(runner, "dense.construct_uninitialized", type, n, NoLimit, 0, 0, [&]() { Dense<T> m(n, n, Uninitialized); DoNotOptimize(m); });
+			Case(runner, "dense.copy_construct", type, n, NoLimit, 0, 2 * n2*e, [&]() { Dense<T> m(a); DoNotOptimize(m); });
+			Case(runner, "dense.copy_assign", type, n, NoLimit, 0, 2 * n2*e, [&]() { out = a; DoNotOptimize(out); });
+			Case(runner, "dense.move", type, n, NoLimit, 0, 0, [&]() { Dense<T> m(std::move(moveSource)); moveSource = std::move(m); DoNotOptimize(moveSource); });
+			Case(runner, "dense.reset_to_constant", type, n, NoLimit, 0, n2*e, [&]() { out.ResetToConstant(static_cast<T>(1)); DoNotOptimize(out); });
+
+			// --- element access
+			Case(runner, "dense.get_value", type, n, ElementCallLimit, 0, n2*e, [&]() {
+				T sum = static_cast<T>(0);
+				for (unsigned int i(0); i < n; i++)
+					for (unsigned int j(0); j < n; j++)
+						sum += a.GetValue(i, j);
+				DoNotOptimize(sum);
+			});
+			Case(runner, "dense.set_value", type, n, ElementCallLimit, 0, n2*e, [&]() {
+				for (unsigned int i(0); i < n; i++)
+					for (unsigned int j(0); j < n; j++)
+						out.SetValue(i, j, static_cast<T>(j));
+				DoNotOptimize(out);
+			});
+
+			// --- shape producing methods
+			Case(runner, "dense.transpose", type, n, NoLimit, 0, 2 * n2*e, [&]() { DoNotOptimize(a.Transpose()); });
+			Case(runner, "dense.transpose_into", type, n, NoLimit, 0, 2 * n2*e, [&]() { a.TransposeInto(out); DoNotOptimize(out); });
+			Case(runner, "dense.transpose_view_materialize", type, n, NoLimit, 0, 2 * n2*e, [&]() { a.TransposeView().MaterializeInto(out); DoNotOptimize(out); });
+			Case(runner, "dense.diagonal", type, n, NoLimit, 0, 2 * n*e, [&]() { DoNotOptimize(a.Diagonal()); });
+			Case(runner, "dense.submatrix", type, n, NoLimit, 0, 2.0 * half*half*e, [&]() { DoNotOptimize(a.SubMatrix(0, half - 1, 0, half - 1)); });
+			Case(runner, "dense.submatrix_into", type, n, NoLimit, 0, 2.0 * half*half*e, [&]() { a.SubMatrixInto(0, half - 1, 0, half - 1, out); DoNotOptimize(out); });
+			Case(runner, "dense.submatrix_view_trace", type, n, NoLimit, half, half*e, [&]() { DoNotOptimize(a.SubMatrixView(0, half - 1, 0, half - 1).Trace()); });
+			if (n > 1)
+			{
+				Case(runner, "dense.minor", type, n, NoLimit, 0, 2.0 * (n - 1)*(n - 1)*e, [&]() { DoNotOptimize(a.Minor(0, 0)); });
+				Case(runner, "dense.minor_into", type, n, NoLimit, 0, 2.0 * (n - 1)*(n - 1)*e, [&]() { a.MinorInto(0, 0, out); DoNotOptimize(out); });
+			}
+			Case(runner, "dense.concat_rows", type, n, NoLimit, 0, 4 * n2*e, [&]() { DoNotOptimize(a.ConcatRows(b)); });
+			Case(runner, "dense.concat_rows_into", type, n, NoLimit, 0, 4 * n2*e, [&]() { a.ConcatRowsInto(b, out); DoNotOptimize(out); });
+			Case(runner, "dense.concat_cols", type, n, NoLimit, 0, 4 * n2*e, [&]() { DoNotOptimize(a.ConcatCols(b)); });
+			Case(runner, "dense.concat_cols_into", type, n, NoLimit, 0, 4 * n2*e, [&]() { a.ConcatColsInto(b, out); DoNotOptimize(out); });
+			out = a;
+
+			// --- linear actions on rows and columns
+			Case(runner, "dense.trace", type, n, NoLimit, n, n*e, [&]() { DoNotOptimize(a.Trace()); });
+			Case(runner, "dense.row_interchange", type, n, NoLimit, 0, 4 * n*e, [&]() { out.RowInterchange(0, n - 1); DoNotOptimize(out); });
+			Case(runner, "dense.col_interchange", type, n, NoLimit, 0, 4 * n*e, [&]() { out.ColInterchange(0, n - 1); DoNotOptimize(out); });
+			Case(runner, "dense.mul_row_by_scalar", type, n, NoLimit, n, 2 * n*e, [&]() { out.MulRowByScalar(0, static_cast<T>(1)); DoNotOptimize(out); });
+			Case(runner, "dense.mul_col_by_scalar", type, n, NoLimit, n, 2 * n*e, [&]() { out.MulColByScalar(0, static_cast<T>(1)); DoNotOptimize(out); });
+
+			// --- element-wise arithmetic
+			Case(runner, "dense.add_scalar", type, n, NoLimit, n2, 2 * n2*e, [&]() { out.AddScalar(static_cast<T>(1)); DoNotOptimize(out); });
+			Case(runner, "dense.mul_scalar", type, n, NoLimit, n2, 2 * n2*e, [&]() { out.MulScalar(static_cast<T>(1)); DoNotOptimize(out); });
+			out = a;
+			Case(runner, "dense.add_matrix", type, n, NoLimit, n2, 3 * n2*e, [&]() { out.AddMatrix(b); DoNotOptimize(out); });
+			Case(runner, "dense.copy_add_scalar", type, n, NoLimit, n2, 2 * n2*e, [&]() { DoNotOptimize(a.CopyAddScalar(static_cast<T>(1))); });
+			Case(runner, "dense.copy_add_scalar_into", type, n, NoLimit, n2, 2 * n2*e, [&]() { a.CopyAddScalarInto(static_cast<T>(1), out); DoNotOptimize(out); });
+			Case(runner, "dense.copy_mul_scalar", type, n, NoLimit, n2, 2 * n2*e, [&]() { DoNotOptimize(a.CopyMulScalar(static_cast<T>(3))); });
+			Case(runner, "dense.copy_mul_scalar_into", type, n, NoLimit, n2, 2 * n2*e, [&]() { a.CopyMulScalarInto(static_cast<T>(3), out); DoNotOptimize(out); });
+			Case(runner, "dense.copy_add_matrix", type, n, NoLimit, n2, 3 * n2*e, [&]() { DoNotOptimize(a.CopyAddMatrix(b)); });
+			Case(runner, "dense.copy_add_matrix_into", type, n, NoLimit, n2, 3 * n2*e, [&]() { a.CopyAddMatrixInto(b, out); DoNotOptimize(out); });
+			Case(runner, "dense.mul_elementwise", type, n, NoLimit, n2, 3 * n2*e, [&]() { DoNotOptimize(a.MulElementwise(b)); });
+			Case(runner, "dense.mul_elementwise_into", type, n, NoLimit, n2, 3 * n2*e, [&]() { a.MulElementwiseInto(b, out); DoNotOptimize(out); });
+			Case(runner, "dense.expression_fused", type, n, NoLimit, 3 * n2, 3 * n2*e, [&]() { out = a + b * static_cast<T>(2) - static_cast<T>(1); DoNotOptimize(out); });
+			Case(runner, "dense.expression_materialized", type, n, NoLimit, 3 * n2, 8 * n2*e, [&]() {
+				DoNotOptimize(a.CopyAddMatrix(b.CopyMulScalar(static_cast<T>(2))).CopyAddScalar(static_cast<T>(-1)));
+			});
+
+			// --- products
+			Case(runner, "dense.mul_naive", type, n, NaiveCubicLimit, 2 * n3, 3 * n2*e, [&]() { DoNotOptimize(a.MulNaive(b)); });
+			Case(runner, "dense.mul_transposed", type, n, NaiveCubicLimit, 2 * n3, 3 * n2*e, [&]() { DoNotOptimize(a.MulTransposed(b)); });
+			Case(runner, "dense.mul_operator", type, n, CubicLimit, 2 * n3, 3 * n2*e, [&]() { DoNotOptimize(a * b); });
+			Case(runner, "dense.mul_into", type, n, CubicLimit, 2 * n3, 3 * n2*e, [&]() { a.MulInto(b, out); DoNotOptimize(out); });
+			Case(runner, "dense.mul_transpose_view", type, n, CubicLimit, 2 * n3, 3 * n2*e, [&]() { a.TransposeView().MulInto(b, out); DoNotOptimize(out); });
+
+			// --- determinant and inverse - LU for floating point types, Bareiss and cofactors otherwise
+			// the determinant of a leaves int from n = 8, integral determinants are taken of a unit triangular matrix
+			unsigned int solverLimit = floating ? CubicLimit : CofactorLimit;
+			unsigned int inverseLimit = floating ? CubicLimit : CofactorInverseLimit;
+			Dense<T> determinantSource = floating ? a : UnitTriangular<T>(n, 1);
+			Case(runner, "dense.determinant", type, n, solverLimit, floating ? 2 * n3 / 3 : 0, n2*e, [&]() { DoNotOptimize(determinantSource.Determinant()); });
+			Case(runner, "dense.inverse_by_minors", type, n, inverseLimit, floating ? 2 * n3 : 0, 2 * n2*e, [&]() { DoNotOptimize(a.InverseByMinors()); });
+			Case(runner, "dense.determinant_by_cofactors", type, n, CofactorLimit, 0, n2*e, [&]() { DoNotOptimize(determinantSource.DeterminantByCofactors()); });
+			Case(runner, "dense.inverse_by_cofactors", type, n, CofactorInverseLimit, 0, 2 * n2*e, [&]() { DoNotOptimize(a.InverseByCofactors()); });
+
+			// --- io
+			Case(runner, "dense.to_string", type, n, IoLimit, 0, n2*e, [&]() { DoNotOptimize(a.ToString()); });
+		}
+	}
+
+	// factorization and solves, floating point only
+	template <class T>
+	void LUSuite(BenchmarkRunner& runner)
+	{
+		const char* type = TypeName<T>();
+		const double e = sizeof(T);
+
+		for (unsigned int n : BenchmarkSizes)
+		{
+			if (n > runner.Options().maxSize)
+				break;
+
+			const double n2 = double(n) * n;
+			const double n3 = n2 * n;
+
+			Dense<T> a = Filled<T>(n, n, 2);
+			Dense<T> rhs = Filled<T>(n, 1, 5);
+
+			Case(runner, "lu.factorize", type, n, CubicLimit, 2 * n3 / 3, n2*e, [&]() { LU<T> lu(a); DoNotOptimize(lu); });
+
+			if (runner.Selected("lu.solve", n, CubicLimit))
+			{
+				LU<T> lu(a);
+				runner.Run("lu.solve", type, n, 2 * n2, n2*e, [&]() { DoNotOptimize(lu.Solve(rhs)); });
+			}
+		}
+	}
+
+	// Householder QR of square matrices, blocked and column pivoted, and least squares on tall and skinny
+	// matrices of 256 rows per column through QR, TSQR, the LeastSquares dispatch and the normal equations
+	// the least squares cases are sized by their column count
+	template <class T>
+	void QRSuite(BenchmarkRunner& runner)
+	{
+		const char* type = TypeName<T>();
+		const double e = sizeof(T);
+
+		for (unsigned int n : BenchmarkSizes)
+		{
+			if (n > runner.Options().maxSize)
+				break;
+
+			const double n2 = double(n) * n;
+			const double n3 = n2 * n;
+			Dense<T> a = Filled<T>(n, n, 2);
+
+			Case(runner, "qr.factorize", type, n, CubicLimit, 4 * n3 / 3, n2*e, [&]() { QR<T> qr(a); DoNotOptimize(qr); });
+			Case(runner, "qr.factorize_pivoted", type, n, NaiveCubicLimit, 4 * n3 / 3, n2*e, [&]() { QR<T> qr(a, true); DoNotOptimize(qr); });
+		}
+
+		const unsigned int skinnyCols[] = { 8, 16, 32, 64, 128 };
+		for (unsigned int cols : skinnyCols)
+		{
+			const char* cases[] = { "lstsq.qr", "lstsq.tsqr", "lstsq.auto", "lstsq.normal" };
+			if (none_of(begin(cases), end(cases), [&](const char* name) { return runner.Selected(name, cols, CubicLimit); }))
+				continue;
+
+			unsigned int rows = 256 * cols;
+			const double flops = 2.0 * rows * cols * cols - 2.0 * cols * cols * cols / 3;
+			const double bytes = double(rows) * cols * e;
+			Dense<T> a = Filled<T>(rows, cols, 4);
+			Dense<T> b = Filled<T>(rows, 1, 5);
+
+			Case(runner, "lstsq.qr", type, cols, CubicLimit, flops, bytes, [&]() { DoNotOptimize(QR<T>(a).Solve(b)); });
+			Case(runner, "lstsq.tsqr", type, cols, CubicLimit, flops, bytes, [&]() { DoNotOptimize(QR<T>::SolveTallSkinny(a, b)); });
+			Case(runner, "lstsq.auto", type, cols, CubicLimit, flops, bytes, [&]() { DoNotOptimize(LeastSquares(a, b)); });
+			Case(runner, "lstsq.normal", type, cols, CubicLimit, flops / 2, bytes, [&]() {
+				Dense<T> transposed = a.Transpose();
+				DoNotOptimize(LU<T>(transposed * a).Solve(transposed * b));
+			});
+		}
+	}
+
+	// symmetric eigenproblems against the tridiagonal reduction alone, which every variant starts with -
+	// eigenvalues only, all eigenpairs by divide and conquer and the lowest tenth of them by bisection and
+	// inverse iteration. only the lower triangle of the filled matrix is read, so it stands for a symmetric one
+	// flops are the nominal 4n^3/3 of the reduction plus 2n^2 for every back transformed vector
+	template <class T>
+	void EigenSuite(BenchmarkRunner& runner)
+	{
+		const char* type = TypeName<T>();
+		const double e = sizeof(T);
+
+		for (unsigned int n : BenchmarkSizes)
+		{
+			if (n > runner.Options().maxSize)
+				break;
+
+			const double n2 = double(n) * n;
+			const double reduction = 4 * n2 * n / 3;
+			const unsigned int subset = max(n / 10, 1u);
+			Dense<T> a = Filled<T>(n, n, 6);
+
+			Case(runner, "eigen.tridiagonalize", type, n, CubicLimit, reduction, n2*e, [&]() {
+				Dense<T> work(a);
+				vector<T> tau;
+				vector<T> diagonal;
+				vector<T> offDiagonal;
+				SymmetricEigen<T>::Tridiagonalize(work, tau, diagonal, offDiagonal);
+				DoNotOptimize(diagonal);
+			});
+			Case(runner, "eigen.values", type, n, CubicLimit, reduction, n2*e, [&]() { SymmetricEigen<T> eigen(a, false); DoNotOptimize(eigen); });
+			Case(runner, "eigen.vectors", type, n, CubicLimit, reduction + 2 * n2 * n, 2 * n2*e, [&]() { SymmetricEigen<T> eigen(a); DoNotOptimize(eigen); });
+			Case(runner, "eigen.subset", type, n, CubicLimit, reduction + 2 * n2 * subset, n2*e, [&]() {
+				DoNotOptimize(SymmetricEigen<T>::ByIndex(a, 0, subset - 1));
+			});
+		}
+	}
+
+	// exact integer determinants - Bareiss in 64 bits on I + u*v', whose minors stay small at every size,
+	// and modulo a prime on a general matrix, against the cofactor expansion and the inexact LU in double
+	// items are the element updates of the elimination, about n^3/3
+	void BareissSuite(BenchmarkRunner& runner)
+	{
+		const unsigned int bareissSizes[] = { 5, 10, 20, 50, 100, 200, 500 };
+
+		for (unsigned int n : bareissSizes)
+		{
+			if (n > runner.Options().maxSize)
+				break;
+
+			const double updates = double(n) * n * n / 3;
+			Dense<int> rankOne(n, n);
+			for (unsigned int i(0); i < n; i++)
+				for (unsigned int j(0); j < n; j++)
+					rankOne.Data()[i*n + j] = (static_cast<int>((i * 5 + 1) % 7) - 3) * (static_cast<int>((j * 3 + 2) % 7) - 3) + ((i == j) ? 1 : 0);
+			Dense<int> general = Filled<int>(n, n, 3);
+			Dense<double> generalDouble = Filled<double>(n, n, 3);
+
+			if (runner.Selected("bareiss.int64", n, CubicLimit))
+				runner.Run("bareiss.int64", "int", n, 0, 0, updates, [&]() { DoNotOptimize(rankOne.Determinant()); });
+			if (runner.Selected("bareiss.modular", n, CubicLimit))
+			{
+				runner.Run("bareiss.modular", "int", n, 0, 0, updates, [&]() {
+					Bareiss<int, ModularInteger<2147483629> > bareiss(general);
+					DoNotOptimize(bareiss);
+				});
+			}
+			if (runner.Selected("bareiss.cofactors", n, CofactorLimit))
+				runner.Run("bareiss.cofactors", "int", n, 0, 0, updates, [&]() { DoNotOptimize(rankOne.DeterminantByCofactors()); });
+			if (runner.Selected("bareiss.lu_double", n, CubicLimit))
+				runner.Run("bareiss.lu_double", "double", n, 2 * n * updates, 0, updates, [&]() { DoNotOptimize(generalDouble.Determinant()); });
+		}
+	}
+
+	// singular value decompositions across aspect ratios, sized by the short side n - square, 4 and 16 rows per
+	// column (QR before the bidiagonalization) and 4 columns per row (through the transpose). values only, thin and
+	// full vectors, the pseudoinverse, and the leading 10 triplets by the randomized SVD with its default
+	// oversampling and power iterations
+	// flops are the nominal 4mn^2 - 4n^3/3 of the bidiagonalization plus 2n^2 for every back transformed vector,
+	// and 2mnl for every product of A with the l = 20 samples of the randomized SVD
+	template <class T>
+	void SvdSuite(BenchmarkRunner& runner)
+	{
+		struct Shape { const char* suffix; unsigned int rowFactor; unsigned int colFactor; unsigned int limit; };
+		const Shape shapes[] = {
+			{ "square", 1, 1, CubicLimit },
+			{ "tall4", 4, 1, NaiveCubicLimit },
+			{ "tall16", 16, 1, NaiveCubicLimit / 2 },
+			{ "wide4", 1, 4, NaiveCubicLimit } };
+		const char* type = TypeName<T>();
+		const double e = sizeof(T);
+		const unsigned int rank = 10;
+
+		for (const Shape& shape : shapes)
+		{
+			string names[] = { string("svd.values.") + shape.suffix, string("svd.thin.") + shape.suffix, string("svd.full.") + shape.suffix,
+				string("svd.pinv.") + shape.suffix, string("svd.truncated.") + shape.suffix };
+			unsigned int fullLimit = shape.limit / max(shape.rowFactor, shape.colFactor);
+
+			for (unsigned int n : BenchmarkSizes)
+			{
+				if (n > runner.Options().maxSize)
+					break;
+				if (none_of(begin(names), end(names), [&](const string& name) { return runner.Selected(name, n, shape.limit); }))
+					continue;
+
+				unsigned int rows = n * shape.rowFactor;
+				unsigned int cols = n * shape.colFactor;
+				const double large = max(rows, cols);
+				const double small = n;
+				const double reduction = 4 * large * small * small - 4 * small * small * small / 3;
+				const double bytes = large * small * e;
+				Dense<T> a = Filled<T>(rows, cols, 7);
+
+				Case(runner, names[0].c_str(), type, n, shape.limit, reduction, bytes, [&]() { SVD<T> svd(a, SvdVectors::None); DoNotOptimize(svd); });
+				Case(runner, names[1].c_str(), type, n, shape.limit, reduction + 2 * small * small * (large + small), bytes, [&]() {
+					SVD<T> svd(a);
+					DoNotOptimize(svd);
+				});
+				Case(runner, names[2].c_str(), type, n, fullLimit, reduction + 2 * large * large * large + 2 * small * small * small, bytes, [&]() {
+					SVD<T> svd(a, SvdVectors::Full);
+					DoNotOptimize(svd);
+				});
+				Case(runner, names[3].c_str(), type, n, shape.limit, reduction + 2 * small * small * (large + small) + 2 * large * small * small, bytes, [&]() {
+					DoNotOptimize(a.PseudoInverse());
+				});
+				if (n > 2 * rank)
+				{
+					Case(runner, names[4].c_str(), type, n, shape.limit, 6 * 2 * large * small * 2 * rank, bytes, [&]() {
+						DoNotOptimize(SVD<T>::Truncated(a, rank));
+					});
+				}
+			}
+		}
+	}
+}
+
+void Numero::Benchmark::RunDenseBenchmarks(BenchmarkRunner& runner)
+{
+	DenseSuite<int>(runner);
+	DenseSuite<float>(runner);
+	DenseSuite<double>(runner);
+
+	LUSuite<float>(runner);
+	LUSuite<double>(runner);
+
+	BareissSuite(runner);
+
+	QRSuite<float>(runner);
+	QRSuite<double>(runner);
+
+	EigenSuite<float>(runner);
+	EigenSuite<double>(runner);
+
+	SvdSuite<float>(runner);
+	SvdSuite<double>(runner);
+}
+#pragma endregion
+
+
+#pragma region FIXED_SIZE
+namespace
+{
+	// fixed-size operations against the dynamic paths they replace
+	// inputs pass through DoNotOptimize so that nothing is folded at compile time
+	template <class T, unsigned int N>
+	void FixedSuite(BenchmarkRunner& runner)
+	{
+		const char* type = TypeName<T>();
+		const double n3 = double(N) * N * N;
+
+		Dense<T> dynamicA = Filled<T>(N, N, 1);
+		Dense<T> dynamicB = Filled<T>(N, N, 4);
+		Dense<T, N, N> fixedA(dynamicA);
+		Dense<T, N, N> fixedB(dynamicB);
+
+		Case(runner, "fixed.mul", type, N, NoLimit, 2 * n3, 0, [&]() { DoNotOptimize(fixedA); DoNotOptimize(fixedA * fixedB); });
+		Case(runner, "fixed.dynamic_mul_naive", type, N, NoLimit, 2 * n3, 0, [&]() { DoNotOptimize(dynamicA.MulNaive(dynamicB)); });
+		Case(runner, "fixed.transpose", type, N, NoLimit, 0, 0, [&]() { DoNotOptimize(fixedA); DoNotOptimize(fixedA.Transpose()); });
+		Case(runner, "fixed.dynamic_transpose", type, N, NoLimit, 0, 0, [&]() { DoNotOptimize(dynamicA.Transpose()); });
+		Case(runner, "fixed.determinant", type, N, NoLimit, 0, 0, [&]() { DoNotOptimize(fixedA); DoNotOptimize(fixedA.Determinant()); });
+		Case(runner, "fixed.dynamic_determinant", type, N, NoLimit, 0, 0, [&]() { DoNotOptimize(dynamicA.Determinant()); });
+		Case(runner, "fixed.inverse", type, N, NoLimit, 0, 0, [&]() { DoNotOptimize(fixedA); DoNotOptimize(fixedA.Inverse()); });
+		Case(runner, "fixed.dynamic_inverse_by_minors", type, N, NoLimit, 0, 0, [&]() { DoNotOptimize(dynamicA.InverseByMinors()); });
+	}
+
+	template <class T>
+	void FixedSuites(BenchmarkRunner& runner)
+	{
+		FixedSuite<T, 2>(runner);
+		FixedSuite<T, 3>(runner);
+		FixedSuite<T, 4>(runner);
+	}
+}
+
+void Numero::Benchmark::RunFixedBenchmarks(BenchmarkRunner& runner)
+{
+	FixedSuites<int>(runner);
+	FixedSuites<float>(runner);
+	FixedSuites<double>(runner);
+}
+#pragma endregion
+
+
+#pragma region SIMD
+namespace
+{
+	// element-wise kernels at every instruction set level the CPU supports
+	template <class T>
+	void SimdSuite(BenchmarkRunner& runner)
+	{
+		const char* type = TypeName<T>();
+		const double e = sizeof(T);
+		const unsigned int simdSizes[] = { 64, 1024, 4096 };
+		SimdLevel detected = Simd::Detected();
+
+		for (unsigned int n : simdSizes)
+		{
+			if (n > runner.Options().maxSize)
+				break;
+
+			const double n2 = double(n) * n;
+			const size_t count = static_cast<size_t>(n) * n;
+			Dense<T> a = Filled<T>(n, n, 1);
+			Dense<T> b = Filled<T>(n, n, 4);
+			Dense<T> out(n, n);
+
+			for (int level(0); level <= static_cast<int>(detected); level++)
+			{
+				SimdLevel active = Simd::SetActive(static_cast<SimdLevel>(level));
+				string suffix = string(".") + Simd::LevelName(active);
+
+				Case(runner, ("simd.fill" + suffix).c_str(), type, n, NoLimit, 0, n2*e, [&]() { Simd::Fill(out.Data(), static_cast<T>(1), count); DoNotOptimize(out); });
+				Case(runner, ("simd.add_scalar" + suffix).c_str(), type, n, NoLimit, n2, 2 * n2*e, [&]() { Simd::AddScalar(a.Data(), static_cast<T>(1), out.Data(), count); DoNotOptimize(out); });
+				Case(runner, ("simd.mul_scalar" + suffix).c_str(), type, n, NoLimit, n2, 2 * n2*e, [&]() { Simd::MulScalar(a.Data(), static_cast<T>(3), out.Data(), count); DoNotOptimize(out); });
+				Case(runner, ("simd.add" + suffix).c_str(), type, n, NoLimit, n2, 3 * n2*e, [&]() { Simd::Add(a.Data(), b.Data(), out.Data(), count); DoNotOptimize(out); });
+				Case(runner, ("simd.mul" + suffix).c_str(), type, n, NoLimit, n2, 3 * n2*e, [&]() { Simd::Mul(a.Data(), b.Data(), out.Data(), count); DoNotOptimize(out); });
+			}
+
+			Simd::SetActive(detected);
+		}
+	}
+}
+
+void Numero::Benchmark::RunSimdBenchmarks(BenchmarkRunner& runner)
+{
+	SimdSuite<int>(runner);
+	SimdSuite<float>(runner);
+	SimdSuite<double>(runner);
+}
+#pragma endregion
+
+
+#pragma region PARALLEL
+// blocked product scaling over the thread pool, and allocation pool reuse of temporaries
+void Numero::Benchmark::RunParallelBenchmarks(BenchmarkRunner& runner)
+{
+	const unsigned int n = 1024;
+	if (n > runner.Options().maxSize)
+		return;
+
+	const double n2 = double(n) * n;
+	Dense<double> a = Filled<double>(n, n, 1);
+	Dense<double> b = Filled<double>(n, n, 4);
+	Dense<double> out(n, n);
+
+	unsigned int maxThreads = ThreadPool::Global().ThreadCount();
+	for (unsigned int threads(1); ; threads = (2 * threads < maxThreads) ? 2 * threads : maxThreads)
+	{
+		string name = "parallel.mul_into.threads_" + to_string(threads);
+		Case(runner, name.c_str(), "double", n, CubicLimit, 2 * n2 * n, 3 * n2 * sizeof(double), [&]() { a.MulInto(b, out, threads); DoNotOptimize(out); });
+
+		if (threads == maxThreads)
+			break;
+	}
+
+	Dense<double> small = Filled<double>(64, 64, 1);
+	Case(runner, "parallel.pooled_temporaries", "double", 64, NoLimit, 0, 0, [&]() {
+		Dense<double> transposed = small.Transpose();
+		Dense<double> scaled = transposed.CopyMulScalar(2.0);
+		DoNotOptimize(scaled);
+	});
+}
+#pragma endregion
@@ -0,0 +1,364 @@
+#include <iostream>
+#include <sstream>
+#include <cstdio>
+#include "../Numero/MatrixMarket.cpp"
+#include "../Numero/BinaryMatrix.cpp"
+#include "Benchmarks.h"
+
+using namespace Numero;
+using namespace Numero::Benchmark;
+using namespace Numero::DataTypes;
+
+#pragma region HELPERS
+namespace
+{
+	unsigned int NextRandom(unsigned int& seed)
+	{
+		seed = seed * 1664525 + 1013904223;
+		return seed >> 8;
+	}
+
+	// perRow entries in every row with full precision values, the way exported simulation matrices look
+	Sparse<double> RandomMatrix(unsigned int rows, unsigned int perRow, unsigned int seed)
+	{
+		vector<SparseValueTriplet<double> > triplets;
+		triplets.reserve(static_cast<size_t>(rows) * perRow);
+
+		for (unsigned int row(0); row < rows; row++)
+		{
+			for (unsigned int i(0); i < perRow; i++)
+				triplets.push_back(SparseValueTriplet<double>(row, NextRandom(seed) % rows, (NextRandom(seed) % 1000003) / 7.0 - 7e4));
+		}
+
+		return Sparse<double>(rows, rows, triplets);
+	}
+
+	string ReadText(const string& path)
+	{
+		MappedFile file(path);
+		return string(file.Data(), file.Size());
+	}
+
+	// the loading loop this suite replaces - a stream extraction and a call per entry
+	Dense<double> StreamDense(const string& text)
+	{
+		istringstream in(text);
+		string line;
+		getline(in, line);
+		unsigned int rows, cols;
+		in >> rows >> cols;
+
+		Dense<double> matrix(rows, cols);
+		for (unsigned int col(0); col < cols; col++)
+		{
+			for (unsigned int row(0); row < rows; row++)
+			{
+				double value;
+				in >> value;
+				matrix.SetValue(row, col, value);
+			}
+		}
+		return matrix;
+	}
+
+	Sparse<double> StreamSparse(const string& text)
+	{
+		istringstream in(text);
+		string line;
+		getline(in, line);
+		unsigned int rows, cols, entries;
+		in >> rows >> cols >> entries;
+
+		vector<SparseValueTriplet<double> > triplets;
+		triplets.reserve(entries);
+		for (unsigned int i(0); i < entries; i++)
+		{
+			unsigned int row, col;
+			double value;
+			in >> row >> col >> value;
+			triplets.push_back(SparseValueTriplet<double>(row - 1, col - 1, value));
+		}
+		return Sparse<double>(rows, cols, triplets);
+	}
+
+	void PrintThroughput(const BenchmarkRunner& runner, const string& name, size_t bytes)
+	{
+		const vector<BenchmarkResult>& results = runner.Results();
+		if (!results.empty() && results.back().name == name)
+			cout << "  " << bytes / results.back().medianSecs / 1e6 << " MB/s" << endl;
+	}
+
+	// the formatting loop ToString replaced - a stream insertion and a virtual call per element
+	string StreamFormat(const Dense<double>& matrix)
+	{
+		ostringstream ss;
+		ss << "[";
+		for (unsigned int row(0); row < matrix.Rows(); row++)
+		{
+			for (unsigned int col(0); col < matrix.Cols(); col++)
+			{
+				ss << matrix.GetValue(row, col);
+				if (col != matrix.Cols() - 1)
+					ss << ",";
+			}
+			ss << ((row != matrix.Rows() - 1) ? ";" : "]") << endl;
+		}
+		return ss.str();
+	}
+}
+#pragma endregion
+
+
+#pragma region SUITE
+namespace
+{
+	// ToString, formatting into a reused buffer and Parse against the stream loop, reported in MB/s of text
+	void TextSuite(BenchmarkRunner& runner)
+	{
+		const string cases[] = { "io.text_to_string", "io.text_format_chunks", "io.text_ostringstream", "io.text_parse" };
+
+		for (unsigned int n : BenchmarkSizes)
+		{
+			if (n < 64 || none_of(begin(cases), end(cases), [&](const string& name) { return runner.Selected(name, n, CubicLimit); }))
+				continue;
+
+			Dense<double> matrix(n, n);
+			unsigned int seed = n;
+			for (unsigned int i(0); i < matrix.Numel(); i++)
+				matrix.Data()[i] = (NextRandom(seed) % 1000003) / 7.0 - 7e4;
+			string text = matrix.ToString();
+			double bytes = static_cast<double>(text.size());
+
+			if (runner.Selected("io.text_to_string", n, CubicLimit))
+			{
+				runner.Run("io.text_to_string", "double", n, 0, bytes, matrix.Numel(), [&]() {
+					string formatted = matrix.ToString();
+					DoNotOptimize(formatted);
+				});
+				PrintThroughput(runner, "io.text_to_string", text.size());
+			}
+
+			if (runner.Selected("io.text_format_chunks", n, CubicLimit))
+			{
+				vector<char> buffer(TextFormat::ChunkSize);
+				runner.Run("io.text_format_chunks", "double", n, 0, bytes, matrix.Numel(), [&]() {
+					size_t total = 0;
+					matrix.Format(buffer.data(), buffer.size(), [&](const char*, size_t length) { total += length; });
+					DoNotOptimize(total);
+				});
+				PrintThroughput(runner, "io.text_format_chunks", text.size());
+			}
+
+			if (runner.Selected("io.text_ostringstream", n, CubicLimit))
+			{
+				runner.Run("io.text_ostringstream", "double", n, 0, bytes, matrix.Numel(), [&]() {
+					string formatted = StreamFormat(matrix);
+					DoNotOptimize(formatted);
+				});
+				PrintThroughput(runner, "io.text_ostringstream", text.size());
+			}
+
+			if (runner.Selected("io.text_parse", n, CubicLimit))
+			{
+				runner.Run("io.text_parse", "double", n, 0, bytes, matrix.Numel(), [&]() {
+					Dense<double> parsed;
+					Dense<double>::Parse(text, parsed);
+					DoNotOptimize(parsed);
+				});
+				PrintThroughput(runner, "io.text_parse", text.size());
+			}
+		}
+	}
+
+	// binary saves and loads against ToString and the Matrix Market reader, reported in MB/s of file
+	// the mapped cases open the file and read every element once, which is what the copy saves
+	void BinarySuite(BenchmarkRunner& runner)
+	{
+		const string densePath = "numero_benchmark_dense.nbm";
+		const string sparsePath = "numero_benchmark_sparse.nbm";
+		const string denseCases[] = { "io.bin_write_dense", "io.bin_read_dense", "io.bin_map_dense", "io.to_string_dense" };
+		const string sparseCases[] = { "io.bin_write_sparse", "io.bin_read_sparse", "io.bin_map_sparse" };
+
+		for (unsigned int n : BenchmarkSizes)
+		{
+			if (n < 64 || none_of(begin(denseCases), end(denseCases), [&](const string& name) { return runner.Selected(name, n, CubicLimit); }))
+				continue;
+
+			Dense<double> matrix(n, n);
+			unsigned int seed = n;
+			for (unsigned int i(0); i < matrix.Numel(); i++)
+				matrix.Data()[i] = (NextRandom(seed) % 1000003) / 7.0 - 7e4;
+			size_t fileBytes = BinaryMatrix::MakeHeader<double>(BinaryLayout::DenseRowMajor, n, n, matrix.Numel()).fileSize;
+			double bytes = static_cast<double>(fileBytes);
+
+			if (runner.Selected("io.bin_write_dense", n, CubicLimit))
+			{
+				runner.Run("io.bin_write_dense", "double", n, 0, bytes, matrix.Numel(), [&]() {
+					DoNotOptimize(BinaryMatrix::WriteDense(densePath, matrix));
+				});
+				PrintThroughput(runner, "io.bin_write_dense", fileBytes);
+			}
+
+			BinaryMatrix::WriteDense(densePath, matrix);
+			if (runner.Selected("io.bin_read_dense", n, CubicLimit))
+			{
+				runner.Run("io.bin_read_dense", "double", n, 0, bytes, matrix.Numel(), [&]() {
+					Dense<double> read;
+					BinaryMatrix::ReadDense(densePath, read);
+					DoNotOptimize(read);
+				});
+				PrintThroughput(runner, "io.bin_read_dense", fileBytes);
+			}
+
+			if (runner.Selected("io.bin_map_dense", n, CubicLimit))
+			{
+				runner.Run("io.bin_map_dense", "double", n, 0, bytes, matrix.Numel(), [&]() {
+					MappedDense<double> mapped(densePath);
+					double sum = 0;
+					for (unsigned int i(0); i < mapped.Rows() * mapped.Cols(); i++)
+						sum += mapped.Data()[i];
+					DoNotOptimize(sum);
+				});
+				PrintThroughput(runner, "io.bin_map_dense", fileBytes);
+			}
+
+			if (runner.Selected("io.to_string_dense", n, CubicLimit))
+			{
+				runner.Run("io.to_string_dense", "double", n, 0, bytes, matrix.Numel(), [&]() {
+					string text = matrix.ToString();
+					DoNotOptimize(text);
+				});
+				PrintThroughput(runner, "io.to_string_dense", fileBytes);
+			}
+		}
+		remove(densePath.c_str());
+
+		for (unsigned int n : SparseSizes)
+		{
+			if (none_of(begin(sparseCases), end(sparseCases), [&](const string& name) { return runner.Selected(name, n, SparseLimit); }))
+				continue;
+
+			Sparse<double> matrix = RandomMatrix(n, 8, n);
+			size_t fileBytes = BinaryMatrix::MakeHeader<double>(BinaryLayout::SparseCsr, n, n, matrix.NonZeros()).fileSize;
+			double bytes = static_cast<double>(fileBytes);
+
+			if (runner.Selected("io.bin_write_sparse", n, SparseLimit))
+			{
+				runner.Run("io.bin_write_sparse", "double", n, 0, bytes, matrix.NonZeros(), [&]() {
+					DoNotOptimize(BinaryMatrix::WriteSparse(sparsePath, matrix));
+				});
+				PrintThroughput(runner, "io.bin_write_sparse", fileBytes);
+			}
+
+			BinaryMatrix::WriteSparse(sparsePath, matrix);
+			if (runner.Selected("io.bin_read_sparse", n, SparseLimit))
+			{
+				runner.Run("io.bin_read_sparse", "double", n, 0, bytes, matrix.NonZeros(), [&]() {
+					Sparse<double> read;
+					BinaryMatrix::ReadSparse(sparsePath, read);
+					DoNotOptimize(read);
+				});
+				PrintThroughput(runner, "io.bin_read_sparse", fileBytes);
+			}
+
+			if (runner.Selected("io.bin_map_sparse", n, SparseLimit))
+			{
+				vector<double> x(n, 1.0), y(n);
+				runner.Run("io.bin_map_sparse", "double", n, 0, bytes, matrix.NonZeros(), [&]() {
+					MappedSparse<double> mapped(sparsePath);
+					mapped.MulVectorInto(x.data(), y.data());
+					DoNotOptimize(y);
+				});
+				PrintThroughput(runner, "io.bin_map_sparse", fileBytes);
+			}
+		}
+		remove(sparsePath.c_str());
+	}
+}
+
+// Matrix Market parsing from memory and from a mapped file against stream extraction, reported in MB/s of text
+void Numero::Benchmark::RunIoBenchmarks(BenchmarkRunner& runner)
+{
+	const string sparsePath = "numero_benchmark_sparse.mtx";
+	const string densePath = "numero_benchmark_dense.mtx";
+
+	for (unsigned int n : SparseSizes)
+	{
+		if (!runner.Selected("io.mtx_parse_sparse", n, MatrixMarketLimit) && !runner.Selected("io.mtx_read_sparse", n, MatrixMarketLimit)
+			&& !runner.Selected("io.mtx_istream_sparse", n, MatrixMarketLimit))
+			continue;
+
+		Sparse<double> matrix = RandomMatrix(n, 8, n);
+		MatrixMarket::WriteSparse(sparsePath, matrix);
+		string text = ReadText(sparsePath);
+		double bytes = static_cast<double>(text.size());
+
+		if (runner.Selected("io.mtx_parse_sparse", n, MatrixMarketLimit))
+		{
+			runner.Run("io.mtx_parse_sparse", "double", n, 0, bytes, matrix.NonZeros(), [&]() {
+				Sparse<double> parsed;
+				MatrixMarket::ParseSparse(text.data(), text.size(), parsed);
+				DoNotOptimize(parsed);
+			});
+			PrintThroughput(runner, "io.mtx_parse_sparse", text.size());
+		}
+
+		if (runner.Selected("io.mtx_read_sparse", n, MatrixMarketLimit))
+		{
+			runner.Run("io.mtx_read_sparse", "double", n, 0, bytes, matrix.NonZeros(), [&]() {
+				Sparse<double> read;
+				MatrixMarket::ReadSparse(sparsePath, read);
+				DoNotOptimize(read);
+			});
+			PrintThroughput(runner, "io.mtx_read_sparse", text.size());
+		}
+
+		if (runner.Selected("io.mtx_istream_sparse", n, MatrixMarketLimit))
+		{
+			runner.Run("io.mtx_istream_sparse", "double", n, 0, bytes, matrix.NonZeros(), [&]() {
+				Sparse<double> read = StreamSparse(text);
+				DoNotOptimize(read);
+			});
+			PrintThroughput(runner, "io.mtx_istream_sparse", text.size());
+		}
+	}
+	remove(sparsePath.c_str());
+
+	for (unsigned int n : BenchmarkSizes)
+	{
+		if (n < 64 || (!runner.Selected("io.mtx_read_dense", n, CubicLimit) && !runner.Selected("io.mtx_istream_dense", n, CubicLimit)))
+			continue;
+
+		Dense<double> matrix(n, n);
+		unsigned int seed = n;
+		for (unsigned int i(0); i < matrix.Numel(); i++)
+			matrix.Data()[i] = (NextRandom(seed) % 1000003) / 7.0 - 7e4;
+		MatrixMarket::WriteDense(densePath, matrix);
+		string text = ReadText(densePath);
+		double bytes = static_cast<double>(text.size());
+
+		if (runner.Selected("io.mtx_read_dense", n, CubicLimit))
+		{
+			runner.Run("io.mtx_read_dense", "double", n, 0, bytes, matrix.Numel(), [&]() {
+				Dense<double> read;
+				MatrixMarket::ReadDense(densePath, read);
+				DoNotOptimize(read);
+			});
+			PrintThroughput(runner, "io.mtx_read_dense", text.size());
+		}
+
+		if (runner.Selected("io.mtx_istream_dense", n, CubicLimit))
+		{
+			runner.Run("io.mtx_istream_dense", "double", n, 0, bytes, matrix.Numel(), [&]() {
+				Dense<double> read = StreamDense(text);
+				DoNotOptimize(read);
+			});
+			PrintThroughput(runner, "io.mtx_istream_dense", text.size());
+		}
+	}
+	remove(densePath.c_str());
+
+	TextSuite(runner);
+	BinarySuite(runner);
+}
+#pragma endregion
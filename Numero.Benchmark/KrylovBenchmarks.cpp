@@ -0,0 +1,151 @@
+#include <iostream>
+#include "../Numero/Krylov.cpp"
+#include "Benchmarks.h"
+
+using namespace Numero;
+using namespace Numero::Benchmark;
+using namespace Numero::DataTypes;
+
+#pragma region HELPERS
+namespace
+{
+	// 5-point Laplacian on a side x side grid, plus a first order upwind convection term when convection is not zero
+	Sparse<double> GridMatrix(unsigned int side, double convection)
+	{
+		vector<SparseValueTriplet<double> > triplets;
+		triplets.reserve(static_cast<size_t>(side) * side * 5);
+
+		for (unsigned int i(0); i < side; i++)
+		{
+			for (unsigned int j(0); j < side; j++)
+			{
+				unsigned int row = i * side + j;
+				triplets.push_back(SparseValueTriplet<double>(row, row, 4 + convection));
+				if (i > 0)
+					triplets.push_back(SparseValueTriplet<double>(row, row - side, -1 - convection));
+				if (i + 1 < side)
+					triplets.push_back(SparseValueTriplet<double>(row, row + side, -1));
+				if (j > 0)
+					triplets.push_back(SparseValueTriplet<double>(row, row - 1, -1));
+				if (j + 1 < side)
+					triplets.push_back(SparseValueTriplet<double>(row, row + 1, -1));
+			}
+		}
+
+		return Sparse<double>(side * side, side * side, triplets);
+	}
+
+	// one full solve per call - items are iterations, so Mitems/s is the iteration rate
+	// the iteration count and the seconds per iteration of the first solve, as reported through the callback, are printed below the case
+	template <class Solve>
+	void SolveCase(BenchmarkRunner& runner, const string& name, unsigned int n, const Solve& solve)
+	{
+		if (!runner.Selected(name, n, SparseLimit))
+			return;
+
+		unsigned int iterations = 0;
+		double lastSeconds = 0;
+		KrylovOptions options;
+		options.maxIterations = 5000;
+		options.callback = [&](unsigned int iteration, double, double seconds) { iterations = iteration; lastSeconds = seconds; };
+
+		KrylovResult first = solve(options);
+		options.callback = KrylovCallback();
+
+		runner.Run(name, "double", n, 0, 0, first.iterations, [&]() {
+			KrylovResult result = solve(options);
+			DoNotOptimize(result);
+		});
+
+		cout << "  " << iterations << " iterations, " << (iterations ? lastSeconds / iterations * 1e6 : 0.0) << " us per iteration, converged "
+			<< (first.converged ? "yes" : "no") << endl;
+	}
+}
+#pragma endregion
+
+
+#pragma region SUITE
+// fused vector kernels against their unfused sequences, then complete solves on grid problems
+void Numero::Benchmark::RunKrylovBenchmarks(BenchmarkRunner& runner)
+{
+	for (unsigned int n : SparseSizes)
+	{
+		if (n > runner.Options().maxSize)
+			break;
+
+		vector<double> x(n, 0.5), y(n, 0.25);
+
+		if (runner.Selected("krylov.axpy_dot", n, SparseLimit))
+		{
+			runner.Run("krylov.axpy_dot", "double", n, 4.0 * n, 3.0 * n * sizeof(double), n, [&]() {
+				double norm = Krylov::AxpyDot(1e-9, x.data(), y.data(), y.data(), n);
+				DoNotOptimize(norm);
+			});
+		}
+
+		if (runner.Selected("krylov.axpy_then_dot", n, SparseLimit))
+		{
+			runner.Run("krylov.axpy_then_dot", "double", n, 4.0 * n, 5.0 * n * sizeof(double), n, [&]() {
+				Krylov::Axpy(1e-9, x.data(), y.data(), n);
+				double norm = Krylov::Dot(y.data(), y.data(), n);
+				DoNotOptimize(norm);
+			});
+		}
+	}
+
+	// grids of 32x32 up to 1024x1024 unknowns
+	for (unsigned int side : { 32u, 128u, 362u, 1024u })
+	{
+		unsigned int n = side * side;
+		if (n > runner.Options().maxSize)
+			break;
+
+		Sparse<double> poisson = GridMatrix(side, 0);
+		Dense<double> rhs(n, 1);
+		rhs.ResetToConstant(1);
+		Dense<double> x;
+
+		SolveCase(runner, "krylov.cg", n, [&](const KrylovOptions& options) {
+			x.Resize(0, 0);
+			return Krylov::ConjugateGradient(poisson, rhs, x, options);
+		});
+
+		if (runner.Selected("krylov.cg_ssor", n, SparseLimit))
+		{
+			SsorPreconditioner<double> ssor(poisson, 1.5);
+			SolveCase(runner, "krylov.cg_ssor", n, [&](const KrylovOptions& options) {
+				x.Resize(0, 0);
+				return Krylov::ConjugateGradient(poisson, rhs, x, ssor, options);
+			});
+		}
+
+		if (runner.Selected("krylov.cg_ilu0", n, SparseLimit))
+		{
+			Ilu0Preconditioner<double> ilu(poisson);
+			SolveCase(runner, "krylov.cg_ilu0", n, [&](const KrylovOptions& options) {
+				x.Resize(0, 0);
+				return Krylov::ConjugateGradient(poisson, rhs, x, ilu, options);
+			});
+		}
+
+		Sparse<double> convection = GridMatrix(side, 2);
+		if (runner.Selected("krylov.bicgstab_ilu0", n, SparseLimit) || runner.Selected("krylov.gmres", n, SparseLimit))
+		{
+			Ilu0Preconditioner<double> ilu(convection);
+			JacobiPreconditioner<double> jacobi(convection);
+			SolveCase(runner, "krylov.bicgstab_ilu0", n, [&](const KrylovOptions& options) {
+				x.Resize(0, 0);
+				return Krylov::BiCgStab(convection, rhs, x, ilu, options);
+			});
+			SolveCase(runner, "krylov.gmres_jacobi", n, [&](const KrylovOptions& options) {
+				x.Resize(0, 0);
+				return Krylov::Gmres(convection, rhs, x, jacobi, options);
+			});
+			SolveCase(runner, "krylov.gmres_ilu0", n, [&](const KrylovOptions& options) {
+				x.Resize(0, 0);
+				return Krylov::Gmres(convection, rhs, x, ilu, options);
+			});
+		}
+	}
+}
+#pragma endregion
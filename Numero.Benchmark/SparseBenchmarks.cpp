@@ -0,0 +1,528 @@
+#include <cmath>
+#include <iostream>
+#include "../Numero/Sparse.cpp"
+#include "../Numero/SparseSell.cpp"
+#include "../Numero/SparseBlock.cpp"
+#include "Benchmarks.h"
+
+using namespace Numero;
+using namespace Numero::Benchmark;
+using namespace Numero::DataTypes;
+
+#pragma region HELPERS
+namespace
+{
+	unsigned int NextRandom(unsigned int& seed)
+	{
+		seed = seed * 1664525 + 1013904223;
+		return seed >> 8;
+	}
+
+	// perRow entries in every row at random columns, in random order,
+	// a quarter of them repeating the position of an earlier entry
+	vector<SparseValueTriplet<double> > RandomTriplets(unsigned int rows, unsigned int cols, unsigned int perRow, unsigned int seed)
+	{
+		vector<SparseValueTriplet<double> > triplets;
+		triplets.reserve(static_cast<size_t>(rows) * perRow);
+
+		for (unsigned int i(0); i < rows * perRow; i++)
+		{
+			if (i % 4 == 3)
+			{
+				const SparseValueTriplet<double>& earlier = triplets[NextRandom(seed) % i];
+				triplets.push_back(SparseValueTriplet<double>(earlier.Row(), earlier.Col(), 1.0));
+			}
+			else
+			{
+				unsigned int row = NextRandom(seed) % rows;
+				triplets.push_back(SparseValueTriplet<double>(row, NextRandom(seed) % cols, (NextRandom(seed) % 100) * 0.01));
+			}
+		}
+
+		return triplets;
+	}
+
+	// row lengths follow a power law - a few rows hold thousands of nonzeros, most hold a handful,
+	// the way graph adjacency matrices do - averaging about perRow per row
+	Sparse<double> PowerLawMatrix(unsigned int rows, unsigned int perRow, unsigned int seed)
+	{
+		vector<SparseValueTriplet<double> > triplets;
+		triplets.reserve(static_cast<size_t>(rows) * perRow);
+
+		for (unsigned int row(0); row < rows; row++)
+		{
+			// inverse transform of a Pareto distribution with exponent 2, capped at the row count
+			double uniform = (NextRandom(seed) % 65536 + 1) / 65537.0;
+			double length = (perRow / 2.0) / sqrt(uniform);
+			unsigned int count = (length < rows) ? static_cast<unsigned int>(length) : rows;
+
+			for (unsigned int i(0); i < count; i++)
+				triplets.push_back(SparseValueTriplet<double>(row, NextRandom(seed) % rows, (NextRandom(seed) % 100) * 0.01));
+		}
+
+		return Sparse<double>(rows, rows, triplets);
+	}
+
+	// halfBandwidth diagonals on either side of the main one, like a 1D stencil or a banded FEM system
+	Sparse<double> BandedMatrix(unsigned int rows, unsigned int halfBandwidth)
+	{
+		vector<SparseValueTriplet<double> > triplets;
+		triplets.reserve(static_cast<size_t>(rows) * (2 * halfBandwidth + 1));
+
+		for (unsigned int row(0); row < rows; row++)
+		{
+			unsigned int first = (row > halfBandwidth) ? row - halfBandwidth : 0;
+			unsigned int last = (row + halfBandwidth < rows) ? row + halfBandwidth : rows - 1;
+			for (unsigned int col(first); col <= last; col++)
+				triplets.push_back(SparseValueTriplet<double>(row, col, (row == col) ? 4.0 : -1.0 / (1 + row - col + halfBandwidth)));
+		}
+
+		return Sparse<double>(rows, rows, triplets);
+	}
+
+	// nodes x nodes grid of 3x3 blocks, every node coupled to itself and its four grid neighbours,
+	// like a 2D elasticity or 3-component FEM system - rows are a multiple of 3, 9 to 15 nonzeros each
+	Sparse<double> BlockMatrix(unsigned int rows, unsigned int seed)
+	{
+		const unsigned int dofs = 3;
+		unsigned int nodes = rows / dofs;
+		unsigned int side = static_cast<unsigned int>(sqrt(double(nodes)));
+		vector<SparseValueTriplet<double> > triplets;
+		triplets.reserve(static_cast<size_t>(nodes) * 5 * dofs * dofs);
+
+		for (unsigned int node(0); node < nodes; node++)
+		{
+			unsigned int neighbours[5] = { node, node - 1, node + 1, node - side, node + side };
+			for (unsigned int neighbour : neighbours)
+			{
+				// unsigned wrap-around puts missing neighbours past the end
+				if (neighbour >= nodes)
+					continue;
+				for (unsigned int i(0); i < dofs * dofs; i++)
+					triplets.push_back(SparseValueTriplet<double>(dofs * node + i / dofs, dofs * neighbour + i % dofs, (NextRandom(seed) % 100) * 0.01));
+			}
+		}
+
+		return Sparse<double>(nodes * dofs, nodes * dofs, triplets);
+	}
+
+	// y = A*x for one matrix in CSR, SELL-8-256 and 3x3 / 4x4 block CSR, followed by a line naming the fastest layout
+	// bytes count the stored arrays of every layout, padding included, so the fill overhead shows up as bandwidth
+	void FormatCases(BenchmarkRunner& runner, const string& prefix, const Sparse<double>& matrix)
+	{
+		const unsigned int n = matrix.Rows();
+		const double nonZeros = matrix.NonZeros();
+		const double vectorBytes = 2.0 * n * sizeof(double);
+		const double entryBytes = sizeof(double) + sizeof(unsigned int);
+
+		Dense<double> x(n, 1);
+		Dense<double> y(n, 1);
+		x.ResetToConstant(0.5);
+
+		string bestName;
+		double bestSecs = 0;
+		double csrSecs = 0;
+		// the fastest layout by median time of the cases that ran
+		auto track = [&](const string& name) {
+			const BenchmarkResult& result = runner.Results().back();
+			if (result.name != name)
+				return;
+			if (bestName.empty() || result.medianSecs < bestSecs)
+			{
+				bestName = name;
+				bestSecs = result.medianSecs;
+			}
+			if (name == prefix + ".csr")
+				csrSecs = result.medianSecs;
+		};
+
+		string name = prefix + ".csr";
+		if (runner.Selected(name, n, SparseLimit))
+		{
+			runner.Run(name, "double", n, 2 * nonZeros, nonZeros * entryBytes + (n + 1.0) * sizeof(unsigned int) + vectorBytes, nonZeros, [&]() {
+				matrix.MulVectorInto(x.Data(), y.Data());
+				DoNotOptimize(y);
+			});
+			track(name);
+		}
+
+		name = prefix + ".sell_8_256";
+		if (runner.Selected(name, n, SparseLimit))
+		{
+			SparseSell<double> sell(matrix, 8, 256);
+			runner.Run(name, "double", n, 2 * nonZeros, sell.StoredEntries() * entryBytes + n * sizeof(unsigned int) + vectorBytes, nonZeros, [&]() {
+				sell.MulVectorInto(x.Data(), y.Data());
+				DoNotOptimize(y);
+			});
+			track(name);
+		}
+
+		for (unsigned int size(3); size <= 4; size++)
+		{
+			name = prefix + ".bcsr_" + to_string(size);
+			if (!runner.Selected(name, n, SparseLimit))
+				continue;
+
+			SparseBlock<double> block(matrix, size, size);
+			runner.Run(name, "double", n, 2 * nonZeros, block.StoredEntries() * sizeof(double) + block.Blocks() * sizeof(unsigned int) + vectorBytes, nonZeros, [&]() {
+				block.MulVectorInto(x.Data(), y.Data());
+				DoNotOptimize(y);
+			});
+			track(name);
+		}
+
+		if (!bestName.empty() && csrSecs > 0)
+			cout << "  fastest layout: " << bestName << ", " << csrSecs / bestSecs << "x CSR" << endl;
+	}
+
+	// n x n matrix with about percent of its elements set, at random positions
+	Dense<double> RandomDense(unsigned int n, unsigned int percent, unsigned int seed)
+	{
+		Dense<double> dense(n, n);
+		for (unsigned int i(0); i < dense.Numel(); i++)
+		{
+			if (NextRandom(seed) % 100 < percent)
+				dense.Data()[i] = (NextRandom(seed) % 100) * 0.01 + 0.01;
+		}
+		return dense;
+	}
+
+	// both kernels of Sparse * Dense with rhsCount columns and the operator choosing between them, then the
+	// conversions - items are multiply-adds of the sparse kernel, so the rates compare directly across kernels
+	void MixedCases(BenchmarkRunner& runner, unsigned int n, unsigned int percent, unsigned int rhsCount)
+	{
+		string prefix = "sparse.mixed.d" + to_string(percent) + ".k" + to_string(rhsCount);
+		if (!runner.Selected(prefix + ".sparse_rows", n, CubicLimit) && !runner.Selected(prefix + ".dense_gemm", n, CubicLimit)
+			&& !runner.Selected(prefix + ".auto", n, CubicLimit) && !runner.Selected(prefix + ".to_sparse", n, CubicLimit)
+			&& !runner.Selected(prefix + ".to_dense", n, CubicLimit))
+			return;
+
+		Dense<double> dense = RandomDense(n, percent, n + percent);
+		Sparse<double> sparse = dense.ToSparse();
+		Dense<double> x(n, rhsCount);
+		Dense<double> y(n, rhsCount);
+		x.ResetToConstant(0.5);
+		double products = double(sparse.NonZeros()) * rhsCount;
+
+		if (runner.Selected(prefix + ".sparse_rows", n, CubicLimit))
+		{
+			runner.Run(prefix + ".sparse_rows", "double", n, 2 * products, 0, products, [&]() {
+				sparse.MulInto(x, y);
+				DoNotOptimize(y);
+			});
+		}
+
+		if (runner.Selected(prefix + ".dense_gemm", n, CubicLimit))
+		{
+			runner.Run(prefix + ".dense_gemm", "double", n, 2 * products, 0, products, [&]() {
+				sparse.ToDense().MulInto(x, y);
+				DoNotOptimize(y);
+			});
+		}
+
+		if (runner.Selected(prefix + ".auto", n, CubicLimit))
+		{
+			runner.Run(prefix + ".auto", "double", n, 2 * products, 0, products, [&]() {
+				Dense<double> product = sparse * x;
+				DoNotOptimize(product);
+			});
+			cout << "  selected: " << MixedKernels::KernelName(MixedKernels::LastSelection().kernel) << endl;
+		}
+
+		if (runner.Selected(prefix + ".to_sparse", n, CubicLimit))
+		{
+			runner.Run(prefix + ".to_sparse", "double", n, 0, dense.Numel() * sizeof(double), dense.Numel(), [&]() {
+				Sparse<double> converted = dense.ToSparse();
+				DoNotOptimize(converted);
+			});
+		}
+
+		if (runner.Selected(prefix + ".to_dense", n, CubicLimit))
+		{
+			runner.Run(prefix + ".to_dense", "double", n, 0, dense.Numel() * sizeof(double), dense.Numel(), [&]() {
+				Dense<double> converted = sparse.ToDense();
+				DoNotOptimize(converted);
+			});
+		}
+	}
+
+	// multiply-adds of A*b - rows of b gathered by every nonzero of A
+	double ProductCount(const Sparse<double>& a, const Sparse<double>& b)
+	{
+		double products = 0;
+		for (unsigned int entry(0); entry < a.NonZeros(); entry++)
+			products += b.RowNonZeros(a.ColumnIndices()[entry]);
+		return products;
+	}
+
+	Dense<double> Densify(const Sparse<double>& matrix)
+	{
+		Dense<double> dense(matrix.Rows(), matrix.Cols());
+		const unsigned int* offsets = matrix.RowOffsets();
+		for (unsigned int row(0); row < matrix.Rows(); row++)
+			for (unsigned int entry(offsets[row]); entry < offsets[row + 1]; entry++)
+				dense(row, matrix.ColumnIndices()[entry], matrix.Values()[entry]);
+		return dense;
+	}
+
+	// y = A*x and Y = A*X for one matrix
+	// bytes count the CSR arrays and the output once and x once per nonzero that gathers it
+	void ProductCases(BenchmarkRunner& runner, const string& prefix, const Sparse<double>& matrix)
+	{
+		const unsigned int n = matrix.Rows();
+		const unsigned int rhsCount = 8;
+		const double nonZeros = matrix.NonZeros();
+		const double csrBytes = nonZeros * (sizeof(double) + sizeof(unsigned int)) + (n + 1.0) * sizeof(unsigned int);
+
+		Dense<double> x(n, 1);
+		Dense<double> y(n, 1);
+		Dense<double> xs(n, rhsCount);
+		Dense<double> ys(n, rhsCount);
+		x.ResetToConstant(0.5);
+		xs.ResetToConstant(0.5);
+
+		SimdLevel detected = Simd::Detected();
+		SimdLevel levels[2] = { SimdLevel::Scalar, detected };
+		for (unsigned int l(0); l < 2; l++)
+		{
+			if (l == 1 && detected == SimdLevel::Scalar)
+				break;
+
+			SimdLevel active = Simd::SetActive(levels[l]);
+			string name = prefix + ".spmv." + Simd::LevelName(active);
+			if (runner.Selected(name, n, SparseLimit))
+			{
+				runner.Run(name, "double", n, 2 * nonZeros, csrBytes + (nonZeros + n) * sizeof(double), nonZeros, [&]() {
+					matrix.MulInto(x, y);
+					DoNotOptimize(y);
+				});
+			}
+		}
+		Simd::SetActive(detected);
+
+		string name = prefix + ".spmv_serial";
+		if (runner.Selected(name, n, SparseLimit))
+		{
+			runner.Run(name, "double", n, 2 * nonZeros, csrBytes + (nonZeros + n) * sizeof(double), nonZeros, [&]() {
+				matrix.MulVectorInto(x.Data(), y.Data(), 1);
+				DoNotOptimize(y);
+			});
+		}
+
+		name = prefix + ".spmm_8";
+		if (runner.Selected(name, n, SparseLimit))
+		{
+			runner.Run(name, "double", n, 2 * nonZeros * rhsCount, csrBytes + (nonZeros + n) * rhsCount * sizeof(double), nonZeros * rhsCount, [&]() {
+				matrix.MulInto(xs, ys);
+				DoNotOptimize(ys);
+			});
+		}
+	}
+}
+#pragma endregion
+
+
+#pragma region SUITE
+// triplet batches to CSR - throughput in triplets per second, on all threads and on one,
+// then element reads and updates with and without pending inserts
+void Numero::Benchmark::RunSparseBenchmarks(BenchmarkRunner& runner)
+{
+	const unsigned int perRow = 8;
+
+	for (unsigned int n : SparseSizes)
+	{
+		if (n > runner.Options().maxSize)
+			break;
+
+		vector<SparseValueTriplet<double> > triplets = RandomTriplets(n, n, perRow, 7);
+		double count = double(triplets.size());
+		double tripletBytes = count * sizeof(SparseValueTriplet<double>);
+
+		if (runner.Selected("sparse.assemble", n, SparseLimit))
+		{
+			runner.Run("sparse.assemble", "double", n, 0, tripletBytes, count, [&]() {
+				Sparse<double> sparse(n, n, triplets);
+				DoNotOptimize(sparse);
+			});
+		}
+
+		if (runner.Selected("sparse.assemble_serial", n, SparseLimit))
+		{
+			runner.Run("sparse.assemble_serial", "double", n, 0, tripletBytes, count, [&]() {
+				Sparse<double> sparse(n, n, triplets, 1);
+				DoNotOptimize(sparse);
+			});
+		}
+
+		if (runner.Selected("sparse.get_value", n, SparseLimit))
+		{
+			Sparse<double> sparse(n, n, triplets);
+			runner.Run("sparse.get_value", "double", n, 0, 0, count, [&]() {
+				double sum = 0;
+				for (const SparseValueTriplet<double>& triplet : triplets)
+					sum += sparse.GetValue(triplet.Row(), triplet.Col());
+				DoNotOptimize(sum);
+			});
+		}
+
+		// a simulation step - one percent of the nonzeros rewritten in place and as many new positions inserted
+		vector<SparseValueTriplet<double> > inserts = RandomTriplets(n, n, perRow, 23);
+		inserts.resize(triplets.size() / 100);
+		double insertCount = double(inserts.size());
+		Sparse<double> base(n, n, triplets);
+		Sparse<double> buffered(base);
+		for (const SparseValueTriplet<double>& insert : inserts)
+			buffered.SetValue(insert.Row(), insert.Col(), insert.Value());
+
+		if (runner.Selected("sparse.update_in_place", n, SparseLimit))
+		{
+			Sparse<double> sparse(base);
+			runner.Run("sparse.update_in_place", "double", n, 0, 0, insertCount, [&]() {
+				for (unsigned int i(0); i < inserts.size(); i++)
+					sparse.SetValue(triplets[i].Row(), triplets[i].Col(), inserts[i].Value());
+				DoNotOptimize(sparse);
+			});
+		}
+
+		// both insert cases copy the matrix first, the rebuild assembles the step from all triplets again
+		if (runner.Selected("sparse.insert_buffered", n, SparseLimit))
+		{
+			runner.Run("sparse.insert_buffered", "double", n, 0, 0, insertCount, [&]() {
+				Sparse<double> sparse(base);
+				for (const SparseValueTriplet<double>& insert : inserts)
+					sparse.SetValue(insert.Row(), insert.Col(), insert.Value());
+				sparse.Commit();
+				DoNotOptimize(sparse);
+			});
+		}
+
+		if (runner.Selected("sparse.insert_rebuild", n, SparseLimit))
+		{
+			runner.Run("sparse.insert_rebuild", "double", n, 0, 0, insertCount, [&]() {
+				vector<SparseValueTriplet<double> > step(triplets);
+				step.insert(step.end(), inserts.begin(), inserts.end());
+				Sparse<double> sparse(n, n);
+				sparse.Assemble(step);
+				DoNotOptimize(sparse);
+			});
+		}
+
+		if (runner.Selected("sparse.commit", n, SparseLimit))
+		{
+			runner.Run("sparse.commit", "double", n, 0, 0, insertCount, [&]() {
+				Sparse<double> sparse(buffered);
+				sparse.Commit();
+				DoNotOptimize(sparse);
+			});
+		}
+
+		// element reads while the inserts are pending, against sparse.get_value on the committed matrix
+		if (runner.Selected("sparse.get_value_pending", n, SparseLimit))
+		{
+			runner.Run("sparse.get_value_pending", "double", n, 0, 0, count + insertCount, [&]() {
+				double sum = 0;
+				for (const SparseValueTriplet<double>& triplet : triplets)
+					sum += buffered.GetValue(triplet.Row(), triplet.Col());
+				for (const SparseValueTriplet<double>& insert : inserts)
+					sum += buffered.GetValue(insert.Row(), insert.Col());
+				DoNotOptimize(sum);
+			});
+		}
+	}
+
+	// products - effective bandwidth on skewed and on regular row lengths
+	for (unsigned int n : SparseSizes)
+	{
+		if (n > runner.Options().maxSize)
+			break;
+
+		if (runner.Selected("sparse.power_law", n, SparseLimit))
+			ProductCases(runner, "sparse.power_law", PowerLawMatrix(n, perRow, 11));
+		if (runner.Selected("sparse.banded", n, SparseLimit))
+			ProductCases(runner, "sparse.banded", BandedMatrix(n, 8));
+	}
+
+	// sparse-sparse products - items are multiply-adds, the densify case converts both operands and uses the dense product
+	for (unsigned int n : SparseSizes)
+	{
+		if (n > runner.Options().maxSize)
+			break;
+
+		Sparse<double> random(n, n, RandomTriplets(n, n, perRow, 17));
+		Sparse<double> banded = BandedMatrix(n, 2);
+		double randomProducts = ProductCount(random, random);
+		double bandedProducts = ProductCount(banded, banded);
+
+		if (runner.Selected("sparse.spgemm", n, SparseLimit))
+		{
+			runner.Run("sparse.spgemm", "double", n, 2 * randomProducts, 0, randomProducts, [&]() {
+				Sparse<double> product = random * random;
+				DoNotOptimize(product);
+			});
+		}
+
+		if (runner.Selected("sparse.spgemm_serial", n, SparseLimit))
+		{
+			runner.Run("sparse.spgemm_serial", "double", n, 2 * randomProducts, 0, randomProducts, [&]() {
+				Sparse<double> product;
+				random.MulInto(random, product, 1);
+				DoNotOptimize(product);
+			});
+		}
+
+		if (runner.Selected("sparse.spgemm_banded", n, SparseLimit))
+		{
+			runner.Run("sparse.spgemm_banded", "double", n, 2 * bandedProducts, 0, bandedProducts, [&]() {
+				Sparse<double> product = banded * banded;
+				DoNotOptimize(product);
+			});
+		}
+
+		if (runner.Selected("sparse.spgemm_ata", n, SparseLimit))
+		{
+			Sparse<double> transposed = random.Transpose();
+			double normalProducts = ProductCount(transposed, random);
+			runner.Run("sparse.spgemm_ata", "double", n, 2 * normalProducts, 0, normalProducts, [&]() {
+				Sparse<double> product = random.Transpose() * random;
+				DoNotOptimize(product);
+			});
+		}
+
+		if (runner.Selected("sparse.spgemm_densify", n, CubicLimit))
+		{
+			runner.Run("sparse.spgemm_densify", "double", n, 2 * randomProducts, 0, randomProducts, [&]() {
+				Dense<double> product = Densify(random) * Densify(random);
+				DoNotOptimize(product);
+			});
+		}
+	}
+
+	// storage layouts - which one pays off depends on the structure of the matrix
+	for (unsigned int n : SparseSizes)
+	{
+		if (n > runner.Options().maxSize)
+			break;
+
+		if (runner.Selected("sparse.format.power_law", n, SparseLimit))
+			FormatCases(runner, "sparse.format.power_law", PowerLawMatrix(n, perRow, 11));
+		if (runner.Selected("sparse.format.banded", n, SparseLimit))
+			FormatCases(runner, "sparse.format.banded", BandedMatrix(n, 8));
+		if (runner.Selected("sparse.format.block", n, SparseLimit))
+			FormatCases(runner, "sparse.format.block", BlockMatrix(n, 13));
+	}
+
+	// mixed operands in the 1-30% density range, where neither layout is an obvious win
+	for (unsigned int n : BenchmarkSizes)
+	{
+		if (n < 256)
+			continue;
+
+		for (unsigned int percent : { 1u, 5u, 10u, 20u, 30u })
+		{
+			MixedCases(runner, n, percent, 1);
+			MixedCases(runner, n, percent, 8);
+			MixedCases(runner, n, percent, 64);
+		}
+	}
+}
+#pragma endregion
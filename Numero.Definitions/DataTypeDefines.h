@@ -5,6 +5,8 @@ namespace Numero
 {
 	namespace Definitions
 	{
+		// dimension of a matrix whose size is only known at runtime
+		const unsigned int Dynamic = 0;
 	}
 }
 
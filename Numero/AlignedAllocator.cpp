@@ -0,0 +1,217 @@
+#include <atomic>
+#include <cstdlib>
+#include <new>
+#include "AlignedAllocator.h"
+
+#ifdef _MSC_VER
+#include <malloc.h>
+#endif
+
+using namespace Numero;
+using namespace Numero::DataTypes;
+
+#pragma region SYSTEM_ALLOCATION
+namespace
+{
+	// 64 byte classes up to 256 bytes, then four classes per power of two up to MaxPooledBytes
+	const unsigned int ClassCount = 4 + 18 * 4;
+
+	atomic<unsigned long long> hitCount(0);
+	atomic<unsigned long long> missCount(0);
+	atomic<size_t> liveBytes(0);
+	atomic<size_t> cachedBytes(0);
+
+	size_t RoundToAlignment(size_t bytes)
+	{
+		return (bytes + AlignedAllocator::Alignment - 1) & ~(AlignedAllocator::Alignment - 1);
+	}
+
+	// size class of a pooled request and the number of bytes every block of that class holds
+	unsigned int SizeClass(size_t bytes, size_t& classBytes)
+	{
+		size_t rounded = RoundToAlignment(bytes);
+
+		if (rounded <= 4 * AlignedAllocator::Alignment)
+		{
+			classBytes = rounded;
+			return static_cast<unsigned int>(rounded / AlignedAllocator::Alignment) - 1;
+		}
+
+		// 2^exponent < rounded <= 2^(exponent+1), split into quarters
+		unsigned int exponent = 0;
+		for (size_t value = rounded - 1; value > 1; value >>= 1)
+			exponent++;
+
+		size_t step = size_t(1) << (exponent - 2);
+		size_t quarter = (rounded - (size_t(1) << exponent) + step - 1) / step;
+
+		classBytes = (size_t(1) << exponent) + quarter * step;
+		return 4 + (exponent - 8) * 4 + static_cast<unsigned int>(quarter) - 1;
+	}
+
+	void* SystemAllocate(size_t bytes)
+	{
+#ifdef _MSC_VER
+		void* memory = _aligned_malloc(bytes, AlignedAllocator::Alignment);
+#else
+		void* memory = aligned_alloc(AlignedAllocator::Alignment, bytes);
+#endif
+		if (memory == nullptr)
+			throw bad_alloc();
+
+		missCount.fetch_add(1, memory_order_relaxed);
+		return memory;
+	}
+
+	void SystemFree(void* memory)
+	{
+#ifdef _MSC_VER
+		_aligned_free(memory);
+#else
+		free(memory);
+#endif
+	}
+}
+#pragma endregion
+
+
+#pragma region THREAD_CACHE
+namespace
+{
+	// free lists of one thread - released blocks are linked through their first bytes
+	// the cache is trivially destructible, so it is still usable while other thread_local
+	// and static objects holding matrices are destroyed - the releaser below only empties it
+	struct ThreadCache
+	{
+		void* heads[ClassCount];
+		unsigned int counts[ClassCount];
+		size_t bytes;
+		bool closed;
+	};
+
+	thread_local ThreadCache threadCache;
+
+	void ReleaseCache(ThreadCache& cache)
+	{
+		for (unsigned int sizeClass(0); sizeClass < ClassCount; sizeClass++)
+		{
+			while (cache.heads[sizeClass] != nullptr)
+			{
+				void* block = cache.heads[sizeClass];
+				cache.heads[sizeClass] = *static_cast<void**>(block);
+				SystemFree(block);
+			}
+			cache.counts[sizeClass] = 0;
+		}
+
+		cachedBytes.fetch_sub(cache.bytes, memory_order_relaxed);
+		cache.bytes = 0;
+	}
+
+	// frees the cache when its thread exits, later releases go straight to the system
+	struct CacheReleaser
+	{
+		~CacheReleaser()
+		{
+			ReleaseCache(threadCache);
+			threadCache.closed = true;
+		}
+	};
+
+	thread_local CacheReleaser cacheReleaser;
+
+	ThreadCache& LocalCache()
+	{
+		// touching the releaser registers its destructor for this thread
+		(void)&cacheReleaser;
+		return threadCache;
+	}
+}
+#pragma endregion
+
+
+#pragma region INTERFACE
+void* AlignedAllocator::Allocate(size_t bytes)
+{
+	if (bytes > MaxPooledBytes)
+	{
+		size_t rounded = RoundToAlignment(bytes);
+		void* memory = SystemAllocate(rounded);
+		liveBytes.fetch_add(rounded, memory_order_relaxed);
+		return memory;
+	}
+
+	size_t classBytes;
+	unsigned int sizeClass = SizeClass(bytes, classBytes);
+	ThreadCache& cache = LocalCache();
+
+	void* block = cache.heads[sizeClass];
+	if (block != nullptr)
+	{
+		cache.heads[sizeClass] = *static_cast<void**>(block);
+		cache.counts[sizeClass]--;
+		cache.bytes -= classBytes;
+		cachedBytes.fetch_sub(classBytes, memory_order_relaxed);
+		hitCount.fetch_add(1, memory_order_relaxed);
+	}
+	else
+	{
+		block = SystemAllocate(classBytes);
+	}
+
+	liveBytes.fetch_add(classBytes, memory_order_relaxed);
+	return block;
+}
+
+void AlignedAllocator::Deallocate(void* memory, size_t bytes)
+{
+	if (memory == nullptr)
+		return;
+
+	if (bytes > MaxPooledBytes)
+	{
+		liveBytes.fetch_sub(RoundToAlignment(bytes), memory_order_relaxed);
+		SystemFree(memory);
+		return;
+	}
+
+	size_t classBytes;
+	unsigned int sizeClass = SizeClass(bytes, classBytes);
+	liveBytes.fetch_sub(classBytes, memory_order_relaxed);
+
+	ThreadCache& cache = threadCache;
+	if (cache.closed || cache.counts[sizeClass] >= MaxCachedPerClass || cache.bytes + classBytes > MaxCachedBytesPerThread)
+	{
+		SystemFree(memory);
+		return;
+	}
+
+	LocalCache();
+	*static_cast<void**>(memory) = cache.heads[sizeClass];
+	cache.heads[sizeClass] = memory;
+	cache.counts[sizeClass]++;
+	cache.bytes += classBytes;
+	cachedBytes.fetch_add(classBytes, memory_order_relaxed);
+}
+
+void AlignedAllocator::Trim()
+{
+	ReleaseCache(threadCache);
+}
+
+AllocatorStats AlignedAllocator::Stats()
+{
+	AllocatorStats stats;
+	stats.hits = hitCount.load(memory_order_relaxed);
+	stats.misses = missCount.load(memory_order_relaxed);
+	stats.bytesLive = liveBytes.load(memory_order_relaxed);
+	stats.bytesCached = cachedBytes.load(memory_order_relaxed);
+	return stats;
+}
+
+void AlignedAllocator::ResetStats()
+{
+	hitCount.store(0, memory_order_relaxed);
+	missCount.store(0, memory_order_relaxed);
+}
+#pragma endregion
@@ -0,0 +1,55 @@
+#ifndef _ALIGNED_ALLOCATOR_H_
+#define _ALIGNED_ALLOCATOR_H_
+
+#include "../Numero.Definitions/DataTypeDefines.h"
+#include <cstddef>
+
+namespace Numero
+{
+	using namespace std;
+	using namespace Definitions;
+
+	namespace DataTypes
+	{
+		// counters of the allocator, summed over all threads
+		struct AllocatorStats
+		{
+			unsigned long long hits;		// requests served from a thread cache
+			unsigned long long misses;		// requests that went to the system allocator
+			size_t bytesLive;				// bytes handed out and not yet returned
+			size_t bytesCached;				// bytes held in thread caches for reuse
+		};
+
+		// AlignedAllocator class
+		// cache line aligned storage for matrix data
+		// requests are rounded up to size classes - four per power of two - and released buffers
+		// are kept in a per-thread free list of their class, so a loop creating temporaries of
+		// the same shapes stops reaching the system allocator after its first iteration
+		// a buffer may be released on any thread, it then joins that thread's cache
+		class AlignedAllocator
+		{
+		public:
+			static const size_t Alignment = 64;
+
+			// larger requests bypass the caches
+			static const size_t MaxPooledBytes = size_t(1) << 26;
+			// bounds of what a thread keeps, beyond them released buffers are freed
+			static const unsigned int MaxCachedPerClass = 8;
+			static const size_t MaxCachedBytesPerThread = size_t(1) << 27;
+
+			// aligned block of at least bytes bytes, bytes must not be 0
+			static void* Allocate(size_t bytes);
+			// bytes must be the size the block was allocated with
+			static void Deallocate(void* memory, size_t bytes);
+
+			// frees the buffers cached by the calling thread
+			static void Trim();
+
+			static AllocatorStats Stats();
+			// zeroes the hit and miss counters
+			static void ResetStats();
+		};
+	}
+}
+
+#endif // !_ALIGNED_ALLOCATOR_H_
@@ -0,0 +1,364 @@
+#ifndef _BAREISS_CPP_
+#define _BAREISS_CPP_
+
+#include <assert.h>
+#include <algorithm>
+#include <limits>
+#include "Bareiss.h"
+#include "Dense.cpp"
+#include "ThreadPool.h"
+
+using namespace Numero;
+using namespace Numero::DataTypes;
+
+#pragma region MODULAR_INTEGER
+template <unsigned int Prime>
+ModularInteger<Prime> ModularInteger<Prime>::operator+(ModularInteger other) const
+{
+	ModularInteger sum;
+	sum.value = (value + other.value) % Prime;
+	return sum;
+}
+
+template <unsigned int Prime>
+ModularInteger<Prime> ModularInteger<Prime>::operator-(ModularInteger other) const
+{
+	ModularInteger difference;
+	difference.value = (value + Prime - other.value) % Prime;
+	return difference;
+}
+
+template <unsigned int Prime>
+ModularInteger<Prime> ModularInteger<Prime>::operator-() const
+{
+	ModularInteger negated;
+	negated.value = (Prime - value) % Prime;
+	return negated;
+}
+
+template <unsigned int Prime>
+ModularInteger<Prime> ModularInteger<Prime>::operator*(ModularInteger other) const
+{
+	ModularInteger product;
+	product.value = static_cast<unsigned int>(static_cast<unsigned long long>(value) * other.value % Prime);
+	return product;
+}
+
+// value^(Prime - 2) by repeated squaring
+template <unsigned int Prime>
+ModularInteger<Prime> ModularInteger<Prime>::Inverse() const
+{
+	assert(value != 0);
+
+	ModularInteger inverse(1);
+	ModularInteger power(*this);
+	for (unsigned int exponent(Prime - 2); exponent != 0; exponent >>= 1)
+	{
+		if (exponent & 1)
+			inverse = inverse * power;
+		power = power * power;
+	}
+	return inverse;
+}
+
+template <unsigned int Prime>
+ModularInteger<Prime> ModularInteger<Prime>::operator/(ModularInteger other) const
+{
+	return *this * other.Inverse();
+}
+#pragma endregion
+
+
+#pragma region ELIMINATION
+template <class T, class Accumulator>
+Bareiss<T, Accumulator>::Bareiss(const Dense<T>& matrix, unsigned int nThreads)
+	: n(matrix.Rows()), elements(static_cast<size_t>(matrix.Rows()) * matrix.Cols()), determinant(1), overflow(false)
+{
+	static_assert(!is_integral<Accumulator>::value || is_signed<Accumulator>::value, "integral accumulators must be signed");
+
+	assert(matrix.Rows() == matrix.Cols());
+
+	const T* data = matrix.Data();
+	for (size_t i(0); i < elements.size(); i++)
+	{
+		if constexpr (is_integral<T>::value && is_integral<Accumulator>::value)
+		{
+			// an integer that does not fit, such as an unsigned long long above LLONG_MAX, is reported, not wrapped
+			bool fits = is_signed<T>::value
+				? static_cast<long long>(data[i]) >= static_cast<long long>(numeric_limits<Accumulator>::min())
+					&& static_cast<long long>(data[i]) <= static_cast<long long>(numeric_limits<Accumulator>::max())
+				: static_cast<unsigned long long>(data[i]) <= static_cast<unsigned long long>(numeric_limits<Accumulator>::max());
+			if (!fits)
+			{
+				overflow = true;
+				return;
+			}
+			elements[i] = static_cast<Accumulator>(data[i]);
+		}
+		else if constexpr (is_unsigned<T>::value)
+		{
+			// rings built from a long long take the halves of the elements above LLONG_MAX
+			unsigned long long value = static_cast<unsigned long long>(data[i]);
+			if (value > static_cast<unsigned long long>(numeric_limits<long long>::max()))
+				elements[i] = Accumulator(static_cast<long long>(value >> 1)) * Accumulator(2) + Accumulator(static_cast<long long>(value & 1));
+			else
+				elements[i] = Accumulator(static_cast<long long>(value));
+		}
+		else
+		{
+			elements[i] = static_cast<Accumulator>(data[i]);
+		}
+	}
+
+	Eliminate(nThreads);
+}
+
+template <class T, class Accumulator>
+bool Bareiss<T, Accumulator>::Update(Accumulator a, Accumulator b, Accumulator c, Accumulator d, Accumulator divisor, Accumulator reciprocal,
+	Accumulator& out)
+{
+	if constexpr (is_integral<Accumulator>::value)
+	{
+		Accumulator ab, cd, difference;
+#if defined(__GNUC__) || defined(__clang__)
+		if (__builtin_mul_overflow(a, b, &ab) || __builtin_mul_overflow(c, d, &cd) || __builtin_sub_overflow(ab, cd, &difference))
+			return false;
+#else
+		const Accumulator high = numeric_limits<Accumulator>::max();
+		const Accumulator low = numeric_limits<Accumulator>::min();
+		auto multiply = [&](Accumulator x, Accumulator y, Accumulator& product) -> bool
+		{
+			if (x > 0 ? (y > 0 ? x > high / y : y < low / x) : (y > 0 ? x < low / y : (x != 0 && y < high / x)))
+				return false;
+			product = x * y;
+			return true;
+		};
+
+		if (!multiply(a, b, ab) || !multiply(c, d, cd) || (cd > 0 && ab < low + cd) || (cd < 0 && ab > high + cd))
+			return false;
+		difference = ab - cd;
+#endif
+		// the only quotient that does not fit
+		if (divisor == -1 && difference == numeric_limits<Accumulator>::min())
+			return false;
+
+		out = (divisor == 1) ? difference : difference / divisor;
+		return true;
+	}
+	else
+	{
+		out = (a * b - c * d) * reciprocal;
+		return true;
+	}
+}
+
+// step k turns every element below and right of the pivot into
+// (pivot * element - left * above) / previous pivot, the minor of rows 0..k and i, columns 0..k and j
+// a zero pivot is exchanged with the first row below that has a nonzero in its column, flipping the sign
+template <class T, class Accumulator>
+void Bareiss<T, Accumulator>::Eliminate(unsigned int nThreads)
+{
+	const Accumulator zero(0);
+	Accumulator* data = elements.data();
+	Accumulator previous(1);
+	bool negate = false;
+
+	ThreadPool& pool = ThreadPool::Global();
+	unsigned int poolThreads = (nThreads == 0 || nThreads > pool.ThreadCount()) ? pool.ThreadCount() : nThreads;
+	vector<char> chunkOverflow(poolThreads);
+
+	for (unsigned int k(0); k < n; k++)
+	{
+		Accumulator* pivotRow = data + static_cast<size_t>(k) * n;
+		if (pivotRow[k] == zero)
+		{
+			unsigned int swapRow = k + 1;
+			while (swapRow < n && data[static_cast<size_t>(swapRow) * n + k] == zero)
+				swapRow++;
+
+			if (swapRow == n)
+			{
+				determinant = zero;
+				return;
+			}
+
+			swap_ranges(pivotRow + k, pivotRow + n, data + static_cast<size_t>(swapRow) * n + k);
+			negate = !negate;
+		}
+
+		// fields divide by one reciprocal per step - a modular inverse is a whole exponentiation
+		Accumulator pivot = pivotRow[k];
+		Accumulator reciprocal = Accumulator(1);
+		if constexpr (!is_integral<Accumulator>::value)
+			reciprocal = Accumulator(1) / previous;
+		unsigned int remaining = n - k - 1;
+		unsigned int threads = (static_cast<unsigned long long>(remaining) * remaining < ParallelThreshold) ? 1 : poolThreads;
+		unsigned int chunkSize = (remaining + threads - 1) / threads;
+
+		pool.ParallelFor(threads, [&](unsigned int chunk)
+		{
+			unsigned int begin = k + 1 + ((chunk * chunkSize < remaining) ? chunk * chunkSize : remaining);
+			unsigned int end = (begin + chunkSize < n) ? begin + chunkSize : n;
+			bool failed = false;
+
+			for (unsigned int i(begin); i < end; i++)
+			{
+				Accumulator* row = data + static_cast<size_t>(i) * n;
+				Accumulator left = row[k];
+				for (unsigned int j(k + 1); j < n; j++)
+				{
+					if (!Update(row[j], pivot, left, pivotRow[j], previous, reciprocal, row[j]))
+						failed = true;
+				}
+			}
+			chunkOverflow[chunk] = failed ? 1 : 0;
+		}, threads);
+
+		for (unsigned int chunk(0); chunk < threads; chunk++)
+		{
+			if (chunkOverflow[chunk] != 0)
+			{
+				overflow = true;
+				return;
+			}
+		}
+
+		previous = pivot;
+	}
+
+	if (n == 0)
+		return;
+
+	// the last pivot is the determinant of the row-exchanged matrix
+	determinant = data[static_cast<size_t>(n) * n - 1];
+	if (negate)
+	{
+		if constexpr (is_integral<Accumulator>::value)
+		{
+			if (determinant == numeric_limits<Accumulator>::min())
+			{
+				overflow = true;
+				return;
+			}
+		}
+		determinant = -determinant;
+	}
+}
+#pragma endregion
+
+
+#pragma region GETTERS
+template <class T, class Accumulator>
+bool Bareiss<T, Accumulator>::Overflow() const
+{
+	return overflow;
+}
+
+template <class T, class Accumulator>
+Accumulator Bareiss<T, Accumulator>::Determinant() const
+{
+	return determinant;
+}
+#pragma endregion
+
+
+#pragma region WRAPPING_ELIMINATION
+// the pivot p = 2^v * u, u odd, has the lowest valuation v of the trailing block, so every element e below it is
+// 2^v * e' and e - (e' * u^-1) * p is exactly zero - the multiplier is only defined modulo 2^(bits - v), which is
+// enough since the pivot row is a multiple of 2^v as well. the determinant is the product of the pivots
+template <class T>
+T WrappingElimination<T>::Determinant(const Dense<T>& matrix)
+{
+	static_assert(is_integral<T>::value && !is_same<T, bool>::value, "wrapping elimination needs an integral type");
+	// short types are eliminated in unsigned int, whose products do not promote to int
+	typedef typename common_type<typename make_unsigned<T>::type, unsigned int>::type Word;
+
+	assert(matrix.Rows() == matrix.Cols());
+
+	unsigned int n = matrix.Rows();
+	vector<Word> elements(static_cast<size_t>(n) * n);
+	const T* source = matrix.Data();
+	for (size_t i(0); i < elements.size(); i++)
+		elements[i] = static_cast<Word>(source[i]);
+
+	Word* data = elements.data();
+	Word determinant(1);
+	bool negate = false;
+
+	for (unsigned int k(0); k < n; k++)
+	{
+		// lowest valuation of the trailing block, the first odd element ends the search
+		unsigned int pivotRow = n;
+		unsigned int pivotCol = n;
+		unsigned int valuation = numeric_limits<Word>::digits;
+		for (unsigned int i(k); i < n && valuation != 0; i++)
+		{
+			for (unsigned int j(k); j < n; j++)
+			{
+				Word element = data[static_cast<size_t>(i) * n + j];
+				if (element == 0)
+					continue;
+
+				unsigned int zeros = 0;
+				while ((element & 1) == 0)
+				{
+					element >>= 1;
+					zeros++;
+				}
+				if (zeros < valuation)
+				{
+					valuation = zeros;
+					pivotRow = i;
+					pivotCol = j;
+					if (valuation == 0)
+						break;
+				}
+			}
+		}
+
+		if (pivotRow == n)
+			return static_cast<T>(0);
+
+		if (pivotRow != k)
+		{
+			swap_ranges(data + static_cast<size_t>(k) * n, data + static_cast<size_t>(k + 1) * n, data + static_cast<size_t>(pivotRow) * n);
+			negate = !negate;
+		}
+		if (pivotCol != k)
+		{
+			for (unsigned int i(0); i < n; i++)
+				swap(data[static_cast<size_t>(i) * n + k], data[static_cast<size_t>(i) * n + pivotCol]);
+			negate = !negate;
+		}
+
+		Word* pivotData = data + static_cast<size_t>(k) * n;
+		Word pivot = pivotData[k];
+		determinant *= pivot;
+		if (determinant == 0)
+			return static_cast<T>(0);
+
+		// inverse of the odd part by Newton's iteration, every step doubles the correct low bits from 3
+		Word odd = pivot >> valuation;
+		Word inverse = odd;
+		for (unsigned int bits(3); bits < static_cast<unsigned int>(numeric_limits<Word>::digits); bits *= 2)
+			inverse *= static_cast<Word>(2) - odd * inverse;
+
+		for (unsigned int i(k + 1); i < n; i++)
+		{
+			Word* row = data + static_cast<size_t>(i) * n;
+			if (row[k] == 0)
+				continue;
+
+			Word multiplier = static_cast<Word>((row[k] >> valuation) * inverse);
+			for (unsigned int j(k + 1); j < n; j++)
+				row[j] -= static_cast<Word>(multiplier * pivotData[j]);
+		}
+	}
+
+	if (negate)
+		determinant = static_cast<Word>(0) - determinant;
+	return static_cast<T>(determinant);
+}
+#pragma endregion
+
+#endif // !_BAREISS_CPP_
@@ -0,0 +1,100 @@
+#ifndef _BAREISS_H_
+#define _BAREISS_H_
+
+#include "../Numero.Definitions/DataTypeDefines.h"
+#include "Dense.h"
+#include <vector>
+#include <type_traits>
+
+namespace Numero
+{
+	using namespace std;
+	using namespace Definitions;
+
+	namespace DataTypes
+	{
+		// ModularInteger class
+		// integer modulo a prime below 2^31, products are formed in 64 bits so nothing overflows
+		// division multiplies by the inverse from Fermat's little theorem, the divisor must not be zero
+		template <unsigned int Prime>
+		class ModularInteger
+		{
+		private:
+			unsigned int value;		// in [0, Prime)
+		public:
+			static_assert(Prime > 2 && Prime < 0x80000000u, "modulus must be an odd prime below 2^31");
+
+			ModularInteger() : value(0) {}
+			ModularInteger(long long integer)
+				: value(static_cast<unsigned int>((integer % static_cast<long long>(Prime) + Prime) % Prime)) {}
+
+			unsigned int Value() const { return value; }
+			ModularInteger Inverse() const;
+
+			ModularInteger operator+(ModularInteger other) const;
+			ModularInteger operator-(ModularInteger other) const;
+			ModularInteger operator-() const;
+			ModularInteger operator*(ModularInteger other) const;
+			ModularInteger operator/(ModularInteger other) const;
+			bool operator==(ModularInteger other) const { return value == other.value; }
+			bool operator!=(ModularInteger other) const { return value != other.value; }
+		};
+
+		// accumulator of the exact determinant when none is given - 64 bits for the integral types and T itself
+		// otherwise. the minors can leave 64 bits even when the determinant fits T, which Overflow() reports
+		template <class T>
+		struct BareissAccumulator
+		{
+			typedef typename conditional<is_integral<T>::value, long long, T>::type Type;
+		};
+
+		// Bareiss class
+		// fraction-free Gaussian elimination - after step k every remaining element is a (k+1)x(k+1) minor of the
+		// matrix, so every division is exact and integral matrices are eliminated without fractions in O(n^3)
+		// Accumulator is the arithmetic of the elimination: a signed integer, with every product and difference
+		// checked for overflow, or a ModularInteger for the determinant modulo a prime, which cannot overflow
+		// rows below the pivot are updated in parallel, which leaves the result independent of the thread count
+		template <class T, class Accumulator = typename BareissAccumulator<T>::Type>
+		class Bareiss
+		{
+		private:
+			unsigned int n;
+			vector<Accumulator> elements;	// row-major working copy, eliminated in place
+			Accumulator determinant;
+			bool overflow;
+
+			void Eliminate(unsigned int nThreads);
+
+			// out = (a * b - c * d) / divisor, false when an intermediate leaves the range of Accumulator
+			// types other than integers multiply by reciprocal, 1 / divisor, instead
+			static bool Update(Accumulator a, Accumulator b, Accumulator c, Accumulator d, Accumulator divisor, Accumulator reciprocal,
+				Accumulator& out);
+
+		public:
+			// trailing blocks below this many elements are updated on the calling thread
+			static const unsigned int ParallelThreshold = 1 << 14;
+
+			// --- constructors
+			explicit Bareiss(const Dense<T>& matrix, unsigned int nThreads = 0);
+
+			// true when an intermediate, or an element of the matrix, did not fit Accumulator - the
+			// determinant is then meaningless
+			bool Overflow() const;
+			Accumulator Determinant() const;
+		};
+
+		// WrappingElimination class
+		// determinant of an integral matrix modulo 2^bits of T, by Gaussian elimination over the integers modulo 2^bits -
+		// every pivot is the element with the fewest trailing zero bits left, so it divides the rest of its column and
+		// the multipliers are exact. nothing can overflow: the result is the determinant whenever it fits T and the
+		// wrap-around of the cofactor expansion for unsigned types otherwise. full pivoting, O(n^3) on one thread
+		template <class T>
+		class WrappingElimination
+		{
+		public:
+			static T Determinant(const Dense<T>& matrix);
+		};
+	}
+}
+
+#endif // !_BAREISS_H_
@@ -0,0 +1,468 @@
+#ifndef _BINARY_MATRIX_CPP_
+#define _BINARY_MATRIX_CPP_
+
+#include <assert.h>
+#include <cstring>
+#include <algorithm>
+#include "BinaryMatrix.h"
+#include "MappedFile.h"
+#include "Sparse.cpp"
+#include "Dense.cpp"
+#include "DenseView.cpp"
+#include "ThreadPool.h"
+
+using namespace Numero;
+using namespace Numero::DataTypes;
+
+static_assert(sizeof(BinaryMatrixHeader) == BinaryMatrix::HeaderSize, "the header is a fixed 128 bytes");
+
+#pragma region HEADER
+// the file is <header> then the arrays - values for a dense matrix, column indices, values and
+// row offsets for CSR, each padded to start at a multiple of Alignment
+template <class T>
+BinaryMatrixHeader BinaryMatrix::MakeHeader(BinaryLayout layout, unsigned int rows, unsigned int cols, unsigned long long nonZeros)
+{
+	static_assert(BinaryDataTypeOf<T>::Code != BinaryDataType::None, "the binary format does not store this element type");
+
+	auto align = [](unsigned long long offset) -> unsigned long long { return (offset + Alignment - 1) / Alignment * Alignment; };
+
+	BinaryMatrixHeader header;
+	memset(&header, 0, sizeof(header));
+	memcpy(header.magic, "NUMEROBM", sizeof(header.magic));
+	header.version = Version;
+	header.byteOrder = ByteOrderMark;
+	header.dataType = BinaryDataTypeOf<T>::Code;
+	header.elementSize = sizeof(T);
+	header.layout = layout;
+	header.alignment = Alignment;
+	header.rows = rows;
+	header.cols = cols;
+	header.nonZeros = nonZeros;
+
+	if (layout == BinaryLayout::DenseRowMajor)
+	{
+		header.valuesOffset = align(HeaderSize);
+		header.fileSize = header.valuesOffset + nonZeros * sizeof(T);
+	}
+	else
+	{
+		header.columnIndicesOffset = align(HeaderSize);
+		header.valuesOffset = align(header.columnIndicesOffset + nonZeros * sizeof(unsigned int));
+		header.rowOffsetsOffset = align(header.valuesOffset + nonZeros * sizeof(T));
+		header.fileSize = header.rowOffsetsOffset + (static_cast<unsigned long long>(rows) + 1) * sizeof(unsigned int);
+	}
+	return header;
+}
+
+inline bool BinaryMatrix::ParseHeader(const char* data, size_t size, BinaryMatrixHeader& header)
+{
+	if (data == nullptr || size < HeaderSize)
+		return false;
+
+	memcpy(&header, data, sizeof(header));
+	return memcmp(header.magic, "NUMEROBM", sizeof(header.magic)) == 0 && header.version == Version && header.byteOrder == ByteOrderMark
+		&& header.alignment != 0 && (header.alignment & (header.alignment - 1)) == 0 && header.fileSize <= size;
+}
+
+inline bool BinaryMatrix::ReadHeader(const string& path, BinaryMatrixHeader& header)
+{
+	MappedFile file(path);
+	return file.IsOpen() && ParseHeader(file.Data(), file.Size(), header);
+}
+
+template <class T>
+bool BinaryMatrix::Validate(const char* data, const BinaryMatrixHeader& header, BinaryLayout layout)
+{
+	if (header.dataType != BinaryDataTypeOf<T>::Code || header.elementSize != sizeof(T) || header.layout != layout)
+		return false;
+
+	// count elements of the given size at offset, aligned for them and inside the file
+	auto inside = [&](unsigned long long offset, unsigned long long count, size_t size) -> bool
+	{
+		return offset >= HeaderSize && offset % size == 0 && offset <= header.fileSize && count <= (header.fileSize - offset) / size;
+	};
+
+	if (layout == BinaryLayout::DenseRowMajor)
+		return header.nonZeros == static_cast<unsigned long long>(header.rows) * header.cols && inside(header.valuesOffset, header.nonZeros, sizeof(T));
+
+	if (header.nonZeros > 0xFFFFFFFFu || !inside(header.columnIndicesOffset, header.nonZeros, sizeof(unsigned int))
+		|| !inside(header.valuesOffset, header.nonZeros, sizeof(T))
+		|| !inside(header.rowOffsetsOffset, static_cast<unsigned long long>(header.rows) + 1, sizeof(unsigned int)))
+		return false;
+
+	const unsigned int* offsets = reinterpret_cast<const unsigned int*>(data + header.rowOffsetsOffset);
+	if (offsets[0] != 0 || offsets[header.rows] != header.nonZeros)
+		return false;
+	for (unsigned int row(0); row < header.rows; row++)
+	{
+		if (offsets[row] > offsets[row + 1])
+			return false;
+	}
+	return true;
+}
+#pragma endregion
+
+
+#pragma region READING
+inline void BinaryMatrix::Copy(void* destination, const void* source, size_t bytes, unsigned int nThreads)
+{
+	ThreadPool& pool = ThreadPool::Global();
+	unsigned int threads = (bytes < ParallelCopyThreshold) ? 1 : ((nThreads == 0 || nThreads > pool.ThreadCount()) ? pool.ThreadCount() : nThreads);
+	size_t chunkSize = (bytes + threads - 1) / threads;
+
+	pool.ParallelFor(threads, [&](unsigned int chunk)
+	{
+		size_t begin = min(static_cast<size_t>(chunk) * chunkSize, bytes);
+		size_t end = min(begin + chunkSize, bytes);
+		if (end > begin)
+			memcpy(static_cast<char*>(destination) + begin, static_cast<const char*>(source) + begin, end - begin);
+	}, threads);
+}
+
+template <class T>
+void BinaryMatrix::AssignCsr(const unsigned int* rowOffsets, const unsigned int* columnIndices, const T* values,
+	unsigned int rows, unsigned int cols, Sparse<T>& matrix, unsigned int nThreads)
+{
+	unsigned int nonZeros = rowOffsets[rows];
+	matrix = Sparse<T>(rows, cols);
+	matrix.columnIndices.resize(nonZeros);
+	matrix.values.resize(nonZeros);
+
+	Copy(matrix.rowOffsets.data(), rowOffsets, (static_cast<size_t>(rows) + 1) * sizeof(unsigned int), nThreads);
+	Copy(matrix.columnIndices.data(), columnIndices, static_cast<size_t>(nonZeros) * sizeof(unsigned int), nThreads);
+	Copy(matrix.values.data(), values, static_cast<size_t>(nonZeros) * sizeof(T), nThreads);
+}
+
+template <class T>
+bool BinaryMatrix::ReadDense(const string& path, Dense<T>& matrix, unsigned int nThreads)
+{
+	MappedFile file(path);
+	BinaryMatrixHeader header;
+	if (!file.IsOpen() || !ParseHeader(file.Data(), file.Size(), header) || !Validate<T>(file.Data(), header, BinaryLayout::DenseRowMajor))
+		return false;
+
+	Dense<T> read(header.rows, header.cols, Uninitialized);
+	Copy(read.Data(), file.Data() + header.valuesOffset, static_cast<size_t>(header.nonZeros) * sizeof(T), nThreads);
+	matrix = move(read);
+	return true;
+}
+
+// rows are checked in equal chunks, each chunk for columns ascending within its rows and below the column count
+template <class T>
+bool BinaryMatrix::ReadSparse(const string& path, Sparse<T>& matrix, unsigned int nThreads)
+{
+	MappedFile file(path);
+	BinaryMatrixHeader header;
+	if (!file.IsOpen() || !ParseHeader(file.Data(), file.Size(), header) || !Validate<T>(file.Data(), header, BinaryLayout::SparseCsr))
+		return false;
+
+	const unsigned int* rowOffsets = reinterpret_cast<const unsigned int*>(file.Data() + header.rowOffsetsOffset);
+	const unsigned int* columnIndices = reinterpret_cast<const unsigned int*>(file.Data() + header.columnIndicesOffset);
+	const T* values = reinterpret_cast<const T*>(file.Data() + header.valuesOffset);
+	unsigned int rows = header.rows;
+	unsigned int cols = header.cols;
+
+	ThreadPool& pool = ThreadPool::Global();
+	unsigned int threads = (header.nonZeros * sizeof(unsigned int) < ParallelCopyThreshold) ? 1
+		: ((nThreads == 0 || nThreads > pool.ThreadCount()) ? pool.ThreadCount() : nThreads);
+	unsigned int chunkSize = (rows + threads - 1) / threads;
+	vector<char> chunkValid(threads, 1);
+
+	pool.ParallelFor(threads, [&](unsigned int chunk)
+	{
+		unsigned int begin = min(chunk * chunkSize, rows);
+		unsigned int end = min(begin + chunkSize, rows);
+		for (unsigned int row(begin); row < end; row++)
+		{
+			for (unsigned int entry(rowOffsets[row]); entry < rowOffsets[row + 1]; entry++)
+			{
+				if (columnIndices[entry] >= cols || (entry > rowOffsets[row] && columnIndices[entry] <= columnIndices[entry - 1]))
+				{
+					chunkValid[chunk] = 0;
+					return;
+				}
+			}
+		}
+	}, threads);
+
+	if (find(chunkValid.begin(), chunkValid.end(), 0) != chunkValid.end())
+		return false;
+
+	AssignCsr(rowOffsets, columnIndices, values, rows, cols, matrix, nThreads);
+	return true;
+}
+#pragma endregion
+
+
+#pragma region WRITING
+template <class T>
+bool BinaryMatrix::WriteDense(const string& path, const Dense<T>& matrix)
+{
+	BinaryDenseWriter<T> writer(path, matrix.Rows(), matrix.Cols());
+	return writer.IsOpen() && writer.WriteRows(matrix.Data(), matrix.Rows()) && writer.Close();
+}
+
+template <class T>
+bool BinaryMatrix::WriteSparse(const string& path, const Sparse<T>& matrix)
+{
+	const unsigned int* offsets = matrix.RowOffsets();
+	const unsigned int* columns = matrix.ColumnIndices();
+	const T* values = matrix.Values();
+
+	BinarySparseWriter<T> writer(path, matrix.Rows(), matrix.Cols(), matrix.NonZeros());
+	if (!writer.IsOpen())
+		return false;
+
+	for (unsigned int row(0); row < matrix.Rows(); row++)
+	{
+		if (!writer.WriteRow(columns + offsets[row], values + offsets[row], offsets[row + 1] - offsets[row]))
+			return false;
+	}
+	return writer.Close();
+}
+
+template <class T>
+BinaryDenseWriter<T>::BinaryDenseWriter(const string& path, unsigned int rows, unsigned int cols)
+	: out(path, ios::binary | ios::trunc),
+	header(BinaryMatrix::MakeHeader<T>(BinaryLayout::DenseRowMajor, rows, cols, static_cast<unsigned long long>(rows) * cols)), rowsWritten(0)
+{
+	out.write(reinterpret_cast<const char*>(&header), sizeof(header));
+}
+
+template <class T>
+BinaryDenseWriter<T>::~BinaryDenseWriter()
+{
+	if (out.is_open())
+		Close();
+}
+
+template <class T>
+bool BinaryDenseWriter<T>::IsOpen() const
+{
+	return out.is_open() && !out.fail();
+}
+
+template <class T>
+bool BinaryDenseWriter<T>::WriteRows(const T* data, unsigned int count)
+{
+	if (!IsOpen() || count > header.rows - rowsWritten)
+		return false;
+
+	out.write(reinterpret_cast<const char*>(data), static_cast<streamsize>(static_cast<size_t>(count) * header.cols * sizeof(T)));
+	rowsWritten += count;
+	return !out.fail();
+}
+
+template <class T>
+bool BinaryDenseWriter<T>::Close()
+{
+	if (!out.is_open())
+		return false;
+
+	bool complete = IsOpen() && rowsWritten == header.rows;
+	out.close();
+	return complete && !out.fail();
+}
+
+template <class T>
+BinarySparseWriter<T>::BinarySparseWriter(const string& path, unsigned int rows, unsigned int cols, unsigned int nonZeros)
+	: out(path, ios::binary | ios::trunc), header(BinaryMatrix::MakeHeader<T>(BinaryLayout::SparseCsr, rows, cols, nonZeros)),
+	flushed(0), failed(false)
+{
+	rowOffsets.reserve(static_cast<size_t>(rows) + 1);
+	rowOffsets.push_back(0);
+	columnBlock.reserve(FlushEntries);
+	valueBlock.reserve(FlushEntries);
+	out.write(reinterpret_cast<const char*>(&header), sizeof(header));
+	failed = out.fail();
+}
+
+template <class T>
+BinarySparseWriter<T>::~BinarySparseWriter()
+{
+	if (out.is_open())
+		Close();
+}
+
+template <class T>
+bool BinarySparseWriter<T>::IsOpen() const
+{
+	return out.is_open() && !failed;
+}
+
+// the buffered entries go behind the ones already written in both regions
+template <class T>
+bool BinarySparseWriter<T>::Flush()
+{
+	if (failed || columnBlock.empty())
+		return !failed;
+
+	out.seekp(static_cast<streamoff>(header.columnIndicesOffset + flushed * sizeof(unsigned int)));
+	out.write(reinterpret_cast<const char*>(columnBlock.data()), static_cast<streamsize>(columnBlock.size() * sizeof(unsigned int)));
+	out.seekp(static_cast<streamoff>(header.valuesOffset + flushed * sizeof(T)));
+	out.write(reinterpret_cast<const char*>(valueBlock.data()), static_cast<streamsize>(valueBlock.size() * sizeof(T)));
+
+	flushed += columnBlock.size();
+	columnBlock.clear();
+	valueBlock.clear();
+	failed = out.fail();
+	return !failed;
+}
+
+template <class T>
+bool BinarySparseWriter<T>::WriteRow(const unsigned int* columns, const T* values, unsigned int count)
+{
+	unsigned long long written = rowOffsets.back();
+	if (!IsOpen() || rowOffsets.size() > header.rows || count > header.nonZeros - written)
+		return false;
+
+	for (unsigned int i(0); i < count; i++)
+	{
+		if (columns[i] >= header.cols || (i > 0 && columns[i] <= columns[i - 1]))
+			return false;
+	}
+
+	columnBlock.insert(columnBlock.end(), columns, columns + count);
+	valueBlock.insert(valueBlock.end(), values, values + count);
+	rowOffsets.push_back(static_cast<unsigned int>(written + count));
+
+	return (columnBlock.size() < FlushEntries) || Flush();
+}
+
+// the row offsets end the file, so an unfinished matrix is shorter than its header says and is rejected on load
+template <class T>
+bool BinarySparseWriter<T>::Close()
+{
+	if (!out.is_open())
+		return false;
+
+	bool complete = Flush() && rowOffsets.size() == static_cast<size_t>(header.rows) + 1 && rowOffsets.back() == header.nonZeros;
+	if (complete)
+	{
+		out.seekp(static_cast<streamoff>(header.rowOffsetsOffset));
+		out.write(reinterpret_cast<const char*>(rowOffsets.data()), static_cast<streamsize>(rowOffsets.size() * sizeof(unsigned int)));
+	}
+	out.close();
+	return complete && !out.fail();
+}
+#pragma endregion
+
+
+#pragma region MAPPING
+template <class T>
+MappedDense<T>::MappedDense(const string& path)
+	: MappedDense()
+{
+	Open(path);
+}
+
+template <class T>
+bool MappedDense<T>::Open(const string& path)
+{
+	Close();
+
+	BinaryMatrixHeader header;
+	if (!file.Open(path) || !BinaryMatrix::ParseHeader(file.Data(), file.Size(), header)
+		|| !BinaryMatrix::Validate<T>(file.Data(), header, BinaryLayout::DenseRowMajor))
+	{
+		Close();
+		return false;
+	}
+
+	data = reinterpret_cast<const T*>(file.Data() + header.valuesOffset);
+	nRows = header.rows;
+	nCols = header.cols;
+	return true;
+}
+
+template <class T>
+void MappedDense<T>::Close()
+{
+	file.Close();
+	data = nullptr;
+	nRows = 0;
+	nCols = 0;
+}
+
+template <class T>
+DenseView<T> MappedDense<T>::View() const
+{
+	return DenseView<T>(data, nRows, nCols, nCols, 1);
+}
+
+template <class T>
+Dense<T> MappedDense<T>::Materialize() const
+{
+	Dense<T> copy(nRows, nCols, Uninitialized);
+	BinaryMatrix::Copy(copy.Data(), data, static_cast<size_t>(nRows) * nCols * sizeof(T));
+	return copy;
+}
+
+template <class T>
+MappedSparse<T>::MappedSparse(const string& path)
+	: MappedSparse()
+{
+	Open(path);
+}
+
+template <class T>
+bool MappedSparse<T>::Open(const string& path)
+{
+	Close();
+
+	BinaryMatrixHeader header;
+	if (!file.Open(path) || !BinaryMatrix::ParseHeader(file.Data(), file.Size(), header)
+		|| !BinaryMatrix::Validate<T>(file.Data(), header, BinaryLayout::SparseCsr))
+	{
+		Close();
+		return false;
+	}
+
+	rowOffsets = reinterpret_cast<const unsigned int*>(file.Data() + header.rowOffsetsOffset);
+	columnIndices = reinterpret_cast<const unsigned int*>(file.Data() + header.columnIndicesOffset);
+	values = reinterpret_cast<const T*>(file.Data() + header.valuesOffset);
+	nRows = header.rows;
+	nCols = header.cols;
+	return true;
+}
+
+template <class T>
+void MappedSparse<T>::Close()
+{
+	file.Close();
+	rowOffsets = nullptr;
+	columnIndices = nullptr;
+	values = nullptr;
+	nRows = 0;
+	nCols = 0;
+}
+
+template <class T>
+T MappedSparse<T>::GetValue(unsigned int row, unsigned int col) const
+{
+	assert(row < nRows && col < nCols);
+
+	const unsigned int* begin = columnIndices + rowOffsets[row];
+	const unsigned int* end = columnIndices + rowOffsets[row + 1];
+	const unsigned int* position = lower_bound(begin, end, col);
+	return (position != end && *position == col) ? values[position - columnIndices] : static_cast<T>(0);
+}
+
+template <class T>
+void MappedSparse<T>::MulVectorInto(const T* x, T* y, unsigned int nThreads) const
+{
+	assert(x != y);
+
+	Sparse<T>::CsrMulVectorInto(rowOffsets, columnIndices, values, nRows, nCols, x, y, nThreads);
+}
+
+template <class T>
+Sparse<T> MappedSparse<T>::Materialize() const
+{
+	Sparse<T> copy;
+	BinaryMatrix::AssignCsr(rowOffsets, columnIndices, values, nRows, nCols, copy);
+	return copy;
+}
+#pragma endregion
+
+#endif // !_BINARY_MATRIX_CPP_
@@ -0,0 +1,236 @@
+#ifndef _BINARY_MATRIX_H_
+#define _BINARY_MATRIX_H_
+
+#include "../Numero.Definitions/DataTypeDefines.h"
+#include "Sparse.h"
+#include "Dense.h"
+#include "DenseView.h"
+#include "MappedFile.h"
+#include <vector>
+#include <string>
+#include <fstream>
+
+namespace Numero
+{
+	using namespace std;
+	using namespace Definitions;
+
+	namespace DataTypes
+	{
+		// element types of the binary format - the code is stored in the file and checked on load
+		enum class BinaryDataType : unsigned int
+		{
+			None = 0,
+			Int8, UInt8, Int16, UInt16, Int32, UInt32, Int64, UInt64, Float, Double
+		};
+
+		// storage of the arrays that follow the header
+		enum class BinaryLayout : unsigned int
+		{
+			DenseRowMajor = 1,		// one array of rows * cols elements
+			SparseCsr = 2			// row offsets, column indices and values, as in Sparse
+		};
+
+		// code of the element type T, None for types the format does not store
+		template <class T> struct BinaryDataTypeOf { static const BinaryDataType Code = BinaryDataType::None; };
+		template <> struct BinaryDataTypeOf<signed char> { static const BinaryDataType Code = BinaryDataType::Int8; };
+		template <> struct BinaryDataTypeOf<unsigned char> { static const BinaryDataType Code = BinaryDataType::UInt8; };
+		template <> struct BinaryDataTypeOf<short> { static const BinaryDataType Code = BinaryDataType::Int16; };
+		template <> struct BinaryDataTypeOf<unsigned short> { static const BinaryDataType Code = BinaryDataType::UInt16; };
+		template <> struct BinaryDataTypeOf<int> { static const BinaryDataType Code = BinaryDataType::Int32; };
+		template <> struct BinaryDataTypeOf<unsigned int> { static const BinaryDataType Code = BinaryDataType::UInt32; };
+		template <> struct BinaryDataTypeOf<long long> { static const BinaryDataType Code = BinaryDataType::Int64; };
+		template <> struct BinaryDataTypeOf<unsigned long long> { static const BinaryDataType Code = BinaryDataType::UInt64; };
+		template <> struct BinaryDataTypeOf<float> { static const BinaryDataType Code = BinaryDataType::Float; };
+		template <> struct BinaryDataTypeOf<double> { static const BinaryDataType Code = BinaryDataType::Double; };
+
+		// the first bytes of a binary matrix file, written as is in native byte order
+		// every array starts at a multiple of alignment from the start of the file, so a mapping hands
+		// out arrays as aligned as the allocator's. rowOffsets and columnIndices are 32 bit, as in Sparse
+		struct BinaryMatrixHeader
+		{
+			char magic[8];						// "NUMEROBM"
+			unsigned int version;
+			unsigned int byteOrder;				// ByteOrderMark as the writer stored it
+			BinaryDataType dataType;
+			unsigned int elementSize;
+			BinaryLayout layout;
+			unsigned int alignment;
+			unsigned int rows;
+			unsigned int cols;
+			unsigned long long nonZeros;		// elements of a dense matrix
+			unsigned long long valuesOffset;
+			unsigned long long columnIndicesOffset;	// 0 for dense matrices
+			unsigned long long rowOffsetsOffset;	// 0 for dense matrices
+			unsigned long long fileSize;
+			char reserved[48];				// zero, pads the header to HeaderSize
+		};
+
+		// BinaryMatrix class
+		// reader and writer of the versioned binary format (.nbm) - a fixed header, then the storage of the
+		// matrix as it is in memory. reads are one copy of the mapped file into the arrays, and MappedDense and
+		// MappedSparse below use the mapping itself. the readers return false when the file cannot be mapped,
+		// does not follow the format or holds another element type than T
+		class BinaryMatrix
+		{
+		public:
+			static const unsigned int Version = 1;
+			static const unsigned int ByteOrderMark = 0x01020304;
+			static const unsigned int Alignment = 64;
+			static const size_t HeaderSize = 128;
+
+			// --- reading
+			static bool ParseHeader(const char* data, size_t size, BinaryMatrixHeader& header);
+			static bool ReadHeader(const string& path, BinaryMatrixHeader& header);
+
+			// checks a parsed header against the element type and layout - every array inside the file,
+			// and for CSR the row offsets ascending up to the nonzero count
+			template <class T>
+			static bool Validate(const char* data, const BinaryMatrixHeader& header, BinaryLayout layout);
+
+			// nThreads as in ThreadPool::ParallelFor - the arrays are copied in parallel chunks
+			template <class T>
+			static bool ReadDense(const string& path, Dense<T>& matrix, unsigned int nThreads = 0);
+			// column indices are checked against the column count and the row order
+			template <class T>
+			static bool ReadSparse(const string& path, Sparse<T>& matrix, unsigned int nThreads = 0);
+
+			// --- writing, through the streaming writers below
+			template <class T>
+			static bool WriteDense(const string& path, const Dense<T>& matrix);
+			template <class T>
+			static bool WriteSparse(const string& path, const Sparse<T>& matrix);
+
+			// header of a matrix with the arrays at their aligned offsets
+			template <class T>
+			static BinaryMatrixHeader MakeHeader(BinaryLayout layout, unsigned int rows, unsigned int cols, unsigned long long nonZeros);
+
+			// replaces the contents of matrix with copies of the CSR arrays
+			template <class T>
+			static void AssignCsr(const unsigned int* rowOffsets, const unsigned int* columnIndices, const T* values,
+				unsigned int rows, unsigned int cols, Sparse<T>& matrix, unsigned int nThreads = 0);
+			// memcpy split between threads above ParallelCopyThreshold
+			static void Copy(void* destination, const void* source, size_t bytes, unsigned int nThreads = 0);
+
+			// arrays of at least this many bytes are copied by several threads
+			static const size_t ParallelCopyThreshold = 1 << 22;
+		};
+
+		// BinaryDenseWriter class
+		// writes a dense matrix row block by row block, so a matrix larger than memory is written from
+		// pieces of it. the header is complete from the start, the rows follow in order
+		template <class T>
+		class BinaryDenseWriter
+		{
+		private:
+			ofstream out;
+			BinaryMatrixHeader header;
+			unsigned int rowsWritten;
+		public:
+			BinaryDenseWriter(const string& path, unsigned int rows, unsigned int cols);
+			~BinaryDenseWriter();
+
+			bool IsOpen() const;
+			// count whole rows, row-major - false once the stream fails or more rows than the matrix has are given
+			bool WriteRows(const T* data, unsigned int count);
+			// true when every row was written and the file is complete
+			bool Close();
+		};
+
+		// BinarySparseWriter class
+		// writes a CSR matrix row by row with its nonzero count known up front. column indices and values go to
+		// their two regions of the file in blocks of FlushEntries, and the row offsets - 4 bytes a row - are kept
+		// in memory until Close writes them behind the values
+		template <class T>
+		class BinarySparseWriter
+		{
+		private:
+			ofstream out;
+			BinaryMatrixHeader header;
+			vector<unsigned int> rowOffsets;
+			vector<unsigned int> columnBlock;
+			vector<T> valueBlock;
+			unsigned long long flushed;			// entries already in the file
+			bool failed;
+
+			bool Flush();
+		public:
+			static const unsigned int FlushEntries = 1 << 16;
+
+			BinarySparseWriter(const string& path, unsigned int rows, unsigned int cols, unsigned int nonZeros);
+			~BinarySparseWriter();
+
+			bool IsOpen() const;
+			// the next row, with ascending columns below the column count
+			bool WriteRow(const unsigned int* columns, const T* values, unsigned int count);
+			// true when every row and nonzero was written and the file is complete
+			bool Close();
+		};
+
+		// MappedDense class
+		// a binary dense matrix used in place from its mapping - the view is read-only, costs no copy, and pages
+		// come in as they are touched. it stays valid until Close or destruction of the MappedDense
+		template <class T>
+		class MappedDense
+		{
+		private:
+			MappedFile file;
+			const T* data;
+			unsigned int nRows;
+			unsigned int nCols;
+		public:
+			MappedDense() : data(nullptr), nRows(0), nCols(0) {}
+			explicit MappedDense(const string& path);
+
+			// false when the file cannot be mapped or is not a dense matrix of T
+			bool Open(const string& path);
+			void Close();
+			bool IsOpen() const { return file.IsOpen(); }
+
+			unsigned int Rows() const { return nRows; }
+			unsigned int Cols() const { return nCols; }
+			const T* Data() const { return data; }
+			DenseView<T> View() const;
+			Dense<T> Materialize() const;
+		};
+
+		// MappedSparse class
+		// a binary CSR matrix used in place from its mapping. Open checks the row offsets, the column indices
+		// are trusted as written - ReadSparse checks them, at the price of reading every page
+		template <class T>
+		class MappedSparse
+		{
+		private:
+			MappedFile file;
+			const unsigned int* rowOffsets;
+			const unsigned int* columnIndices;
+			const T* values;
+			unsigned int nRows;
+			unsigned int nCols;
+		public:
+			MappedSparse() : rowOffsets(nullptr), columnIndices(nullptr), values(nullptr), nRows(0), nCols(0) {}
+			explicit MappedSparse(const string& path);
+
+			// false when the file cannot be mapped or is not a CSR matrix of T
+			bool Open(const string& path);
+			void Close();
+			bool IsOpen() const { return file.IsOpen(); }
+
+			unsigned int Rows() const { return nRows; }
+			unsigned int Cols() const { return nCols; }
+			unsigned int NonZeros() const { return rowOffsets ? rowOffsets[nRows] : 0; }
+
+			// binary search within the row, as Sparse::GetValue
+			T GetValue(unsigned int row, unsigned int col) const;
+			// y = A*x, the kernel of Sparse::MulVectorInto
+			void MulVectorInto(const T* x, T* y, unsigned int nThreads = 0) const;
+			Sparse<T> Materialize() const;
+
+			const unsigned int* RowOffsets() const { return rowOffsets; }
+			const unsigned int* ColumnIndices() const { return columnIndices; }
+			const T* Values() const { return values; }
+		};
+	}
+}
+
+#endif // !_BINARY_MATRIX_H_
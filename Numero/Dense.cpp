@@ -1,35 +1,167 @@
+#ifndef _DENSE_CPP_
+#define _DENSE_CPP_
+
 #include <assert.h>
+#include <algorithm>
+#include <type_traits>
+#include <limits>
 #include "Dense.h"
+#include "Simd.h"
+#include "AlignedAllocator.h"
+#include "Gemm.cpp"
+#include "LU.cpp"
+#include "Bareiss.cpp"
+#include "TextFormat.cpp"
+#include "DenseView.cpp"
+#include "DenseFixed.cpp"
 
 using namespace Numero;
 using namespace Numero::DataTypes;
 
 #pragma region MEMORY_MANIPULATION
+// storage for count elements from the aligned pool, contents unspecified
+template <class T>
+void Dense<T>::AllocateStorage(unsigned int count)
+{
+	static_assert(is_trivially_copyable<T>::value && is_trivially_destructible<T>::value,
+		"Dense storage is raw memory and holds trivially copyable elements only");
+
+	capacity = count;
+	matrixData = (count > 0) ? static_cast<T*>(AlignedAllocator::Allocate(static_cast<size_t>(count)*sizeof(T))) : nullptr;
+}
+
 // matrix data memory allocation method
 template <class T>
 void Dense<T>::Allocate(unsigned int rows, unsigned int cols)
 {
-	matrixData = new T[rows*cols];
+	AllocateStorage(rows*cols);
 	ResetToConstant(static_cast<T>(0));
 }
 
 template<class T>
 void Dense<T>::Allocate(unsigned int rows, unsigned int cols, const T * data)
 {
-    matrixData = new T[rows*cols];
+	AllocateStorage(rows*cols);
 
-    for (int i = 0; i < rows*cols; i++)
-    {
-        matrixData[i] = data[i];
-    }
+	copy(data, data + capacity, matrixData);
 }
-;
 
-// matrix data memory deallocation method
+// matrix data memory deallocation method - the buffer goes back to the pool
 template <class T>
 void Dense<T>::Deallocate()
 {
-	delete matrixData;
+	AlignedAllocator::Deallocate(matrixData, static_cast<size_t>(capacity)*sizeof(T));
+	matrixData = nullptr;
+	capacity = 0;
+}
+
+// move constructor - takes over the buffer and leaves other as an empty matrix
+template <class T>
+Dense<T>::Dense(Dense&& other) noexcept : Matrix<T>(other.nRows, other.nCols), matrixData(other.matrixData), capacity(other.capacity)
+{
+	other.matrixData = nullptr;
+	other.capacity = 0;
+	other.nRows = 0;
+	other.nCols = 0;
+}
+
+// copy assignment - deep copy into the existing buffer when it is large enough
+template <class T>
+Dense<T>& Dense<T>::operator=(const Dense<T>& other)
+{
+	if (this == &other)
+		return *this;
+
+	Resize(other.nRows, other.nCols);
+	copy(other.matrixData, other.matrixData + other.Numel(), matrixData);
+
+	return *this;
+}
+
+// move assignment - releases the current buffer and takes over other's
+template <class T>
+Dense<T>& Dense<T>::operator=(Dense<T>&& other) noexcept
+{
+	if (this == &other)
+		return *this;
+
+	Deallocate();
+
+	matrixData = other.matrixData;
+	capacity = other.capacity;
+	nRows = other.nRows;
+	nCols = other.nCols;
+
+	other.matrixData = nullptr;
+	other.capacity = 0;
+	other.nRows = 0;
+	other.nCols = 0;
+
+	return *this;
+}
+
+// reshape, reallocating only when the new size exceeds the capacity
+template <class T>
+void Dense<T>::Resize(unsigned int rows, unsigned int cols)
+{
+	unsigned int numElements = rows*cols;
+
+	if (numElements > capacity)
+	{
+		Deallocate();
+		AllocateStorage(numElements);
+	}
+
+	nRows = rows;
+	nCols = cols;
+}
+
+template <class T>
+unsigned int Dense<T>::Capacity() const
+{
+	return capacity;
+}
+#pragma endregion
+
+
+#pragma region EXPRESSION_EVALUATION
+// constructs the matrix from a lazy expression
+template <class T>
+template <class E>
+Dense<T>::Dense(const DenseExpression<E>& expression) : Matrix<T>(0, 0), matrixData(nullptr), capacity(0)
+{
+	*this = expression;
+}
+
+// evaluates an element-wise expression tree in a single pass
+// operands are only ever read at the position being written, so the
+// destination may itself appear in the expression - unless it is read through
+// a view that moves elements around, in which case the result goes through a temporary
+template <class T>
+template <class E>
+Dense<T>& Dense<T>::operator=(const DenseExpression<E>& expression)
+{
+	const E& expr = expression.Self();
+
+	if (expr.Aliases(matrixData, matrixData + capacity))
+	{
+		Dense<T> evaluated;
+		evaluated = expr;
+		return *this = move(evaluated);
+	}
+
+	Resize(expr.Rows(), expr.Cols());
+
+	for (unsigned int row(0); row < nRows; row++)
+	{
+		T* outRow = matrixData + row*nCols;
+		for (unsigned int col(0); col < nCols; col++)
+		{
+			outRow[col] = expr.At(row, col);
+		}
+	}
+
+	return *this;
 }
 #pragma endregion
 
@@ -46,11 +178,7 @@ unsigned int Dense<T>::Numel() const
 template <class T>
 void Dense<T>::ResetToConstant(T constantVal)
 {
-	unsigned int numElements = Numel();
-	for (unsigned int index(0); index < numElements; index++)
-	{
-		matrixData[index] = constantVal;
-	}
+	Simd::Fill(matrixData, constantVal, Numel());
 }
 
 
@@ -87,109 +215,128 @@ void Dense<T>::operator()(unsigned int row, unsigned int col, T value)
 
 
 #pragma region OPERATOR_OVERLOADS
-
-template <class T>
-Dense<T> Dense<T>::operator*(T scalar) const
-{
-	return CopyMulScalar(scalar);
-}
-
 template <class T>
 Dense<T> Dense<T>::operator*(const Dense<T>& other) const
 {
 	// empirically, naive multiplication is faster in very small matrices
 	if (nRows > 2)
 	{
-		return MulTransposed(other);
+		Dense<T> product;
+		MulInto(other, product);
+		return product;
 	}
 	else
 	{
 		return MulNaive(other);
 	}
 }
-
-template <class T>
-Dense<T> Dense<T>::operator+(const Dense<T>& other) const
-{
-	return CopyAddMatrix(other);
-}
-
-template <class T>
-Dense<T> Dense<T>::operator+(T scalar) const
-{
-	return CopyAddScalar(scalar);
-}
 #pragma endregion
 
 
 #pragma region CONCATENATION_FUNCTIONS
 // validated
 // vertical concatenation of two matrices into a new matrix
-// TODO: consider switching GetValue and SetValue to actual usage of matrixData
 template <class T>
-Dense<T> Dense<T>::ConcatRows(const Dense<T>& matrixB)
+Dense<T> Dense<T>::ConcatRows(const Dense<T>& matrixB) const
 {
-	assert(nCols == matrixB.nCols);
+	Dense<T> concat;
+	ConcatRowsInto(matrixB, concat);
+	return concat;
+}
 
-	unsigned int newRowNum = nRows + matrixB.nRows;
+// vertical concatenation - row-major storage makes it two contiguous copies
+template <class T>
+void Dense<T>::ConcatRowsInto(const Dense<T>& matrixB, Dense<T>& out) const
+{
+	assert(nCols == matrixB.nCols);
+	assert((&out != this) && (&out != &matrixB));
 
-	Dense<T> concat(newRowNum, nCols);
+	out.Resize(nRows + matrixB.nRows, nCols);
 
-	for (unsigned int i(0); i < newRowNum; i++)
-	{
-		for (unsigned int j(0); j < nCols; j++)
-		{
-			if (i >= nRows)
-				concat.SetValue(i, j, matrixB.GetValue(i - nRows, j));
-			else
-				concat.SetValue(i, j, GetValue(i, j));
-		}
-	}
-	return concat;
+	T* end = copy(matrixData, matrixData + Numel(), out.matrixData);
+	copy(matrixB.matrixData, matrixB.matrixData + matrixB.Numel(), end);
 }
 
 // validated
 // horizontal concatenation of two matrices into a new matrix
-// TODO: consider switching SetValue to actual usage of matrixData
 template <class T>
-Dense<T> Dense<T>::ConcatCols(const Dense<T>& matrixB)
+Dense<T> Dense<T>::ConcatCols(const Dense<T>& matrixB) const
 {
-	assert(nRows == matrixB.nRows);
+	Dense<T> concat;
+	ConcatColsInto(matrixB, concat);
+	return concat;
+}
 
-	unsigned int newColNum = nCols + matrixB.nCols;
+// horizontal concatenation - every output row is a row of this followed by a row of matrixB
+template <class T>
+void Dense<T>::ConcatColsInto(const Dense<T>& matrixB, Dense<T>& out) const
+{
+	assert(nRows == matrixB.nRows);
+	assert((&out != this) && (&out != &matrixB));
 
-	Dense<T> concat(nRows, newColNum);
+	out.Resize(nRows, nCols + matrixB.nCols);
 
+	T* outRow = out.matrixData;
 	for (unsigned int i(0); i < nRows; i++)
 	{
-		for (unsigned int j(0); j < newColNum; j++)
-		{
-			if (j >= nCols)
-				concat.SetValue(i, j, matrixB.GetValue(i, j - nCols));
-			else
-				concat.SetValue(i, j, GetValue(i, j));
-		}
+		outRow = copy(matrixData + i*nCols, matrixData + (i + 1)*nCols, outRow);
+		outRow = copy(matrixB.matrixData + i*matrixB.nCols, matrixB.matrixData + (i + 1)*matrixB.nCols, outRow);
 	}
-	return concat;
 }
 
+// sub matrix of the inclusive row and column ranges
 template <class T>
-Dense<T> Dense<T>::SubMatrix(unsigned int startRow, unsigned int endRow, unsigned int startCol, unsigned int endCol)
+Dense<T> Dense<T>::SubMatrix(unsigned int startRow, unsigned int endRow, unsigned int startCol, unsigned int endCol) const
 {
+	Dense<T> sub;
+	SubMatrixInto(startRow, endRow, startCol, endCol, sub);
+	return sub;
+}
+
+template <class T>
+void Dense<T>::SubMatrixInto(unsigned int startRow, unsigned int endRow, unsigned int startCol, unsigned int endCol, Dense<T>& out) const
+{
+	assert((startRow <= endRow) && (endRow < nRows));
+	assert((startCol <= endCol) && (endCol < nCols));
+	assert(&out != this);
+
 	unsigned int newRowCount = endRow - startRow + 1;	// +1 becuase zero based
 	unsigned int newColCount = endCol - startCol + 1;
 
-	Dense<T> sub(newRowCount, newColCount);
+	out.Resize(newRowCount, newColCount);
 
 	for (unsigned int i(0); i < newRowCount; i++)
 	{
-		for (unsigned int j(0); j < newColCount; j++)
-		{
-			sub.SetValue(i, j, GetValue(startRow + i, startCol + j));
-		}
+		const T* sourceRow = matrixData + (startRow + i)*nCols + startCol;
+		copy(sourceRow, sourceRow + newColCount, out.matrixData + i*newColCount);
 	}
+}
+#pragma endregion
 
-	return sub;
+
+#pragma region VIEWS
+template <class T>
+DenseView<T> Dense<T>::View() const
+{
+	return DenseView<T>(*this);
+}
+
+template <class T>
+DenseView<T> Dense<T>::SubMatrixView(unsigned int startRow, unsigned int endRow, unsigned int startCol, unsigned int endCol) const
+{
+	return View().SubMatrix(startRow, endRow, startCol, endCol);
+}
+
+template <class T>
+DenseView<T> Dense<T>::TransposeView() const
+{
+	return View().Transpose();
+}
+
+template <class T>
+DenseView<T> Dense<T>::DiagonalView() const
+{
+	return View().Diagonal();
 }
 #pragma endregion
 
@@ -214,14 +361,58 @@ T Dense<T>::Trace() const
 
 // validated
 // function to calculate determinant of Dense matrix
+// floating point matrices above CofactorLimit go through LU factorization in O(n^3)
 template <class T>
 T Dense<T>::Determinant() const
 {
 	// asserting square matrix
 	assert(nRows == nCols);
+
+	if constexpr (is_floating_point<T>::value)
+	{
+		if (nRows > CofactorLimit)
+			return LU<T>(*this).Determinant();
+	}
+
+	if constexpr (is_integral<T>::value && !is_same<T, bool>::value)
+	{
+		if (nRows > CofactorLimit)
+		{
+			Bareiss<T> bareiss(*this);
+
+			// minors beyond 64 bits - the elimination modulo 2^bits is still exact when the determinant fits T
+			if (bareiss.Overflow())
+				return WrappingElimination<T>::Determinant(*this);
+
+			typename BareissAccumulator<T>::Type determinant = bareiss.Determinant();
+
+			// unsigned types keep the wrap-around of the cofactor expansion, signed ones must hold the result
+			assert(is_unsigned<T>::value || (determinant >= static_cast<long long>(numeric_limits<T>::min())
+				&& determinant <= static_cast<long long>(numeric_limits<T>::max())));
+
+			return static_cast<T>(determinant);
+		}
+	}
+
+	return DeterminantByCofactors();
+}
+
+// validated
+// determinant by cofactor expansion along the first row
+// exact for integral types, but O(n!) - only meant for small matrices
+template <class T>
+T Dense<T>::DeterminantByCofactors() const
+{
+	assert(nRows == nCols);
 	
 	T det = (T)0;
 
+	// empty matrix - determinant of the empty product
+	if (nRows == 0)
+	{
+		return static_cast<T>(1);
+	}
+
 	// stopping condition - matrix of size 1x1
 	if (nRows == 1)
 	{
@@ -250,7 +441,7 @@ T Dense<T>::Determinant() const
 
 		Dense<T> minor = Minor(0, i);
 		T scalarFactor = GetValue(0, i);
-		det += sign*scalarFactor*minor.Determinant();
+		det += sign*scalarFactor*minor.DeterminantByCofactors();
 	}
 
 	return det;
@@ -261,20 +452,37 @@ T Dense<T>::Determinant() const
 template <class T>
 Dense<T> Dense<T>::Transpose() const
 {
-	int transCols = nRows;
-	int transRows = nCols;
+	Dense<T> transposed;
+	TransposeInto(transposed);
+	return transposed;
+}
 
-	Dense<T> transposed(transRows, transCols);
+// transpose by square tiles so both the reads and the writes stay within a few cache lines
+template <class T>
+void Dense<T>::TransposeInto(Dense<T>& out) const
+{
+	assert(&out != this);
 
-	for (int rowIndex(0); rowIndex < transRows; rowIndex++)
+	const unsigned int tileSize = 32;
+	out.Resize(nCols, nRows);
+
+	for (unsigned int rowTile(0); rowTile < nRows; rowTile += tileSize)
 	{
-		for (int colIndex(0); colIndex < transCols; colIndex++)
+		unsigned int rowEnd = (nRows - rowTile < tileSize) ? nRows : rowTile + tileSize;
+
+		for (unsigned int colTile(0); colTile < nCols; colTile += tileSize)
 		{
-			transposed.SetValue(rowIndex, colIndex, GetValue(colIndex, rowIndex));
+			unsigned int colEnd = (nCols - colTile < tileSize) ? nCols : colTile + tileSize;
+
+			for (unsigned int row(rowTile); row < rowEnd; row++)
+			{
+				for (unsigned int col(colTile); col < colEnd; col++)
+				{
+					out.matrixData[col*nRows + row] = matrixData[row*nCols + col];
+				}
+			}
 		}
 	}
-
-	return transposed;
 }
 
 // validated
@@ -282,14 +490,23 @@ Dense<T> Dense<T>::Transpose() const
 template <class T>
 Dense<T> Dense<T>::Diagonal() const
 {
-	Dense<T> diag(1, nRows);
+	Dense<T> diag;
+	DiagonalInto(diag);
+	return diag;
+}
 
-	for (unsigned int i(0); i < nRows; i++)
+template <class T>
+void Dense<T>::DiagonalInto(Dense<T>& out) const
+{
+	assert(&out != this);
+
+	unsigned int diagLength = (nRows < nCols) ? nRows : nCols;
+	out.Resize(1, diagLength);
+
+	for (unsigned int i(0); i < diagLength; i++)
 	{
-		diag.matrixData[i] = matrixData[i + i*nCols];
+		out.matrixData[i] = matrixData[i + i*nCols];
 	}
-
-	return diag;
 }
 
 // validated
@@ -297,22 +514,10 @@ Dense<T> Dense<T>::Diagonal() const
 template <class T>
 void Dense<T>::RowInterchange(unsigned int rowA, unsigned int rowB)
 {
-	T* tempBuffer = new T[nCols];
-
-	// copy first row to a buffer
-	for (unsigned int rowElement(0); rowElement < nCols; rowElement++)
-	{
-		tempBuffer[rowElement] = matrixData[rowA*nCols + rowElement];
-	}
+	if (rowA == rowB)
+		return;
 
-	// interchange the two rows using the buffer
-	for (unsigned int rowElement(0); rowElement < nCols; rowElement++)
-	{
-		matrixData[rowA*nCols + rowElement] = matrixData[rowB*nCols + rowElement];
-		matrixData[rowB*nCols + rowElement] = tempBuffer[rowElement];
-	}
-
-	delete[] tempBuffer;
+	swap_ranges(matrixData + rowA*nCols, matrixData + (rowA + 1)*nCols, matrixData + rowB*nCols);
 }
 
 // validated
@@ -320,22 +525,13 @@ void Dense<T>::RowInterchange(unsigned int rowA, unsigned int rowB)
 template <class T>
 void Dense<T>::ColInterchange(unsigned int colA, unsigned int colB)
 {
-	T* tempBuffer = new T[nRows];
+	if (colA == colB)
+		return;
 
-	// copy first row to a buffer
-	for (unsigned int colElement(0); colElement < nCols; colElement++)
-	{
-		tempBuffer[colElement] = matrixData[colA + colElement * nCols];
-	}
-
-	// interchange the two rows using the buffer
-	for (unsigned int colElement(0); colElement < nRows; colElement++)
+	for (unsigned int row(0); row < nRows; row++)
 	{
-		matrixData[colA + colElement * nCols] = matrixData[colB + colElement * nCols];
-		matrixData[colB + colElement * nCols] = tempBuffer[colElement];
+		swap(matrixData[colA + row * nCols], matrixData[colB + row * nCols]);
 	}
-
-	delete[] tempBuffer;
 }
 
 // validated
@@ -355,43 +551,65 @@ void Dense<T>::MulRowByScalar(unsigned int row, T scalar)
 template <class T>
 Dense<T> Dense<T>::Minor(unsigned int excludedRowIndex, unsigned int excludedColIndex) const
 {
-	Dense<T> sub(nRows - 1, nCols - 1);
+	Dense<T> sub;
+	MinorInto(excludedRowIndex, excludedColIndex, sub);
+	return sub;
+}
+
+// every kept row is copied as the two contiguous runs around the excluded column
+template <class T>
+void Dense<T>::MinorInto(unsigned int excludedRowIndex, unsigned int excludedColIndex, Dense<T>& out) const
+{
+	assert((excludedRowIndex < nRows) && (excludedColIndex < nCols));
+	assert(&out != this);
+
+	out.Resize(nRows - 1, nCols - 1);
 
-	unsigned int subRowIndex, subColIndex;
-	for (unsigned int rowIndex(0), subRowIndex(0); rowIndex < nRows; rowIndex++)
+	T* subRow = out.matrixData;
+	for (unsigned int rowIndex(0); rowIndex < nRows; rowIndex++)
 	{
 		if (rowIndex == excludedRowIndex)
 			continue;
 
-		for (unsigned int colIndex(0), subColIndex(0); colIndex < nCols; colIndex++)
-		{
-			if (colIndex == excludedColIndex)
-				continue;
+		const T* row = matrixData + rowIndex*nCols;
+		subRow = copy(row, row + excludedColIndex, subRow);
+		subRow = copy(row + excludedColIndex + 1, row + nCols, subRow);
+	}
+}
 
-			sub.SetValue(subRowIndex,
-				subColIndex,
-				GetValue(rowIndex, colIndex));
+// validated for 3x3
+// floating point matrices above CofactorLimit are inverted through LU factorization
+// singular and rectangular matrices have PseudoInverse instead
+template <class T>
+Dense<T> Dense<T>::InverseByMinors() const
+{
+	assert(nRows == nCols);
 
-			subColIndex++;
+	if constexpr (is_floating_point<T>::value)
+	{
+		if (nRows > CofactorLimit)
+		{
+			LU<T> factorization(*this);
+			assert(!factorization.IsSingular());
+			return factorization.Inverse();
 		}
-
-		subRowIndex++;
 	}
-	return sub;
+
+	return InverseByCofactors();
 }
 
 // validated for 3x3
-// add in the future Moore-Penrose pseudoinverse algorithm
+// inverse as the transposed cofactor matrix divided by the determinant
 template <class T>
-Dense<T> Dense<T>::InverseByMinors() const
+Dense<T> Dense<T>::InverseByCofactors() const
 {
 	assert(nRows == nCols);
 	
-	T determinant = Determinant();
+	T determinant = DeterminantByCofactors();
 
 	assert(determinant != 0);		//TODO: remove assertion and return exception
 
-	Dense<T> inverse(nRows, nCols);
+	Dense<T> inverse(nRows, nCols, Uninitialized);
 	int sign = 1;
 
 	for (unsigned int i(0); i < nRows; i++)
@@ -411,7 +629,7 @@ Dense<T> Dense<T>::InverseByMinors() const
 			sign *= -1;
 
 			Dense<T> currentMinor = Minor(i, j);
-			inverse.SetValue(i, j, (1/determinant)*sign*currentMinor.Determinant());
+			inverse.SetValue(i, j, (1/determinant)*sign*currentMinor.DeterminantByCofactors());
 		}
 	}
 
@@ -432,32 +650,43 @@ void Dense<T>::MulColByScalar(unsigned int col, T scalar)
 // validated
 // element wise matrix to matrix multiplication
 template <class T>
-Dense<T> Dense<T>::MulElementwise(Dense<T>& other) const
+Dense<T> Dense<T>::MulElementwise(const Dense<T>& other) const
+{
+	Dense<T> multiplied;
+	MulElementwiseInto(other, multiplied);
+	return multiplied;
+}
+
+template <class T>
+void Dense<T>::MulElementwiseInto(const Dense<T>& other, Dense<T>& out) const
 {
 	assert((nRows == other.nRows) && (nCols == other.nCols));
-	unsigned int nElements = Numel();
-	Dense<T> multiplied(nRows, nCols);
 
-	for (unsigned int i(0); i < nElements; i++)
-	{
-		multiplied.matrixData[i] = matrixData[i] * other.matrixData[i];
-	}
-	
-	return multiplied;
+	out.Resize(nRows, nCols);
+	Simd::Mul(matrixData, other.matrixData, out.matrixData, Numel());
 }
 
 // validated
 // naive code for matrix multiplication. consider refactoring and optimizations
 // currently, all access to matrix data is done through GetValue and SetValue
 template <class T>
-Dense<T> Dense<T>::MulNaive(Dense<T>& other) const
+Dense<T> Dense<T>::MulNaive(const Dense<T>& other) const
+{
+	Dense<T> product;
+	MulNaiveInto(other, product);
+	return product;
+}
+
+template <class T>
+void Dense<T>::MulNaiveInto(const Dense<T>& other, Dense<T>& out) const
 {
 	assert(nCols == other.nRows);
+	assert((&out != this) && (&out != &other));
 
 	unsigned int productRows = nRows;
 	unsigned int productCols = other.nCols;
 
-	Dense<T> product(productRows, productCols);
+	out.Resize(productRows, productCols);
 
 	for (unsigned int i(0); i < productRows; i++)
 	{
@@ -470,25 +699,23 @@ Dense<T> Dense<T>::MulNaive(Dense<T>& other) const
 				element += GetValue(i, k) * other.GetValue(k, j);
 			}
 
-			product.SetValue(i, j, element);
+			out.SetValue(i, j, element);
 		}
 	}
-
-	return product;
 }
 
 // validated
 // code for multiplying two matrices with transposing the rhs matrix
 // causes optimization for large matrices.
 template <class T>
-Dense<T> Dense<T>::MulTransposed(Dense<T>& other) const
+Dense<T> Dense<T>::MulTransposed(const Dense<T>& other) const
 {
 	Dense<T> otherTransposed = other.Transpose();
 
 	unsigned int productRows = nRows;
 	unsigned int productCols = other.nCols;
 
-	Dense<T> product(productRows, productCols);
+	Dense<T> product(productRows, productCols, Uninitialized);
 
 	for (unsigned int i(0); i < productRows; i++)
 	{
@@ -508,39 +735,89 @@ Dense<T> Dense<T>::MulTransposed(Dense<T>& other) const
 	return product;
 }
 
+// validated
+// blocked multiplication through the Gemm engine
+// out is resized to [nRows, other.nCols] and must not alias either operand
+// nThreads limits the number of pool threads used, 0 uses the whole pool
 template <class T>
-void Dense<T>::AddScalar(T scalar)
+void Dense<T>::MulInto(const Dense<T>& other, Dense<T>& out, unsigned int nThreads) const
 {
-	int nElements = Numel();
+	assert(nCols == other.nRows);
+	assert((&out != this) && (&out != &other));
 
-	for (int i(0); i < nElements; i++)
-	{
-		matrixData[i] += scalar;
-	}
+	out.Resize(nRows, other.nCols);
+
+	Gemm<T>::Multiply(nRows, other.nCols, nCols,
+		static_cast<T>(1),
+		matrixData, nCols, 1,
+		other.matrixData, other.nCols, 1,
+		static_cast<T>(0),
+		out.matrixData, out.nCols, 1,
+		nThreads);
 }
 
+// rows are split between threads, every row is a dot product with four partial sums
+// y must not alias x or the matrix
 template <class T>
-Dense<T> Dense<T>::CopyAddScalar(T scalar) const
+void Dense<T>::MulVectorInto(const T* x, T* y, unsigned int nThreads) const
 {
-	Dense<T> sum(nRows, nCols);
-	int nElements = sum.Numel();
+	assert(x != y);
+
+	ThreadPool& pool = ThreadPool::Global();
+	unsigned int poolThreads = pool.ThreadCount();
+	unsigned int threads = (static_cast<unsigned long long>(nRows) * nCols < Gemm<T>::ParallelThreshold) ? 1
+		: ((nThreads == 0 || nThreads > poolThreads) ? poolThreads : nThreads);
+	unsigned int chunkSize = (nRows + threads - 1) / threads;
 
-	for (int i(0); i < nElements; i++)
+	pool.ParallelFor(threads, [&](unsigned int chunk)
 	{
-		sum.matrixData[i] = matrixData[i] + scalar;
-	}
+		unsigned int begin = (chunk * chunkSize < nRows) ? chunk * chunkSize : nRows;
+		unsigned int end = (begin + chunkSize < nRows) ? begin + chunkSize : nRows;
+
+		for (unsigned int row(begin); row < end; row++)
+		{
+			const T* a = matrixData + static_cast<size_t>(row) * nCols;
+			T s0 = static_cast<T>(0), s1 = s0, s2 = s0, s3 = s0;
+			unsigned int col(0);
+			for (; col + 4 <= nCols; col += 4)
+			{
+				s0 += a[col] * x[col];
+				s1 += a[col + 1] * x[col + 1];
+				s2 += a[col + 2] * x[col + 2];
+				s3 += a[col + 3] * x[col + 3];
+			}
+			for (; col < nCols; col++)
+				s0 += a[col] * x[col];
+			y[row] = (s0 + s1) + (s2 + s3);
+		}
+	}, threads);
+}
+
+template <class T>
+void Dense<T>::AddScalar(T scalar)
+{
+	Simd::AddScalar(matrixData, scalar, matrixData, Numel());
+}
+
+template <class T>
+Dense<T> Dense<T>::CopyAddScalar(T scalar) const
+{
+	Dense<T> sum;
+	CopyAddScalarInto(scalar, sum);
 	return sum;
 }
 
 template <class T>
-void Dense<T>::MulScalar(T scalar)
+void Dense<T>::CopyAddScalarInto(T scalar, Dense<T>& out) const
 {
-	int nElements = sum.Numel();
+	out.Resize(nRows, nCols);
+	Simd::AddScalar(matrixData, scalar, out.matrixData, Numel());
+}
 
-	for (int i(0); i < nElements; i++)
-	{
-		matrixData[i] *= scalar;
-	}
+template <class T>
+void Dense<T>::MulScalar(T scalar)
+{
+	Simd::MulScalar(matrixData, scalar, matrixData, Numel());
 }
 
 template <class T>
@@ -548,41 +825,39 @@ void Dense<T>::AddMatrix(const Dense<T>& other)
 {
 	assert((nCols == other.nCols) && (nRows == other.nRows));
 
-	int nElements = Numel();
-
-	for (int i(0); i < nElements; i++)
-	{
-		matrixData[i] += other.matrixData[i];
-	}
+	Simd::Add(matrixData, other.matrixData, matrixData, Numel());
 }
 
 template <class T>
 Dense<T> Dense<T>::CopyMulScalar(T scalar) const
 {
-	Dense<T> sum(nRows, nCols);
-	int nElements = sum.Numel();
+	Dense<T> product;
+	CopyMulScalarInto(scalar, product);
+	return product;
+}
 
-	for (int i(0); i < nElements; i++)
-	{
-		sum.matrixData[i] = matrixData[i] * scalar;
-	}
-	return sum;
+template <class T>
+void Dense<T>::CopyMulScalarInto(T scalar, Dense<T>& out) const
+{
+	out.Resize(nRows, nCols);
+	Simd::MulScalar(matrixData, scalar, out.matrixData, Numel());
 }
 
 template <class T>
 Dense<T> Dense<T>::CopyAddMatrix(const Dense<T>& other) const
 {
-	assert((nCols == other.nCols) && (nRows == other.nRows));
-
-	Dense<T> sum(nRows, nCols);
-	int nElements = Numel();
+	Dense<T> sum;
+	CopyAddMatrixInto(other, sum);
+	return sum;
+}
 
-	for (int i(0); i < nElements; i++)
-	{
-		sum.matrixData[i] = matrixData[i] + other.matrixData[i];
-	}
+template <class T>
+void Dense<T>::CopyAddMatrixInto(const Dense<T>& other, Dense<T>& out) const
+{
+	assert((nCols == other.nCols) && (nRows == other.nRows));
 
-	return sum;
+	out.Resize(nRows, nCols);
+	Simd::Add(matrixData, other.matrixData, out.matrixData, Numel());
 }
 #pragma endregion
 
@@ -594,6 +869,19 @@ unsigned int Dense<T>::Matrix2Index(unsigned int row, unsigned int col) const
 {
 	return col + row*(nCols);
 }
+
+// raw row-major storage
+template <class T>
+T* Dense<T>::Data()
+{
+	return matrixData;
+}
+
+template <class T>
+const T* Dense<T>::Data() const
+{
+	return matrixData;
+}
 #pragma endregion
 
 
@@ -602,26 +890,47 @@ unsigned int Dense<T>::Matrix2Index(unsigned int row, unsigned int col) const
 template <class T>
 string Dense<T>::ToString() const
 {
-	ostringstream ss;
+	string text;
+	char buffer[TextFormat::ChunkSize];
+	Format(buffer, sizeof(buffer), [&](const char* data, size_t length) { text.append(data, length); });
+	return text;
+}
 
-	ss << "[";
-	for (unsigned int row(0); row < nRows; row++)
-	{
-		for (unsigned int col(0); col < nCols; col++)
-		{
-			ss << GetValue(row, col);
+template <class T>
+template <class Sink>
+void Dense<T>::Format(char* buffer, size_t size, Sink&& sink) const
+{
+	const T* data = matrixData;
+	unsigned int cols = nCols;
+	TextFormat::FormatMatrix<T>(nRows, nCols, [data, cols](unsigned int row, unsigned int col) { return data[static_cast<size_t>(row) * cols + col]; },
+		buffer, size, sink);
+}
 
-			if (col != nCols - 1)
-				ss << ",";
+template <class T>
+void Dense<T>::Format(ostream& out) const
+{
+	char buffer[TextFormat::ChunkSize];
+	Format(buffer, sizeof(buffer), [&](const char* data, size_t length) { out.write(data, static_cast<streamsize>(length)); });
+}
 
-		}
+template <class T>
+bool Dense<T>::Parse(const char* text, size_t length, Dense<T>& matrix)
+{
+	vector<T> values;
+	unsigned int rows, cols;
+	if (!TextFormat::ParseMatrix(text, length, values, rows, cols))
+		return false;
 
-		if (row != nRows - 1)
-			ss << ";" << endl;
-		else
-			ss << "]" << endl;
-	}
+	matrix.Resize(rows, cols);
+	copy(values.begin(), values.end(), matrix.Data());
+	return true;
+}
 
-	return ss.str();
+template <class T>
+bool Dense<T>::Parse(const string& text, Dense<T>& matrix)
+{
+	return Parse(text.data(), text.size(), matrix);
 }
-#pragma endregion
\ No newline at end of file
+#pragma endregion
+
+#endif // !_DENSE_CPP_
@@ -3,6 +3,8 @@
 
 #include "../Numero.Definitions/DataTypeDefines.h"
 #include "Matrix.h"
+#include "DenseExpression.h"
+#include "DenseFixed.h"
 #include <sstream>
 
 namespace Numero
@@ -12,27 +14,63 @@ namespace Numero
 
 	namespace DataTypes
 	{
+		template <class T> class DenseView;
+		template <class T> class Sparse;
+
+		// construction tag for matrices whose every element is written before it is read -
+		// the storage is taken from the pool without the zero fill
+		struct UninitializedTag {};
+		const UninitializedTag Uninitialized = UninitializedTag();
+
 		// Dense class
-		// represents dense matrix
+		// represents dense matrix of runtime size - the Dense<T, Dynamic, Dynamic> specialization
 		// implements matrix base class
+		// element-wise arithmetic builds DenseExpression trees evaluated on assignment
 		template <class T>
-		class Dense : Matrix<T>
+		class Dense<T, Dynamic, Dynamic> : Matrix<T>, public DenseExpression<Dense<T> >
 		{
 		private:
 			T* matrixData;
+			unsigned int capacity;		// number of elements matrixData can hold
 		protected:
+			using Matrix<T>::nRows;
+			using Matrix<T>::nCols;
+
+			void AllocateStorage(unsigned int count);
 			void Allocate(unsigned int rows, unsigned int cols);
             void Allocate(unsigned int rows, unsigned int cols, const T* data);
 			void Deallocate();
 		public:
+			typedef T ValueType;
 
 			// --- constructors / destructor
-			Dense(unsigned int rows, unsigned int cols) : Matrix(rows, cols) { Allocate(rows, cols); };
-            Dense(Dense& other) : Matrix(other.nRows, other.nCols) { Allocate(nRows, nCols, other.matrixData); }
+			Dense() : Matrix<T>(0, 0), matrixData(nullptr), capacity(0) {};
+			Dense(unsigned int rows, unsigned int cols) : Matrix<T>(rows, cols) { Allocate(rows, cols); };
+			Dense(unsigned int rows, unsigned int cols, UninitializedTag) : Matrix<T>(rows, cols) { AllocateStorage(rows*cols); }
+            Dense(const Dense& other) : Matrix<T>(other.nRows, other.nCols) { Allocate(nRows, nCols, other.matrixData); }
+			Dense(Dense&& other) noexcept;
+			template <class E> Dense(const DenseExpression<E>& expression);
+			template <unsigned int R, unsigned int C> Dense(const Dense<T, R, C>& fixed);
 			~Dense() { Deallocate(); };
 
+			// --- assignment - copies reuse the existing buffer when it is large enough
+			Dense<T>& operator=(const Dense<T>& other);
+			Dense<T>& operator=(Dense<T>&& other) noexcept;
+
+			// --- expression evaluation - one fused pass writing every element once
+			template <class E> Dense<T>& operator=(const DenseExpression<E>& expression);
+			T At(unsigned int row, unsigned int col) const { return matrixData[row*nCols + col]; }
+			bool Aliases(const T*, const T*) const { return false; }
+
+			// changes the shape, reallocating only when the capacity is exceeded
+			// contents are unspecified afterwards - used by the *Into methods
+			void Resize(unsigned int rows, unsigned int cols);
+			unsigned int Capacity() const;
+
 			void ResetToConstant(T constantVal);
 			unsigned int Numel() const;
+			using Matrix<T>::Rows;
+			using Matrix<T>::Cols;
 
 			// --- base class implementations
 			virtual T GetValue(unsigned int row, unsigned int col) const;
@@ -41,16 +79,30 @@ namespace Numero
 			virtual void operator()(unsigned int row, unsigned int col, T value);
             virtual string ToString() const;
 
+			// --- text, see TextFormat.h - the ToString syntax with values that read back exactly
+			// formats through buffer, at least TextFormat::MaxValueChars long, handing each filled chunk to sink(data, length)
+			template <class Sink> void Format(char* buffer, size_t size, Sink&& sink) const;
+			void Format(ostream& out) const;
+			// false, leaving matrix unchanged, when text is not a matrix of rows of equal length
+			static bool Parse(const char* text, size_t length, Dense<T>& matrix);
+			static bool Parse(const string& text, Dense<T>& matrix);
+
 			// --- operator overloads
+			// element-wise +, - and scalar operators are the expression operators of DenseExpression.h
 			Dense<T> operator*(const Dense<T>& other) const;
-			Dense<T> operator+(const Dense<T>& other) const;
-			Dense<T> operator*(T scalar) const;
-			Dense<T> operator+(T scalar) const;
 
 			// --- concatenation methods
-			Dense<T> ConcatRows(const Dense<T>& _matrix_b);
-			Dense<T> ConcatCols(const Dense<T>& _matrix_b);
-			Dense<T> SubMatrix(unsigned int startRow, unsigned int endRow, unsigned int startCol, unsigned int endCol);
+			Dense<T> ConcatRows(const Dense<T>& _matrix_b) const;
+			Dense<T> ConcatCols(const Dense<T>& _matrix_b) const;
+			Dense<T> SubMatrix(unsigned int startRow, unsigned int endRow, unsigned int startCol, unsigned int endCol) const;
+
+			// --- zero-copy views - strided windows into this matrix, see DenseView.h
+			// minors and concatenations are not expressible as a single strided window
+			// and stay copies through MinorInto / ConcatRowsInto / ConcatColsInto
+			DenseView<T> View() const;
+			DenseView<T> SubMatrixView(unsigned int startRow, unsigned int endRow, unsigned int startCol, unsigned int endCol) const;
+			DenseView<T> TransposeView() const;
+			DenseView<T> DiagonalView() const;
 
 			// --- mathematical methods
 			T Trace() const;
@@ -59,6 +111,16 @@ namespace Numero
 			Dense<T> Diagonal() const;
 			Dense<T> Minor(unsigned int deletedRowIndex, unsigned int deletedColIndex) const;
 			Dense<T> InverseByMinors() const;
+			T DeterminantByCofactors() const;
+			Dense<T> InverseByCofactors() const;
+			// Moore-Penrose pseudoinverse through the SVD, over the singular values above tolerance times the largest -
+			// the default tolerance is max(rows, cols) * epsilon. floating point T only, defined in SVD.cpp
+			Dense<T> PseudoInverse(T tolerance = static_cast<T>(-1), unsigned int nThreads = 0) const;
+
+			// floating point matrices larger than this are routed through LU factorization, integral ones
+			// through Bareiss elimination in 64 bits, and modulo 2^bits when its minors overflow - both are
+			// exact while the determinant fits T
+			static const unsigned int CofactorLimit = 3;
 
 			// ------ linear actions on matrix
 			void RowInterchange(unsigned int rowA, unsigned int rowB);
@@ -67,9 +129,12 @@ namespace Numero
 			void MulColByScalar(unsigned int col, T scalar);
 
 			// ------ matrix multiplication methods
-			Dense<T> MulElementwise(Dense<T>& other) const;
-			Dense<T> MulNaive(Dense<T>& other) const;
-			Dense<T> MulTransposed(Dense<T>& other) const;
+			Dense<T> MulElementwise(const Dense<T>& other) const;
+			Dense<T> MulNaive(const Dense<T>& other) const;
+			Dense<T> MulTransposed(const Dense<T>& other) const;
+			void MulInto(const Dense<T>& other, Dense<T>& out, unsigned int nThreads = 0) const;
+			// y = A*x on raw vectors of Cols() and Rows() elements - the operator interface of the iterative solvers
+			void MulVectorInto(const T* x, T* y, unsigned int nThreads = 0) const;
 
 			// ------ matrix addition methods
 			void AddScalar(T scalar);
@@ -81,8 +146,32 @@ namespace Numero
 			Dense<T> CopyMulScalar(T scalar) const;
 			Dense<T> CopyAddMatrix(const Dense<T>& other) const;
 
+			// ------ producing methods writing into an existing matrix
+			// out is resized as needed and keeps its buffer, so a warmed up loop does not allocate
+			// out must not alias this matrix unless noted otherwise
+			void ConcatRowsInto(const Dense<T>& matrixB, Dense<T>& out) const;
+			void ConcatColsInto(const Dense<T>& matrixB, Dense<T>& out) const;
+			void SubMatrixInto(unsigned int startRow, unsigned int endRow, unsigned int startCol, unsigned int endCol, Dense<T>& out) const;
+			void TransposeInto(Dense<T>& out) const;
+			void DiagonalInto(Dense<T>& out) const;
+			void MinorInto(unsigned int deletedRowIndex, unsigned int deletedColIndex, Dense<T>& out) const;
+			void MulNaiveInto(const Dense<T>& other, Dense<T>& out) const;
+			// element-wise methods may write into this matrix or into other
+			void MulElementwiseInto(const Dense<T>& other, Dense<T>& out) const;
+			void CopyAddScalarInto(T scalar, Dense<T>& out) const;
+			void CopyMulScalarInto(T scalar, Dense<T>& out) const;
+			void CopyAddMatrixInto(const Dense<T>& other, Dense<T>& out) const;
+
 			// helper functions
 			unsigned int Matrix2Index(unsigned int row, unsigned int col) const;
+
+			// raw row-major storage for kernels working on contiguous data
+			T* Data();
+			const T* Data() const;
+
+			// --- conversion to CSR, keeping the elements whose magnitude exceeds threshold, which must not be negative
+			// rows are counted and written in parallel chunks straight from the storage. defined in Sparse.cpp
+			Sparse<T> ToSparse(T threshold = static_cast<T>(0), unsigned int nThreads = 0) const;
 		};
 	}
 }
@@ -0,0 +1,178 @@
+#ifndef _DENSE_EXPRESSION_H_
+#define _DENSE_EXPRESSION_H_
+
+#include "../Numero.Definitions/DataTypeDefines.h"
+#include <assert.h>
+
+namespace Numero
+{
+	using namespace std;
+	using namespace Definitions;
+
+	namespace DataTypes
+	{
+		// fixed-size matrices are Dense<T, R, C>, runtime sized ones Dense<T> - see Dense.h and DenseFixed.h
+		template <class T, unsigned int R = Dynamic, unsigned int C = Dynamic> class Dense;
+		template <class T> class DenseView;
+
+		// DenseExpression class
+		// CRTP base of lazily evaluated element-wise expressions over Dense matrices and views
+		// every expression exposes Rows(), Cols(), At(row, col) and Aliases(begin, end); assigning an
+		// expression to a Dense evaluates the whole tree in a single pass over the output
+		// expressions refer to their Dense operands and must be evaluated within the statement that built them
+		template <class E>
+		class DenseExpression
+		{
+		public:
+			const E& Self() const { return static_cast<const E&>(*this); }
+		};
+
+		// how an operand is held inside an expression node -
+		// Dense matrices by reference, intermediate nodes by value
+		template <class E>
+		struct ExpressionOperand
+		{
+			typedef E Type;
+		};
+
+		template <class T>
+		struct ExpressionOperand<Dense<T> >
+		{
+			typedef const Dense<T>& Type;
+		};
+
+		// --- element-wise operations
+		struct AddOperation
+		{
+			template <class T> static constexpr T Apply(T a, T b) { return a + b; }
+		};
+
+		struct SubOperation
+		{
+			template <class T> static constexpr T Apply(T a, T b) { return a - b; }
+		};
+
+		struct MulOperation
+		{
+			template <class T> static constexpr T Apply(T a, T b) { return a * b; }
+		};
+
+		// BinaryExpression class
+		// element-wise operation between two expressions of the same shape
+		template <class Operation, class L, class R>
+		class BinaryExpression : public DenseExpression<BinaryExpression<Operation, L, R> >
+		{
+		private:
+			typename ExpressionOperand<L>::Type lhs;
+			typename ExpressionOperand<R>::Type rhs;
+		public:
+			typedef typename L::ValueType ValueType;
+
+			BinaryExpression(const L& left, const R& right) : lhs(left), rhs(right)
+			{
+				assert((left.Rows() == right.Rows()) && (left.Cols() == right.Cols()));
+			}
+
+			unsigned int Rows() const { return lhs.Rows(); }
+			unsigned int Cols() const { return lhs.Cols(); }
+			ValueType At(unsigned int row, unsigned int col) const { return Operation::Apply(lhs.At(row, col), rhs.At(row, col)); }
+			bool Aliases(const ValueType* begin, const ValueType* end) const { return lhs.Aliases(begin, end) || rhs.Aliases(begin, end); }
+		};
+
+		// ScalarExpression class
+		// element-wise operation between an expression and a scalar
+		template <class Operation, class E>
+		class ScalarExpression : public DenseExpression<ScalarExpression<Operation, E> >
+		{
+		public:
+			typedef typename E::ValueType ValueType;
+		private:
+			typename ExpressionOperand<E>::Type expression;
+			ValueType scalar;
+		public:
+			ScalarExpression(const E& expr, ValueType value) : expression(expr), scalar(value) {}
+
+			unsigned int Rows() const { return expression.Rows(); }
+			unsigned int Cols() const { return expression.Cols(); }
+			ValueType At(unsigned int row, unsigned int col) const { return Operation::Apply(expression.At(row, col), scalar); }
+			bool Aliases(const ValueType* begin, const ValueType* end) const { return expression.Aliases(begin, end); }
+		};
+
+		// --- operator overloads building expressions
+		template <class L, class R>
+		BinaryExpression<AddOperation, L, R> operator+(const DenseExpression<L>& left, const DenseExpression<R>& right)
+		{
+			return BinaryExpression<AddOperation, L, R>(left.Self(), right.Self());
+		}
+
+		template <class L, class R>
+		BinaryExpression<SubOperation, L, R> operator-(const DenseExpression<L>& left, const DenseExpression<R>& right)
+		{
+			return BinaryExpression<SubOperation, L, R>(left.Self(), right.Self());
+		}
+
+		template <class E>
+		ScalarExpression<AddOperation, E> operator+(const DenseExpression<E>& expression, typename E::ValueType scalar)
+		{
+			return ScalarExpression<AddOperation, E>(expression.Self(), scalar);
+		}
+
+		template <class E>
+		ScalarExpression<AddOperation, E> operator+(typename E::ValueType scalar, const DenseExpression<E>& expression)
+		{
+			return ScalarExpression<AddOperation, E>(expression.Self(), scalar);
+		}
+
+		template <class E>
+		ScalarExpression<SubOperation, E> operator-(const DenseExpression<E>& expression, typename E::ValueType scalar)
+		{
+			return ScalarExpression<SubOperation, E>(expression.Self(), scalar);
+		}
+
+		template <class E>
+		ScalarExpression<MulOperation, E> operator*(const DenseExpression<E>& expression, typename E::ValueType scalar)
+		{
+			return ScalarExpression<MulOperation, E>(expression.Self(), scalar);
+		}
+
+		template <class E>
+		ScalarExpression<MulOperation, E> operator*(typename E::ValueType scalar, const DenseExpression<E>& expression)
+		{
+			return ScalarExpression<MulOperation, E>(expression.Self(), scalar);
+		}
+
+		// matrix products are not element-wise - operands that are not already backed by memory
+		// are materialized, then both sides are multiplied as strided views by the Gemm engine
+		template <class E>
+		struct ProductOperand
+		{
+			typedef const Dense<typename E::ValueType> Type;
+		};
+
+		template <class T>
+		struct ProductOperand<Dense<T> >
+		{
+			typedef const Dense<T>& Type;
+		};
+
+		template <class T>
+		struct ProductOperand<DenseView<T> >
+		{
+			typedef const DenseView<T>& Type;
+		};
+
+		template <class L, class R>
+		Dense<typename L::ValueType> operator*(const DenseExpression<L>& left, const DenseExpression<R>& right)
+		{
+			typedef typename L::ValueType T;
+			typename ProductOperand<L>::Type lhs = left.Self();
+			typename ProductOperand<R>::Type rhs = right.Self();
+
+			Dense<T> product;
+			DenseView<T>(lhs).MulInto(DenseView<T>(rhs), product);
+			return product;
+		}
+	}
+}
+
+#endif // !_DENSE_EXPRESSION_H_
@@ -0,0 +1,374 @@
+#ifndef _DENSE_FIXED_CPP_
+#define _DENSE_FIXED_CPP_
+
+#include <assert.h>
+#include <algorithm>
+#include <sstream>
+#include "Dense.h"
+#include "TextFormat.cpp"
+
+using namespace Numero;
+using namespace Numero::DataTypes;
+
+#pragma region SQUARE_CLOSED_FORMS
+namespace Numero
+{
+	namespace DataTypes
+	{
+		// determinant and inverse of an N x N row-major array
+		// the inverse is the adjugate divided element by element by the determinant
+		template <class T, unsigned int N>
+		struct FixedSquare;
+
+		template <class T>
+		struct FixedSquare<T, 1>
+		{
+			static constexpr T Determinant(const T* m) { return m[0]; }
+
+			static constexpr void Inverse(const T* m, T* out)
+			{
+				assert(m[0] != 0);
+				out[0] = static_cast<T>(1) / m[0];
+			}
+		};
+
+		template <class T>
+		struct FixedSquare<T, 2>
+		{
+			static constexpr T Determinant(const T* m) { return m[0] * m[3] - m[1] * m[2]; }
+
+			static constexpr void Inverse(const T* m, T* out)
+			{
+				T det = Determinant(m);
+				assert(det != 0);
+
+				out[0] = m[3] / det;
+				out[1] = -m[1] / det;
+				out[2] = -m[2] / det;
+				out[3] = m[0] / det;
+			}
+		};
+
+		// expansion along the first row
+		template <class T>
+		struct FixedSquare<T, 3>
+		{
+			static constexpr T Determinant(const T* m)
+			{
+				return m[0] * (m[4] * m[8] - m[5] * m[7])
+					- m[1] * (m[3] * m[8] - m[5] * m[6])
+					+ m[2] * (m[3] * m[7] - m[4] * m[6]);
+			}
+
+			static constexpr void Inverse(const T* m, T* out)
+			{
+				T det = Determinant(m);
+				assert(det != 0);
+
+				out[0] = (m[4] * m[8] - m[5] * m[7]) / det;
+				out[1] = (m[2] * m[7] - m[1] * m[8]) / det;
+				out[2] = (m[1] * m[5] - m[2] * m[4]) / det;
+				out[3] = (m[5] * m[6] - m[3] * m[8]) / det;
+				out[4] = (m[0] * m[8] - m[2] * m[6]) / det;
+				out[5] = (m[2] * m[3] - m[0] * m[5]) / det;
+				out[6] = (m[3] * m[7] - m[4] * m[6]) / det;
+				out[7] = (m[1] * m[6] - m[0] * m[7]) / det;
+				out[8] = (m[0] * m[4] - m[1] * m[3]) / det;
+			}
+		};
+
+		// Laplace expansion over the 2x2 sub-determinants of the top rows (s) and bottom rows (c),
+		// shared by the determinant and all sixteen cofactors
+		template <class T>
+		struct FixedSquare<T, 4>
+		{
+			static constexpr T Determinant(const T* m)
+			{
+				T s0 = m[0] * m[5] - m[4] * m[1];
+				T s1 = m[0] * m[6] - m[4] * m[2];
+				T s2 = m[0] * m[7] - m[4] * m[3];
+				T s3 = m[1] * m[6] - m[5] * m[2];
+				T s4 = m[1] * m[7] - m[5] * m[3];
+				T s5 = m[2] * m[7] - m[6] * m[3];
+
+				T c5 = m[10] * m[15] - m[14] * m[11];
+				T c4 = m[9] * m[15] - m[13] * m[11];
+				T c3 = m[9] * m[14] - m[13] * m[10];
+				T c2 = m[8] * m[15] - m[12] * m[11];
+				T c1 = m[8] * m[14] - m[12] * m[10];
+				T c0 = m[8] * m[13] - m[12] * m[9];
+
+				return s0 * c5 - s1 * c4 + s2 * c3 + s3 * c2 - s4 * c1 + s5 * c0;
+			}
+
+			static constexpr void Inverse(const T* m, T* out)
+			{
+				T s0 = m[0] * m[5] - m[4] * m[1];
+				T s1 = m[0] * m[6] - m[4] * m[2];
+				T s2 = m[0] * m[7] - m[4] * m[3];
+				T s3 = m[1] * m[6] - m[5] * m[2];
+				T s4 = m[1] * m[7] - m[5] * m[3];
+				T s5 = m[2] * m[7] - m[6] * m[3];
+
+				T c5 = m[10] * m[15] - m[14] * m[11];
+				T c4 = m[9] * m[15] - m[13] * m[11];
+				T c3 = m[9] * m[14] - m[13] * m[10];
+				T c2 = m[8] * m[15] - m[12] * m[11];
+				T c1 = m[8] * m[14] - m[12] * m[10];
+				T c0 = m[8] * m[13] - m[12] * m[9];
+
+				T det = s0 * c5 - s1 * c4 + s2 * c3 + s3 * c2 - s4 * c1 + s5 * c0;
+				assert(det != 0);
+
+				out[0] = (m[5] * c5 - m[6] * c4 + m[7] * c3) / det;
+				out[1] = (-m[1] * c5 + m[2] * c4 - m[3] * c3) / det;
+				out[2] = (m[13] * s5 - m[14] * s4 + m[15] * s3) / det;
+				out[3] = (-m[9] * s5 + m[10] * s4 - m[11] * s3) / det;
+
+				out[4] = (-m[4] * c5 + m[6] * c2 - m[7] * c1) / det;
+				out[5] = (m[0] * c5 - m[2] * c2 + m[3] * c1) / det;
+				out[6] = (-m[12] * s5 + m[14] * s2 - m[15] * s1) / det;
+				out[7] = (m[8] * s5 - m[10] * s2 + m[11] * s1) / det;
+
+				out[8] = (m[4] * c4 - m[5] * c2 + m[7] * c0) / det;
+				out[9] = (-m[0] * c4 + m[1] * c2 - m[3] * c0) / det;
+				out[10] = (m[12] * s4 - m[13] * s2 + m[15] * s0) / det;
+				out[11] = (-m[8] * s4 + m[9] * s2 - m[11] * s0) / det;
+
+				out[12] = (-m[4] * c3 + m[5] * c1 - m[6] * c0) / det;
+				out[13] = (m[0] * c3 - m[1] * c1 + m[2] * c0) / det;
+				out[14] = (-m[12] * s3 + m[13] * s1 - m[14] * s0) / det;
+				out[15] = (m[8] * s3 - m[9] * s1 + m[10] * s0) / det;
+			}
+		};
+	}
+}
+#pragma endregion
+
+
+#pragma region CONSTRUCTION
+template <class T, unsigned int R, unsigned int C>
+constexpr Dense<T, R, C>::Dense() : values()
+{
+}
+
+template <class T, unsigned int R, unsigned int C>
+template <class... Values>
+constexpr Dense<T, R, C>::Dense(T first, Values... rest) : values{ first, static_cast<T>(rest)... }
+{
+	static_assert(sizeof...(Values) + 1 == R*C, "a fixed-size matrix is initialized with exactly R*C values");
+}
+
+template <class T, unsigned int R, unsigned int C>
+Dense<T, R, C>::Dense(const Dense<T>& dynamic) : values()
+{
+	assert((dynamic.Rows() == R) && (dynamic.Cols() == C));
+	copy(dynamic.Data(), dynamic.Data() + R*C, values);
+}
+
+template <class T, unsigned int R, unsigned int C>
+template <class Operation, size_t... I>
+constexpr Dense<T, R, C>::Dense(const Dense& a, const Dense& b, Operation, index_sequence<I...>)
+	: values{ Operation::Apply(a.values[I], b.values[I])... }
+{
+}
+
+template <class T, unsigned int R, unsigned int C>
+template <class Operation, size_t... I>
+constexpr Dense<T, R, C>::Dense(const Dense& a, T scalar, Operation, index_sequence<I...>)
+	: values{ Operation::Apply(a.values[I], scalar)... }
+{
+}
+
+// element I of the transpose is element (I % C, I / C) of the source
+template <class T, unsigned int R, unsigned int C>
+template <size_t... I>
+constexpr Dense<T, R, C>::Dense(const Dense<T, C, R>& source, index_sequence<I...>)
+	: values{ source.values[(I % C)*R + I / C]... }
+{
+}
+
+// element I of the product is the dot product of row I / C and column I % C
+template <class T, unsigned int R, unsigned int C>
+template <unsigned int K, size_t... I>
+constexpr Dense<T, R, C>::Dense(const Dense<T, R, K>& a, const Dense<T, K, C>& b, index_sequence<I...>)
+	: values{ a.Dot(I / C, b, I % C)... }
+{
+}
+
+template <class T, unsigned int R, unsigned int C>
+constexpr Dense<T, R, C> Dense<T, R, C>::Identity()
+{
+	Dense identity;
+	for (unsigned int i(0); i < R && i < C; i++)
+	{
+		identity.values[i*C + i] = static_cast<T>(1);
+	}
+	return identity;
+}
+
+template <class T, unsigned int R, unsigned int C>
+constexpr Dense<T, R, C> Dense<T, R, C>::Constant(T value)
+{
+	Dense constant;
+	for (unsigned int i(0); i < R*C; i++)
+	{
+		constant.values[i] = value;
+	}
+	return constant;
+}
+#pragma endregion
+
+
+#pragma region ELEMENT_ACCESS
+template <class T, unsigned int R, unsigned int C>
+constexpr T Dense<T, R, C>::GetValue(unsigned int row, unsigned int col) const
+{
+	assert((row < R) && (col < C));
+	return values[row*C + col];
+}
+
+template <class T, unsigned int R, unsigned int C>
+constexpr void Dense<T, R, C>::SetValue(unsigned int row, unsigned int col, T value)
+{
+	assert((row < R) && (col < C));
+	values[row*C + col] = value;
+}
+
+template <class T, unsigned int R, unsigned int C>
+constexpr T Dense<T, R, C>::operator()(unsigned int row, unsigned int col) const
+{
+	return GetValue(row, col);
+}
+
+template <class T, unsigned int R, unsigned int C>
+constexpr void Dense<T, R, C>::operator()(unsigned int row, unsigned int col, T value)
+{
+	SetValue(row, col, value);
+}
+#pragma endregion
+
+
+#pragma region OPERATOR_OVERLOADS
+template <class T, unsigned int R, unsigned int C>
+constexpr Dense<T, R, C> Dense<T, R, C>::operator+(const Dense& other) const
+{
+	return Dense(*this, other, AddOperation(), make_index_sequence<R*C>());
+}
+
+template <class T, unsigned int R, unsigned int C>
+constexpr Dense<T, R, C> Dense<T, R, C>::operator-(const Dense& other) const
+{
+	return Dense(*this, other, SubOperation(), make_index_sequence<R*C>());
+}
+
+template <class T, unsigned int R, unsigned int C>
+constexpr Dense<T, R, C> Dense<T, R, C>::operator+(T scalar) const
+{
+	return Dense(*this, scalar, AddOperation(), make_index_sequence<R*C>());
+}
+
+template <class T, unsigned int R, unsigned int C>
+constexpr Dense<T, R, C> Dense<T, R, C>::operator*(T scalar) const
+{
+	return Dense(*this, scalar, MulOperation(), make_index_sequence<R*C>());
+}
+
+template <class T, unsigned int R, unsigned int C>
+constexpr Dense<T, R, C> Dense<T, R, C>::MulElementwise(const Dense& other) const
+{
+	return Dense(*this, other, MulOperation(), make_index_sequence<R*C>());
+}
+
+// accumulates in the same order as Dense<T>::MulNaive
+template <class T, unsigned int R, unsigned int C>
+template <unsigned int K>
+constexpr T Dense<T, R, C>::Dot(unsigned int row, const Dense<T, C, K>& other, unsigned int col) const
+{
+	T element = static_cast<T>(0);
+	for (unsigned int k(0); k < C; k++)
+	{
+		element += values[row*C + k] * other.values[k*K + col];
+	}
+	return element;
+}
+
+template <class T, unsigned int R, unsigned int C>
+template <unsigned int K>
+constexpr Dense<T, R, K> Dense<T, R, C>::operator*(const Dense<T, C, K>& other) const
+{
+	return Dense<T, R, K>(*this, other, make_index_sequence<R*K>());
+}
+#pragma endregion
+
+
+#pragma region MATHEMATICAL_FUNCTIONS
+template <class T, unsigned int R, unsigned int C>
+constexpr Dense<T, C, R> Dense<T, R, C>::Transpose() const
+{
+	return Dense<T, C, R>(*this, make_index_sequence<R*C>());
+}
+
+template <class T, unsigned int R, unsigned int C>
+constexpr T Dense<T, R, C>::Trace() const
+{
+	T trace = static_cast<T>(0);
+	for (unsigned int i(0); i < R && i < C; i++)
+	{
+		trace += values[i*C + i];
+	}
+	return trace;
+}
+
+template <class T, unsigned int R, unsigned int C>
+constexpr T Dense<T, R, C>::Determinant() const
+{
+	static_assert(R == C, "determinant of a non-square matrix");
+	static_assert(R <= 4, "fixed-size determinants are provided up to 4x4, use Dense<T> for larger matrices");
+
+	return FixedSquare<T, R>::Determinant(values);
+}
+
+template <class T, unsigned int R, unsigned int C>
+constexpr Dense<T, R, C> Dense<T, R, C>::Inverse() const
+{
+	static_assert(R == C, "inverse of a non-square matrix");
+	static_assert(R <= 4, "fixed-size inverses are provided up to 4x4, use Dense<T> for larger matrices");
+
+	Dense inverse;
+	FixedSquare<T, R>::Inverse(values, inverse.values);
+	return inverse;
+}
+#pragma endregion
+
+
+#pragma region INTEROP
+template <class T, unsigned int R, unsigned int C>
+Dense<T> Dense<T, R, C>::ToDynamic() const
+{
+	return Dense<T>(*this);
+}
+
+template <class T>
+template <unsigned int R, unsigned int C>
+Dense<T>::Dense(const Dense<T, R, C>& fixed) : Matrix<T>(R, C)
+{
+	Allocate(R, C, fixed.Data());
+}
+#pragma endregion
+
+
+#pragma region IO
+// matlab style string outputter
+template <class T, unsigned int R, unsigned int C>
+string Dense<T, R, C>::ToString() const
+{
+	string text;
+	char buffer[TextFormat::MaxValueChars * (R * C < 64 ? R * C + 1 : 64)];
+	TextFormat::FormatMatrix<T>(R, C, [this](unsigned int row, unsigned int col) { return values[row*C + col]; },
+		buffer, sizeof(buffer), [&](const char* data, size_t length) { text.append(data, length); });
+	return text;
+}
+#pragma endregion
+
+#endif // !_DENSE_FIXED_CPP_
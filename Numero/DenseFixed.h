@@ -0,0 +1,98 @@
+#ifndef _DENSE_FIXED_H_
+#define _DENSE_FIXED_H_
+
+#include "../Numero.Definitions/DataTypeDefines.h"
+#include "DenseExpression.h"
+#include <string>
+#include <utility>
+
+namespace Numero
+{
+	using namespace std;
+	using namespace Definitions;
+
+	namespace DataTypes
+	{
+		// Dense class - fixed size
+		// R x C matrix with dimensions known at compile time, stored by value in row-major order
+		// no heap allocation and no virtual calls - meant for the large numbers of 2x2 / 3x3 / 4x4
+		// transforms where Dense<T> spends its time in allocation and dispatch
+		// element-wise operations and products are expanded over index packs, so every element
+		// is a straight-line expression, and everything is usable in constant expressions
+		template <class T, unsigned int R, unsigned int C>
+		class Dense
+		{
+			static_assert(R != Dynamic && C != Dynamic, "fixed-size matrices need non-zero dimensions");
+
+			template <class U, unsigned int R2, unsigned int C2> friend class Dense;
+
+		private:
+			T values[R*C];
+
+			// element-wise construction over an index pack
+			template <class Operation, size_t... I>
+			constexpr Dense(const Dense& a, const Dense& b, Operation, index_sequence<I...>);
+			template <class Operation, size_t... I>
+			constexpr Dense(const Dense& a, T scalar, Operation, index_sequence<I...>);
+			template <size_t... I>
+			constexpr Dense(const Dense<T, C, R>& source, index_sequence<I...>);
+			template <unsigned int K, size_t... I>
+			constexpr Dense(const Dense<T, R, K>& a, const Dense<T, K, C>& b, index_sequence<I...>);
+
+			template <unsigned int K>
+			constexpr T Dot(unsigned int row, const Dense<T, C, K>& other, unsigned int col) const;
+
+		public:
+			typedef T ValueType;
+
+			// --- constructors
+			// zero matrix
+			constexpr Dense();
+			// all R*C elements in row-major order
+			template <class... Values>
+			constexpr Dense(T first, Values... rest);
+			// copy of a dynamic matrix of the same shape
+			explicit Dense(const Dense<T>& dynamic);
+
+			static constexpr Dense Identity();
+			static constexpr Dense Constant(T value);
+
+			// --- size
+			static constexpr unsigned int Rows() { return R; }
+			static constexpr unsigned int Cols() { return C; }
+			static constexpr unsigned int Numel() { return R*C; }
+
+			// --- element access
+			constexpr T At(unsigned int row, unsigned int col) const { return values[row*C + col]; }
+			constexpr T GetValue(unsigned int row, unsigned int col) const;
+			constexpr void SetValue(unsigned int row, unsigned int col, T value);
+			constexpr T operator()(unsigned int row, unsigned int col) const;
+			constexpr void operator()(unsigned int row, unsigned int col, T value);
+			constexpr T* Data() { return values; }
+			constexpr const T* Data() const { return values; }
+
+			// --- operator overloads
+			constexpr Dense operator+(const Dense& other) const;
+			constexpr Dense operator-(const Dense& other) const;
+			constexpr Dense operator+(T scalar) const;
+			constexpr Dense operator*(T scalar) const;
+			template <unsigned int K>
+			constexpr Dense<T, R, K> operator*(const Dense<T, C, K>& other) const;
+			constexpr Dense MulElementwise(const Dense& other) const;
+
+			// --- mathematical methods
+			constexpr Dense<T, C, R> Transpose() const;
+			constexpr T Trace() const;
+			// square matrices up to 4x4 - closed forms over the 2x2 sub-determinants
+			constexpr T Determinant() const;
+			constexpr Dense Inverse() const;
+
+			// --- interop with runtime sized matrices
+			Dense<T> ToDynamic() const;
+
+			string ToString() const;
+		};
+	}
+}
+
+#endif // !_DENSE_FIXED_H_
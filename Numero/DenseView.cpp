@@ -0,0 +1,203 @@
+#ifndef _DENSE_VIEW_CPP_
+#define _DENSE_VIEW_CPP_
+
+#include <assert.h>
+#include <algorithm>
+#include "DenseView.h"
+#include "Dense.cpp"
+#include "TextFormat.cpp"
+#include "Gemm.cpp"
+
+using namespace Numero;
+using namespace Numero::DataTypes;
+
+#pragma region CONSTRUCTION
+template <class T>
+DenseView<T>::DenseView(const T* data, unsigned int rows, unsigned int cols, ptrdiff_t rowStride, ptrdiff_t colStride)
+	: viewData(data), nRows(rows), nCols(cols), rowStride(rowStride), colStride(colStride)
+{
+}
+
+// view of a whole matrix
+template <class T>
+DenseView<T>::DenseView(const Dense<T>& matrix)
+	: viewData(matrix.Data()), nRows(matrix.Rows()), nCols(matrix.Cols()), rowStride(matrix.Cols()), colStride(1)
+{
+}
+
+template <class T>
+bool DenseView<T>::IsContiguous() const
+{
+	return (colStride == 1) && (rowStride == static_cast<ptrdiff_t>(nCols) || nRows <= 1);
+}
+#pragma endregion
+
+
+#pragma region ELEMENT_ACCESS
+template <class T>
+T DenseView<T>::GetValue(unsigned int row, unsigned int col) const
+{
+	assert((row < nRows) && (col < nCols));
+	return At(row, col);
+}
+
+template <class T>
+T DenseView<T>::operator()(unsigned int row, unsigned int col) const
+{
+	return GetValue(row, col);
+}
+#pragma endregion
+
+
+#pragma region VIEWS
+// view of the inclusive row and column ranges, same convention as Dense::SubMatrix
+template <class T>
+DenseView<T> DenseView<T>::SubMatrix(unsigned int startRow, unsigned int endRow, unsigned int startCol, unsigned int endCol) const
+{
+	assert((startRow <= endRow) && (endRow < nRows));
+	assert((startCol <= endCol) && (endCol < nCols));
+
+	return DenseView<T>(viewData + startRow*rowStride + startCol*colStride,
+		endRow - startRow + 1, endCol - startCol + 1,
+		rowStride, colStride);
+}
+
+// transposing a view only swaps its shape and strides
+template <class T>
+DenseView<T> DenseView<T>::Transpose() const
+{
+	return DenseView<T>(viewData, nCols, nRows, colStride, rowStride);
+}
+
+// row vector of the diagonal elements - each step moves one row and one column
+template <class T>
+DenseView<T> DenseView<T>::Diagonal() const
+{
+	unsigned int diagLength = (nRows < nCols) ? nRows : nCols;
+	return DenseView<T>(viewData, 1, diagLength, rowStride + colStride, rowStride + colStride);
+}
+#pragma endregion
+
+
+#pragma region MATERIALIZATION
+template <class T>
+Dense<T> DenseView<T>::Materialize() const
+{
+	Dense<T> materialized;
+	MaterializeInto(materialized);
+	return materialized;
+}
+
+// contiguous copy - row runs when the columns are unit strided,
+// otherwise square tiles so that transposed views are gathered cache friendly
+template <class T>
+void DenseView<T>::MaterializeInto(Dense<T>& out) const
+{
+	assert(!Overlaps(out.Data(), out.Data() + out.Capacity()));
+
+	out.Resize(nRows, nCols);
+	T* outData = out.Data();
+
+	if (colStride == 1)
+	{
+		for (unsigned int row(0); row < nRows; row++)
+		{
+			const T* sourceRow = viewData + row*rowStride;
+			copy(sourceRow, sourceRow + nCols, outData + row*nCols);
+		}
+		return;
+	}
+
+	const unsigned int tileSize = 32;
+	for (unsigned int rowTile(0); rowTile < nRows; rowTile += tileSize)
+	{
+		unsigned int rowEnd = (nRows - rowTile < tileSize) ? nRows : rowTile + tileSize;
+
+		for (unsigned int colTile(0); colTile < nCols; colTile += tileSize)
+		{
+			unsigned int colEnd = (nCols - colTile < tileSize) ? nCols : colTile + tileSize;
+
+			for (unsigned int row(rowTile); row < rowEnd; row++)
+			{
+				for (unsigned int col(colTile); col < colEnd; col++)
+				{
+					outData[row*nCols + col] = At(row, col);
+				}
+			}
+		}
+	}
+}
+#pragma endregion
+
+
+#pragma region MATHEMATICAL_FUNCTIONS
+template <class T>
+T DenseView<T>::Trace() const
+{
+	T trace = static_cast<T>(0);
+	unsigned int diagLength = (nRows < nCols) ? nRows : nCols;
+
+	for (unsigned int i(0); i < diagLength; i++)
+	{
+		trace += At(i, i);
+	}
+
+	return trace;
+}
+
+// strided operands are handed to the Gemm engine as they are - packing absorbs the strides
+template <class T>
+void DenseView<T>::MulInto(const DenseView<T>& other, Dense<T>& out, unsigned int nThreads) const
+{
+	assert(nCols == other.nRows);
+	assert(!Overlaps(out.Data(), out.Data() + out.Capacity()) && !other.Overlaps(out.Data(), out.Data() + out.Capacity()));
+
+	out.Resize(nRows, other.nCols);
+
+	Gemm<T>::Multiply(nRows, other.nCols, nCols,
+		static_cast<T>(1),
+		viewData, rowStride, colStride,
+		other.viewData, other.rowStride, other.colStride,
+		static_cast<T>(0),
+		out.Data(), out.Cols(), 1,
+		nThreads);
+}
+
+template <class T>
+bool DenseView<T>::Overlaps(const T* begin, const T* end) const
+{
+	if (nRows == 0 || nCols == 0 || begin == end)
+		return false;
+
+	const T* first = viewData;
+	const T* last = viewData + (nRows - 1)*rowStride + (nCols - 1)*colStride;
+
+	return (first < end) && (last >= begin);
+}
+
+template <class T>
+bool DenseView<T>::Aliases(const T* begin, const T* end) const
+{
+	// reading a matrix through a view of itself with its own layout is position preserving
+	if (viewData == begin && IsContiguous())
+		return false;
+
+	return Overlaps(begin, end);
+}
+#pragma endregion
+
+
+#pragma region IO
+// matlab style string outputter
+template <class T>
+string DenseView<T>::ToString() const
+{
+	string text;
+	char buffer[TextFormat::ChunkSize];
+	TextFormat::FormatMatrix<T>(nRows, nCols, [this](unsigned int row, unsigned int col) { return At(row, col); },
+		buffer, sizeof(buffer), [&](const char* data, size_t length) { text.append(data, length); });
+	return text;
+}
+#pragma endregion
+
+#endif // !_DENSE_VIEW_CPP_
@@ -0,0 +1,77 @@
+#ifndef _DENSE_VIEW_H_
+#define _DENSE_VIEW_H_
+
+#include "../Numero.Definitions/DataTypeDefines.h"
+#include "DenseExpression.h"
+#include "Dense.h"
+#include <cstddef>
+#include <string>
+
+namespace Numero
+{
+	using namespace std;
+	using namespace Definitions;
+
+	namespace DataTypes
+	{
+		// DenseView class
+		// non-owning, read-only window into dense storage
+		// described by the address of element (0,0), a shape and row/column strides,
+		// so sub-matrices, transposes and diagonals are O(1) re-interpretations of the same memory
+		// a view does not keep its matrix alive and is invalidated when the matrix is resized or destroyed
+		template <class T>
+		class DenseView : public DenseExpression<DenseView<T> >
+		{
+		private:
+			const T* viewData;
+			unsigned int nRows;
+			unsigned int nCols;
+			ptrdiff_t rowStride;
+			ptrdiff_t colStride;
+		public:
+			typedef T ValueType;
+
+			// --- constructors
+			DenseView(const T* data, unsigned int rows, unsigned int cols, ptrdiff_t rowStride, ptrdiff_t colStride);
+			DenseView(const Dense<T>& matrix);
+
+			unsigned int Rows() const { return nRows; }
+			unsigned int Cols() const { return nCols; }
+			ptrdiff_t RowStride() const { return rowStride; }
+			ptrdiff_t ColStride() const { return colStride; }
+			const T* Data() const { return viewData; }
+			unsigned int Numel() const { return nRows*nCols; }
+
+			// true when the view has the layout of a standalone row-major matrix
+			bool IsContiguous() const;
+
+			// --- element access
+			T At(unsigned int row, unsigned int col) const { return viewData[row*rowStride + col*colStride]; }
+			T GetValue(unsigned int row, unsigned int col) const;
+			T operator()(unsigned int row, unsigned int col) const;
+
+			// --- O(1) views of the view
+			DenseView<T> SubMatrix(unsigned int startRow, unsigned int endRow, unsigned int startCol, unsigned int endCol) const;
+			DenseView<T> Transpose() const;
+			DenseView<T> Diagonal() const;
+
+			// --- contiguous copies
+			Dense<T> Materialize() const;
+			void MaterializeInto(Dense<T>& out) const;
+
+			// --- read-only mathematical methods
+			T Trace() const;
+			void MulInto(const DenseView<T>& other, Dense<T>& out, unsigned int nThreads = 0) const;
+
+			// true when any element of the view lies in [begin, end)
+			bool Overlaps(const T* begin, const T* end) const;
+			// expression aliasing check - like Overlaps, except that a view with the row-major
+			// layout of the destination itself is safe, since every element is read where it is written
+			bool Aliases(const T* begin, const T* end) const;
+
+			string ToString() const;
+		};
+	}
+}
+
+#endif // !_DENSE_VIEW_H_
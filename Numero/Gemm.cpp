@@ -0,0 +1,279 @@
+#ifndef _GEMM_CPP_
+#define _GEMM_CPP_
+
+#include <vector>
+#include "Gemm.h"
+
+using namespace Numero;
+using namespace Numero::DataTypes;
+
+#pragma region DRIVER
+// parallel driver - splits C into independent output tiles, each computed by the serial driver
+// row tiles are MC blocks, made thinner and split by columns only when there are too few of them
+template <class T>
+void Gemm<T>::Multiply(unsigned int m, unsigned int n, unsigned int k,
+	T alpha,
+	const T* a, ptrdiff_t aRowStride, ptrdiff_t aColStride,
+	const T* b, ptrdiff_t bRowStride, ptrdiff_t bColStride,
+	T beta,
+	T* c, ptrdiff_t cRowStride, ptrdiff_t cColStride,
+	unsigned int nThreads)
+{
+	ThreadPool& pool = ThreadPool::Global();
+	unsigned int threads = (nThreads == 0 || nThreads > pool.ThreadCount()) ? pool.ThreadCount() : nThreads;
+	unsigned long long work = static_cast<unsigned long long>(m) * n * k;
+
+	if (threads <= 1 || work < ParallelThreshold)
+	{
+		MultiplySerial(m, n, k, alpha, a, aRowStride, aColStride, b, bRowStride, bColStride, beta, c, cRowStride, cColStride);
+		return;
+	}
+
+	// aim for a few tiles per thread so the dynamic schedule can balance ragged edges
+	unsigned int targetTiles = 4 * threads;
+	unsigned int tileRows = MC;
+	unsigned int rowTiles = (m + tileRows - 1) / tileRows;
+	if (rowTiles < targetTiles && m > MR)
+	{
+		tileRows = ((m + targetTiles - 1) / targetTiles + MR - 1) / MR * MR;
+		rowTiles = (m + tileRows - 1) / tileRows;
+	}
+
+	unsigned int colTiles = (rowTiles >= targetTiles) ? 1 : (targetTiles + rowTiles - 1) / rowTiles;
+	unsigned int tileCols = ((n + colTiles - 1) / colTiles + NR - 1) / NR * NR;
+	colTiles = (n + tileCols - 1) / tileCols;
+
+	pool.ParallelFor(rowTiles * colTiles, [&](unsigned int tile)
+	{
+		unsigned int row = (tile / colTiles) * tileRows;
+		unsigned int col = (tile % colTiles) * tileCols;
+		unsigned int rows = (m - row < tileRows) ? m - row : tileRows;
+		unsigned int cols = (n - col < tileCols) ? n - col : tileCols;
+
+		MultiplySerial(rows, cols, k, alpha,
+			a + row*aRowStride, aRowStride, aColStride,
+			b + col*bColStride, bRowStride, bColStride,
+			beta,
+			c + row*cRowStride + col*cColStride, cRowStride, cColStride);
+	}, threads);
+}
+
+// blocked product driver - loop order follows the BLIS/Goto scheme:
+// NC columns of B -> KC depth -> pack B -> MC rows of A -> pack A -> MRxNR register tiles
+template <class T>
+void Gemm<T>::MultiplySerial(unsigned int m, unsigned int n, unsigned int k,
+	T alpha,
+	const T* a, ptrdiff_t aRowStride, ptrdiff_t aColStride,
+	const T* b, ptrdiff_t bRowStride, ptrdiff_t bColStride,
+	T beta,
+	T* c, ptrdiff_t cRowStride, ptrdiff_t cColStride)
+{
+	if (m == 0 || n == 0)
+		return;
+
+	ScaleC(m, n, beta, c, cRowStride, cColStride);
+
+	if (k == 0 || alpha == static_cast<T>(0))
+		return;
+
+	for (unsigned int jc(0); jc < n; jc += NC)
+	{
+		unsigned int nc = (n - jc < NC) ? n - jc : NC;
+		unsigned int ncPadded = ((nc + NR - 1) / NR) * NR;
+
+		for (unsigned int pc(0); pc < k; pc += KC)
+		{
+			unsigned int kc = (k - pc < KC) ? k - pc : KC;
+
+			T* packedB = PackBufferB(static_cast<size_t>(kc) * ncPadded);
+			PackB(kc, nc, b + pc*bRowStride + jc*bColStride, bRowStride, bColStride, packedB);
+
+			for (unsigned int ic(0); ic < m; ic += MC)
+			{
+				unsigned int mc = (m - ic < MC) ? m - ic : MC;
+				unsigned int mcPadded = ((mc + MR - 1) / MR) * MR;
+
+				T* packedA = PackBufferA(static_cast<size_t>(kc) * mcPadded);
+				PackA(mc, kc, a + ic*aRowStride + pc*aColStride, aRowStride, aColStride, packedA);
+
+				for (unsigned int jr(0); jr < nc; jr += NR)
+				{
+					unsigned int nr = (nc - jr < NR) ? nc - jr : NR;
+
+					for (unsigned int ir(0); ir < mc; ir += MR)
+					{
+						unsigned int mr = (mc - ir < MR) ? mc - ir : MR;
+
+						MicroKernel(kc, alpha,
+							packedA + static_cast<size_t>(ir) * kc,
+							packedB + static_cast<size_t>(jr) * kc,
+							c + (ic + ir)*cRowStride + (jc + jr)*cColStride,
+							cRowStride, cColStride, mr, nr);
+					}
+				}
+			}
+		}
+	}
+}
+
+// C = beta*C, with beta == 0 overwriting so that uninitialized output is allowed
+template <class T>
+void Gemm<T>::ScaleC(unsigned int m, unsigned int n, T beta, T* c, ptrdiff_t cRowStride, ptrdiff_t cColStride)
+{
+	if (beta == static_cast<T>(1))
+		return;
+
+	for (unsigned int i(0); i < m; i++)
+	{
+		T* cRow = c + i*cRowStride;
+		for (unsigned int j(0); j < n; j++)
+		{
+			if (beta == static_cast<T>(0))
+				cRow[j*cColStride] = static_cast<T>(0);
+			else
+				cRow[j*cColStride] *= beta;
+		}
+	}
+}
+#pragma endregion
+
+
+#pragma region PACKING
+// packs an mc x kc block of A into MR-row slivers, each stored column by column
+// rows beyond mc are zero padded so the micro-kernel never branches on edges
+template <class T>
+void Gemm<T>::PackA(unsigned int mc, unsigned int kc,
+	const T* a, ptrdiff_t aRowStride, ptrdiff_t aColStride, T* packed)
+{
+	for (unsigned int ir(0); ir < mc; ir += MR)
+	{
+		unsigned int mr = (mc - ir < MR) ? mc - ir : MR;
+		const T* sliver = a + ir*aRowStride;
+
+		for (unsigned int p(0); p < kc; p++)
+		{
+			for (unsigned int i(0); i < mr; i++)
+			{
+				packed[i] = sliver[i*aRowStride + p*aColStride];
+			}
+			for (unsigned int i(mr); i < MR; i++)
+			{
+				packed[i] = static_cast<T>(0);
+			}
+			packed += MR;
+		}
+	}
+}
+
+// packs a kc x nc panel of B into NR-column slivers, each stored row by row
+template <class T>
+void Gemm<T>::PackB(unsigned int kc, unsigned int nc,
+	const T* b, ptrdiff_t bRowStride, ptrdiff_t bColStride, T* packed)
+{
+	for (unsigned int jr(0); jr < nc; jr += NR)
+	{
+		unsigned int nr = (nc - jr < NR) ? nc - jr : NR;
+		const T* sliver = b + jr*bColStride;
+
+		for (unsigned int p(0); p < kc; p++)
+		{
+			const T* bRow = sliver + p*bRowStride;
+
+			if (nr == NR && bColStride == 1)
+			{
+				for (unsigned int j(0); j < NR; j++)
+				{
+					packed[j] = bRow[j];
+				}
+			}
+			else
+			{
+				for (unsigned int j(0); j < nr; j++)
+				{
+					packed[j] = bRow[j*bColStride];
+				}
+				for (unsigned int j(nr); j < NR; j++)
+				{
+					packed[j] = static_cast<T>(0);
+				}
+			}
+			packed += NR;
+		}
+	}
+}
+
+// packing buffers are kept per thread and only ever grow,
+// so steady state products do not touch the heap
+template <class T>
+T* Gemm<T>::PackBufferA(size_t size)
+{
+	static thread_local vector<T> buffer;
+	if (buffer.size() < size)
+		buffer.resize(size);
+	return buffer.data();
+}
+
+template <class T>
+T* Gemm<T>::PackBufferB(size_t size)
+{
+	static thread_local vector<T> buffer;
+	if (buffer.size() < size)
+		buffer.resize(size);
+	return buffer.data();
+}
+#pragma endregion
+
+
+#pragma region MICRO_KERNEL
+// MRxNR register tile - accumulates a rank-kc update in a local block
+// the fixed trip counts let the compiler keep the tile in vector registers
+template <class T>
+void Gemm<T>::MicroKernel(unsigned int kc, T alpha, const T* packedA, const T* packedB,
+	T* c, ptrdiff_t cRowStride, ptrdiff_t cColStride, unsigned int mr, unsigned int nr)
+{
+	T ab[MR * NR];
+	for (unsigned int i(0); i < MR * NR; i++)
+	{
+		ab[i] = static_cast<T>(0);
+	}
+
+	for (unsigned int p(0); p < kc; p++)
+	{
+		for (unsigned int i(0); i < MR; i++)
+		{
+			T aValue = packedA[i];
+			for (unsigned int j(0); j < NR; j++)
+			{
+				ab[i*NR + j] += aValue * packedB[j];
+			}
+		}
+		packedA += MR;
+		packedB += NR;
+	}
+
+	if (mr == MR && nr == NR && cColStride == 1)
+	{
+		for (unsigned int i(0); i < MR; i++)
+		{
+			T* cRow = c + i*cRowStride;
+			for (unsigned int j(0); j < NR; j++)
+			{
+				cRow[j] += alpha * ab[i*NR + j];
+			}
+		}
+	}
+	else
+	{
+		for (unsigned int i(0); i < mr; i++)
+		{
+			T* cRow = c + i*cRowStride;
+			for (unsigned int j(0); j < nr; j++)
+			{
+				cRow[j*cColStride] += alpha * ab[i*NR + j];
+			}
+		}
+	}
+}
+#pragma endregion
+
+#endif // !_GEMM_CPP_
@@ -0,0 +1,70 @@
+#ifndef _GEMM_H_
+#define _GEMM_H_
+
+#include "../Numero.Definitions/DataTypeDefines.h"
+#include "ThreadPool.h"
+#include <cstddef>
+
+namespace Numero
+{
+	using namespace std;
+	using namespace Definitions;
+
+	namespace DataTypes
+	{
+		// Gemm class
+		// cache blocked, register tiled general matrix multiplication engine
+		// computes C = alpha*A*B + beta*C on raw buffers with arbitrary row/column strides,
+		// so transposed and sub-matrix operands need no copy before the call
+		template <class T>
+		class Gemm
+		{
+		public:
+			// register tile computed by the micro-kernel
+			// 4x4 keeps the double accumulators within the 16 SSE2 registers of the baseline x64 target
+			static const unsigned int MR = 4;
+			static const unsigned int NR = 4;
+
+			// cache blocking - a KCxNR sliver of B stays in L1,
+			// an MCxKC block of A in L2 and a KCxNC panel of B in L3
+			static const unsigned int MC = 128;
+			static const unsigned int KC = 256;
+			static const unsigned int NC = 4096;
+
+			// products below this many multiply-adds are not worth waking the pool for
+			static const unsigned long long ParallelThreshold = 64 * 64 * 64;
+
+			// nThreads - number of pool threads to use, 0 for the whole global pool
+			static void Multiply(unsigned int m, unsigned int n, unsigned int k,
+				T alpha,
+				const T* a, ptrdiff_t aRowStride, ptrdiff_t aColStride,
+				const T* b, ptrdiff_t bRowStride, ptrdiff_t bColStride,
+				T beta,
+				T* c, ptrdiff_t cRowStride, ptrdiff_t cColStride,
+				unsigned int nThreads = 0);
+
+		private:
+			static void MultiplySerial(unsigned int m, unsigned int n, unsigned int k,
+				T alpha,
+				const T* a, ptrdiff_t aRowStride, ptrdiff_t aColStride,
+				const T* b, ptrdiff_t bRowStride, ptrdiff_t bColStride,
+				T beta,
+				T* c, ptrdiff_t cRowStride, ptrdiff_t cColStride);
+
+			static void ScaleC(unsigned int m, unsigned int n, T beta, T* c, ptrdiff_t cRowStride, ptrdiff_t cColStride);
+
+			static void PackA(unsigned int mc, unsigned int kc,
+				const T* a, ptrdiff_t aRowStride, ptrdiff_t aColStride, T* packed);
+			static void PackB(unsigned int kc, unsigned int nc,
+				const T* b, ptrdiff_t bRowStride, ptrdiff_t bColStride, T* packed);
+
+			static void MicroKernel(unsigned int kc, T alpha, const T* packedA, const T* packedB,
+				T* c, ptrdiff_t cRowStride, ptrdiff_t cColStride, unsigned int mr, unsigned int nr);
+
+			static T* PackBufferA(size_t size);
+			static T* PackBufferB(size_t size);
+		};
+	}
+}
+
+#endif // !_GEMM_H_
@@ -0,0 +1,127 @@
+#ifndef _HOUSEHOLDER_CPP_
+#define _HOUSEHOLDER_CPP_
+
+#include <vector>
+#include <cstdlib>
+#include "Householder.h"
+#include "Gemm.cpp"
+
+using namespace Numero;
+using namespace Numero::DataTypes;
+
+#pragma region APPLY
+template <class T>
+void Householder<T>::Apply(const T* reflectors, ptrdiff_t elementStride, ptrdiff_t reflectorStride, unsigned int count,
+	unsigned int shift, const T* tau, T* z, unsigned int rows, unsigned int cols, ptrdiff_t zRowStride, unsigned int nThreads)
+{
+	ApplyPanels(reflectors, elementStride, reflectorStride, count, shift, tau, z, rows, cols, zRowStride, false, nThreads);
+}
+
+template <class T>
+void Householder<T>::ApplyTranspose(const T* reflectors, ptrdiff_t elementStride, ptrdiff_t reflectorStride, unsigned int count,
+	unsigned int shift, const T* tau, T* z, unsigned int rows, unsigned int cols, ptrdiff_t zRowStride, unsigned int nThreads)
+{
+	ApplyPanels(reflectors, elementStride, reflectorStride, count, shift, tau, z, rows, cols, zRowStride, true, nThreads);
+}
+
+// panel by panel, from the last one for Q and from the first for Q', each as I - V*T*V' or I - V*T'*V'
+// T(0:j, j) = -tau(j) * T(0:j, 0:j) * V(:, 0:j)'*v(j) from the Gram matrix V'*V
+template <class T>
+void Householder<T>::ApplyPanels(const T* reflectors, ptrdiff_t elementStride, ptrdiff_t reflectorStride, unsigned int count,
+	unsigned int shift, const T* tau, T* z, unsigned int rows, unsigned int cols, ptrdiff_t zRowStride, bool transpose,
+	unsigned int nThreads)
+{
+	if (count == 0 || cols == 0)
+		return;
+
+	vector<T> v;
+	vector<T> gram;
+	vector<T> t;
+	vector<T> w;
+	vector<T> tw;
+
+	unsigned int panels = (count + BlockSize - 1) / BlockSize;
+	for (unsigned int panel(0); panel < panels; panel++)
+	{
+		unsigned int k0 = (transpose ? panel : panels - 1 - panel) * BlockSize;
+		unsigned int kb = (count - k0 < BlockSize) ? count - k0 : BlockSize;
+		unsigned int head = k0 + shift;
+		unsigned int length = rows - head;
+
+		// v(j) from its implicit 1 down, zero above - gathered along whichever stride is contiguous
+		v.assign(static_cast<size_t>(length) * kb, static_cast<T>(0));
+		const T* first = reflectors + static_cast<ptrdiff_t>(k0) * reflectorStride + static_cast<ptrdiff_t>(head) * elementStride;
+		if (abs(reflectorStride) < abs(elementStride))
+		{
+			for (unsigned int r(1); r < length; r++)
+			{
+				const T* element = first + static_cast<ptrdiff_t>(r) * elementStride;
+				unsigned int below = (r < kb) ? r : kb;
+				for (unsigned int q(0); q < below; q++)
+					v[static_cast<size_t>(r) * kb + q] = element[static_cast<ptrdiff_t>(q) * reflectorStride];
+			}
+		}
+		else
+		{
+			for (unsigned int q(0); q < kb; q++)
+			{
+				const T* reflector = first + static_cast<ptrdiff_t>(q) * reflectorStride;
+				for (unsigned int r(q + 1); r < length; r++)
+					v[static_cast<size_t>(r) * kb + q] = reflector[static_cast<ptrdiff_t>(r) * elementStride];
+			}
+		}
+		for (unsigned int q(0); q < kb; q++)
+			v[static_cast<size_t>(q) * kb + q] = static_cast<T>(1);
+
+		gram.assign(static_cast<size_t>(kb) * kb, static_cast<T>(0));
+		Gemm<T>::Multiply(kb, kb, length,
+			static_cast<T>(1),
+			v.data(), 1, kb,
+			v.data(), kb, 1,
+			static_cast<T>(0),
+			gram.data(), kb, 1,
+			nThreads);
+
+		t.assign(static_cast<size_t>(kb) * kb, static_cast<T>(0));
+		for (unsigned int q(0); q < kb; q++)
+		{
+			T tauQ = tau[k0 + q];
+			t[static_cast<size_t>(q) * kb + q] = tauQ;
+			for (unsigned int r(0); r < q; r++)
+			{
+				T sum = static_cast<T>(0);
+				for (unsigned int s(r); s < q; s++)
+					sum += t[static_cast<size_t>(r) * kb + s] * gram[static_cast<size_t>(s) * kb + q];
+				t[static_cast<size_t>(r) * kb + q] = -tauQ * sum;
+			}
+		}
+
+		T* block = z + static_cast<ptrdiff_t>(head) * zRowStride;
+		w.resize(static_cast<size_t>(kb) * cols);
+		tw.resize(static_cast<size_t>(kb) * cols);
+		Gemm<T>::Multiply(kb, cols, length,
+			static_cast<T>(1),
+			v.data(), 1, kb,
+			block, zRowStride, 1,
+			static_cast<T>(0),
+			w.data(), cols, 1,
+			nThreads);
+		Gemm<T>::Multiply(kb, cols, kb,
+			static_cast<T>(1),
+			t.data(), transpose ? 1 : kb, transpose ? kb : 1,
+			w.data(), cols, 1,
+			static_cast<T>(0),
+			tw.data(), cols, 1,
+			nThreads);
+		Gemm<T>::Multiply(length, cols, kb,
+			static_cast<T>(-1),
+			v.data(), kb, 1,
+			tw.data(), cols, 1,
+			static_cast<T>(1),
+			block, zRowStride, 1,
+			nThreads);
+	}
+}
+#pragma endregion
+
+#endif // !_HOUSEHOLDER_CPP_
@@ -0,0 +1,46 @@
+#ifndef _HOUSEHOLDER_H_
+#define _HOUSEHOLDER_H_
+
+#include "../Numero.Definitions/DataTypeDefines.h"
+#include <cstddef>
+
+namespace Numero
+{
+	using namespace std;
+	using namespace Definitions;
+
+	namespace DataTypes
+	{
+		// Householder class
+		// blocked application of a product of Householder reflectors H(j) = I - tau(j)*v(j)*v(j)' kept inside a
+		// factored matrix, as left by QR and the tridiagonal and bidiagonal reductions - v(j) has an implicit 1 at
+		// position j + shift and its remaining elements, positions j + shift + 1 and on, are read with a stride
+		// so reflectors stored along rows and along columns are handled alike
+		// every panel of BlockSize reflectors is applied as I - V*T*V', three Gemm products - the T factor is
+		// rebuilt from the Gram matrix V'*V of the panel on every call
+		template <class T>
+		class Householder
+		{
+		private:
+			static void ApplyPanels(const T* reflectors, ptrdiff_t elementStride, ptrdiff_t reflectorStride, unsigned int count,
+				unsigned int shift, const T* tau, T* z, unsigned int rows, unsigned int cols, ptrdiff_t zRowStride, bool transpose,
+				unsigned int nThreads);
+
+		public:
+			// reflectors per panel
+			static const unsigned int BlockSize = 32;
+
+			// z = H(0)*H(1)*...*H(count-1)*z for the rows x cols matrix z
+			// element p of v(j) is reflectors[j*reflectorStride + p*elementStride]
+			static void Apply(const T* reflectors, ptrdiff_t elementStride, ptrdiff_t reflectorStride, unsigned int count,
+				unsigned int shift, const T* tau, T* z, unsigned int rows, unsigned int cols, ptrdiff_t zRowStride,
+				unsigned int nThreads = 0);
+			// z = (H(0)*H(1)*...*H(count-1))'*z = H(count-1)*...*H(0)*z, same arguments
+			static void ApplyTranspose(const T* reflectors, ptrdiff_t elementStride, ptrdiff_t reflectorStride, unsigned int count,
+				unsigned int shift, const T* tau, T* z, unsigned int rows, unsigned int cols, ptrdiff_t zRowStride,
+				unsigned int nThreads = 0);
+		};
+	}
+}
+
+#endif // !_HOUSEHOLDER_H_
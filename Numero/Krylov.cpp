@@ -0,0 +1,595 @@
+#ifndef _KRYLOV_CPP_
+#define _KRYLOV_CPP_
+
+#include <assert.h>
+#include <cmath>
+#include <chrono>
+#include <type_traits>
+#include "Krylov.h"
+#include "Sparse.cpp"
+#include "ThreadPool.h"
+
+using namespace Numero;
+using namespace Numero::DataTypes;
+
+#pragma region PRECONDITIONERS
+template <class T>
+void IdentityPreconditioner<T>::Apply(const T* r, T* z, unsigned int) const
+{
+	copy(r, r + n, z);
+}
+
+template <class T>
+JacobiPreconditioner<T>::JacobiPreconditioner(const Sparse<T>& matrix)
+	: inverseDiagonal(matrix.Rows())
+{
+	assert(matrix.Rows() == matrix.Cols());
+
+	for (unsigned int row(0); row < matrix.Rows(); row++)
+	{
+		T diagonal = matrix(row, row);
+		assert(diagonal != static_cast<T>(0));
+		inverseDiagonal[row] = static_cast<T>(1) / diagonal;
+	}
+}
+
+template <class T>
+JacobiPreconditioner<T>::JacobiPreconditioner(const Dense<T>& matrix)
+	: inverseDiagonal(matrix.Rows())
+{
+	assert(matrix.Rows() == matrix.Cols());
+
+	for (unsigned int row(0); row < matrix.Rows(); row++)
+	{
+		T diagonal = matrix(row, row);
+		assert(diagonal != static_cast<T>(0));
+		inverseDiagonal[row] = static_cast<T>(1) / diagonal;
+	}
+}
+
+template <class T>
+void JacobiPreconditioner<T>::Apply(const T* r, T* z, unsigned int nThreads) const
+{
+	const T* d = inverseDiagonal.data();
+	size_t n = inverseDiagonal.size();
+	if (n < ParallelThreshold)
+	{
+		Simd::Mul(r, d, z, n);
+		return;
+	}
+
+	unsigned int blocks = static_cast<unsigned int>((n + ParallelBlock - 1) / ParallelBlock);
+	ThreadPool::Global().ParallelFor(blocks, [&](unsigned int block)
+	{
+		size_t begin = static_cast<size_t>(block) * ParallelBlock;
+		size_t length = (n - begin < ParallelBlock) ? n - begin : ParallelBlock;
+		Simd::Mul(r + begin, d + begin, z + begin, length);
+	}, nThreads);
+}
+
+template <class T>
+SsorPreconditioner<T>::SsorPreconditioner(const Sparse<T>& matrix, T omega)
+	: matrix(matrix), diagonal(matrix.Rows()), omega(omega)
+{
+	assert(matrix.Rows() == matrix.Cols());
+	assert(omega > static_cast<T>(0) && omega < static_cast<T>(2));
+
+	const unsigned int* offsets = matrix.RowOffsets();
+	const unsigned int* columns = matrix.ColumnIndices();
+	for (unsigned int row(0); row < matrix.Rows(); row++)
+	{
+		const unsigned int* position = lower_bound(columns + offsets[row], columns + offsets[row + 1], row);
+		assert(position != columns + offsets[row + 1] && *position == row && matrix.Values()[position - columns] != static_cast<T>(0));
+		diagonal[row] = static_cast<unsigned int>(position - columns);
+	}
+}
+
+// forward sweep with (D/w + L), scaling by D/w, backward sweep with (D/w + U)
+template <class T>
+void SsorPreconditioner<T>::Apply(const T* r, T* z, unsigned int) const
+{
+	const unsigned int n = matrix.Rows();
+	const unsigned int* offsets = matrix.RowOffsets();
+	const unsigned int* columns = matrix.ColumnIndices();
+	const T* values = matrix.Values();
+	T scale = (static_cast<T>(2) - omega) / omega;
+
+	for (unsigned int row(0); row < n; row++)
+	{
+		T sum = scale * r[row];
+		for (unsigned int entry(offsets[row]); entry < diagonal[row]; entry++)
+			sum -= values[entry] * z[columns[entry]];
+		z[row] = sum * omega / values[diagonal[row]];
+	}
+
+	for (unsigned int row(0); row < n; row++)
+		z[row] *= values[diagonal[row]] / omega;
+
+	for (unsigned int row(n); row-- > 0;)
+	{
+		T sum = z[row];
+		for (unsigned int entry(diagonal[row] + 1); entry < offsets[row + 1]; entry++)
+			sum -= values[entry] * z[columns[entry]];
+		z[row] = sum * omega / values[diagonal[row]];
+	}
+}
+
+// row by row (IKJ) elimination restricted to the existing entries -
+// marker maps the columns of the current row to their positions
+template <class T>
+Ilu0Preconditioner<T>::Ilu0Preconditioner(const Sparse<T>& matrix)
+	: factors(matrix), diagonal(matrix.Rows())
+{
+	assert(matrix.Rows() == matrix.Cols());
+
+	const unsigned int n = matrix.Rows();
+	const unsigned int None = 0xFFFFFFFFu;
+	const unsigned int* offsets = factors.RowOffsets();
+	const unsigned int* columns = factors.ColumnIndices();
+	T* values = factors.Values();
+	vector<unsigned int> marker(n, None);
+
+	for (unsigned int row(0); row < n; row++)
+	{
+		for (unsigned int entry(offsets[row]); entry < offsets[row + 1]; entry++)
+			marker[columns[entry]] = entry;
+
+		unsigned int entry(offsets[row]);
+		for (; entry < offsets[row + 1] && columns[entry] < row; entry++)
+		{
+			unsigned int k = columns[entry];
+			values[entry] /= values[diagonal[k]];
+			T factor = values[entry];
+
+			for (unsigned int kEntry(diagonal[k] + 1); kEntry < offsets[k + 1]; kEntry++)
+			{
+				unsigned int position = marker[columns[kEntry]];
+				if (position != None)
+					values[position] -= factor * values[kEntry];
+			}
+		}
+
+		assert(entry < offsets[row + 1] && columns[entry] == row && values[entry] != static_cast<T>(0));
+		diagonal[row] = entry;
+
+		for (unsigned int e(offsets[row]); e < offsets[row + 1]; e++)
+			marker[columns[e]] = None;
+	}
+}
+
+// unit lower solve, then upper solve
+template <class T>
+void Ilu0Preconditioner<T>::Apply(const T* r, T* z, unsigned int) const
+{
+	const unsigned int n = factors.Rows();
+	const unsigned int* offsets = factors.RowOffsets();
+	const unsigned int* columns = factors.ColumnIndices();
+	const T* values = factors.Values();
+
+	for (unsigned int row(0); row < n; row++)
+	{
+		T sum = r[row];
+		for (unsigned int entry(offsets[row]); entry < diagonal[row]; entry++)
+			sum -= values[entry] * z[columns[entry]];
+		z[row] = sum;
+	}
+
+	for (unsigned int row(n); row-- > 0;)
+	{
+		T sum = z[row];
+		for (unsigned int entry(diagonal[row] + 1); entry < offsets[row + 1]; entry++)
+			sum -= values[entry] * z[columns[entry]];
+		z[row] = sum / values[diagonal[row]];
+	}
+}
+#pragma endregion
+
+
+#pragma region VECTOR_KERNELS
+// partial sums of fixed blocks, added in block order on the calling thread
+template <class T, class Body>
+T Krylov::Reduce(unsigned int n, unsigned int nThreads, const Body& body)
+{
+	unsigned int blocks = (n + ReductionBlock - 1) / ReductionBlock;
+	if (blocks <= 1)
+		return body(0, n);
+
+	vector<T> partials(blocks);
+	ThreadPool::Global().ParallelFor(blocks, [&](unsigned int block)
+	{
+		unsigned int begin = block * ReductionBlock;
+		partials[block] = body(begin, (n - begin < ReductionBlock) ? n : begin + ReductionBlock);
+	}, (n < ParallelVectorThreshold) ? 1 : nThreads);
+
+	T sum = static_cast<T>(0);
+	for (unsigned int block(0); block < blocks; block++)
+		sum += partials[block];
+	return sum;
+}
+
+template <class Body>
+void Krylov::ForBlocks(unsigned int n, unsigned int nThreads, const Body& body)
+{
+	unsigned int blocks = (n + ReductionBlock - 1) / ReductionBlock;
+	if (blocks <= 1 || n < ParallelVectorThreshold)
+	{
+		body(0, n);
+		return;
+	}
+
+	ThreadPool::Global().ParallelFor(blocks, [&](unsigned int block)
+	{
+		unsigned int begin = block * ReductionBlock;
+		body(begin, (n - begin < ReductionBlock) ? n : begin + ReductionBlock);
+	}, nThreads);
+}
+
+template <class T>
+T Krylov::Dot(const T* x, const T* y, unsigned int n, unsigned int nThreads)
+{
+	return Reduce<T>(n, nThreads, [&](unsigned int begin, unsigned int end)
+	{
+		T sum = static_cast<T>(0);
+		for (unsigned int i(begin); i < end; i++)
+			sum += x[i] * y[i];
+		return sum;
+	});
+}
+
+template <class T>
+T Krylov::AxpyDot(T alpha, const T* x, T* y, const T* z, unsigned int n, unsigned int nThreads)
+{
+	return Reduce<T>(n, nThreads, [&](unsigned int begin, unsigned int end)
+	{
+		T sum = static_cast<T>(0);
+		for (unsigned int i(begin); i < end; i++)
+		{
+			y[i] += alpha * x[i];
+			sum += y[i] * z[i];
+		}
+		return sum;
+	});
+}
+
+template <class T>
+void Krylov::Axpy(T alpha, const T* x, T* y, unsigned int n, unsigned int nThreads)
+{
+	ForBlocks(n, nThreads, [&](unsigned int begin, unsigned int end)
+	{
+		for (unsigned int i(begin); i < end; i++)
+			y[i] += alpha * x[i];
+	});
+}
+
+template <class T>
+void Krylov::Xpay(const T* x, T beta, T* y, unsigned int n, unsigned int nThreads)
+{
+	ForBlocks(n, nThreads, [&](unsigned int begin, unsigned int end)
+	{
+		for (unsigned int i(begin); i < end; i++)
+			y[i] = x[i] + beta * y[i];
+	});
+}
+
+template <class T>
+void Krylov::Dot2(const T* x, const T* y, const T* z, unsigned int n, T& xy, T& xz, unsigned int nThreads)
+{
+	unsigned int blocks = (n + ReductionBlock - 1) / ReductionBlock;
+	vector<T> partials(2 * (blocks > 0 ? blocks : 1), static_cast<T>(0));
+
+	auto body = [&](unsigned int block)
+	{
+		unsigned int begin = block * ReductionBlock;
+		unsigned int end = (n - begin < ReductionBlock) ? n : begin + ReductionBlock;
+		T sumY = static_cast<T>(0), sumZ = static_cast<T>(0);
+		for (unsigned int i(begin); i < end; i++)
+		{
+			sumY += x[i] * y[i];
+			sumZ += x[i] * z[i];
+		}
+		partials[2 * block] = sumY;
+		partials[2 * block + 1] = sumZ;
+	};
+	ThreadPool::Global().ParallelFor(blocks, body, (n < ParallelVectorThreshold) ? 1 : nThreads);
+
+	xy = static_cast<T>(0);
+	xz = static_cast<T>(0);
+	for (unsigned int block(0); block < blocks; block++)
+	{
+		xy += partials[2 * block];
+		xz += partials[2 * block + 1];
+	}
+}
+#pragma endregion
+
+
+#pragma region SOLVERS
+template <class Operator, class T>
+bool Krylov::Prepare(const Operator& a, const Dense<T>& b, Dense<T>& x)
+{
+	static_assert(is_floating_point<T>::value, "iterative solvers need a floating point type");
+	assert(&x != &b);
+
+	if (a.Rows() != a.Cols() || b.Rows() != a.Rows() || b.Cols() != 1)
+		return false;
+
+	if (x.Rows() != b.Rows() || x.Cols() != 1)
+	{
+		x.Resize(b.Rows(), 1);
+		x.ResetToConstant(static_cast<T>(0));
+	}
+	return true;
+}
+
+template <class Operator, class T>
+KrylovResult Krylov::ConjugateGradient(const Operator& a, const Dense<T>& b, Dense<T>& x, const KrylovOptions& options)
+{
+	return ConjugateGradient(a, b, x, IdentityPreconditioner<T>(a.Rows()), options);
+}
+
+template <class Operator, class T, class Preconditioner>
+KrylovResult Krylov::ConjugateGradient(const Operator& a, const Dense<T>& b, Dense<T>& x, const Preconditioner& m, const KrylovOptions& options)
+{
+	typedef chrono::steady_clock Clock;
+	Clock::time_point start = Clock::now();
+	KrylovResult result = { false, 0, 0.0, 0.0 };
+	if (!Prepare(a, b, x))
+		return result;
+
+	const unsigned int n = a.Rows();
+	const unsigned int threads = options.nThreads;
+
+	double bNorm = sqrt(static_cast<double>(Dot(b.Data(), b.Data(), n, threads)));
+	if (bNorm == 0)
+	{
+		x.ResetToConstant(static_cast<T>(0));
+		result.converged = true;
+		return result;
+	}
+
+	vector<T> r(n), z(n), p(n), q(n);
+	T* xData = x.Data();
+
+	// r = b - A*x
+	a.MulVectorInto(xData, r.data(), threads);
+	Xpay(b.Data(), static_cast<T>(-1), r.data(), n, threads);
+	result.residual = sqrt(static_cast<double>(Dot(r.data(), r.data(), n, threads))) / bNorm;
+
+	m.Apply(r.data(), z.data(), threads);
+	p = z;
+	T rz = Dot(r.data(), z.data(), n, threads);
+
+	while (result.residual > options.tolerance && result.iterations < options.maxIterations)
+	{
+		a.MulVectorInto(p.data(), q.data(), threads);
+		T pq = Dot(p.data(), q.data(), n, threads);
+		// breakdown - A or M not positive definite
+		if (pq == static_cast<T>(0))
+			break;
+
+		T alpha = rz / pq;
+		Axpy(alpha, p.data(), xData, n, threads);
+		T rr = AxpyDot(-alpha, q.data(), r.data(), r.data(), n, threads);
+
+		result.iterations++;
+		result.residual = sqrt(static_cast<double>(rr)) / bNorm;
+		if (options.callback)
+			options.callback(result.iterations, result.residual, chrono::duration<double>(Clock::now() - start).count());
+		if (result.residual <= options.tolerance)
+			break;
+
+		m.Apply(r.data(), z.data(), threads);
+		T rzNext = Dot(r.data(), z.data(), n, threads);
+		Xpay(z.data(), rzNext / rz, p.data(), n, threads);
+		rz = rzNext;
+	}
+
+	result.converged = (result.residual <= options.tolerance);
+	result.seconds = chrono::duration<double>(Clock::now() - start).count();
+	return result;
+}
+
+template <class Operator, class T>
+KrylovResult Krylov::BiCgStab(const Operator& a, const Dense<T>& b, Dense<T>& x, const KrylovOptions& options)
+{
+	return BiCgStab(a, b, x, IdentityPreconditioner<T>(a.Rows()), options);
+}
+
+template <class Operator, class T, class Preconditioner>
+KrylovResult Krylov::BiCgStab(const Operator& a, const Dense<T>& b, Dense<T>& x, const Preconditioner& m, const KrylovOptions& options)
+{
+	typedef chrono::steady_clock Clock;
+	Clock::time_point start = Clock::now();
+	KrylovResult result = { false, 0, 0.0, 0.0 };
+	if (!Prepare(a, b, x))
+		return result;
+
+	const unsigned int n = a.Rows();
+	const unsigned int threads = options.nThreads;
+
+	double bNorm = sqrt(static_cast<double>(Dot(b.Data(), b.Data(), n, threads)));
+	if (bNorm == 0)
+	{
+		x.ResetToConstant(static_cast<T>(0));
+		result.converged = true;
+		return result;
+	}
+
+	vector<T> r(n), rHat(n), p(n, static_cast<T>(0)), v(n, static_cast<T>(0)), pHat(n), sHat(n), t(n);
+	T* xData = x.Data();
+
+	a.MulVectorInto(xData, r.data(), threads);
+	Xpay(b.Data(), static_cast<T>(-1), r.data(), n, threads);
+	rHat = r;
+	result.residual = sqrt(static_cast<double>(Dot(r.data(), r.data(), n, threads))) / bNorm;
+
+	T rho = static_cast<T>(1), alpha = static_cast<T>(1), omega = static_cast<T>(1);
+
+	while (result.residual > options.tolerance && result.iterations < options.maxIterations)
+	{
+		T rhoNext = Dot(rHat.data(), r.data(), n, threads);
+		// breakdown - the shadow residual became orthogonal to the residual
+		if (rhoNext == static_cast<T>(0) || omega == static_cast<T>(0))
+			break;
+
+		// p = r + beta*(p - omega*v)
+		T beta = (rhoNext / rho) * (alpha / omega);
+		Axpy(-omega, v.data(), p.data(), n, threads);
+		Xpay(r.data(), beta, p.data(), n, threads);
+
+		m.Apply(p.data(), pHat.data(), threads);
+		a.MulVectorInto(pHat.data(), v.data(), threads);
+		T rHatV = Dot(rHat.data(), v.data(), n, threads);
+		if (rHatV == static_cast<T>(0))
+			break;
+		alpha = rhoNext / rHatV;
+
+		// s = r - alpha*v, kept in r
+		T ss = AxpyDot(-alpha, v.data(), r.data(), r.data(), n, threads);
+		result.iterations++;
+		if (sqrt(static_cast<double>(ss)) / bNorm <= options.tolerance)
+		{
+			Axpy(alpha, pHat.data(), xData, n, threads);
+			result.residual = sqrt(static_cast<double>(ss)) / bNorm;
+			if (options.callback)
+				options.callback(result.iterations, result.residual, chrono::duration<double>(Clock::now() - start).count());
+			break;
+		}
+
+		m.Apply(r.data(), sHat.data(), threads);
+		a.MulVectorInto(sHat.data(), t.data(), threads);
+		T ts, tt;
+		Dot2(t.data(), r.data(), t.data(), n, ts, tt, threads);
+		omega = (tt == static_cast<T>(0)) ? static_cast<T>(0) : ts / tt;
+
+		Axpy(alpha, pHat.data(), xData, n, threads);
+		Axpy(omega, sHat.data(), xData, n, threads);
+		T rr = AxpyDot(-omega, t.data(), r.data(), r.data(), n, threads);
+		rho = rhoNext;
+
+		result.residual = sqrt(static_cast<double>(rr)) / bNorm;
+		if (options.callback)
+			options.callback(result.iterations, result.residual, chrono::duration<double>(Clock::now() - start).count());
+	}
+
+	result.converged = (result.residual <= options.tolerance);
+	result.seconds = chrono::duration<double>(Clock::now() - start).count();
+	return result;
+}
+
+template <class Operator, class T>
+KrylovResult Krylov::Gmres(const Operator& a, const Dense<T>& b, Dense<T>& x, const KrylovOptions& options)
+{
+	return Gmres(a, b, x, IdentityPreconditioner<T>(a.Rows()), options);
+}
+
+// the Hessenberg matrix is reduced by Givens rotations as it grows, so |g[j+1]| is the residual of the cycle
+// without forming x - the true residual is recomputed at every restart
+template <class Operator, class T, class Preconditioner>
+KrylovResult Krylov::Gmres(const Operator& a, const Dense<T>& b, Dense<T>& x, const Preconditioner& m, const KrylovOptions& options)
+{
+	typedef chrono::steady_clock Clock;
+	Clock::time_point start = Clock::now();
+	KrylovResult result = { false, 0, 0.0, 0.0 };
+	if (options.restart == 0 || !Prepare(a, b, x))
+		return result;
+
+	const unsigned int n = a.Rows();
+	const unsigned int threads = options.nThreads;
+	const unsigned int restart = options.restart;
+
+	double bNorm = sqrt(static_cast<double>(Dot(b.Data(), b.Data(), n, threads)));
+	if (bNorm == 0)
+	{
+		x.ResetToConstant(static_cast<T>(0));
+		result.converged = true;
+		return result;
+	}
+
+	vector<T> basis(static_cast<size_t>(restart + 1) * n);
+	vector<T> hessenberg(static_cast<size_t>(restart + 1) * restart);	// column j holds h[0..j+1][j]
+	vector<T> cosines(restart), sines(restart), g(restart + 1), y(restart);
+	vector<T> w(n), z(n);
+	T* xData = x.Data();
+
+	for (;;)
+	{
+		// r = b - A*x into the first basis vector
+		T* v0 = basis.data();
+		a.MulVectorInto(xData, v0, threads);
+		Xpay(b.Data(), static_cast<T>(-1), v0, n, threads);
+		T beta = sqrt(Dot(v0, v0, n, threads));
+		result.residual = static_cast<double>(beta) / bNorm;
+		if (result.residual <= options.tolerance || result.iterations >= options.maxIterations)
+			break;
+
+		Simd::MulScalar(v0, static_cast<T>(1) / beta, v0, n);
+		fill(g.begin(), g.end(), static_cast<T>(0));
+		g[0] = beta;
+
+		unsigned int k = 0;
+		while (k < restart && result.iterations < options.maxIterations)
+		{
+			unsigned int j = k++;
+			T* h = hessenberg.data() + static_cast<size_t>(j) * (restart + 1);
+
+			m.Apply(basis.data() + static_cast<size_t>(j) * n, z.data(), threads);
+			a.MulVectorInto(z.data(), w.data(), threads);
+
+			// modified Gram-Schmidt, every subtraction fused with the next projection
+			h[0] = Dot(w.data(), basis.data(), n, threads);
+			for (unsigned int i(0); i < j; i++)
+				h[i + 1] = AxpyDot(-h[i], basis.data() + static_cast<size_t>(i) * n, w.data(), basis.data() + static_cast<size_t>(i + 1) * n, n, threads);
+			T norm = sqrt(AxpyDot(-h[j], basis.data() + static_cast<size_t>(j) * n, w.data(), w.data(), n, threads));
+			h[j + 1] = norm;
+			if (norm != static_cast<T>(0))
+				Simd::MulScalar(w.data(), static_cast<T>(1) / norm, basis.data() + static_cast<size_t>(j + 1) * n, n);
+
+			// previous rotations, then a new one zeroing h[j+1]
+			for (unsigned int i(0); i < j; i++)
+			{
+				T upper = cosines[i] * h[i] + sines[i] * h[i + 1];
+				h[i + 1] = -sines[i] * h[i] + cosines[i] * h[i + 1];
+				h[i] = upper;
+			}
+			T radius = sqrt(h[j] * h[j] + h[j + 1] * h[j + 1]);
+			cosines[j] = (radius == static_cast<T>(0)) ? static_cast<T>(1) : h[j] / radius;
+			sines[j] = (radius == static_cast<T>(0)) ? static_cast<T>(0) : h[j + 1] / radius;
+			h[j] = radius;
+			h[j + 1] = static_cast<T>(0);
+			g[j + 1] = -sines[j] * g[j];
+			g[j] = cosines[j] * g[j];
+
+			result.iterations++;
+			result.residual = abs(static_cast<double>(g[j + 1])) / bNorm;
+			if (options.callback)
+				options.callback(result.iterations, result.residual, chrono::duration<double>(Clock::now() - start).count());
+			// converged, or the space is invariant (lucky breakdown)
+			if (result.residual <= options.tolerance || norm == static_cast<T>(0))
+				break;
+		}
+
+		// back substitution of the rotated Hessenberg system, then x += M^-1 * V*y
+		for (unsigned int i(k); i-- > 0;)
+		{
+			T sum = g[i];
+			for (unsigned int l(i + 1); l < k; l++)
+				sum -= hessenberg[static_cast<size_t>(l) * (restart + 1) + i] * y[l];
+			T diagonal = hessenberg[static_cast<size_t>(i) * (restart + 1) + i];
+			y[i] = (diagonal == static_cast<T>(0)) ? static_cast<T>(0) : sum / diagonal;
+		}
+
+		fill(w.begin(), w.end(), static_cast<T>(0));
+		for (unsigned int i(0); i < k; i++)
+			Axpy(y[i], basis.data() + static_cast<size_t>(i) * n, w.data(), n, threads);
+		m.Apply(w.data(), z.data(), threads);
+		Axpy(static_cast<T>(1), z.data(), xData, n, threads);
+	}
+
+	result.converged = (result.residual <= options.tolerance);
+	result.seconds = chrono::duration<double>(Clock::now() - start).count();
+	return result;
+}
+#pragma endregion
+
+#endif // !_KRYLOV_CPP_
@@ -0,0 +1,182 @@
+#ifndef _KRYLOV_H_
+#define _KRYLOV_H_
+
+#include "../Numero.Definitions/DataTypeDefines.h"
+#include "Dense.h"
+#include "Sparse.h"
+#include <vector>
+#include <functional>
+
+namespace Numero
+{
+	using namespace std;
+	using namespace Definitions;
+
+	namespace DataTypes
+	{
+		// called after every iteration with the iteration number (from 1), the relative residual
+		// and the seconds since the solve started
+		typedef function<void(unsigned int iteration, double residual, double seconds)> KrylovCallback;
+
+		// settings of an iterative solve
+		struct KrylovOptions
+		{
+			unsigned int maxIterations;		// matrix-vector products for GMRES, iterations for CG and BiCGSTAB
+			double tolerance;				// on the relative residual |b - A*x| / |b|
+			unsigned int restart;			// GMRES basis size before a restart
+			unsigned int nThreads;			// as in ThreadPool::ParallelFor, 0 uses the whole pool
+			KrylovCallback callback;		// optional, see KrylovCallback
+
+			KrylovOptions()
+				: maxIterations(1000), tolerance(1e-8), restart(30), nThreads(0)
+			{
+			}
+		};
+
+		// outcome of an iterative solve - residual is the last relative residual seen
+		struct KrylovResult
+		{
+			bool converged;
+			unsigned int iterations;
+			double residual;
+			double seconds;
+		};
+
+		// --- preconditioners
+		// every preconditioner provides Apply(r, z, nThreads), z = M^-1 * r on vectors of the system size
+
+		// IdentityPreconditioner class
+		// no preconditioning - used by the solver overloads without a preconditioner
+		template <class T>
+		class IdentityPreconditioner
+		{
+		private:
+			unsigned int n;
+		public:
+			explicit IdentityPreconditioner(unsigned int n) : n(n) {}
+			void Apply(const T* r, T* z, unsigned int nThreads = 0) const;
+		};
+
+		// JacobiPreconditioner class
+		// M = diag(A) - cheap and parallel, suits diagonally dominant systems
+		template <class T>
+		class JacobiPreconditioner
+		{
+		private:
+			vector<T> inverseDiagonal;
+		public:
+			// vectors shorter than this stay on the calling thread, longer ones are scaled in blocks of ParallelBlock
+			static const unsigned int ParallelThreshold = 1 << 15;
+			static const unsigned int ParallelBlock = 4096;
+
+			explicit JacobiPreconditioner(const Sparse<T>& matrix);
+			explicit JacobiPreconditioner(const Dense<T>& matrix);
+			void Apply(const T* r, T* z, unsigned int nThreads = 0) const;
+		};
+
+		// SsorPreconditioner class
+		// symmetric successive over-relaxation, M = w/(2-w) * (D/w + L) * (D/w)^-1 * (D/w + U)
+		// symmetric positive definite for such A and 0 < w < 2, so it serves CG as well
+		// applying it is a forward and a backward sweep, which run on one thread
+		// keeps a reference to the matrix, which must outlive the preconditioner
+		template <class T>
+		class SsorPreconditioner
+		{
+		private:
+			const Sparse<T>& matrix;
+			vector<unsigned int> diagonal;		// position of the diagonal entry of every row
+			T omega;
+		public:
+			explicit SsorPreconditioner(const Sparse<T>& matrix, T omega = static_cast<T>(1));
+			void Apply(const T* r, T* z, unsigned int nThreads = 0) const;
+		};
+
+		// Ilu0Preconditioner class
+		// incomplete LU factorization keeping the sparsity pattern of A, M = L*U
+		// the factors are a copy of the matrix - strictly lower entries hold L (unit diagonal), the rest U
+		// every row needs a nonzero diagonal entry. the triangular solves run on one thread
+		template <class T>
+		class Ilu0Preconditioner
+		{
+		private:
+			Sparse<T> factors;
+			vector<unsigned int> diagonal;
+		public:
+			explicit Ilu0Preconditioner(const Sparse<T>& matrix);
+			void Apply(const T* r, T* z, unsigned int nThreads = 0) const;
+			const Sparse<T>& Factors() const { return factors; }
+		};
+
+		// Krylov class
+		// preconditioned Krylov subspace solvers for A*x = b
+		// the operator A is any type with Rows(), Cols() and MulVectorInto(x, y, nThreads) -
+		// Sparse, Dense, SparseSell and SparseBlock all qualify
+		// x is the initial guess when it has the size of b, otherwise it is resized and started from zero
+		// a non-square A, a b that is not a vector of its size or a zero GMRES restart return at once, not converged
+		// after 0 iterations and with x untouched
+		// reductions add fixed blocks of the vectors in a fixed order, so the iterates do not depend on the thread count
+		class Krylov
+		{
+		private:
+			// vectors are cut into blocks of this many elements for the parallel reductions
+			static const unsigned int ReductionBlock = 4096;
+			// vectors shorter than this stay on the calling thread
+			static const unsigned int ParallelVectorThreshold = 1 << 15;
+
+			template <class T, class Body>
+			static T Reduce(unsigned int n, unsigned int nThreads, const Body& body);
+			template <class Body>
+			static void ForBlocks(unsigned int n, unsigned int nThreads, const Body& body);
+
+			// checks the sizes and sets up the initial guess, false when they do not fit
+			template <class Operator, class T>
+			static bool Prepare(const Operator& a, const Dense<T>& b, Dense<T>& x);
+
+		public:
+			// --- solvers
+			// conjugate gradients - A and M symmetric positive definite
+			template <class Operator, class T, class Preconditioner>
+			static KrylovResult ConjugateGradient(const Operator& a, const Dense<T>& b, Dense<T>& x, const Preconditioner& m,
+				const KrylovOptions& options = KrylovOptions());
+			template <class Operator, class T>
+			static KrylovResult ConjugateGradient(const Operator& a, const Dense<T>& b, Dense<T>& x,
+				const KrylovOptions& options = KrylovOptions());
+
+			// stabilized biconjugate gradients, right preconditioned - general nonsymmetric A,
+			// two products per iteration and short recurrences
+			template <class Operator, class T, class Preconditioner>
+			static KrylovResult BiCgStab(const Operator& a, const Dense<T>& b, Dense<T>& x, const Preconditioner& m,
+				const KrylovOptions& options = KrylovOptions());
+			template <class Operator, class T>
+			static KrylovResult BiCgStab(const Operator& a, const Dense<T>& b, Dense<T>& x,
+				const KrylovOptions& options = KrylovOptions());
+
+			// restarted GMRES(options.restart), right preconditioned, modified Gram-Schmidt and Givens rotations -
+			// general nonsymmetric A, residual minimized over every cycle
+			template <class Operator, class T, class Preconditioner>
+			static KrylovResult Gmres(const Operator& a, const Dense<T>& b, Dense<T>& x, const Preconditioner& m,
+				const KrylovOptions& options = KrylovOptions());
+			template <class Operator, class T>
+			static KrylovResult Gmres(const Operator& a, const Dense<T>& b, Dense<T>& x,
+				const KrylovOptions& options = KrylovOptions());
+
+			// --- fused vector kernels, parallel over fixed blocks
+			template <class T>
+			static T Dot(const T* x, const T* y, unsigned int n, unsigned int nThreads = 0);
+			// y += alpha*x, then returns y.z in the same pass - z may be y for the squared norm
+			template <class T>
+			static T AxpyDot(T alpha, const T* x, T* y, const T* z, unsigned int n, unsigned int nThreads = 0);
+			// y += alpha*x
+			template <class T>
+			static void Axpy(T alpha, const T* x, T* y, unsigned int n, unsigned int nThreads = 0);
+			// y = x + beta*y
+			template <class T>
+			static void Xpay(const T* x, T beta, T* y, unsigned int n, unsigned int nThreads = 0);
+			// x.y and x.z in one pass
+			template <class T>
+			static void Dot2(const T* x, const T* y, const T* z, unsigned int n, T& xy, T& xz, unsigned int nThreads = 0);
+		};
+	}
+}
+
+#endif // !_KRYLOV_H_
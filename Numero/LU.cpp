@@ -0,0 +1,338 @@
+#ifndef _LU_CPP_
+#define _LU_CPP_
+
+#include <assert.h>
+#include <cmath>
+#include <algorithm>
+#include "LU.h"
+#include "Dense.cpp"
+#include "Gemm.cpp"
+
+using namespace Numero;
+using namespace Numero::DataTypes;
+
+#pragma region FACTORIZATION
+template <class T>
+LU<T>::LU(const Dense<T>& matrix, unsigned int nThreads)
+	: n(matrix.Rows()), factors(matrix), pivots(matrix.Rows()), pivotSign(1), singular(false)
+{
+	assert(matrix.Rows() == matrix.Cols());
+
+	Factorize(nThreads);
+}
+
+// right-looking blocked factorization
+// for every panel of BlockSize columns: factor the panel, solve for the U12 block row
+// and apply the rank-BlockSize update A22 -= L21*U12 to the trailing matrix
+template <class T>
+void LU<T>::Factorize(unsigned int nThreads)
+{
+	T* a = factors.Data();
+
+	for (unsigned int k0(0); k0 < n; k0 += BlockSize)
+	{
+		unsigned int kb = (n - k0 < BlockSize) ? n - k0 : BlockSize;
+		unsigned int trailing = n - k0 - kb;
+
+		FactorPanel(k0, kb);
+
+		if (trailing == 0)
+			continue;
+
+		// U12 = inv(L11) * A12 - forward substitution by rows, unit diagonal
+		for (unsigned int i(k0 + 1); i < k0 + kb; i++)
+		{
+			T* rowI = a + static_cast<size_t>(i)*n + k0 + kb;
+			for (unsigned int j(k0); j < i; j++)
+			{
+				T l = a[static_cast<size_t>(i)*n + j];
+				if (l == static_cast<T>(0))
+					continue;
+
+				const T* rowJ = a + static_cast<size_t>(j)*n + k0 + kb;
+				for (unsigned int col(0); col < trailing; col++)
+				{
+					rowI[col] -= l * rowJ[col];
+				}
+			}
+		}
+
+		// A22 -= L21 * U12
+		Gemm<T>::Multiply(trailing, trailing, kb,
+			static_cast<T>(-1),
+			a + static_cast<size_t>(k0 + kb)*n + k0, n, 1,
+			a + static_cast<size_t>(k0)*n + k0 + kb, n, 1,
+			static_cast<T>(1),
+			a + static_cast<size_t>(k0 + kb)*n + k0 + kb, n, 1,
+			nThreads);
+	}
+}
+
+// unblocked partial pivoting elimination of the columns [startCol, startCol + width)
+// row interchanges swap whole rows, so L to the left and the trailing columns follow the pivots
+template <class T>
+void LU<T>::FactorPanel(unsigned int startCol, unsigned int width)
+{
+	T* a = factors.Data();
+	unsigned int endCol = startCol + width;
+
+	for (unsigned int j(startCol); j < endCol; j++)
+	{
+		// find the largest magnitude entry of the column at or below the diagonal
+		unsigned int pivotRow = j;
+		T pivotMagnitude = abs(a[static_cast<size_t>(j)*n + j]);
+		for (unsigned int i(j + 1); i < n; i++)
+		{
+			T magnitude = abs(a[static_cast<size_t>(i)*n + j]);
+			if (magnitude > pivotMagnitude)
+			{
+				pivotMagnitude = magnitude;
+				pivotRow = i;
+			}
+		}
+
+		pivots[j] = pivotRow;
+		if (pivotRow != j)
+		{
+			swap_ranges(a + static_cast<size_t>(j)*n, a + static_cast<size_t>(j + 1)*n, a + static_cast<size_t>(pivotRow)*n);
+			pivotSign = -pivotSign;
+		}
+
+		T pivot = a[static_cast<size_t>(j)*n + j];
+		if (pivot == static_cast<T>(0))
+		{
+			singular = true;
+			continue;
+		}
+
+		// compute multipliers and update the rest of the panel
+		const T* pivotRowData = a + static_cast<size_t>(j)*n;
+		for (unsigned int i(j + 1); i < n; i++)
+		{
+			T* rowI = a + static_cast<size_t>(i)*n;
+			T l = rowI[j] / pivot;
+			rowI[j] = l;
+
+			if (l == static_cast<T>(0))
+				continue;
+
+			for (unsigned int col(j + 1); col < endCol; col++)
+			{
+				rowI[col] -= l * pivotRowData[col];
+			}
+		}
+	}
+}
+#pragma endregion
+
+
+#pragma region QUERIES
+template <class T>
+bool LU<T>::IsSingular() const
+{
+	return singular;
+}
+
+// det(A) = sign(P) * prod(diag(U))
+template <class T>
+T LU<T>::Determinant() const
+{
+	if (singular)
+		return static_cast<T>(0);
+
+	const T* a = factors.Data();
+	T det = static_cast<T>(pivotSign);
+
+	for (unsigned int i(0); i < n; i++)
+	{
+		det *= a[static_cast<size_t>(i)*n + i];
+	}
+
+	return det;
+}
+
+template <class T>
+const Dense<T>& LU<T>::Factors() const
+{
+	return factors;
+}
+
+template <class T>
+const vector<unsigned int>& LU<T>::Pivots() const
+{
+	return pivots;
+}
+#pragma endregion
+
+
+#pragma region SOLVERS
+template <class T>
+Dense<T> LU<T>::Solve(const Dense<T>& b, unsigned int nThreads) const
+{
+	Dense<T> x(b);
+	SolveInPlace(x, nThreads);
+	return x;
+}
+
+// overwrites b with inv(A)*b - pivots, then L, then U
+template <class T>
+void LU<T>::SolveInPlace(Dense<T>& b, unsigned int nThreads) const
+{
+	assert(b.Rows() == n);
+	assert(!singular);
+
+	ApplyPivots(b);
+	SolveLower(b, nThreads);
+	SolveUpper(b, nThreads);
+}
+
+template <class T>
+Dense<T> LU<T>::Inverse(unsigned int nThreads) const
+{
+	Dense<T> inverse(n, n);
+	T* data = inverse.Data();
+
+	for (unsigned int i(0); i < n; i++)
+	{
+		data[static_cast<size_t>(i)*n + i] = static_cast<T>(1);
+	}
+
+	SolveInPlace(inverse, nThreads);
+	return inverse;
+}
+
+template <class T>
+void LU<T>::ApplyPivots(Dense<T>& b) const
+{
+	unsigned int nrhs = b.Cols();
+	T* x = b.Data();
+
+	for (unsigned int i(0); i < n; i++)
+	{
+		if (pivots[i] != i)
+		{
+			swap_ranges(x + static_cast<size_t>(i)*nrhs, x + static_cast<size_t>(i + 1)*nrhs, x + static_cast<size_t>(pivots[i])*nrhs);
+		}
+	}
+}
+
+// forward substitution with the unit lower factor
+// single right-hand sides use row dot products, several use BlockSize row blocks
+// whose off-diagonal part is applied through Gemm
+template <class T>
+void LU<T>::SolveLower(Dense<T>& b, unsigned int nThreads) const
+{
+	const T* l = factors.Data();
+	unsigned int nrhs = b.Cols();
+	T* x = b.Data();
+
+	if (nrhs == 1)
+	{
+		for (unsigned int i(1); i < n; i++)
+		{
+			const T* rowL = l + static_cast<size_t>(i)*n;
+			T sum = x[i];
+			for (unsigned int j(0); j < i; j++)
+			{
+				sum -= rowL[j] * x[j];
+			}
+			x[i] = sum;
+		}
+		return;
+	}
+
+	for (unsigned int i0(0); i0 < n; i0 += BlockSize)
+	{
+		unsigned int ib = (n - i0 < BlockSize) ? n - i0 : BlockSize;
+
+		if (i0 > 0)
+		{
+			Gemm<T>::Multiply(ib, nrhs, i0,
+				static_cast<T>(-1),
+				l + static_cast<size_t>(i0)*n, n, 1,
+				x, nrhs, 1,
+				static_cast<T>(1),
+				x + static_cast<size_t>(i0)*nrhs, nrhs, 1,
+				nThreads);
+		}
+
+		for (unsigned int i(i0 + 1); i < i0 + ib; i++)
+		{
+			T* rowX = x + static_cast<size_t>(i)*nrhs;
+			for (unsigned int j(i0); j < i; j++)
+			{
+				T factor = l[static_cast<size_t>(i)*n + j];
+				const T* rowJ = x + static_cast<size_t>(j)*nrhs;
+				for (unsigned int col(0); col < nrhs; col++)
+				{
+					rowX[col] -= factor * rowJ[col];
+				}
+			}
+		}
+	}
+}
+
+// back substitution with the upper factor, blocked the same way as SolveLower
+template <class T>
+void LU<T>::SolveUpper(Dense<T>& b, unsigned int nThreads) const
+{
+	const T* u = factors.Data();
+	unsigned int nrhs = b.Cols();
+	T* x = b.Data();
+
+	if (nrhs == 1)
+	{
+		for (unsigned int i(n); i-- > 0;)
+		{
+			const T* rowU = u + static_cast<size_t>(i)*n;
+			T sum = x[i];
+			for (unsigned int j(i + 1); j < n; j++)
+			{
+				sum -= rowU[j] * x[j];
+			}
+			x[i] = sum / rowU[i];
+		}
+		return;
+	}
+
+	unsigned int blockCount = (n + BlockSize - 1) / BlockSize;
+	for (unsigned int block(blockCount); block-- > 0;)
+	{
+		unsigned int i0 = block * BlockSize;
+		unsigned int i1 = (n - i0 < BlockSize) ? n : i0 + BlockSize;
+
+		if (i1 < n)
+		{
+			Gemm<T>::Multiply(i1 - i0, nrhs, n - i1,
+				static_cast<T>(-1),
+				u + static_cast<size_t>(i0)*n + i1, n, 1,
+				x + static_cast<size_t>(i1)*nrhs, nrhs, 1,
+				static_cast<T>(1),
+				x + static_cast<size_t>(i0)*nrhs, nrhs, 1,
+				nThreads);
+		}
+
+		for (unsigned int i(i1); i-- > i0;)
+		{
+			T* rowX = x + static_cast<size_t>(i)*nrhs;
+			for (unsigned int j(i + 1); j < i1; j++)
+			{
+				T factor = u[static_cast<size_t>(i)*n + j];
+				const T* rowJ = x + static_cast<size_t>(j)*nrhs;
+				for (unsigned int col(0); col < nrhs; col++)
+				{
+					rowX[col] -= factor * rowJ[col];
+				}
+			}
+
+			T diagonal = u[static_cast<size_t>(i)*n + i];
+			for (unsigned int col(0); col < nrhs; col++)
+			{
+				rowX[col] /= diagonal;
+			}
+		}
+	}
+}
+#pragma endregion
+
+#endif // !_LU_CPP_
@@ -0,0 +1,57 @@
+#ifndef _LU_H_
+#define _LU_H_
+
+#include "../Numero.Definitions/DataTypeDefines.h"
+#include "Dense.h"
+#include <vector>
+
+namespace Numero
+{
+	using namespace std;
+	using namespace Definitions;
+
+	namespace DataTypes
+	{
+		// LU class
+		// LU factorization with partial pivoting, P*A = L*U
+		// blocked right-looking algorithm - panels are factored in place and the
+		// trailing matrix is updated through the Gemm engine
+		template <class T>
+		class LU
+		{
+		private:
+			unsigned int n;
+			Dense<T> factors;				// unit lower L below the diagonal, U on and above it
+			vector<unsigned int> pivots;	// row i was interchanged with row pivots[i]
+			int pivotSign;
+			bool singular;
+
+			void Factorize(unsigned int nThreads);
+			void FactorPanel(unsigned int startCol, unsigned int width);
+
+			void ApplyPivots(Dense<T>& b) const;
+			void SolveLower(Dense<T>& b, unsigned int nThreads) const;
+			void SolveUpper(Dense<T>& b, unsigned int nThreads) const;
+
+		public:
+			// panel width of the blocked factorization
+			static const unsigned int BlockSize = 64;
+
+			// --- constructors
+			explicit LU(const Dense<T>& matrix, unsigned int nThreads = 0);
+
+			bool IsSingular() const;
+			T Determinant() const;
+
+			// solves A*X = B for every column of B, A must not be singular
+			Dense<T> Solve(const Dense<T>& b, unsigned int nThreads = 0) const;
+			void SolveInPlace(Dense<T>& b, unsigned int nThreads = 0) const;
+			Dense<T> Inverse(unsigned int nThreads = 0) const;
+
+			const Dense<T>& Factors() const;
+			const vector<unsigned int>& Pivots() const;
+		};
+	}
+}
+
+#endif // !_LU_H_
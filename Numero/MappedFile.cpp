@@ -0,0 +1,146 @@
+#include "MappedFile.h"
+
+#ifdef _WIN32
+#ifndef NOMINMAX
+#define NOMINMAX
+#endif
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#endif
+
+using namespace Numero;
+using namespace Numero::DataTypes;
+
+#pragma region CONSTRUCTORS
+#ifdef _WIN32
+MappedFile::MappedFile()
+	: data(nullptr), size(0), file(INVALID_HANDLE_VALUE), mapping(nullptr)
+{
+}
+#else
+MappedFile::MappedFile()
+	: data(nullptr), size(0), descriptor(-1)
+{
+}
+#endif
+
+MappedFile::MappedFile(const string& path)
+	: MappedFile()
+{
+	Open(path);
+}
+
+MappedFile::~MappedFile()
+{
+	Close();
+}
+#pragma endregion
+
+
+#pragma region MAPPING
+#ifdef _WIN32
+bool MappedFile::Open(const string& path)
+{
+	Close();
+
+	file = CreateFileA(path.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING, FILE_FLAG_SEQUENTIAL_SCAN, nullptr);
+	if (file == INVALID_HANDLE_VALUE)
+		return false;
+
+	LARGE_INTEGER fileSize;
+	if (!GetFileSizeEx(file, &fileSize))
+	{
+		Close();
+		return false;
+	}
+
+	size = static_cast<size_t>(fileSize.QuadPart);
+	if (size == 0)
+		return true;
+
+	mapping = CreateFileMappingA(file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+	if (mapping != nullptr)
+		data = static_cast<const char*>(MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0));
+
+	if (data == nullptr)
+	{
+		Close();
+		return false;
+	}
+	return true;
+}
+
+void MappedFile::Close()
+{
+	if (data != nullptr)
+		UnmapViewOfFile(data);
+	if (mapping != nullptr)
+		CloseHandle(mapping);
+	if (file != INVALID_HANDLE_VALUE)
+		CloseHandle(file);
+
+	data = nullptr;
+	size = 0;
+	mapping = nullptr;
+	file = INVALID_HANDLE_VALUE;
+}
+
+bool MappedFile::IsOpen() const
+{
+	return file != INVALID_HANDLE_VALUE;
+}
+#else
+bool MappedFile::Open(const string& path)
+{
+	Close();
+
+	descriptor = open(path.c_str(), O_RDONLY);
+	if (descriptor < 0)
+		return false;
+
+	struct stat status;
+	if (fstat(descriptor, &status) != 0)
+	{
+		Close();
+		return false;
+	}
+
+	size = static_cast<size_t>(status.st_size);
+	if (size == 0)
+		return true;
+
+	void* address = mmap(nullptr, size, PROT_READ, MAP_PRIVATE, descriptor, 0);
+	if (address == MAP_FAILED)
+	{
+		Close();
+		return false;
+	}
+
+	// the whole file is about to be read, by several threads at once
+	madvise(address, size, MADV_WILLNEED);
+	data = static_cast<const char*>(address);
+	return true;
+}
+
+void MappedFile::Close()
+{
+	if (data != nullptr)
+		munmap(const_cast<char*>(data), size);
+	if (descriptor >= 0)
+		close(descriptor);
+
+	data = nullptr;
+	size = 0;
+	descriptor = -1;
+}
+
+bool MappedFile::IsOpen() const
+{
+	return descriptor >= 0;
+}
+#endif
+#pragma endregion
@@ -0,0 +1,51 @@
+#ifndef _MAPPED_FILE_H_
+#define _MAPPED_FILE_H_
+
+#include "../Numero.Definitions/DataTypeDefines.h"
+#include <string>
+#include <cstddef>
+
+namespace Numero
+{
+	using namespace std;
+	using namespace Definitions;
+
+	namespace DataTypes
+	{
+		// MappedFile class
+		// read-only memory mapping of a whole file, so loaders parse the page cache in place without copies
+		// and several threads read different parts of the file at once. the mapping lives until Close or destruction
+		class MappedFile
+		{
+		private:
+			const char* data;
+			size_t size;
+#ifdef _WIN32
+			void* file;
+			void* mapping;
+#else
+			int descriptor;
+#endif
+
+		public:
+			// --- constructors / destructor
+			MappedFile();
+			explicit MappedFile(const string& path);
+			~MappedFile();
+
+			MappedFile(const MappedFile&) = delete;
+			MappedFile& operator=(const MappedFile&) = delete;
+
+			// maps the file, closing any previous mapping - false when it cannot be opened or mapped
+			bool Open(const string& path);
+			void Close();
+
+			// an empty file is open with a null Data() and a Size() of zero
+			bool IsOpen() const;
+			const char* Data() const { return data; }
+			size_t Size() const { return size; }
+		};
+	}
+}
+
+#endif // !_MAPPED_FILE_H_
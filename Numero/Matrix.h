@@ -24,6 +24,9 @@ namespace Numero
 		public:
 			Matrix(unsigned int rows, unsigned int cols) : nRows(rows), nCols(cols) {};
 
+			unsigned int Rows() const { return nRows; }
+			unsigned int Cols() const { return nCols; }
+
 			virtual T GetValue(unsigned int row, unsigned int col) const = 0;
 			virtual void SetValue(unsigned int row, unsigned int col, T value) = 0;
 
@@ -0,0 +1,483 @@
+#ifndef _MATRIX_MARKET_CPP_
+#define _MATRIX_MARKET_CPP_
+
+#include <assert.h>
+#include <charconv>
+#include <algorithm>
+#include <fstream>
+#include <sstream>
+#include <limits>
+#include <cctype>
+#include <type_traits>
+#include "MatrixMarket.h"
+#include "MappedFile.h"
+#include "Sparse.cpp"
+#include "Dense.cpp"
+#include "TextFormat.cpp"
+#include "ThreadPool.h"
+
+using namespace Numero;
+using namespace Numero::DataTypes;
+
+#pragma region HEADER
+// %%MatrixMarket matrix <coordinate|array> <real|double|integer|pattern> <general|symmetric|skew-symmetric|hermitian>
+// then comment lines starting with % and the size line - rows cols [entries]
+inline bool MatrixMarket::ParseHeader(const char* text, size_t length, MatrixMarketHeader& header)
+{
+	if (length == 0)
+		return false;
+
+	const char* end = text + length;
+	const char* lineEnd = find(text, end, '\n');
+	string banner(text, lineEnd);
+	transform(banner.begin(), banner.end(), banner.begin(), [](char c) { return static_cast<char>(tolower(static_cast<unsigned char>(c))); });
+
+	istringstream tokens(banner);
+	string tag, object, format, field, symmetry;
+	tokens >> tag >> object >> format >> field >> symmetry;
+	if (tag != "%%matrixmarket" || object != "matrix")
+		return false;
+
+	if (format != "coordinate" && format != "array")
+		return false;
+	if (field != "real" && field != "double" && field != "integer" && field != "pattern")
+		return false;
+	if (symmetry != "general" && symmetry != "symmetric" && symmetry != "skew-symmetric" && symmetry != "hermitian")
+		return false;
+
+	header.coordinate = (format == "coordinate");
+	header.pattern = (field == "pattern");
+	header.symmetric = (symmetry != "general");
+	header.skew = (symmetry == "skew-symmetric");
+	if (header.pattern && !header.coordinate)
+		return false;
+
+	// comments and blank lines up to the size line
+	const char* p = lineEnd;
+	while (p < end && (*p == '\n' || *p == '\r' || *p == ' ' || *p == '\t' || *p == '%'))
+		p = (*p == '%') ? find(p, end, '\n') : p + 1;
+
+	size_t sizes[3] = { 0, 0, 0 };
+	unsigned int expected = header.coordinate ? 3 : 2;
+	for (unsigned int i(0); i < expected; i++)
+	{
+		while (p < end && (*p == ' ' || *p == '\t'))
+			p++;
+		from_chars_result parsed = from_chars(p, end, sizes[i]);
+		if (parsed.ec != errc())
+			return false;
+		p = parsed.ptr;
+	}
+
+	if (sizes[0] > 0xFFFFFFFFu || sizes[1] > 0xFFFFFFFFu || (header.symmetric && sizes[0] != sizes[1]))
+		return false;
+
+	header.rows = static_cast<unsigned int>(sizes[0]);
+	header.cols = static_cast<unsigned int>(sizes[1]);
+	if (header.coordinate)
+		header.entries = sizes[2];
+	else if (!header.symmetric)
+		header.entries = sizes[0] * sizes[1];
+	else
+		header.entries = header.skew ? sizes[0] * (sizes[0] - 1) / 2 : sizes[0] * (sizes[0] + 1) / 2;
+
+	header.bodyOffset = find(p, end, '\n') - text;
+	return true;
+}
+
+inline bool MatrixMarket::ReadHeader(const string& path, MatrixMarketHeader& header)
+{
+	MappedFile file(path);
+	return file.IsOpen() && ParseHeader(file.Data(), file.Size(), header);
+}
+#pragma endregion
+
+
+#pragma region PARSING
+inline void MatrixMarket::SplitLines(const char* begin, const char* end, unsigned int chunks, vector<const char*>& bounds)
+{
+	bounds.assign(1, begin);
+	size_t length = end - begin;
+	for (unsigned int chunk(1); chunk < chunks; chunk++)
+	{
+		const char* target = begin + static_cast<size_t>(static_cast<double>(length) * chunk / chunks);
+		if (target < bounds.back())
+			target = bounds.back();
+		target = find(target, end, '\n');
+		bounds.push_back((target == end) ? end : target + 1);
+	}
+	bounds.push_back(end);
+}
+
+inline size_t MatrixMarket::LineOf(const char* text, const char* position)
+{
+	return static_cast<size_t>(count(text, position, '\n')) + 1;
+}
+
+inline bool MatrixMarket::AtLineEnd(const char*& p, const char* stop)
+{
+	while (p < stop && (*p == ' ' || *p == '\t' || *p == '\r'))
+		p++;
+	return p == stop || *p == '\n';
+}
+
+inline unsigned int MatrixMarket::ParseThreads(size_t bytes, unsigned int nThreads)
+{
+	unsigned int poolThreads = ThreadPool::Global().ThreadCount();
+	if (bytes < ParallelParseThreshold)
+		return 1;
+	return (nThreads == 0 || nThreads > poolThreads) ? poolThreads : nThreads;
+}
+
+// every chunk parses its lines into its own batch, the batches are then copied in file order into one
+template <class T>
+bool MatrixMarket::ParseTriplets(const char* text, size_t length, const MatrixMarketHeader& header,
+	vector<SparseValueTriplet<T> >& triplets, unsigned int nThreads, size_t* errorLine)
+{
+	typedef SparseValueTriplet<T> Triplet;
+
+	const char* begin = text + header.bodyOffset;
+	const char* end = text + length;
+	ThreadPool& pool = ThreadPool::Global();
+	unsigned int threads = ParseThreads(end - begin, nThreads);
+	unsigned int chunks = (threads == 1) ? 1 : threads * 4;
+
+	vector<const char*> bounds;
+	SplitLines(begin, end, chunks, bounds);
+
+	vector<vector<Triplet> > parts(chunks);
+	vector<size_t> lines(chunks, 0);
+	vector<const char*> failed(chunks, nullptr);
+	double entriesPerByte = (end > begin) ? static_cast<double>(header.entries) / (end - begin) : 0;
+
+	pool.ParallelFor(chunks, [&](unsigned int chunk)
+	{
+		const char* p = bounds[chunk];
+		const char* stop = bounds[chunk + 1];
+		vector<Triplet>& part = parts[chunk];
+		part.reserve(static_cast<size_t>(entriesPerByte * (stop - p) * (header.symmetric ? 2 : 1)) + 16);
+		size_t count = 0;
+		const char* line = p;
+
+		while (true)
+		{
+			while (p < stop && (*p == ' ' || *p == '\t' || *p == '\r' || *p == '\n'))
+				p++;
+			if (p == stop)
+				break;
+			line = p;
+			if (*p == '%')
+			{
+				p = find(p, stop, '\n');
+				continue;
+			}
+
+			unsigned int row, col;
+			T value = static_cast<T>(1);
+			from_chars_result parsed = from_chars(p, stop, row);
+			if (parsed.ec != errc())
+				break;
+			p = parsed.ptr;
+			while (p < stop && (*p == ' ' || *p == '\t'))
+				p++;
+			parsed = from_chars(p, stop, col);
+			if (parsed.ec != errc())
+				break;
+			p = parsed.ptr;
+			if (!header.pattern)
+			{
+				while (p < stop && (*p == ' ' || *p == '\t'))
+					p++;
+				if (!TextFormat::ParseValue(p, stop, value))
+					break;
+			}
+			if (!AtLineEnd(p, stop) || row == 0 || row > header.rows || col == 0 || col > header.cols)
+				break;
+
+			part.push_back(Triplet(row - 1, col - 1, value));
+			if (header.symmetric && row != col)
+				part.push_back(Triplet(col - 1, row - 1, header.skew ? static_cast<T>(-value) : value));
+			count++;
+		}
+
+		if (p != stop)
+			failed[chunk] = line;
+		lines[chunk] = count;
+	}, threads);
+
+	vector<size_t> offsets(chunks + 1, 0);
+	size_t entries = 0;
+	for (unsigned int chunk(0); chunk < chunks; chunk++)
+	{
+		if (failed[chunk] != nullptr)
+		{
+			if (errorLine != nullptr)
+				*errorLine = LineOf(text, failed[chunk]);
+			return false;
+		}
+		entries += lines[chunk];
+		offsets[chunk + 1] = offsets[chunk] + parts[chunk].size();
+	}
+	if (entries != header.entries)
+		return false;
+
+	triplets.resize(offsets[chunks]);
+	pool.ParallelFor(chunks, [&](unsigned int chunk)
+	{
+		copy(parts[chunk].begin(), parts[chunk].end(), triplets.begin() + offsets[chunk]);
+		vector<Triplet>().swap(parts[chunk]);
+	}, threads);
+
+	return true;
+}
+
+// values run down the columns - of the whole matrix, or of the lower triangle for the symmetric kinds,
+// whose upper triangle is the mirror. every chunk parses its values, then places them from its first index
+template <class T>
+bool MatrixMarket::ParseArray(const char* text, size_t length, const MatrixMarketHeader& header, Dense<T>& matrix, unsigned int nThreads,
+	size_t* errorLine)
+{
+	const char* begin = text + header.bodyOffset;
+	const char* end = text + length;
+	ThreadPool& pool = ThreadPool::Global();
+	unsigned int threads = ParseThreads(end - begin, nThreads);
+	unsigned int chunks = (threads == 1) ? 1 : threads * 4;
+
+	vector<const char*> bounds;
+	SplitLines(begin, end, chunks, bounds);
+
+	vector<vector<T> > parts(chunks);
+	vector<const char*> failed(chunks, nullptr);
+
+	pool.ParallelFor(chunks, [&](unsigned int chunk)
+	{
+		const char* p = bounds[chunk];
+		const char* stop = bounds[chunk + 1];
+		vector<T>& part = parts[chunk];
+		const char* line = p;
+
+		while (true)
+		{
+			while (p < stop && (*p == ' ' || *p == '\t' || *p == '\r' || *p == '\n'))
+				p++;
+			if (p == stop)
+				break;
+			line = p;
+			if (*p == '%')
+			{
+				p = find(p, stop, '\n');
+				continue;
+			}
+
+			T value;
+			if (!TextFormat::ParseValue(p, stop, value) || !AtLineEnd(p, stop))
+				break;
+			part.push_back(value);
+		}
+
+		if (p != stop)
+			failed[chunk] = line;
+	}, threads);
+
+	vector<size_t> offsets(chunks + 1, 0);
+	for (unsigned int chunk(0); chunk < chunks; chunk++)
+	{
+		if (failed[chunk] != nullptr)
+		{
+			if (errorLine != nullptr)
+				*errorLine = LineOf(text, failed[chunk]);
+			return false;
+		}
+		offsets[chunk + 1] = offsets[chunk] + parts[chunk].size();
+	}
+	if (offsets[chunks] != header.entries)
+		return false;
+
+	unsigned int rows = header.rows;
+	unsigned int cols = header.cols;
+	unsigned int skip = header.skew ? 1 : 0;
+	matrix.Resize(rows, cols);
+	T* data = matrix.Data();
+	if (header.skew)
+	{
+		for (unsigned int i(0); i < rows; i++)
+			data[static_cast<size_t>(i) * cols + i] = static_cast<T>(0);
+	}
+
+	pool.ParallelFor(chunks, [&](unsigned int chunk)
+	{
+		const vector<T>& part = parts[chunk];
+		if (part.empty())
+			return;
+
+		// position of the first value of the chunk
+		size_t index = offsets[chunk];
+		unsigned int row, col;
+		if (!header.symmetric)
+		{
+			col = static_cast<unsigned int>(index / rows);
+			row = static_cast<unsigned int>(index % rows);
+		}
+		else
+		{
+			col = 0;
+			while (index >= rows - col - skip)
+			{
+				index -= rows - col - skip;
+				col++;
+			}
+			row = col + skip + static_cast<unsigned int>(index);
+		}
+
+		for (T value : part)
+		{
+			data[static_cast<size_t>(row) * cols + col] = value;
+			if (header.symmetric && row != col)
+				data[static_cast<size_t>(col) * cols + row] = header.skew ? static_cast<T>(-value) : value;
+
+			if (++row == rows)
+			{
+				col++;
+				row = header.symmetric ? col + skip : 0;
+			}
+		}
+	}, threads);
+
+	return true;
+}
+
+template <class T>
+bool MatrixMarket::ParseSparse(const char* text, size_t length, Sparse<T>& matrix, unsigned int nThreads, size_t* errorLine)
+{
+	if (errorLine != nullptr)
+		*errorLine = 0;
+
+	MatrixMarketHeader header;
+	if (!ParseHeader(text, length, header))
+		return false;
+
+	vector<SparseValueTriplet<T> > triplets;
+	if (header.coordinate)
+	{
+		if (!ParseTriplets(text, length, header, triplets, nThreads, errorLine))
+			return false;
+	}
+	else
+	{
+		Dense<T> dense;
+		if (!ParseArray(text, length, header, dense, nThreads, errorLine))
+			return false;
+
+		const T* data = dense.Data();
+		for (unsigned int row(0); row < header.rows; row++)
+		{
+			for (unsigned int col(0); col < header.cols; col++)
+			{
+				T value = data[static_cast<size_t>(row) * header.cols + col];
+				if (value != static_cast<T>(0))
+					triplets.push_back(SparseValueTriplet<T>(row, col, value));
+			}
+		}
+	}
+
+	matrix = Sparse<T>(header.rows, header.cols);
+	matrix.Assemble(triplets, nThreads);
+	return true;
+}
+
+template <class T>
+bool MatrixMarket::ParseDense(const char* text, size_t length, Dense<T>& matrix, unsigned int nThreads, size_t* errorLine)
+{
+	if (errorLine != nullptr)
+		*errorLine = 0;
+
+	MatrixMarketHeader header;
+	if (!ParseHeader(text, length, header))
+		return false;
+
+	if (!header.coordinate)
+		return ParseArray(text, length, header, matrix, nThreads, errorLine);
+
+	vector<SparseValueTriplet<T> > triplets;
+	if (!ParseTriplets(text, length, header, triplets, nThreads, errorLine))
+		return false;
+
+	// in file order, so duplicates are summed the same way on any thread count
+	matrix.Resize(header.rows, header.cols);
+	matrix.ResetToConstant(static_cast<T>(0));
+	T* data = matrix.Data();
+	for (const SparseValueTriplet<T>& triplet : triplets)
+		data[static_cast<size_t>(triplet.Row()) * header.cols + triplet.Col()] += triplet.Value();
+
+	return true;
+}
+
+template <class T>
+bool MatrixMarket::ReadSparse(const string& path, Sparse<T>& matrix, unsigned int nThreads, size_t* errorLine)
+{
+	if (errorLine != nullptr)
+		*errorLine = 0;
+
+	MappedFile file(path);
+	return file.IsOpen() && ParseSparse(file.Data(), file.Size(), matrix, nThreads, errorLine);
+}
+
+template <class T>
+bool MatrixMarket::ReadDense(const string& path, Dense<T>& matrix, unsigned int nThreads, size_t* errorLine)
+{
+	if (errorLine != nullptr)
+		*errorLine = 0;
+
+	MappedFile file(path);
+	return file.IsOpen() && ParseDense(file.Data(), file.Size(), matrix, nThreads, errorLine);
+}
+#pragma endregion
+
+
+#pragma region WRITING
+template <class T>
+bool MatrixMarket::WriteSparse(const string& path, const Sparse<T>& matrix)
+{
+	ofstream out(path, ios::binary);
+	if (!out)
+		return false;
+
+	out.precision(numeric_limits<T>::max_digits10);
+	out << "%%MatrixMarket matrix coordinate " << (is_integral<T>::value ? "integer" : "real") << " general\n";
+	out << matrix.Rows() << ' ' << matrix.Cols() << ' ' << matrix.NonZeros() << '\n';
+
+	const unsigned int* offsets = matrix.RowOffsets();
+	const unsigned int* columns = matrix.ColumnIndices();
+	const T* values = matrix.Values();
+	for (unsigned int row(0); row < matrix.Rows(); row++)
+	{
+		for (unsigned int entry(offsets[row]); entry < offsets[row + 1]; entry++)
+			out << row + 1 << ' ' << columns[entry] + 1 << ' ' << values[entry] << '\n';
+	}
+
+	return static_cast<bool>(out);
+}
+
+template <class T>
+bool MatrixMarket::WriteDense(const string& path, const Dense<T>& matrix)
+{
+	ofstream out(path, ios::binary);
+	if (!out)
+		return false;
+
+	out.precision(numeric_limits<T>::max_digits10);
+	out << "%%MatrixMarket matrix array " << (is_integral<T>::value ? "integer" : "real") << " general\n";
+	out << matrix.Rows() << ' ' << matrix.Cols() << '\n';
+
+	const T* data = matrix.Data();
+	for (unsigned int col(0); col < matrix.Cols(); col++)
+	{
+		for (unsigned int row(0); row < matrix.Rows(); row++)
+			out << data[static_cast<size_t>(row) * matrix.Cols() + col] << '\n';
+	}
+
+	return static_cast<bool>(out);
+}
+#pragma endregion
+
+#endif // !_MATRIX_MARKET_CPP_
@@ -0,0 +1,89 @@
+#ifndef _MATRIX_MARKET_H_
+#define _MATRIX_MARKET_H_
+
+#include "../Numero.Definitions/DataTypeDefines.h"
+#include "Sparse.h"
+#include "Dense.h"
+#include "SparseValueTriplet.h"
+#include <vector>
+#include <string>
+
+namespace Numero
+{
+	using namespace std;
+	using namespace Definitions;
+
+	namespace DataTypes
+	{
+		// banner and size line of a Matrix Market file
+		struct MatrixMarketHeader
+		{
+			bool coordinate;		// false for the dense array format
+			bool pattern;			// coordinate entries without values, read as ones
+			bool symmetric;			// only the lower triangle is stored - also set for skew-symmetric and hermitian
+			bool skew;				// the mirrored entries are negated
+			unsigned int rows;
+			unsigned int cols;
+			size_t entries;			// lines of the body - nonzeros as stored, or values of the array
+			size_t bodyOffset;		// first byte after the size line
+		};
+
+		// MatrixMarket class
+		// reader and writer of the Matrix Market exchange format (.mtx), real, integer and pattern fields
+		// the file is memory mapped and its body cut at line ends into chunks that threads parse with from_chars
+		// coordinate chunks produce SparseValueTriplet batches that go straight into the CSR assembly, array chunks
+		// are placed into the Dense storage. chunks keep the file order, so the result does not depend on the thread count
+		// the readers return false when the file cannot be mapped or does not follow the format, and put the 1-based
+		// line of the first malformed body line into errorLine when it is given, 0 when the failure is elsewhere
+		class MatrixMarket
+		{
+		private:
+			// chunk boundaries of [begin, end) at line starts, about equal in bytes
+			static void SplitLines(const char* begin, const char* end, unsigned int chunks, vector<const char*>& bounds);
+			static unsigned int ParseThreads(size_t bytes, unsigned int nThreads);
+			// 1-based line of position in text
+			static size_t LineOf(const char* text, const char* position);
+			// after a value - only blanks up to the line end
+			static bool AtLineEnd(const char*& p, const char* stop);
+
+			// the body as one batch of 0-based triplets, symmetric files expanded to both triangles
+			template <class T>
+			static bool ParseTriplets(const char* text, size_t length, const MatrixMarketHeader& header,
+				vector<SparseValueTriplet<T> >& triplets, unsigned int nThreads, size_t* errorLine);
+			// the body of an array file into matrix
+			template <class T>
+			static bool ParseArray(const char* text, size_t length, const MatrixMarketHeader& header, Dense<T>& matrix, unsigned int nThreads,
+				size_t* errorLine);
+
+		public:
+			// bodies shorter than this many bytes are parsed on the calling thread
+			static const size_t ParallelParseThreshold = 1 << 20;
+
+			// --- reading
+			static bool ParseHeader(const char* text, size_t length, MatrixMarketHeader& header);
+			static bool ReadHeader(const string& path, MatrixMarketHeader& header);
+
+			// nThreads as in ThreadPool::ParallelFor. duplicates of a coordinate position are summed
+			template <class T>
+			static bool ReadSparse(const string& path, Sparse<T>& matrix, unsigned int nThreads = 0, size_t* errorLine = nullptr);
+			template <class T>
+			static bool ReadDense(const string& path, Dense<T>& matrix, unsigned int nThreads = 0, size_t* errorLine = nullptr);
+
+			// the same on text already in memory
+			template <class T>
+			static bool ParseSparse(const char* text, size_t length, Sparse<T>& matrix, unsigned int nThreads = 0,
+				size_t* errorLine = nullptr);
+			template <class T>
+			static bool ParseDense(const char* text, size_t length, Dense<T>& matrix, unsigned int nThreads = 0,
+				size_t* errorLine = nullptr);
+
+			// --- writing, general symmetry with values printed to round trip
+			template <class T>
+			static bool WriteSparse(const string& path, const Sparse<T>& matrix);
+			template <class T>
+			static bool WriteDense(const string& path, const Dense<T>& matrix);
+		};
+	}
+}
+
+#endif // !_MATRIX_MARKET_H_
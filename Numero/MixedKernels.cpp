@@ -0,0 +1,64 @@
+#include "MixedKernels.h"
+#include <atomic>
+
+using namespace Numero;
+using namespace Numero::DataTypes;
+
+#pragma region HELPERS
+namespace
+{
+	atomic<MixedKernels::SelectionHook>& Hook()
+	{
+		static atomic<MixedKernels::SelectionHook> hook(nullptr);
+		return hook;
+	}
+
+	MixedSelection& Last()
+	{
+		static thread_local MixedSelection last = { "", MixedKernel::None, 0, 0, 0, 0 };
+		return last;
+	}
+}
+#pragma endregion
+
+
+#pragma region SELECTION
+MixedKernel MixedKernels::SelectProduct(unsigned int sparseRows, unsigned int sparseCols, unsigned long long nonZeros, unsigned int denseCount)
+{
+	double elements = static_cast<double>(sparseRows) * sparseCols;
+	double sparseCost = static_cast<double>(nonZeros) * denseCount;
+	double denseCost = elements * (ConversionCost + GemmMultiplyAddCost * denseCount);
+
+	return (denseCost < sparseCost) ? MixedKernel::DenseGemm : MixedKernel::SparseRows;
+}
+
+void MixedKernels::Record(const MixedSelection& selection)
+{
+	Last() = selection;
+
+	SelectionHook hook = Hook().load(memory_order_acquire);
+	if (hook != nullptr)
+		hook(selection);
+}
+
+MixedSelection MixedKernels::LastSelection()
+{
+	return Last();
+}
+
+MixedKernels::SelectionHook MixedKernels::SetHook(SelectionHook hook)
+{
+	return Hook().exchange(hook, memory_order_acq_rel);
+}
+
+const char* MixedKernels::KernelName(MixedKernel kernel)
+{
+	switch (kernel)
+	{
+	case MixedKernel::SparseRows: return "sparse rows";
+	case MixedKernel::DenseGemm: return "dense gemm";
+	case MixedKernel::Scatter: return "scatter";
+	default: return "none";
+	}
+}
+#pragma endregion
@@ -0,0 +1,67 @@
+#ifndef _MIXED_KERNELS_H_
+#define _MIXED_KERNELS_H_
+
+#include "../Numero.Definitions/DataTypeDefines.h"
+
+namespace Numero
+{
+	using namespace std;
+	using namespace Definitions;
+
+	namespace DataTypes
+	{
+		// kernels the operators between Dense and Sparse operands choose from
+		enum class MixedKernel
+		{
+			None = 0,		// no selection made yet
+			SparseRows,		// the CSR rows of the sparse operand against the dense one
+			DenseGemm,		// the sparse operand converted to Dense and multiplied through Gemm
+			Scatter			// the dense operand copied and the nonzeros added into it
+		};
+
+		// one kernel choice of a mixed operator
+		struct MixedSelection
+		{
+			const char* operation;		// "sparse*dense", "dense*sparse", "sparse+dense" or "dense+sparse"
+			MixedKernel kernel;
+			unsigned int rows;			// of the result
+			unsigned int inner;			// the shared dimension of a product, 0 for sums
+			unsigned int cols;			// of the result
+			double density;				// nonzeros of the sparse operand over its elements, measured at the call
+		};
+
+		// MixedKernels class
+		// kernel selection of the mixed Dense / Sparse operators from the density and shape of the operands,
+		// and the log of the choices - the last one of every thread can be queried, and a hook sees all of them
+		// a product costs nnz * k multiply-adds in the sparse kernel, where k is the column count of the dense
+		// operand, against a conversion of the sparse operand and its full Gemm. the constants below are relative
+		// costs measured on the sparse.mixed benchmarks
+		class MixedKernels
+		{
+		public:
+			typedef void(*SelectionHook)(const MixedSelection& selection);
+
+			// cost of one Gemm multiply-add and of writing one element of the converted operand, in multiply-adds
+			// of the sparse kernel. the sparse rows sustain about 1.1 billion multiply-adds per second against
+			// Gemm's 1.6 billion, so on these numbers the dense kernel only wins above about 70% density
+			static constexpr double GemmMultiplyAddCost = 0.7;
+			static constexpr double ConversionCost = 1.0;
+
+			// the kernel of a product of a sparseRows x sparseCols operand holding nonZeros with denseCount
+			// dense vectors - the columns of the right operand of Sparse * Dense, the rows of the left of Dense * Sparse
+			static MixedKernel SelectProduct(unsigned int sparseRows, unsigned int sparseCols, unsigned long long nonZeros, unsigned int denseCount);
+
+			// keeps the selection as the last one of the calling thread and passes it to the hook
+			static void Record(const MixedSelection& selection);
+			// the last selection of the calling thread, kernel None before the first
+			static MixedSelection LastSelection();
+
+			// installs a hook called on the selecting thread after every selection, null removes it - returns the previous hook
+			static SelectionHook SetHook(SelectionHook hook);
+
+			static const char* KernelName(MixedKernel kernel);
+		};
+	}
+}
+
+#endif // !_MIXED_KERNELS_H_
@@ -0,0 +1,378 @@
+#ifndef _QR_CPP_
+#define _QR_CPP_
+
+#include <assert.h>
+#include <cmath>
+#include <limits>
+#include <algorithm>
+#include <type_traits>
+#include "QR.h"
+#include "Dense.cpp"
+#include "Gemm.cpp"
+#include "Householder.cpp"
+#include "ThreadPool.h"
+
+using namespace Numero;
+using namespace Numero::DataTypes;
+
+#pragma region FACTORIZATION
+template <class T>
+QR<T>::QR(const Dense<T>& matrix, bool columnPivoting, unsigned int nThreads)
+	: QR(matrix.Data(), matrix.Rows(), matrix.Cols(), columnPivoting, nThreads)
+{
+}
+
+template <class T>
+QR<T>::QR(const T* data, unsigned int rows, unsigned int cols, bool columnPivoting, unsigned int nThreads)
+	: m(rows), n(cols), factors(rows, cols, Uninitialized), tau(min(rows, cols)), permutation(cols), pivoted(columnPivoting)
+{
+	static_assert(is_floating_point<T>::value, "QR factorization needs a floating point type");
+
+	copy(data, data + static_cast<size_t>(rows) * cols, factors.Data());
+	for (unsigned int j(0); j < n; j++)
+		permutation[j] = j;
+
+	if (pivoted)
+		FactorPivoted();
+	else
+		Factorize(nThreads);
+}
+
+// right-looking blocked factorization
+// for every panel of BlockSize columns: generate its reflectors, applying each one to the rest of the panel,
+// and apply the transpose of their product to the trailing columns
+// reflector j is column j below the diagonal, element p of it at factors(p, j)
+template <class T>
+void QR<T>::Factorize(unsigned int nThreads)
+{
+	unsigned int k = min(m, n);
+	vector<T> work(n);
+
+	for (unsigned int k0(0); k0 < k; k0 += BlockSize)
+	{
+		unsigned int kb = (k - k0 < BlockSize) ? k - k0 : BlockSize;
+		for (unsigned int j(k0); j < k0 + kb; j++)
+			Reflect(j, k0 + kb, work);
+
+		unsigned int trailing = n - k0 - kb;
+		if (trailing > 0)
+		{
+			Householder<T>::ApplyTranspose(factors.Data() + k0, n, 1, kb, k0, tau.data() + k0,
+				factors.Data() + k0 + kb, m, trailing, n, nThreads);
+		}
+	}
+}
+
+// the column of largest remaining norm is swapped in before every reflector, the norms of the others
+// are downdated by the new row of R and recomputed once cancellation has eaten half the digits
+template <class T>
+void QR<T>::FactorPivoted()
+{
+	T* a = factors.Data();
+	unsigned int k = min(m, n);
+	vector<T> norms(n, static_cast<T>(0));
+	vector<T> work(n);
+	const T recomputeThreshold = sqrt(numeric_limits<T>::epsilon());
+
+	for (unsigned int i(0); i < m; i++)
+	{
+		const T* row = a + static_cast<size_t>(i) * n;
+		for (unsigned int j(0); j < n; j++)
+			norms[j] += row[j] * row[j];
+	}
+	for (unsigned int j(0); j < n; j++)
+		norms[j] = sqrt(norms[j]);
+	vector<T> original(norms);
+
+	for (unsigned int j(0); j < k; j++)
+	{
+		unsigned int pivot = static_cast<unsigned int>(max_element(norms.begin() + j, norms.end()) - norms.begin());
+		if (pivot != j)
+		{
+			for (unsigned int i(0); i < m; i++)
+				swap(a[static_cast<size_t>(i) * n + j], a[static_cast<size_t>(i) * n + pivot]);
+			swap(norms[j], norms[pivot]);
+			swap(original[j], original[pivot]);
+			swap(permutation[j], permutation[pivot]);
+		}
+
+		Reflect(j, n, work);
+
+		for (unsigned int col(j + 1); col < n; col++)
+		{
+			if (norms[col] == static_cast<T>(0))
+				continue;
+
+			T ratio = abs(a[static_cast<size_t>(j) * n + col]) / norms[col];
+			T remaining = max(static_cast<T>(0), (static_cast<T>(1) - ratio) * (static_cast<T>(1) + ratio));
+			T relative = norms[col] / original[col];
+			if (remaining * relative * relative > recomputeThreshold)
+			{
+				norms[col] *= sqrt(remaining);
+				continue;
+			}
+
+			T sum = static_cast<T>(0);
+			for (unsigned int i(j + 1); i < m; i++)
+				sum += a[static_cast<size_t>(i) * n + col] * a[static_cast<size_t>(i) * n + col];
+			norms[col] = sqrt(sum);
+			original[col] = norms[col];
+		}
+	}
+}
+
+// H = I - tau*v*v' with v(0) = 1 maps x = A(j:m, j) onto beta*e1, beta = -sign(x(0))*||x||
+// v(1:) overwrites x(1:) and beta its head. a column that is zero below the diagonal gives H = I
+// the columns (j, endCol) get A -= tau*v*(v'*A), accumulating v'*A row by row along the storage
+template <class T>
+void QR<T>::Reflect(unsigned int j, unsigned int endCol, vector<T>& work)
+{
+	T* a = factors.Data();
+	T alpha = a[static_cast<size_t>(j) * n + j];
+
+	T tail = static_cast<T>(0);
+	for (unsigned int i(j + 1); i < m; i++)
+		tail += a[static_cast<size_t>(i) * n + j] * a[static_cast<size_t>(i) * n + j];
+
+	if (tail == static_cast<T>(0))
+	{
+		tau[j] = static_cast<T>(0);
+		return;
+	}
+
+	T beta = -copysign(sqrt(alpha * alpha + tail), alpha);
+	tau[j] = (beta - alpha) / beta;
+	T scale = static_cast<T>(1) / (alpha - beta);
+	for (unsigned int i(j + 1); i < m; i++)
+		a[static_cast<size_t>(i) * n + j] *= scale;
+	a[static_cast<size_t>(j) * n + j] = beta;
+
+	if (endCol <= j + 1)
+		return;
+
+	unsigned int width = endCol - j - 1;
+	T* w = work.data();
+	T* rowJ = a + static_cast<size_t>(j) * n + j + 1;
+	copy(rowJ, rowJ + width, w);
+	for (unsigned int i(j + 1); i < m; i++)
+	{
+		const T* rowI = a + static_cast<size_t>(i) * n;
+		T vi = rowI[j];
+		for (unsigned int col(0); col < width; col++)
+			w[col] += vi * rowI[j + 1 + col];
+	}
+
+	for (unsigned int col(0); col < width; col++)
+	{
+		w[col] *= tau[j];
+		rowJ[col] -= w[col];
+	}
+	for (unsigned int i(j + 1); i < m; i++)
+	{
+		T* rowI = a + static_cast<size_t>(i) * n;
+		T vi = rowI[j];
+		for (unsigned int col(0); col < width; col++)
+			rowI[j + 1 + col] -= vi * w[col];
+	}
+}
+#pragma endregion
+
+
+#pragma region QUERIES
+template <class T>
+unsigned int QR<T>::Rank(T tolerance) const
+{
+	unsigned int k = min(m, n);
+	if (k == 0)
+		return 0;
+
+	if (tolerance < static_cast<T>(0))
+		tolerance = static_cast<T>(max(m, n)) * numeric_limits<T>::epsilon();
+
+	const T* a = factors.Data();
+	T threshold = tolerance * abs(a[0]);
+	unsigned int rank = 0;
+	for (unsigned int i(0); i < k; i++)
+	{
+		if (abs(a[static_cast<size_t>(i) * n + i]) > threshold)
+			rank++;
+	}
+	return rank;
+}
+
+template <class T>
+void QR<T>::ApplyQTranspose(Dense<T>& b, unsigned int nThreads) const
+{
+	assert(b.Rows() == m);
+
+	Householder<T>::ApplyTranspose(factors.Data(), n, 1, min(m, n), 0, tau.data(), b.Data(), m, b.Cols(), b.Cols(), nThreads);
+}
+
+template <class T>
+void QR<T>::ApplyQ(Dense<T>& b, unsigned int nThreads) const
+{
+	assert(b.Rows() == m);
+
+	Householder<T>::Apply(factors.Data(), n, 1, min(m, n), 0, tau.data(), b.Data(), m, b.Cols(), b.Cols(), nThreads);
+}
+
+template <class T>
+Dense<T> QR<T>::Q(unsigned int nThreads) const
+{
+	unsigned int k = min(m, n);
+	Dense<T> q(m, k);
+	for (unsigned int i(0); i < k; i++)
+		q.Data()[static_cast<size_t>(i) * k + i] = static_cast<T>(1);
+
+	ApplyQ(q, nThreads);
+	return q;
+}
+
+template <class T>
+Dense<T> QR<T>::R() const
+{
+	unsigned int k = min(m, n);
+	Dense<T> r(k, n);
+	for (unsigned int i(0); i < k; i++)
+	{
+		const T* row = factors.Data() + static_cast<size_t>(i) * n;
+		copy(row + i, row + n, r.Data() + static_cast<size_t>(i) * n + i);
+	}
+	return r;
+}
+
+template <class T>
+const Dense<T>& QR<T>::Factors() const
+{
+	return factors;
+}
+
+template <class T>
+const vector<T>& QR<T>::Tau() const
+{
+	return tau;
+}
+
+template <class T>
+const vector<unsigned int>& QR<T>::Permutation() const
+{
+	return permutation;
+}
+#pragma endregion
+
+
+#pragma region LEAST_SQUARES
+// Q'*B, back substitution with the leading rank x rank block of R, then the rows put back in column order
+template <class T>
+Dense<T> QR<T>::Solve(const Dense<T>& b, unsigned int nThreads) const
+{
+	if (b.Rows() != m)
+		return Dense<T>();
+
+	Dense<T> c(b);
+	ApplyQTranspose(c, nThreads);
+
+	unsigned int rank = pivoted ? Rank() : min(m, n);
+	unsigned int nrhs = b.Cols();
+	const T* a = factors.Data();
+	T* y = c.Data();
+
+	for (unsigned int i(rank); i-- > 0;)
+	{
+		T* rowY = y + static_cast<size_t>(i) * nrhs;
+		const T* rowR = a + static_cast<size_t>(i) * n;
+		for (unsigned int j(i + 1); j < rank; j++)
+		{
+			T factor = rowR[j];
+			const T* rowJ = y + static_cast<size_t>(j) * nrhs;
+			for (unsigned int col(0); col < nrhs; col++)
+				rowY[col] -= factor * rowJ[col];
+		}
+
+		T diagonal = rowR[i];
+		for (unsigned int col(0); col < nrhs; col++)
+			rowY[col] /= diagonal;
+	}
+
+	Dense<T> x(n, nrhs);
+	for (unsigned int j(0); j < rank; j++)
+		copy(y + static_cast<size_t>(j) * nrhs, y + static_cast<size_t>(j + 1) * nrhs, x.Data() + static_cast<size_t>(permutation[j]) * nrhs);
+	return x;
+}
+
+// every level of the reduction tree factors row blocks of about TallSkinnyBlockBytes, which stay in cache through
+// the whole panel factorization, and stacks their R factors and reduced right hand sides for the next level
+// blocks are balanced to within a row and there are at least as many as threads while every block keeps 4 * n rows
+template <class T>
+Dense<T> QR<T>::SolveTallSkinny(const Dense<T>& a, const Dense<T>& b, unsigned int nThreads)
+{
+	if (a.Rows() != b.Rows())
+		return Dense<T>();
+
+	unsigned int cols = max(a.Cols(), 1u);
+	unsigned int nrhs = b.Cols();
+
+	ThreadPool& pool = ThreadPool::Global();
+	unsigned int threads = (nThreads == 0 || nThreads > pool.ThreadCount()) ? pool.ThreadCount() : nThreads;
+	unsigned int minRows = 4 * cols;
+	unsigned int blockRows = max(minRows, static_cast<unsigned int>(TallSkinnyBlockBytes / (static_cast<size_t>(cols) * sizeof(T))));
+
+	Dense<T> levelA;
+	Dense<T> levelB;
+	const Dense<T>* currentA = &a;
+	const Dense<T>* currentB = &b;
+
+	while (true)
+	{
+		unsigned int rows = currentA->Rows();
+		unsigned int blocks = max(rows / blockRows, min(threads, rows / minRows));
+		if (blocks <= 1)
+			break;
+
+		Dense<T> stackedR(blocks * cols, a.Cols());
+		Dense<T> stackedC(blocks * cols, nrhs);
+		const T* dataA = currentA->Data();
+		const T* dataB = currentB->Data();
+
+		pool.ParallelFor(blocks, [&](unsigned int block)
+		{
+			unsigned int begin = static_cast<unsigned int>(static_cast<unsigned long long>(rows) * block / blocks);
+			unsigned int end = static_cast<unsigned int>(static_cast<unsigned long long>(rows) * (block + 1) / blocks);
+
+			QR<T> local(dataA + static_cast<size_t>(begin) * a.Cols(), end - begin, a.Cols(), false, 1);
+			Dense<T> part(end - begin, nrhs, Uninitialized);
+			copy(dataB + static_cast<size_t>(begin) * nrhs, dataB + static_cast<size_t>(end) * nrhs, part.Data());
+			local.ApplyQTranspose(part, 1);
+
+			for (unsigned int i(0); i < a.Cols(); i++)
+			{
+				const T* row = local.factors.Data() + static_cast<size_t>(i) * a.Cols();
+				copy(row + i, row + a.Cols(), stackedR.Data() + (static_cast<size_t>(block) * cols + i) * a.Cols() + i);
+			}
+			copy(part.Data(), part.Data() + static_cast<size_t>(a.Cols()) * nrhs, stackedC.Data() + static_cast<size_t>(block) * cols * nrhs);
+		}, min(blocks, threads));
+
+		levelA = move(stackedR);
+		levelB = move(stackedC);
+		currentA = &levelA;
+		currentB = &levelB;
+	}
+
+	return QR<T>(*currentA, false, nThreads).Solve(*currentB, nThreads);
+}
+
+template <class T>
+Dense<T> Numero::DataTypes::LeastSquares(const Dense<T>& a, const Dense<T>& b, unsigned int nThreads)
+{
+	if (a.Rows() != b.Rows())
+		return Dense<T>();
+
+	bool tallSkinny = a.Rows() >= QR<T>::TallSkinnyRows && a.Rows() >= static_cast<unsigned long long>(QR<T>::TallSkinnyRatio) * a.Cols();
+	if (tallSkinny)
+		return QR<T>::SolveTallSkinny(a, b, nThreads);
+
+	return QR<T>(a, false, nThreads).Solve(b, nThreads);
+}
+#pragma endregion
+
+#endif // !_QR_CPP_
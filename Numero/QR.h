@@ -0,0 +1,90 @@
+#ifndef _QR_H_
+#define _QR_H_
+
+#include "../Numero.Definitions/DataTypeDefines.h"
+#include "Dense.h"
+#include <vector>
+
+namespace Numero
+{
+	using namespace std;
+	using namespace Definitions;
+
+	namespace DataTypes
+	{
+		// QR class
+		// Householder QR factorization of an m x n matrix, A*P = Q*R, for floating point T
+		// blocked right-looking algorithm - every panel of BlockSize reflectors is applied in the compact WY
+		// form H1*H2*...*Hb = I - V*T*V' of Householder<T>, with T upper triangular, so the trailing update and every
+		// application of Q are three Gemm products. Q is never formed unless asked for
+		// with column pivoting the column of largest remaining norm is eliminated next, which orders the diagonal of
+		// R by magnitude and reveals the rank - the pivoted factorization updates the whole trailing matrix after
+		// every reflector to keep the column norms current, so it runs at matrix-vector speed
+		template <class T>
+		class QR
+		{
+		private:
+			unsigned int m;
+			unsigned int n;
+			Dense<T> factors;				// R on and above the diagonal, the reflectors below it with an implicit unit head
+			vector<T> tau;					// reflector i is I - tau[i]*v*v'
+			vector<unsigned int> permutation;	// column j of A*P is column permutation[j] of A
+			bool pivoted;
+
+			QR(const T* data, unsigned int rows, unsigned int cols, bool columnPivoting, unsigned int nThreads);
+
+			void Factorize(unsigned int nThreads);
+			void FactorPivoted();
+
+			// generates the reflector of column j from rows j..m-1 and applies it to the columns (j, endCol)
+			void Reflect(unsigned int j, unsigned int endCol, vector<T>& work);
+
+		public:
+			// reflectors per panel of the blocked factorization
+			static const unsigned int BlockSize = 32;
+
+			// --- constructors
+			explicit QR(const Dense<T>& matrix, bool columnPivoting = false, unsigned int nThreads = 0);
+
+			// diagonal elements of R above tolerance * |R(0,0)| - the default tolerance is max(m, n) * epsilon
+			// meaningful for the pivoted factorization, an upper bound without pivoting
+			unsigned int Rank(T tolerance = static_cast<T>(-1)) const;
+
+			// b = Q'*b and b = Q*b in place, b has m rows
+			void ApplyQTranspose(Dense<T>& b, unsigned int nThreads = 0) const;
+			void ApplyQ(Dense<T>& b, unsigned int nThreads = 0) const;
+
+			// the leading min(m, n) columns of Q, and R as min(m, n) x n
+			Dense<T> Q(unsigned int nThreads = 0) const;
+			Dense<T> R() const;
+
+			// X minimizing ||A*X - B|| for every column of B - with pivoting the basic solution of rank Rank(),
+			// whose remaining elements are zero, without it R must have a nonzero diagonal
+			// an empty matrix when b does not have m rows
+			Dense<T> Solve(const Dense<T>& b, unsigned int nThreads = 0) const;
+
+			// TSQR least squares for m much larger than n - the rows are split into blocks, every block is factored
+			// and its part of B reduced to n rows independently, and the stacked R factors are reduced again the same
+			// way until one block is left. blocks are sized to stay in cache and there is at least one per thread
+			// the result depends on the block count, and so on nThreads, within rounding. an empty matrix when b
+			// does not have the rows of a
+			static Dense<T> SolveTallSkinny(const Dense<T>& a, const Dense<T>& b, unsigned int nThreads = 0);
+
+			// LeastSquares takes the TSQR path from TallSkinnyRatio rows per column and at least TallSkinnyRows rows
+			static const unsigned int TallSkinnyRatio = 16;
+			static const unsigned int TallSkinnyRows = 8192;
+			// target size of a TSQR block, every block keeps at least 4 * n rows
+			static const size_t TallSkinnyBlockBytes = 512 * 1024;
+
+			const Dense<T>& Factors() const;
+			const vector<T>& Tau() const;
+			const vector<unsigned int>& Permutation() const;
+		};
+
+		// X minimizing ||A*X - B|| through QR, or TSQR for tall and skinny A - an empty matrix when the rows differ
+		template <class T>
+		Dense<T> LeastSquares(const Dense<T>& a, const Dense<T>& b, unsigned int nThreads = 0);
+	}
+}
+
+#endif // !_QR_H_
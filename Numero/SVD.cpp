@@ -0,0 +1,784 @@
+#ifndef _SVD_CPP_
+#define _SVD_CPP_
+
+#include <assert.h>
+#include <cmath>
+#include <limits>
+#include <algorithm>
+#include <numeric>
+#include <random>
+#include <type_traits>
+#include "SVD.h"
+#include "Dense.cpp"
+#include "Gemm.cpp"
+#include "QR.cpp"
+#include "Householder.cpp"
+#include "ThreadPool.h"
+#include "Simd.h"
+
+using namespace Numero;
+using namespace Numero::DataTypes;
+
+#pragma region CONSTRUCTORS
+// a wide matrix is decomposed through its transpose, A' = U*S*V' giving A = V*S*U'
+template <class T>
+SVD<T>::SVD(const Dense<T>& matrix, SvdVectors vectors, unsigned int nThreads)
+	: m(matrix.Rows()), n(matrix.Cols()), converged(true)
+{
+	static_assert(is_floating_point<T>::value, "SVD needs a floating point type");
+
+	if (m >= n)
+	{
+		Dense<T> a(matrix);
+		Factorize(a, vectors, nThreads);
+	}
+	else
+	{
+		Dense<T> a = matrix.Transpose();
+		Factorize(a, vectors, nThreads);
+		swap(u, v);
+	}
+}
+
+// Y = A*omega for a Gaussian omega, Q = orth(Y), every power iteration Q = orth(A*orth(A'*Q)),
+// and with B = Q'*A = Ub*S*V' the triplets are Q*Ub, S and V
+template <class T>
+SVD<T> SVD<T>::Truncated(const Dense<T>& matrix, unsigned int rank, unsigned int oversampling,
+	unsigned int powerIterations, unsigned int nThreads)
+{
+	static_assert(is_floating_point<T>::value, "SVD needs a floating point type");
+
+	unsigned int m = matrix.Rows();
+	unsigned int n = matrix.Cols();
+	assert(rank > 0 && rank <= min(m, n));
+
+	unsigned int samples = min(rank + oversampling, min(m, n));
+	const T* a = matrix.Data();
+
+	mt19937 generator(5489u);
+	normal_distribution<T> gaussian;
+	Dense<T> omega(n, samples, Uninitialized);
+	T* o = omega.Data();
+	for (size_t i(0); i < static_cast<size_t>(n) * samples; i++)
+		o[i] = gaussian(generator);
+
+	Dense<T> sample(m, samples, Uninitialized);
+	Gemm<T>::Multiply(m, samples, n,
+		static_cast<T>(1),
+		a, n, 1,
+		omega.Data(), samples, 1,
+		static_cast<T>(0),
+		sample.Data(), samples, 1,
+		nThreads);
+	Dense<T> q = QR<T>(sample, false, nThreads).Q(nThreads);
+
+	for (unsigned int iteration(0); iteration < powerIterations; iteration++)
+	{
+		Gemm<T>::Multiply(n, samples, m,
+			static_cast<T>(1),
+			a, 1, n,
+			q.Data(), samples, 1,
+			static_cast<T>(0),
+			omega.Data(), samples, 1,
+			nThreads);
+		Dense<T> z = QR<T>(omega, false, nThreads).Q(nThreads);
+		Gemm<T>::Multiply(m, samples, n,
+			static_cast<T>(1),
+			a, n, 1,
+			z.Data(), samples, 1,
+			static_cast<T>(0),
+			sample.Data(), samples, 1,
+			nThreads);
+		q = QR<T>(sample, false, nThreads).Q(nThreads);
+	}
+
+	Dense<T> b(samples, n, Uninitialized);
+	Gemm<T>::Multiply(samples, n, m,
+		static_cast<T>(1),
+		q.Data(), 1, samples,
+		a, n, 1,
+		static_cast<T>(0),
+		b.Data(), n, 1,
+		nThreads);
+	SVD<T> small(b, SvdVectors::Thin, nThreads);
+
+	SVD<T> result;
+	result.m = m;
+	result.n = n;
+	result.converged = small.converged;
+	result.values.assign(small.values.begin(), small.values.begin() + rank);
+	result.u = Dense<T>(m, rank, Uninitialized);
+	Gemm<T>::Multiply(m, rank, samples,
+		static_cast<T>(1),
+		q.Data(), samples, 1,
+		small.u.Data(), small.u.Cols(), 1,
+		static_cast<T>(0),
+		result.u.Data(), rank, 1,
+		nThreads);
+	result.v = Dense<T>(n, rank, Uninitialized);
+	for (unsigned int i(0); i < n; i++)
+	{
+		const T* row = small.v.Data() + static_cast<size_t>(i) * small.v.Cols();
+		copy(row, row + rank, result.v.Data() + static_cast<size_t>(i) * rank);
+	}
+	return result;
+}
+
+// a is m x n with m >= n - from QRFirstRatio rows per column only R of A = Q*R is reduced, and U = Q*U of R
+template <class T>
+void SVD<T>::Factorize(Dense<T>& a, SvdVectors vectors, unsigned int nThreads)
+{
+	unsigned int rows = a.Rows();
+	unsigned int cols = a.Cols();
+	if (cols == 0 || rows < QRFirstRatio * cols)
+	{
+		Diagonalize(a, rows, vectors, nThreads);
+		return;
+	}
+
+	QR<T> qr(a, false, nThreads);
+	Dense<T> r = qr.R();
+	Diagonalize(r, rows, vectors, nThreads);
+	if (vectors != SvdVectors::None)
+		qr.ApplyQ(u, nThreads);
+}
+
+// bidiagonal QR with the rotations accumulated when vectors are wanted, then U = Q*[Ub 0; 0 I] and V = P*Vb
+template <class T>
+void SVD<T>::Diagonalize(Dense<T>& a, unsigned int uRows, SvdVectors vectors, unsigned int nThreads)
+{
+	unsigned int rows = a.Rows();
+	unsigned int cols = a.Cols();
+	unsigned int uCols = (vectors == SvdVectors::Full) ? uRows : cols;
+	if (cols == 0)
+	{
+		if (vectors != SvdVectors::None)
+		{
+			u = Dense<T>(uRows, uCols);
+			for (unsigned int j(0); j < uCols; j++)
+				u(j, j, static_cast<T>(1));
+			v = Dense<T>(0, 0);
+		}
+		return;
+	}
+
+	vector<T> tauq;
+	vector<T> taup;
+	vector<T> d;
+	vector<T> e;
+	Bidiagonalize(a, tauq, taup, d, e, nThreads);
+	e.push_back(static_cast<T>(0));
+
+	if (vectors == SvdVectors::None)
+	{
+		converged = BidiagonalQR(d.data(), e.data(), cols, nullptr, nullptr, 0, nThreads);
+		values.resize(cols);
+		for (unsigned int j(0); j < cols; j++)
+			values[j] = abs(d[j]);
+		sort(values.begin(), values.end(), greater<T>());
+		return;
+	}
+
+	// rows of ut and vt padded by 8 elements past a multiple of 8, so that rows of power of two lengths do not map the
+	// same chunk of columns of every row to the same cache sets
+	size_t ld = (cols + 7) / 8 * 8 + 8;
+	vector<T> ut(ld * cols, static_cast<T>(0));
+	vector<T> vt(ld * cols, static_cast<T>(0));
+	for (unsigned int j(0); j < cols; j++)
+	{
+		ut[j * ld + j] = static_cast<T>(1);
+		vt[j * ld + j] = static_cast<T>(1);
+	}
+	converged = BidiagonalQR(d.data(), e.data(), cols, ut.data(), vt.data(), ld, nThreads);
+
+	vector<unsigned int> order(cols);
+	iota(order.begin(), order.end(), 0u);
+	stable_sort(order.begin(), order.end(), [&](unsigned int x, unsigned int y) { return abs(d[x]) > abs(d[y]); });
+
+	// the signs of negative singular values move into V
+	values.resize(cols);
+	u = Dense<T>(uRows, uCols);
+	v = Dense<T>(cols, cols, Uninitialized);
+	T* uData = u.Data();
+	T* vData = v.Data();
+	for (unsigned int j(0); j < cols; j++)
+	{
+		T value = d[order[j]];
+		T sign = (value < static_cast<T>(0)) ? static_cast<T>(-1) : static_cast<T>(1);
+		values[j] = abs(value);
+		const T* uRow = ut.data() + order[j] * ld;
+		const T* vRow = vt.data() + order[j] * ld;
+		for (unsigned int i(0); i < cols; i++)
+		{
+			uData[static_cast<size_t>(i) * uCols + j] = uRow[i];
+			vData[static_cast<size_t>(i) * cols + j] = sign * vRow[i];
+		}
+	}
+	for (unsigned int j(cols); j < uCols; j++)
+		uData[static_cast<size_t>(j) * uCols + j] = static_cast<T>(1);
+
+	Householder<T>::Apply(a.Data(), cols, 1, cols, 0, tauq.data(), uData, rows, uCols, uCols, nThreads);
+	Householder<T>::Apply(a.Data(), 1, cols, cols - 1, 1, taup.data(), vData, cols, cols, cols, nThreads);
+}
+#pragma endregion
+
+
+#pragma region BIDIAGONALIZATION
+// after every panel the trailing matrix gets a -= V*y' + x*U', two rank-BlockSize Gemm products, and the units of
+// the reflectors, kept explicit for the panel and the update, give way to d and e
+template <class T>
+void SVD<T>::Bidiagonalize(Dense<T>& a, vector<T>& tauq, vector<T>& taup, vector<T>& d, vector<T>& e,
+	unsigned int nThreads)
+{
+	unsigned int m = a.Rows();
+	unsigned int n = a.Cols();
+	assert(m >= n);
+
+	T* data = a.Data();
+	tauq.assign(n, static_cast<T>(0));
+	taup.assign(n > 0 ? n - 1 : 0, static_cast<T>(0));
+	d.assign(n, static_cast<T>(0));
+	e.assign(n > 0 ? n - 1 : 0, static_cast<T>(0));
+
+	vector<T> x;
+	vector<T> y;
+	for (unsigned int k0(0); k0 < n; k0 += BlockSize)
+	{
+		unsigned int kb = (n - k0 < BlockSize) ? n - k0 : BlockSize;
+		ReducePanel(data, m, n, k0, kb, tauq.data(), taup.data(), d.data(), e.data(), x, y, nThreads);
+
+		unsigned int start = k0 + kb;
+		if (start < n)
+		{
+			Gemm<T>::Multiply(m - start, n - start, kb,
+				static_cast<T>(-1),
+				data + static_cast<size_t>(start) * n + k0, n, 1,
+				y.data() + static_cast<size_t>(start) * kb, 1, kb,
+				static_cast<T>(1),
+				data + static_cast<size_t>(start) * n + start, n, 1,
+				nThreads);
+			Gemm<T>::Multiply(m - start, n - start, kb,
+				static_cast<T>(-1),
+				x.data() + static_cast<size_t>(start) * kb, kb, 1,
+				data + static_cast<size_t>(k0) * n + start, n, 1,
+				static_cast<T>(1),
+				data + static_cast<size_t>(start) * n + start, n, 1,
+				nThreads);
+		}
+
+		for (unsigned int j(k0); j < start; j++)
+		{
+			data[static_cast<size_t>(j) * n + j] = d[j];
+			if (j + 1 < n)
+				data[static_cast<size_t>(j) * n + j + 1] = e[j];
+		}
+	}
+}
+
+// for every column i of the panel: apply the earlier reflector pairs of the panel to column i through y and x,
+// generate the column reflector v, and y(:, i) = tauq*(A'*v - Y*(V'*v) - U'*(X'*v)); then apply the pairs, this
+// one's column reflector included, to row i, generate the row reflector u, and x(:, i) = taup*(A*u - V*(Y'*u) -
+// X*(U'*u)). A is the trailing matrix as it was before the panel - its two products are the O(mn) steps of a pair
+template <class T>
+void SVD<T>::ReducePanel(T* a, unsigned int m, unsigned int n, unsigned int k0, unsigned int kb, T* tauq, T* taup,
+	T* d, T* e, vector<T>& x, vector<T>& y, unsigned int nThreads)
+{
+	x.assign(static_cast<size_t>(m) * kb, static_cast<T>(0));
+	y.assign(static_cast<size_t>(n) * kb, static_cast<T>(0));
+	vector<T> column(m);
+	vector<T> product(max(m, n));
+	vector<T> t1(kb);
+	vector<T> t2(kb);
+	vector<T> partial;
+
+	ThreadPool& pool = ThreadPool::Global();
+	unsigned int threads = (nThreads == 0 || nThreads > pool.ThreadCount()) ? pool.ThreadCount() : nThreads;
+
+	for (unsigned int p(0); p < kb; p++)
+	{
+		unsigned int i = k0 + p;
+		T* rowI = a + static_cast<size_t>(i) * n;
+		unsigned int rows = m - i;
+
+		if (p > 0)
+		{
+			const T* yi = y.data() + static_cast<size_t>(i) * kb;
+			for (unsigned int q(0); q < p; q++)
+				t1[q] = a[static_cast<size_t>(k0 + q) * n + i];
+			for (unsigned int r(i); r < m; r++)
+			{
+				T* ar = a + static_cast<size_t>(r) * n;
+				const T* xr = x.data() + static_cast<size_t>(r) * kb;
+				T sum = static_cast<T>(0);
+				for (unsigned int q(0); q < p; q++)
+					sum += ar[k0 + q] * yi[q] + xr[q] * t1[q];
+				ar[i] -= sum;
+			}
+		}
+
+		// H = I - tauq*v*v' maps a(i:m, i) onto d[i]*e1, v(0) = 1 and v(1:) overwrites a(i+1:m, i)
+		for (unsigned int r(0); r < rows; r++)
+			column[r] = a[static_cast<size_t>(i + r) * n + i];
+		T alpha = column[0];
+		T tail = static_cast<T>(0);
+		for (unsigned int r(1); r < rows; r++)
+			tail += column[r] * column[r];
+
+		if (tail == static_cast<T>(0))
+		{
+			tauq[i] = static_cast<T>(0);
+			d[i] = alpha;
+		}
+		else
+		{
+			T beta = -copysign(sqrt(alpha * alpha + tail), alpha);
+			tauq[i] = (beta - alpha) / beta;
+			T scale = static_cast<T>(1) / (alpha - beta);
+			for (unsigned int r(1); r < rows; r++)
+			{
+				column[r] *= scale;
+				a[static_cast<size_t>(i + r) * n + i] = column[r];
+			}
+			d[i] = beta;
+		}
+		column[0] = static_cast<T>(1);
+		rowI[i] = static_cast<T>(1);
+		if (i + 1 == n)
+			break;
+
+		unsigned int cols = n - i - 1;
+		if (tauq[i] != static_cast<T>(0))
+		{
+			// product = A(i:m, i+1:n)'*v - every chunk of rows but the first accumulates into a buffer of its own
+			const T* trailing = a + static_cast<size_t>(i) * n + i + 1;
+			unsigned int chunks = (static_cast<size_t>(rows) * cols >= ParallelReduction && threads > 1) ? threads : 1;
+			partial.assign(static_cast<size_t>(chunks - 1) * cols, static_cast<T>(0));
+			fill(product.begin(), product.begin() + cols, static_cast<T>(0));
+			pool.ParallelFor(chunks, [&](unsigned int chunk)
+			{
+				unsigned int begin = static_cast<unsigned int>(static_cast<size_t>(rows) * chunk / chunks);
+				unsigned int end = static_cast<unsigned int>(static_cast<size_t>(rows) * (chunk + 1) / chunks);
+				T* sum = (chunk == 0) ? product.data() : partial.data() + static_cast<size_t>(chunk - 1) * cols;
+				unsigned int r(begin);
+				for (; r + 4 <= end; r += 4)
+				{
+					const T* row0 = trailing + static_cast<size_t>(r) * n;
+					const T* row1 = row0 + n;
+					const T* row2 = row1 + n;
+					const T* row3 = row2 + n;
+					T v0 = column[r];
+					T v1 = column[r + 1];
+					T v2 = column[r + 2];
+					T v3 = column[r + 3];
+					for (unsigned int c(0); c < cols; c++)
+						sum[c] += row0[c] * v0 + row1[c] * v1 + row2[c] * v2 + row3[c] * v3;
+				}
+				for (; r < end; r++)
+				{
+					const T* row = trailing + static_cast<size_t>(r) * n;
+					T vr = column[r];
+					for (unsigned int c(0); c < cols; c++)
+						sum[c] += row[c] * vr;
+				}
+			}, chunks);
+			for (unsigned int chunk(1); chunk < chunks; chunk++)
+			{
+				const T* sum = partial.data() + static_cast<size_t>(chunk - 1) * cols;
+				for (unsigned int c(0); c < cols; c++)
+					product[c] += sum[c];
+			}
+
+			if (p > 0)
+			{
+				fill(t1.begin(), t1.begin() + p, static_cast<T>(0));
+				fill(t2.begin(), t2.begin() + p, static_cast<T>(0));
+				for (unsigned int r(0); r < rows; r++)
+				{
+					const T* ar = a + static_cast<size_t>(i + r) * n + k0;
+					const T* xr = x.data() + static_cast<size_t>(i + r) * kb;
+					for (unsigned int q(0); q < p; q++)
+					{
+						t1[q] += ar[q] * column[r];
+						t2[q] += xr[q] * column[r];
+					}
+				}
+				for (unsigned int c(0); c < cols; c++)
+				{
+					const T* yc = y.data() + static_cast<size_t>(i + 1 + c) * kb;
+					T sum = static_cast<T>(0);
+					for (unsigned int q(0); q < p; q++)
+						sum += yc[q] * t1[q];
+					product[c] -= sum;
+				}
+				for (unsigned int q(0); q < p; q++)
+				{
+					const T* uq = a + static_cast<size_t>(k0 + q) * n + i + 1;
+					for (unsigned int c(0); c < cols; c++)
+						product[c] -= uq[c] * t2[q];
+				}
+			}
+			for (unsigned int c(0); c < cols; c++)
+				y[static_cast<size_t>(i + 1 + c) * kb + p] = tauq[i] * product[c];
+		}
+
+		// row i gets the pairs of the panel through y and x
+		for (unsigned int c(0); c < cols; c++)
+		{
+			const T* yc = y.data() + static_cast<size_t>(i + 1 + c) * kb;
+			T sum = static_cast<T>(0);
+			for (unsigned int q(0); q <= p; q++)
+				sum += yc[q] * rowI[k0 + q];
+			rowI[i + 1 + c] -= sum;
+		}
+		for (unsigned int q(0); q < p; q++)
+		{
+			const T* uq = a + static_cast<size_t>(k0 + q) * n + i + 1;
+			T xiq = x[static_cast<size_t>(i) * kb + q];
+			for (unsigned int c(0); c < cols; c++)
+				rowI[i + 1 + c] -= uq[c] * xiq;
+		}
+
+		// G = I - taup*u*u' maps a(i, i+1:n) onto e[i]*e1, u(0) = 1 and u(1:) overwrites a(i, i+2:n)
+		alpha = rowI[i + 1];
+		tail = static_cast<T>(0);
+		for (unsigned int c(i + 2); c < n; c++)
+			tail += rowI[c] * rowI[c];
+
+		if (tail == static_cast<T>(0))
+		{
+			taup[i] = static_cast<T>(0);
+			e[i] = alpha;
+		}
+		else
+		{
+			T beta = -copysign(sqrt(alpha * alpha + tail), alpha);
+			taup[i] = (beta - alpha) / beta;
+			T scale = static_cast<T>(1) / (alpha - beta);
+			for (unsigned int c(i + 2); c < n; c++)
+				rowI[c] *= scale;
+			e[i] = beta;
+		}
+		rowI[i + 1] = static_cast<T>(1);
+		if (taup[i] == static_cast<T>(0))
+			continue;
+
+		// product = A(i+1:m, i+1:n)*u, rows split across the pool
+		const T* u = rowI + i + 1;
+		unsigned int below = rows - 1;
+		const T* trailing = a + static_cast<size_t>(i + 1) * n + i + 1;
+		unsigned int chunks = (static_cast<size_t>(below) * cols >= ParallelReduction && threads > 1) ? threads : 1;
+		pool.ParallelFor(chunks, [&](unsigned int chunk)
+		{
+			unsigned int begin = static_cast<unsigned int>(static_cast<size_t>(below) * chunk / chunks);
+			unsigned int end = static_cast<unsigned int>(static_cast<size_t>(below) * (chunk + 1) / chunks);
+			unsigned int r(begin);
+			for (; r + 4 <= end; r += 4)
+			{
+				const T* row0 = trailing + static_cast<size_t>(r) * n;
+				const T* row1 = row0 + n;
+				const T* row2 = row1 + n;
+				const T* row3 = row2 + n;
+				T sum0 = static_cast<T>(0);
+				T sum1 = static_cast<T>(0);
+				T sum2 = static_cast<T>(0);
+				T sum3 = static_cast<T>(0);
+				for (unsigned int c(0); c < cols; c++)
+				{
+					sum0 += row0[c] * u[c];
+					sum1 += row1[c] * u[c];
+					sum2 += row2[c] * u[c];
+					sum3 += row3[c] * u[c];
+				}
+				product[r] = sum0;
+				product[r + 1] = sum1;
+				product[r + 2] = sum2;
+				product[r + 3] = sum3;
+			}
+			for (; r < end; r++)
+			{
+				const T* row = trailing + static_cast<size_t>(r) * n;
+				T sum = static_cast<T>(0);
+				for (unsigned int c(0); c < cols; c++)
+					sum += row[c] * u[c];
+				product[r] = sum;
+			}
+		}, chunks);
+
+		fill(t1.begin(), t1.begin() + p + 1, static_cast<T>(0));
+		for (unsigned int c(0); c < cols; c++)
+		{
+			const T* yc = y.data() + static_cast<size_t>(i + 1 + c) * kb;
+			for (unsigned int q(0); q <= p; q++)
+				t1[q] += yc[q] * u[c];
+		}
+		for (unsigned int q(0); q < p; q++)
+		{
+			const T* uq = a + static_cast<size_t>(k0 + q) * n + i + 1;
+			T sum = static_cast<T>(0);
+			for (unsigned int c(0); c < cols; c++)
+				sum += uq[c] * u[c];
+			t2[q] = sum;
+		}
+		for (unsigned int r(0); r < below; r++)
+		{
+			const T* ar = a + static_cast<size_t>(i + 1 + r) * n + k0;
+			T* xr = x.data() + static_cast<size_t>(i + 1 + r) * kb;
+			T sum = static_cast<T>(0);
+			for (unsigned int q(0); q <= p; q++)
+				sum += ar[q] * t1[q];
+			for (unsigned int q(0); q < p; q++)
+				sum += xr[q] * t2[q];
+			xr[p] = taup[i] * (product[r] - sum);
+		}
+	}
+}
+#pragma endregion
+
+
+#pragma region BIDIAGONAL_QR
+// Golub-Kahan sweeps with the Wilkinson shift of the trailing 2 x 2 block of B'*B - a negligible e[k] splits the
+// matrix, a negligible d[k] above the last row of a block is eliminated by chasing e[k] down with left rotations
+// rotations of columns k, k+1 of Ub or Vb are rotations of rows k, k+1 of ut or vt - they are recorded and applied
+// RotationBatch at a time, the columns of ut and vt split into one chunk per thread of at least RotationChunk columns
+template <class T>
+bool SVD<T>::BidiagonalQR(T* d, T* e, unsigned int count, T* ut, T* vt, size_t ld, unsigned int nThreads)
+{
+	if (count < 2)
+		return true;
+
+	T norm = static_cast<T>(0);
+	for (unsigned int k(0); k < count; k++)
+		norm = max(norm, abs(d[k]) + abs(e[k]));
+	if (norm == static_cast<T>(0))
+		return true;
+	T tolerance = numeric_limits<T>::epsilon() * norm;
+
+	struct Rotation
+	{
+		unsigned int i;
+		unsigned int j;
+		T c;
+		T s;
+	};
+	vector<Rotation> left;
+	vector<Rotation> right;
+	ThreadPool& pool = ThreadPool::Global();
+	unsigned int threads = (nThreads == 0 || nThreads > pool.ThreadCount()) ? pool.ThreadCount() : nThreads;
+	unsigned int chunks = max(1u, min(threads, count / RotationChunk));
+	auto apply = [&]()
+	{
+		pool.ParallelFor(chunks, [&](unsigned int chunk)
+		{
+			unsigned int first = static_cast<unsigned int>(static_cast<size_t>(count) * chunk / chunks);
+			unsigned int width = static_cast<unsigned int>(static_cast<size_t>(count) * (chunk + 1) / chunks) - first;
+			for (const Rotation& rotation : left)
+				Simd::Rotate(ut + rotation.i * ld + first, ut + rotation.j * ld + first, rotation.c, rotation.s, width);
+			for (const Rotation& rotation : right)
+				Simd::Rotate(vt + rotation.i * ld + first, vt + rotation.j * ld + first, rotation.c, rotation.s, width);
+		}, chunks);
+		left.clear();
+		right.clear();
+	};
+	auto givens = [](T f, T g, T& c, T& s)
+	{
+		T r = sqrt(f * f + g * g);
+		if (r == static_cast<T>(0))
+		{
+			c = static_cast<T>(1);
+			s = static_cast<T>(0);
+		}
+		else
+		{
+			c = f / r;
+			s = g / r;
+		}
+		return r;
+	};
+
+	unsigned int sweeps = 0;
+	bool converged = true;
+	unsigned int h = count - 1;
+	while (h > 0)
+	{
+		if (left.size() >= RotationBatch)
+			apply();
+
+		if (abs(e[h - 1]) <= tolerance)
+		{
+			e[h - 1] = static_cast<T>(0);
+			h--;
+			continue;
+		}
+
+		unsigned int l = h - 1;
+		while (l > 0 && abs(e[l - 1]) > tolerance)
+			l--;
+		if (l > 0)
+			e[l - 1] = static_cast<T>(0);
+
+		// a zero diagonal element k moves its e[k] down into rows k+1..h and drops out
+		bool chased = false;
+		for (unsigned int k(l); k < h && !chased; k++)
+		{
+			if (abs(d[k]) > tolerance)
+				continue;
+			chased = true;
+			d[k] = static_cast<T>(0);
+			T f = e[k];
+			e[k] = static_cast<T>(0);
+			for (unsigned int j(k + 1); j <= h && f != static_cast<T>(0); j++)
+			{
+				T c;
+				T s;
+				d[j] = givens(d[j], f, c, s);
+				if (j < h)
+				{
+					f = -s * e[j];
+					e[j] *= c;
+				}
+				if (ut != nullptr)
+					left.push_back({ j, k, c, s });
+			}
+		}
+		if (chased)
+			continue;
+
+		// gives up, leaving approximations, after MaxSweeps sweeps per singular value
+		if (sweeps++ == MaxSweeps * count)
+		{
+			converged = false;
+			break;
+		}
+
+		T a11 = d[h - 1] * d[h - 1] + ((h - 1 > l) ? e[h - 2] * e[h - 2] : static_cast<T>(0));
+		T a22 = d[h] * d[h] + e[h - 1] * e[h - 1];
+		T a12 = d[h - 1] * e[h - 1];
+		T delta = (a11 - a22) / static_cast<T>(2);
+		T shift = a22 - a12 * a12 / (delta + copysign(sqrt(delta * delta + a12 * a12), delta));
+
+		T y = d[l] * d[l] - shift;
+		T z = d[l] * e[l];
+		for (unsigned int k(l); k < h; k++)
+		{
+			// right rotation of columns k, k+1 zeroes the bulge above the superdiagonal
+			T c;
+			T s;
+			T r = givens(y, z, c, s);
+			if (k > l)
+				e[k - 1] = r;
+			y = c * d[k] + s * e[k];
+			e[k] = c * e[k] - s * d[k];
+			z = s * d[k + 1];
+			d[k + 1] *= c;
+			if (vt != nullptr)
+				right.push_back({ k, k + 1, c, s });
+
+			// left rotation of rows k, k+1 zeroes the bulge below the diagonal
+			d[k] = givens(y, z, c, s);
+			y = c * e[k] + s * d[k + 1];
+			d[k + 1] = c * d[k + 1] - s * e[k];
+			if (k + 1 < h)
+			{
+				z = s * e[k + 1];
+				e[k + 1] *= c;
+			}
+			if (ut != nullptr)
+				left.push_back({ k, k + 1, c, s });
+		}
+		e[h - 1] = y;
+	}
+	if (!left.empty() || !right.empty())
+		apply();
+	return converged;
+}
+#pragma endregion
+
+
+#pragma region SOLVERS
+template <class T>
+unsigned int SVD<T>::Rank(T tolerance) const
+{
+	if (values.empty())
+		return 0;
+	if (tolerance < static_cast<T>(0))
+		tolerance = static_cast<T>(max(m, n)) * numeric_limits<T>::epsilon();
+
+	T threshold = tolerance * values[0];
+	unsigned int rank = 0;
+	while (rank < values.size() && values[rank] > threshold)
+		rank++;
+	return rank;
+}
+
+// V(:, 0:r) scaled column by column, times U(:, 0:r)'
+template <class T>
+Dense<T> SVD<T>::PseudoInverse(T tolerance, unsigned int nThreads) const
+{
+	if (u.Rows() != m || v.Rows() != n)
+		return Dense<T>();
+
+	unsigned int rank = Rank(tolerance);
+	Dense<T> scaled(n, rank, Uninitialized);
+	for (unsigned int i(0); i < n; i++)
+	{
+		const T* row = v.Data() + static_cast<size_t>(i) * v.Cols();
+		T* out = scaled.Data() + static_cast<size_t>(i) * rank;
+		for (unsigned int j(0); j < rank; j++)
+			out[j] = row[j] / values[j];
+	}
+
+	Dense<T> result(n, m);
+	Gemm<T>::Multiply(n, m, rank,
+		static_cast<T>(1),
+		scaled.Data(), rank, 1,
+		u.Data(), 1, u.Cols(),
+		static_cast<T>(0),
+		result.Data(), m, 1,
+		nThreads);
+	return result;
+}
+
+// X = V(:, 0:r)*diag(1 / values)*U(:, 0:r)'*B
+template <class T>
+Dense<T> SVD<T>::Solve(const Dense<T>& b, T tolerance, unsigned int nThreads) const
+{
+	if (u.Rows() != m || v.Rows() != n || b.Rows() != m)
+		return Dense<T>();
+
+	unsigned int rank = Rank(tolerance);
+	unsigned int cols = b.Cols();
+	Dense<T> projected(rank, cols);
+	Gemm<T>::Multiply(rank, cols, m,
+		static_cast<T>(1),
+		u.Data(), 1, u.Cols(),
+		b.Data(), cols, 1,
+		static_cast<T>(0),
+		projected.Data(), cols, 1,
+		nThreads);
+	for (unsigned int j(0); j < rank; j++)
+	{
+		T* row = projected.Data() + static_cast<size_t>(j) * cols;
+		for (unsigned int c(0); c < cols; c++)
+			row[c] /= values[j];
+	}
+
+	Dense<T> result(n, cols);
+	Gemm<T>::Multiply(n, cols, rank,
+		static_cast<T>(1),
+		v.Data(), v.Cols(), 1,
+		projected.Data(), cols, 1,
+		static_cast<T>(0),
+		result.Data(), cols, 1,
+		nThreads);
+	return result;
+}
+
+// declared in Dense.h - through the thin SVD
+template <class T>
+Dense<T> Dense<T>::PseudoInverse(T tolerance, unsigned int nThreads) const
+{
+	return SVD<T>(*this, SvdVectors::Thin, nThreads).PseudoInverse(tolerance, nThreads);
+}
+#pragma endregion
+
+#endif // !_SVD_CPP_
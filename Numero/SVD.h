@@ -0,0 +1,106 @@
+#ifndef _SVD_H_
+#define _SVD_H_
+
+#include "../Numero.Definitions/DataTypeDefines.h"
+#include "Dense.h"
+#include <vector>
+
+namespace Numero
+{
+	using namespace std;
+	using namespace Definitions;
+
+	namespace DataTypes
+	{
+		// singular vectors computed by SVD
+		enum class SvdVectors
+		{
+			None = 0,		// singular values only
+			Thin = 1,		// U is m x min(m, n), V is n x min(m, n)
+			Full = 2		// U is m x m, V is n x n
+		};
+
+		// SVD class
+		// singular value decomposition of an m x n matrix, A = U*diag(values)*V', for floating point T
+		// the matrix, or its transpose when it is wide, is reduced to upper bidiagonal form Q'*A*P by Householder
+		// reflectors from both sides - every panel of BlockSize column and row reflectors is accumulated as in
+		// LAPACK's labrd and the trailing matrix gets two rank-BlockSize Gemm updates. from QRFirstRatio rows per
+		// column the matrix is first factored by QR and only R is bidiagonalized
+		// the bidiagonal matrix is diagonalized by implicit shift QR sweeps (Golub-Kahan), whose rotations are
+		// accumulated in min(m, n) x min(m, n) matrices, and the singular vectors are mapped back by the reflectors
+		// in compact WY form
+		template <class T>
+		class SVD
+		{
+		private:
+			unsigned int m;
+			unsigned int n;
+			vector<T> values;				// descending
+			Dense<T> u;						// empty unless the vectors were computed
+			Dense<T> v;
+			bool converged;					// false when the bidiagonal QR gave up
+
+			SVD() : m(0), n(0), converged(true) {}
+
+			// a is m x n with m >= n
+			void Factorize(Dense<T>& a, SvdVectors vectors, unsigned int nThreads);
+			// the SVD of a, m x n with m >= n, with U given uRows rows - the rows of a and zeros below them
+			void Diagonalize(Dense<T>& a, unsigned int uRows, SvdVectors vectors, unsigned int nThreads);
+
+			// upper bidiagonal d, e of the m x n matrix a, m >= n - on return column reflector j is stored below the
+			// diagonal of column j, row reflector j right of e[j] in row j with an implicit 1 at column j + 1
+			static void Bidiagonalize(Dense<T>& a, vector<T>& tauq, vector<T>& taup, vector<T>& d, vector<T>& e,
+				unsigned int nThreads);
+			// panel of kb reflector pairs from column k0, x is m x kb and y is n x kb with the trailing matrix to be
+			// updated by a -= V*y' + x*U', V and U the column and row reflectors of the panel
+			static void ReducePanel(T* a, unsigned int m, unsigned int n, unsigned int k0, unsigned int kb, T* tauq, T* taup,
+				T* d, T* e, vector<T>& x, vector<T>& y, unsigned int nThreads);
+			// singular values of the upper bidiagonal d, e of size count, left in d unsorted and possibly negative
+			// the rotations are accumulated in the rows of ut and vt, count x count transposes of the singular
+			// vectors of the bidiagonal matrix with row stride ld, when they are given
+			// false when MaxSweeps * count sweeps did not converge - d then holds approximations
+			static bool BidiagonalQR(T* d, T* e, unsigned int count, T* ut, T* vt, size_t ld, unsigned int nThreads);
+
+		public:
+			// reflectors per panel of the bidiagonalization
+			static const unsigned int BlockSize = 32;
+			// the matrix-vector products of a reflector pair are split across the pool from this many trailing elements
+			static const unsigned int ParallelReduction = 65536;
+			// rows per column from which QR precedes the bidiagonalization
+			static constexpr double QRFirstRatio = 1.6;
+			// bidiagonal QR sweeps per singular value before giving up
+			static const unsigned int MaxSweeps = 30;
+			// the rotations of the bidiagonal QR are applied in batches of this many, split across the pool in chunks
+			// of at least RotationChunk columns
+			static const unsigned int RotationBatch = 16384;
+			static const unsigned int RotationChunk = 64;
+
+			// --- constructors
+			explicit SVD(const Dense<T>& matrix, SvdVectors vectors = SvdVectors::Thin, unsigned int nThreads = 0);
+
+			// the leading rank singular triplets by randomized range finding (Halko, Martinsson and Tropp) - A is
+			// sampled by rank + oversampling Gaussian vectors, powerIterations passes of A*A' sharpen the sample
+			// and the SVD of the small matrix Q'*A gives the triplets. the sample is drawn from a fixed seed
+			static SVD Truncated(const Dense<T>& matrix, unsigned int rank, unsigned int oversampling = 10,
+				unsigned int powerIterations = 2, unsigned int nThreads = 0);
+
+			unsigned int Count() const { return static_cast<unsigned int>(values.size()); }
+			const vector<T>& Values() const { return values; }
+			const Dense<T>& U() const { return u; }
+			const Dense<T>& V() const { return v; }
+			// false when the bidiagonal QR stopped after MaxSweeps sweeps per singular value - the values and
+			// vectors are then approximations
+			bool Converged() const { return converged; }
+
+			// singular values above tolerance * values[0] - the default tolerance is max(m, n) * epsilon
+			unsigned int Rank(T tolerance = static_cast<T>(-1)) const;
+			// Moore-Penrose pseudoinverse V*diag(1 / values)*U' over the singular values Rank(tolerance) counts
+			Dense<T> PseudoInverse(T tolerance = static_cast<T>(-1), unsigned int nThreads = 0) const;
+			// minimum norm X minimizing ||A*X - B|| for every column of B, without forming the pseudoinverse
+			// both need the vectors - they return an empty matrix for SvdVectors::None, or when b does not have m rows
+			Dense<T> Solve(const Dense<T>& b, T tolerance = static_cast<T>(-1), unsigned int nThreads = 0) const;
+		};
+	}
+}
+
+#endif // !_SVD_H_
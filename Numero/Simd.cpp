@@ -0,0 +1,176 @@
+#include <atomic>
+#include "Simd.h"
+
+#if defined(_MSC_VER) && (defined(_M_X64) || defined(_M_IX86))
+#include <intrin.h>
+#define NUMERO_X86_CPUID
+#elif defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+#include <cpuid.h>
+#define NUMERO_X86_CPUID
+#endif
+
+using namespace Numero;
+using namespace Numero::DataTypes;
+
+#pragma region DETECTION
+namespace
+{
+#ifdef NUMERO_X86_CPUID
+	void Cpuid(unsigned int leaf, unsigned int subLeaf, unsigned int registers[4])
+	{
+#ifdef _MSC_VER
+		int values[4];
+		__cpuidex(values, static_cast<int>(leaf), static_cast<int>(subLeaf));
+		for (unsigned int i(0); i < 4; i++)
+			registers[i] = static_cast<unsigned int>(values[i]);
+#else
+		__cpuid_count(leaf, subLeaf, registers[0], registers[1], registers[2], registers[3]);
+#endif
+	}
+
+	// register state the OS saves on context switches
+	unsigned long long ReadXcr0()
+	{
+#ifdef _MSC_VER
+		return _xgetbv(0);
+#else
+		unsigned int low, high;
+		__asm__ volatile("xgetbv" : "=a"(low), "=d"(high) : "c"(0));
+		return (static_cast<unsigned long long>(high) << 32) | low;
+#endif
+	}
+#endif
+
+	// an instruction set is usable when the CPU reports it and the OS preserves its registers
+	SimdLevel DetectLevel()
+	{
+#ifdef NUMERO_X86_CPUID
+		unsigned int registers[4];		// eax, ebx, ecx, edx
+
+		Cpuid(0, 0, registers);
+		unsigned int maxLeaf = registers[0];
+
+		Cpuid(1, 0, registers);
+		bool sse2 = (registers[3] & (1u << 26)) != 0;
+		bool osxsave = (registers[2] & (1u << 27)) != 0;
+		bool avx = (registers[2] & (1u << 28)) != 0;
+
+		if (!sse2)
+			return SimdLevel::Scalar;
+
+		if (!osxsave || !avx || maxLeaf < 7)
+			return SimdLevel::Sse2;
+
+		unsigned long long xcr0 = ReadXcr0();
+		bool ymmState = (xcr0 & 0x6) == 0x6;			// xmm and ymm
+		bool zmmState = (xcr0 & 0xE6) == 0xE6;			// xmm, ymm, opmask and both zmm halves
+
+		Cpuid(7, 0, registers);
+		bool avx2 = (registers[1] & (1u << 5)) != 0;
+		bool avx512f = (registers[1] & (1u << 16)) != 0;
+
+		if (avx512f && zmmState)
+			return SimdLevel::Avx512;
+		if (avx2 && ymmState)
+			return SimdLevel::Avx2;
+		return SimdLevel::Sse2;
+#else
+		return SimdLevel::Scalar;
+#endif
+	}
+
+	// kernels of every level - levels the build has no kernels for keep the ones below them
+	struct LevelTables
+	{
+		SimdKernelTable<float> floatTables[4];
+		SimdKernelTable<double> doubleTables[4];
+		SimdKernelTable<int> intTables[4];
+
+		LevelTables()
+		{
+			floatTables[0] = Simd::ScalarTable<float>();
+			doubleTables[0] = Simd::ScalarTable<double>();
+			intTables[0] = Simd::ScalarTable<int>();
+
+			for (unsigned int level(1); level < 4; level++)
+			{
+				floatTables[level] = floatTables[level - 1];
+				doubleTables[level] = doubleTables[level - 1];
+				intTables[level] = intTables[level - 1];
+
+				if (level == static_cast<unsigned int>(SimdLevel::Sse2))
+					LoadSse2Kernels(floatTables[level], doubleTables[level], intTables[level]);
+				else if (level == static_cast<unsigned int>(SimdLevel::Avx2))
+					LoadAvx2Kernels(floatTables[level], doubleTables[level], intTables[level]);
+				else
+					LoadAvx512Kernels(floatTables[level], doubleTables[level], intTables[level]);
+			}
+		}
+	};
+
+	const LevelTables& Tables()
+	{
+		static const LevelTables tables;
+		return tables;
+	}
+
+	atomic<int>& ActiveLevel()
+	{
+		static atomic<int> activeLevel(static_cast<int>(Simd::Detected()));
+		return activeLevel;
+	}
+}
+
+SimdLevel Simd::Detected()
+{
+	static const SimdLevel detected = DetectLevel();
+	return detected;
+}
+
+SimdLevel Simd::Active()
+{
+	return static_cast<SimdLevel>(ActiveLevel().load(memory_order_relaxed));
+}
+
+SimdLevel Simd::SetActive(SimdLevel level)
+{
+	if (level > Detected())
+		level = Detected();
+
+	ActiveLevel().store(static_cast<int>(level), memory_order_relaxed);
+	return level;
+}
+
+const char* Simd::LevelName(SimdLevel level)
+{
+	switch (level)
+	{
+	case SimdLevel::Sse2:
+		return "SSE2";
+	case SimdLevel::Avx2:
+		return "AVX2";
+	case SimdLevel::Avx512:
+		return "AVX-512";
+	default:
+		return "scalar";
+	}
+}
+#pragma endregion
+
+
+#pragma region DISPATCH
+const SimdKernelTable<float>& Simd::Table(const float*)
+{
+	return Tables().floatTables[ActiveLevel().load(memory_order_relaxed)];
+}
+
+const SimdKernelTable<double>& Simd::Table(const double*)
+{
+	return Tables().doubleTables[ActiveLevel().load(memory_order_relaxed)];
+}
+
+const SimdKernelTable<int>& Simd::Table(const int*)
+{
+	return Tables().intTables[ActiveLevel().load(memory_order_relaxed)];
+}
+#pragma endregion
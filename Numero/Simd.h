@@ -0,0 +1,241 @@
+#ifndef _SIMD_H_
+#define _SIMD_H_
+
+#include "../Numero.Definitions/DataTypeDefines.h"
+#include <cstddef>
+
+namespace Numero
+{
+	using namespace std;
+	using namespace Definitions;
+
+	namespace DataTypes
+	{
+		// instruction set levels of the element-wise kernels, ordered by capability
+		enum class SimdLevel
+		{
+			Scalar = 0,
+			Sse2 = 1,
+			Avx2 = 2,
+			Avx512 = 3
+		};
+
+		// SimdKernelTable struct
+		// one set of element-wise kernels over n contiguous elements
+		// every kernel accepts out == a (or out == b), so the same entry serves in-place updates
+		// gatherDot is the sparse row kernel - sum of values[i] * x[indices[i]], indices below 2^31
+		// sellSlice and blockRow are the row kernels of the SELL-C-sigma and block CSR layouts, see SparseSell.h and SparseBlock.h
+		// rotate is the plane rotation x, y = c*x + s*y, c*y - s*x of two rows, as in the bidiagonal QR of SVD.h
+		template <class T>
+		struct SimdKernelTable
+		{
+			void(*fill)(T* out, T value, size_t n);
+			void(*addScalar)(const T* a, T scalar, T* out, size_t n);
+			void(*mulScalar)(const T* a, T scalar, T* out, size_t n);
+			void(*add)(const T* a, const T* b, T* out, size_t n);
+			void(*mul)(const T* a, const T* b, T* out, size_t n);
+			T(*gatherDot)(const T* values, const unsigned int* indices, const T* x, size_t n);
+			void(*sellSlice)(const T* values, const unsigned int* indices, const T* x, size_t width, size_t height, T* out);
+			void(*blockRow)(const T* blocks, const unsigned int* blockCols, size_t count, const T* x, size_t xCount, size_t rows, size_t cols, T* out);
+			void(*rotate)(T* x, T* y, T c, T s, size_t n);
+		};
+
+		// Simd class
+		// element-wise kernels dispatched at runtime to the widest instruction set the CPU supports
+		// float, double and int get explicit SSE2 / AVX2 / AVX-512 kernels, any other type uses the scalar loops
+		// element-wise kernels only reorder independent element operations, so results are bit-identical across levels
+		// the sparse row kernels are reductions and may sum in a different order at every level, and the multiply-adds
+		// of rotate may be fused where the instruction set has FMA
+		class Simd
+		{
+		private:
+			// kernels of the active level - the pointer argument only selects the overload
+			static const SimdKernelTable<float>& Table(const float*);
+			static const SimdKernelTable<double>& Table(const double*);
+			static const SimdKernelTable<int>& Table(const int*);
+
+			template <class T>
+			static const SimdKernelTable<T>& Table(const T*)
+			{
+				static const SimdKernelTable<T> table = ScalarTable<T>();
+				return table;
+			}
+
+		public:
+			// highest level supported by both the CPU and the OS, detected once from CPUID
+			static SimdLevel Detected();
+
+			// level used by the kernels - the detected one unless lowered through SetActive
+			static SimdLevel Active();
+
+			// selects the kernels of the given level, clamped to Detected() - returns the level in effect
+			static SimdLevel SetActive(SimdLevel level);
+
+			static const char* LevelName(SimdLevel level);
+
+			// --- kernels
+			template <class T>
+			static void Fill(T* out, T value, size_t n) { Table(out).fill(out, value, n); }
+			template <class T>
+			static void AddScalar(const T* a, T scalar, T* out, size_t n) { Table(out).addScalar(a, scalar, out, n); }
+			template <class T>
+			static void MulScalar(const T* a, T scalar, T* out, size_t n) { Table(out).mulScalar(a, scalar, out, n); }
+			template <class T>
+			static void Add(const T* a, const T* b, T* out, size_t n) { Table(out).add(a, b, out, n); }
+			template <class T>
+			static void Mul(const T* a, const T* b, T* out, size_t n) { Table(out).mul(a, b, out, n); }
+			template <class T>
+			static T GatherDot(const T* values, const unsigned int* indices, const T* x, size_t n) { return Table(x).gatherDot(values, indices, x, n); }
+			template <class T>
+			static void SellSlice(const T* values, const unsigned int* indices, const T* x, size_t width, size_t height, T* out) { Table(out).sellSlice(values, indices, x, width, height, out); }
+			template <class T>
+			static void BlockRow(const T* blocks, const unsigned int* blockCols, size_t count, const T* x, size_t xCount, size_t rows, size_t cols, T* out) { Table(out).blockRow(blocks, blockCols, count, x, xCount, rows, cols, out); }
+			template <class T>
+			static void Rotate(T* x, T* y, T c, T s, size_t n) { Table(x).rotate(x, y, c, s, n); }
+
+			// plain loops, used for types without explicit kernels and as the Scalar level
+			template <class T>
+			static void ScalarFill(T* out, T value, size_t n)
+			{
+				for (size_t i(0); i < n; i++)
+					out[i] = value;
+			}
+
+			template <class T>
+			static void ScalarAddScalar(const T* a, T scalar, T* out, size_t n)
+			{
+				for (size_t i(0); i < n; i++)
+					out[i] = a[i] + scalar;
+			}
+
+			template <class T>
+			static void ScalarMulScalar(const T* a, T scalar, T* out, size_t n)
+			{
+				for (size_t i(0); i < n; i++)
+					out[i] = a[i] * scalar;
+			}
+
+			template <class T>
+			static void ScalarAdd(const T* a, const T* b, T* out, size_t n)
+			{
+				for (size_t i(0); i < n; i++)
+					out[i] = a[i] + b[i];
+			}
+
+			template <class T>
+			static void ScalarMul(const T* a, const T* b, T* out, size_t n)
+			{
+				for (size_t i(0); i < n; i++)
+					out[i] = a[i] * b[i];
+			}
+
+			template <class T>
+			static T ScalarGatherDot(const T* values, const unsigned int* indices, const T* x, size_t n)
+			{
+				T sum = static_cast<T>(0);
+				for (size_t i(0); i < n; i++)
+					sum += values[i] * x[indices[i]];
+				return sum;
+			}
+
+			// slice of height rows stored column by column, width entries per row
+			template <class T>
+			static void ScalarSellSlice(const T* values, const unsigned int* indices, const T* x, size_t width, size_t height, T* out)
+			{
+				for (size_t r(0); r < height; r++)
+				{
+					T sum = static_cast<T>(0);
+					for (size_t j(0); j < width; j++)
+						sum += values[j*height + r] * x[indices[j*height + r]];
+					out[r] = sum;
+				}
+			}
+
+			// count column-major blocks of rows x cols - partial blocks at the right edge read the columns below xCount only
+			// 2x2, 3x3 and 4x4 blocks go through fixed-size loops that keep the row sums in registers
+			template <class T>
+			static void ScalarBlockRow(const T* blocks, const unsigned int* blockCols, size_t count, const T* x, size_t xCount, size_t rows, size_t cols, T* out)
+			{
+				if (rows == cols && rows >= 2 && rows <= 4)
+				{
+					if (rows == 2)
+						FixedBlockRow<T, 2>(blocks, blockCols, count, x, xCount, out);
+					else if (rows == 3)
+						FixedBlockRow<T, 3>(blocks, blockCols, count, x, xCount, out);
+					else
+						FixedBlockRow<T, 4>(blocks, blockCols, count, x, xCount, out);
+					return;
+				}
+
+				for (size_t r(0); r < rows; r++)
+					out[r] = static_cast<T>(0);
+
+				for (size_t b(0); b < count; b++)
+				{
+					const T* block = blocks + b*rows*cols;
+					size_t first = static_cast<size_t>(blockCols[b])*cols;
+					size_t columns = (first + cols <= xCount) ? cols : xCount - first;
+					for (size_t c(0); c < columns; c++)
+						for (size_t r(0); r < rows; r++)
+							out[r] += block[c*rows + r] * x[first + c];
+				}
+			}
+
+			template <class T, size_t N>
+			static void FixedBlockRow(const T* blocks, const unsigned int* blockCols, size_t count, const T* x, size_t xCount, T* out)
+			{
+				T sums[N] = {};
+
+				for (size_t b(0); b < count; b++)
+				{
+					const T* block = blocks + b*N*N;
+					size_t first = static_cast<size_t>(blockCols[b])*N;
+					size_t columns = (first + N <= xCount) ? N : xCount - first;
+					if (columns == N)
+					{
+						for (size_t c(0); c < N; c++)
+							for (size_t r(0); r < N; r++)
+								sums[r] += block[c*N + r] * x[first + c];
+					}
+					else
+					{
+						for (size_t c(0); c < columns; c++)
+							for (size_t r(0); r < N; r++)
+								sums[r] += block[c*N + r] * x[first + c];
+					}
+				}
+
+				for (size_t r(0); r < N; r++)
+					out[r] = sums[r];
+			}
+
+			template <class T>
+			static void ScalarRotate(T* x, T* y, T c, T s, size_t n)
+			{
+				for (size_t i(0); i < n; i++)
+				{
+					T first = x[i];
+					T second = y[i];
+					x[i] = c * first + s * second;
+					y[i] = c * second - s * first;
+				}
+			}
+
+			template <class T>
+			static SimdKernelTable<T> ScalarTable()
+			{
+				SimdKernelTable<T> table = { &ScalarFill<T>, &ScalarAddScalar<T>, &ScalarMulScalar<T>, &ScalarAdd<T>, &ScalarMul<T>,
+					&ScalarGatherDot<T>, &ScalarSellSlice<T>, &ScalarBlockRow<T>, &ScalarRotate<T> };
+				return table;
+			}
+		};
+
+		// explicit kernels of the individual instruction sets, see SimdSse2.cpp, SimdAvx2.cpp and SimdAvx512.cpp
+		// each returns false when the library was built without that instruction set
+		bool LoadSse2Kernels(SimdKernelTable<float>& floatTable, SimdKernelTable<double>& doubleTable, SimdKernelTable<int>& intTable);
+		bool LoadAvx2Kernels(SimdKernelTable<float>& floatTable, SimdKernelTable<double>& doubleTable, SimdKernelTable<int>& intTable);
+		bool LoadAvx512Kernels(SimdKernelTable<float>& floatTable, SimdKernelTable<double>& doubleTable, SimdKernelTable<int>& intTable);
+	}
+}
+
+#endif // !_SIMD_H_
@@ -0,0 +1,97 @@
+// AVX2 element-wise and sparse kernels
+// this file must not include anything besides the intrinsics and the kernel loops,
+// so that no inline function of another header is compiled with these target options
+#if defined(__GNUC__) && !defined(__clang__)
+#pragma GCC target("avx2")
+#endif
+
+#include "SimdLoops.h"
+
+#if defined(_M_X64) || defined(_M_IX86) || defined(__x86_64__) || defined(__i386__)
+#include <immintrin.h>
+#define NUMERO_HAS_AVX2_KERNELS
+#endif
+
+using namespace Numero;
+using namespace Numero::DataTypes;
+
+#ifdef NUMERO_HAS_AVX2_KERNELS
+namespace
+{
+	// gathers use the masked forms with a zero source and a full mask -
+	// the plain forms start from an undefined register, which GCC reports as uninitialized
+	struct Avx2FloatOps
+	{
+		typedef __m256 Vector;
+		typedef float Scalar;
+		static const size_t Width = 8;
+
+		static Vector Load(const float* p) { return _mm256_loadu_ps(p); }
+		static void Store(float* p, Vector v) { _mm256_storeu_ps(p, v); }
+		static Vector Broadcast(float value) { return _mm256_set1_ps(value); }
+		static Vector Add(Vector a, Vector b) { return _mm256_add_ps(a, b); }
+		static Vector Mul(Vector a, Vector b) { return _mm256_mul_ps(a, b); }
+		static Vector Gather(const float* base, const unsigned int* indices) { return _mm256_mask_i32gather_ps(_mm256_setzero_ps(), base, _mm256_loadu_si256(reinterpret_cast<const __m256i*>(indices)), _mm256_castsi256_ps(_mm256_set1_epi32(-1)), 4); }
+		static float Sum(Vector v)
+		{
+			__m128 s = _mm_add_ps(_mm256_castps256_ps128(v), _mm256_extractf128_ps(v, 1));
+			s = _mm_add_ps(s, _mm_movehl_ps(s, s));
+			return _mm_cvtss_f32(_mm_add_ss(s, _mm_shuffle_ps(s, s, 1)));
+		}
+	};
+
+	struct Avx2DoubleOps
+	{
+		typedef __m256d Vector;
+		typedef double Scalar;
+		static const size_t Width = 4;
+
+		static Vector Load(const double* p) { return _mm256_loadu_pd(p); }
+		static void Store(double* p, Vector v) { _mm256_storeu_pd(p, v); }
+		static Vector Broadcast(double value) { return _mm256_set1_pd(value); }
+		static Vector Add(Vector a, Vector b) { return _mm256_add_pd(a, b); }
+		static Vector Mul(Vector a, Vector b) { return _mm256_mul_pd(a, b); }
+		static Vector Gather(const double* base, const unsigned int* indices) { return _mm256_mask_i32gather_pd(_mm256_setzero_pd(), base, _mm_loadu_si128(reinterpret_cast<const __m128i*>(indices)), _mm256_castsi256_pd(_mm256_set1_epi64x(-1)), 8); }
+		static double Sum(Vector v)
+		{
+			__m128d s = _mm_add_pd(_mm256_castpd256_pd128(v), _mm256_extractf128_pd(v, 1));
+			return _mm_cvtsd_f64(_mm_add_sd(s, _mm_unpackhi_pd(s, s)));
+		}
+	};
+
+	struct Avx2IntOps
+	{
+		typedef __m256i Vector;
+		typedef int Scalar;
+		static const size_t Width = 8;
+
+		static Vector Load(const int* p) { return _mm256_loadu_si256(reinterpret_cast<const __m256i*>(p)); }
+		static void Store(int* p, Vector v) { _mm256_storeu_si256(reinterpret_cast<__m256i*>(p), v); }
+		static Vector Broadcast(int value) { return _mm256_set1_epi32(value); }
+		static Vector Add(Vector a, Vector b) { return _mm256_add_epi32(a, b); }
+		static Vector Mul(Vector a, Vector b) { return _mm256_mullo_epi32(a, b); }
+		static Vector Gather(const int* base, const unsigned int* indices) { return _mm256_mask_i32gather_epi32(_mm256_setzero_si256(), base, _mm256_loadu_si256(reinterpret_cast<const __m256i*>(indices)), _mm256_set1_epi32(-1), 4); }
+		static int Sum(Vector v)
+		{
+			__m128i s = _mm_add_epi32(_mm256_castsi256_si128(v), _mm256_extracti128_si256(v, 1));
+			s = _mm_add_epi32(s, _mm_shuffle_epi32(s, _MM_SHUFFLE(1, 0, 3, 2)));
+			return _mm_cvtsi128_si32(_mm_add_epi32(s, _mm_shuffle_epi32(s, _MM_SHUFFLE(2, 3, 0, 1))));
+		}
+	};
+}
+#endif
+
+bool Numero::DataTypes::LoadAvx2Kernels(SimdKernelTable<float>& floatTable, SimdKernelTable<double>& doubleTable, SimdKernelTable<int>& intTable)
+{
+#ifdef NUMERO_HAS_AVX2_KERNELS
+	SimdLoops<Avx2FloatOps>::Load(floatTable);
+	SimdLoops<Avx2DoubleOps>::Load(doubleTable);
+	SimdLoops<Avx2IntOps>::Load(intTable);
+	SimdLoops<Avx2FloatOps>::LoadGather(floatTable);
+	SimdLoops<Avx2DoubleOps>::LoadGather(doubleTable);
+	SimdLoops<Avx2IntOps>::LoadGather(intTable);
+	return true;
+#else
+	return false;
+#endif
+}
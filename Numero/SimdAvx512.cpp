@@ -0,0 +1,107 @@
+// AVX-512 element-wise and sparse kernels
+// this file must not include anything besides the intrinsics and the kernel loops,
+// so that no inline function of another header is compiled with these target options
+#if defined(__GNUC__) && !defined(__clang__)
+#pragma GCC target("avx512f")
+#endif
+
+#include "SimdLoops.h"
+
+#if defined(_M_X64) || defined(__x86_64__)
+#include <immintrin.h>
+#define NUMERO_HAS_AVX512_KERNELS
+#endif
+
+using namespace Numero;
+using namespace Numero::DataTypes;
+
+#ifdef NUMERO_HAS_AVX512_KERNELS
+namespace
+{
+	// gathers use the masked forms with a zero source and reductions go through memory -
+	// the plain intrinsics start from undefined registers, which GCC reports as uninitialized
+	struct Avx512FloatOps
+	{
+		typedef __m512 Vector;
+		typedef float Scalar;
+		static const size_t Width = 16;
+
+		static Vector Load(const float* p) { return _mm512_loadu_ps(p); }
+		static void Store(float* p, Vector v) { _mm512_storeu_ps(p, v); }
+		static Vector Broadcast(float value) { return _mm512_set1_ps(value); }
+		static Vector Add(Vector a, Vector b) { return _mm512_add_ps(a, b); }
+		static Vector Mul(Vector a, Vector b) { return _mm512_mul_ps(a, b); }
+		static Vector Gather(const float* base, const unsigned int* indices) { return _mm512_mask_i32gather_ps(_mm512_setzero_ps(), 0xFFFF, _mm512_loadu_si512(indices), base, 4); }
+		static float Sum(Vector v)
+		{
+			float lanes[Width];
+			_mm512_storeu_ps(lanes, v);
+			float sum = 0;
+			for (size_t i(0); i < Width; i++)
+				sum += lanes[i];
+			return sum;
+		}
+	};
+
+	struct Avx512DoubleOps
+	{
+		typedef __m512d Vector;
+		typedef double Scalar;
+		static const size_t Width = 8;
+
+		static Vector Load(const double* p) { return _mm512_loadu_pd(p); }
+		static void Store(double* p, Vector v) { _mm512_storeu_pd(p, v); }
+		static Vector Broadcast(double value) { return _mm512_set1_pd(value); }
+		static Vector Add(Vector a, Vector b) { return _mm512_add_pd(a, b); }
+		static Vector Mul(Vector a, Vector b) { return _mm512_mul_pd(a, b); }
+		static Vector Gather(const double* base, const unsigned int* indices) { return _mm512_mask_i32gather_pd(_mm512_setzero_pd(), 0xFF, _mm256_loadu_si256(reinterpret_cast<const __m256i*>(indices)), base, 8); }
+		static double Sum(Vector v)
+		{
+			double lanes[Width];
+			_mm512_storeu_pd(lanes, v);
+			double sum = 0;
+			for (size_t i(0); i < Width; i++)
+				sum += lanes[i];
+			return sum;
+		}
+	};
+
+	struct Avx512IntOps
+	{
+		typedef __m512i Vector;
+		typedef int Scalar;
+		static const size_t Width = 16;
+
+		static Vector Load(const int* p) { return _mm512_loadu_si512(p); }
+		static void Store(int* p, Vector v) { _mm512_storeu_si512(p, v); }
+		static Vector Broadcast(int value) { return _mm512_set1_epi32(value); }
+		static Vector Add(Vector a, Vector b) { return _mm512_add_epi32(a, b); }
+		static Vector Mul(Vector a, Vector b) { return _mm512_mullo_epi32(a, b); }
+		static Vector Gather(const int* base, const unsigned int* indices) { return _mm512_mask_i32gather_epi32(_mm512_setzero_si512(), 0xFFFF, _mm512_loadu_si512(indices), base, 4); }
+		static int Sum(Vector v)
+		{
+			int lanes[Width];
+			_mm512_storeu_si512(lanes, v);
+			int sum = 0;
+			for (size_t i(0); i < Width; i++)
+				sum += lanes[i];
+			return sum;
+		}
+	};
+}
+#endif
+
+bool Numero::DataTypes::LoadAvx512Kernels(SimdKernelTable<float>& floatTable, SimdKernelTable<double>& doubleTable, SimdKernelTable<int>& intTable)
+{
+#ifdef NUMERO_HAS_AVX512_KERNELS
+	SimdLoops<Avx512FloatOps>::Load(floatTable);
+	SimdLoops<Avx512DoubleOps>::Load(doubleTable);
+	SimdLoops<Avx512IntOps>::Load(intTable);
+	SimdLoops<Avx512FloatOps>::LoadGather(floatTable);
+	SimdLoops<Avx512DoubleOps>::LoadGather(doubleTable);
+	SimdLoops<Avx512IntOps>::LoadGather(intTable);
+	return true;
+#else
+	return false;
+#endif
+}
@@ -0,0 +1,263 @@
+#ifndef _SIMD_LOOPS_H_
+#define _SIMD_LOOPS_H_
+
+#include "Simd.h"
+
+namespace Numero
+{
+	namespace DataTypes
+	{
+		// internal linkage on purpose - every instruction set file instantiates these loops
+		// with its own target options, and the copies must never be merged by the linker
+		namespace
+		{
+			// SimdLoops struct
+			// element-wise loops written once over a vector operations policy
+			// Ops provides Vector, Scalar, Width and Load / Store / Broadcast / Add / Mul
+			// the main loop handles four vectors per iteration, then single vectors, then a scalar tail
+			template <class Ops>
+			struct SimdLoops
+			{
+				typedef typename Ops::Scalar T;
+				typedef typename Ops::Vector V;
+
+				static void Fill(T* out, T value, size_t n)
+				{
+					const size_t w = Ops::Width;
+					V v = Ops::Broadcast(value);
+					size_t i(0);
+
+					for (; i + 4 * w <= n; i += 4 * w)
+					{
+						Ops::Store(out + i, v);
+						Ops::Store(out + i + w, v);
+						Ops::Store(out + i + 2 * w, v);
+						Ops::Store(out + i + 3 * w, v);
+					}
+					for (; i + w <= n; i += w)
+						Ops::Store(out + i, v);
+					for (; i < n; i++)
+						out[i] = value;
+				}
+
+				template <class Operation>
+				static void ScalarOperation(const T* a, T scalar, T* out, size_t n)
+				{
+					const size_t w = Ops::Width;
+					V s = Ops::Broadcast(scalar);
+					size_t i(0);
+
+					for (; i + 4 * w <= n; i += 4 * w)
+					{
+						V v0 = Operation::Apply(Ops::Load(a + i), s);
+						V v1 = Operation::Apply(Ops::Load(a + i + w), s);
+						V v2 = Operation::Apply(Ops::Load(a + i + 2 * w), s);
+						V v3 = Operation::Apply(Ops::Load(a + i + 3 * w), s);
+						Ops::Store(out + i, v0);
+						Ops::Store(out + i + w, v1);
+						Ops::Store(out + i + 2 * w, v2);
+						Ops::Store(out + i + 3 * w, v3);
+					}
+					for (; i + w <= n; i += w)
+						Ops::Store(out + i, Operation::Apply(Ops::Load(a + i), s));
+					for (; i < n; i++)
+						out[i] = Operation::Apply(a[i], scalar);
+				}
+
+				template <class Operation>
+				static void BinaryOperation(const T* a, const T* b, T* out, size_t n)
+				{
+					const size_t w = Ops::Width;
+					size_t i(0);
+
+					for (; i + 4 * w <= n; i += 4 * w)
+					{
+						V v0 = Operation::Apply(Ops::Load(a + i), Ops::Load(b + i));
+						V v1 = Operation::Apply(Ops::Load(a + i + w), Ops::Load(b + i + w));
+						V v2 = Operation::Apply(Ops::Load(a + i + 2 * w), Ops::Load(b + i + 2 * w));
+						V v3 = Operation::Apply(Ops::Load(a + i + 3 * w), Ops::Load(b + i + 3 * w));
+						Ops::Store(out + i, v0);
+						Ops::Store(out + i + w, v1);
+						Ops::Store(out + i + 2 * w, v2);
+						Ops::Store(out + i + 3 * w, v3);
+					}
+					for (; i + w <= n; i += w)
+						Ops::Store(out + i, Operation::Apply(Ops::Load(a + i), Ops::Load(b + i)));
+					for (; i < n; i++)
+						out[i] = Operation::Apply(a[i], b[i]);
+				}
+
+				// vector and scalar forms of the two operations
+				struct Add
+				{
+					static V Apply(V x, V y) { return Ops::Add(x, y); }
+					static T Apply(T x, T y) { return x + y; }
+				};
+
+				struct Mul
+				{
+					static V Apply(V x, V y) { return Ops::Mul(x, y); }
+					static T Apply(T x, T y) { return x * y; }
+				};
+
+				// two accumulators hide the latency of the gathers
+				// only instantiated for instruction sets whose Ops provide Gather and Sum
+				static T GatherDot(const T* values, const unsigned int* indices, const T* x, size_t n)
+				{
+					const size_t w = Ops::Width;
+					V s0 = Ops::Broadcast(static_cast<T>(0));
+					V s1 = s0;
+					size_t i(0);
+
+					for (; i + 2 * w <= n; i += 2 * w)
+					{
+						s0 = Ops::Add(s0, Ops::Mul(Ops::Load(values + i), Ops::Gather(x, indices + i)));
+						s1 = Ops::Add(s1, Ops::Mul(Ops::Load(values + i + w), Ops::Gather(x, indices + i + w)));
+					}
+					for (; i + w <= n; i += w)
+						s0 = Ops::Add(s0, Ops::Mul(Ops::Load(values + i), Ops::Gather(x, indices + i)));
+
+					T sum = Ops::Sum(Ops::Add(s0, s1));
+					for (; i < n; i++)
+						sum += values[i] * x[indices[i]];
+					return sum;
+				}
+
+				// rows of the slice go in vector groups - every lane gathers for its own row
+				static void SellSlice(const T* values, const unsigned int* indices, const T* x, size_t width, size_t height, T* out)
+				{
+					const size_t w = Ops::Width;
+					size_t r(0);
+
+					for (; r + w <= height; r += w)
+					{
+						V s = Ops::Broadcast(static_cast<T>(0));
+						for (size_t j(0); j < width; j++)
+							s = Ops::Add(s, Ops::Mul(Ops::Load(values + j*height + r), Ops::Gather(x, indices + j*height + r)));
+						Ops::Store(out + r, s);
+					}
+					for (; r < height; r++)
+					{
+						T sum = static_cast<T>(0);
+						for (size_t j(0); j < width; j++)
+							sum += values[j*height + r] * x[indices[j*height + r]];
+						out[r] = sum;
+					}
+				}
+
+				static void LoadGather(SimdKernelTable<T>& table)
+				{
+					table.gatherDot = &GatherDot;
+					table.sellSlice = &SellSlice;
+				}
+
+				// 2x2, 3x3 and 4x4 blocks shorter than a vector keep the row sums in registers, as Simd::FixedBlockRow
+				template <size_t N>
+				static void FixedBlockRow(const T* blocks, const unsigned int* blockCols, size_t count, const T* x, size_t xCount, T* out)
+				{
+					T sums[N] = {};
+
+					for (size_t b(0); b < count; b++)
+					{
+						const T* block = blocks + b*N*N;
+						size_t first = static_cast<size_t>(blockCols[b])*N;
+						size_t columns = (first + N <= xCount) ? N : xCount - first;
+						for (size_t c(0); c < columns; c++)
+							for (size_t r(0); r < N; r++)
+								sums[r] += block[c*N + r] * x[first + c];
+					}
+
+					for (size_t r(0); r < N; r++)
+						out[r] = sums[r];
+				}
+
+				// every block column scales one broadcast element of x into the rows of the block - no gathers needed
+				// other blocks shorter than a vector run the scalar tail alone
+				static void BlockRow(const T* blocks, const unsigned int* blockCols, size_t count, const T* x, size_t xCount, size_t rows, size_t cols, T* out)
+				{
+					const size_t w = Ops::Width;
+					if (rows < w && rows == cols && rows >= 2 && rows <= 4)
+					{
+						if (rows == 2)
+							FixedBlockRow<2>(blocks, blockCols, count, x, xCount, out);
+						else if (rows == 3)
+							FixedBlockRow<3>(blocks, blockCols, count, x, xCount, out);
+						else
+							FixedBlockRow<4>(blocks, blockCols, count, x, xCount, out);
+						return;
+					}
+
+					for (size_t r(0); r < rows; r++)
+						out[r] = static_cast<T>(0);
+
+					for (size_t b(0); b < count; b++)
+					{
+						const T* block = blocks + b*rows*cols;
+						size_t first = static_cast<size_t>(blockCols[b])*cols;
+						size_t columns = (first + cols <= xCount) ? cols : xCount - first;
+
+						for (size_t c(0); c < columns; c++)
+						{
+							const T* column = block + c*rows;
+							V xc = Ops::Broadcast(x[first + c]);
+							size_t r(0);
+							for (; r + w <= rows; r += w)
+								Ops::Store(out + r, Ops::Add(Ops::Load(out + r), Ops::Mul(Ops::Load(column + r), xc)));
+							for (; r < rows; r++)
+								out[r] += column[r] * x[first + c];
+						}
+					}
+				}
+
+				// the negated sine keeps the kernel to Add and Mul
+				static void Rotate(T* x, T* y, T c, T s, size_t n)
+				{
+					const size_t w = Ops::Width;
+					V vc = Ops::Broadcast(c);
+					V vs = Ops::Broadcast(s);
+					V vn = Ops::Broadcast(-s);
+					size_t i(0);
+
+					for (; i + 2 * w <= n; i += 2 * w)
+					{
+						V x0 = Ops::Load(x + i);
+						V x1 = Ops::Load(x + i + w);
+						V y0 = Ops::Load(y + i);
+						V y1 = Ops::Load(y + i + w);
+						Ops::Store(x + i, Ops::Add(Ops::Mul(vc, x0), Ops::Mul(vs, y0)));
+						Ops::Store(x + i + w, Ops::Add(Ops::Mul(vc, x1), Ops::Mul(vs, y1)));
+						Ops::Store(y + i, Ops::Add(Ops::Mul(vc, y0), Ops::Mul(vn, x0)));
+						Ops::Store(y + i + w, Ops::Add(Ops::Mul(vc, y1), Ops::Mul(vn, x1)));
+					}
+					for (; i + w <= n; i += w)
+					{
+						V x0 = Ops::Load(x + i);
+						V y0 = Ops::Load(y + i);
+						Ops::Store(x + i, Ops::Add(Ops::Mul(vc, x0), Ops::Mul(vs, y0)));
+						Ops::Store(y + i, Ops::Add(Ops::Mul(vc, y0), Ops::Mul(vn, x0)));
+					}
+					for (; i < n; i++)
+					{
+						T first = x[i];
+						T second = y[i];
+						x[i] = c * first + s * second;
+						y[i] = c * second - s * first;
+					}
+				}
+
+				static void Load(SimdKernelTable<T>& table)
+				{
+					table.fill = &Fill;
+					table.addScalar = &ScalarOperation<Add>;
+					table.mulScalar = &ScalarOperation<Mul>;
+					table.add = &BinaryOperation<Add>;
+					table.mul = &BinaryOperation<Mul>;
+					table.blockRow = &BlockRow;
+					table.rotate = &Rotate;
+				}
+			};
+		}
+	}
+}
+
+#endif // !_SIMD_LOOPS_H_
@@ -0,0 +1,80 @@
+// SSE2 element-wise and sparse block kernels
+// this file must not include anything besides the intrinsics and the kernel loops,
+// so that no inline function of another header is compiled with these target options
+#if defined(__GNUC__) && !defined(__clang__)
+#pragma GCC target("sse2")
+#endif
+
+#include "SimdLoops.h"
+
+#if defined(_M_X64) || defined(_M_IX86) || defined(__x86_64__) || defined(__i386__)
+#include <emmintrin.h>
+#define NUMERO_HAS_SSE2_KERNELS
+#endif
+
+using namespace Numero;
+using namespace Numero::DataTypes;
+
+#ifdef NUMERO_HAS_SSE2_KERNELS
+namespace
+{
+	struct Sse2FloatOps
+	{
+		typedef __m128 Vector;
+		typedef float Scalar;
+		static const size_t Width = 4;
+
+		static Vector Load(const float* p) { return _mm_loadu_ps(p); }
+		static void Store(float* p, Vector v) { _mm_storeu_ps(p, v); }
+		static Vector Broadcast(float value) { return _mm_set1_ps(value); }
+		static Vector Add(Vector a, Vector b) { return _mm_add_ps(a, b); }
+		static Vector Mul(Vector a, Vector b) { return _mm_mul_ps(a, b); }
+	};
+
+	struct Sse2DoubleOps
+	{
+		typedef __m128d Vector;
+		typedef double Scalar;
+		static const size_t Width = 2;
+
+		static Vector Load(const double* p) { return _mm_loadu_pd(p); }
+		static void Store(double* p, Vector v) { _mm_storeu_pd(p, v); }
+		static Vector Broadcast(double value) { return _mm_set1_pd(value); }
+		static Vector Add(Vector a, Vector b) { return _mm_add_pd(a, b); }
+		static Vector Mul(Vector a, Vector b) { return _mm_mul_pd(a, b); }
+	};
+
+	struct Sse2IntOps
+	{
+		typedef __m128i Vector;
+		typedef int Scalar;
+		static const size_t Width = 4;
+
+		static Vector Load(const int* p) { return _mm_loadu_si128(reinterpret_cast<const __m128i*>(p)); }
+		static void Store(int* p, Vector v) { _mm_storeu_si128(reinterpret_cast<__m128i*>(p), v); }
+		static Vector Broadcast(int value) { return _mm_set1_epi32(value); }
+		static Vector Add(Vector a, Vector b) { return _mm_add_epi32(a, b); }
+
+		// SSE2 has no 32 bit low multiply - multiply even and odd lanes as 64 bit products
+		// and gather the low halves, which wraps exactly like the scalar multiplication
+		static Vector Mul(Vector a, Vector b)
+		{
+			Vector even = _mm_mul_epu32(a, b);
+			Vector odd = _mm_mul_epu32(_mm_srli_epi64(a, 32), _mm_srli_epi64(b, 32));
+			return _mm_unpacklo_epi32(_mm_shuffle_epi32(even, _MM_SHUFFLE(0, 0, 2, 0)), _mm_shuffle_epi32(odd, _MM_SHUFFLE(0, 0, 2, 0)));
+		}
+	};
+}
+#endif
+
+bool Numero::DataTypes::LoadSse2Kernels(SimdKernelTable<float>& floatTable, SimdKernelTable<double>& doubleTable, SimdKernelTable<int>& intTable)
+{
+#ifdef NUMERO_HAS_SSE2_KERNELS
+	SimdLoops<Sse2FloatOps>::Load(floatTable);
+	SimdLoops<Sse2DoubleOps>::Load(doubleTable);
+	SimdLoops<Sse2IntOps>::Load(intTable);
+	return true;
+#else
+	return false;
+#endif
+}
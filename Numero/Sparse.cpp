@@ -0,0 +1,1048 @@
+#ifndef _SPARSE_CPP_
+#define _SPARSE_CPP_
+
+#include <assert.h>
+#include <algorithm>
+#include "Sparse.h"
+#include "SparseValueTriplet.cpp"
+#include "Dense.cpp"
+#include "TextFormat.cpp"
+#include "ThreadPool.h"
+#include "Simd.h"
+
+using namespace Numero;
+using namespace Numero::DataTypes;
+
+#pragma region ASSEMBLY
+template <class T>
+Sparse<T>::Sparse(unsigned int rows, unsigned int cols, const vector<SparseValueTriplet<T> >& triplets, unsigned int nThreads)
+	: Matrix<T>(rows, cols)
+{
+	Assemble(triplets.data(), static_cast<unsigned int>(triplets.size()), nThreads);
+}
+
+template <class T>
+Sparse<T>::Sparse(unsigned int rows, unsigned int cols, const SparseValueTriplet<T>* triplets, unsigned int count, unsigned int nThreads)
+	: Matrix<T>(rows, cols)
+{
+	Assemble(triplets, count, nThreads);
+}
+
+template <class T>
+void Sparse<T>::Assemble(const SparseValueTriplet<T>* triplets, unsigned int count, unsigned int nThreads)
+{
+	for (unsigned int i(0); i < count; i++)
+		assert(triplets[i].Row() < nRows && triplets[i].Col() < nCols);
+
+	if (count < ParallelAssemblyThreshold)
+		nThreads = 1;
+
+	vector<SparseValueTriplet<T> > sorted(triplets, triplets + count);
+	SortTriplets(sorted, nThreads);
+	CompressSorted(sorted, nThreads);
+	pending.clear();
+	pendingIndex.clear();
+}
+
+template <class T>
+void Sparse<T>::Assemble(vector<SparseValueTriplet<T> >& triplets, unsigned int nThreads)
+{
+	assert(triplets.size() <= 0xFFFFFFFFu);
+	for (size_t i(0); i < triplets.size(); i++)
+		assert(triplets[i].Row() < nRows && triplets[i].Col() < nCols);
+
+	if (triplets.size() < ParallelAssemblyThreshold)
+		nThreads = 1;
+
+	SortTriplets(triplets, nThreads);
+	CompressSorted(triplets, nThreads);
+	pending.clear();
+	pendingIndex.clear();
+}
+
+// stable merge sort - chunks are sorted in parallel, then every round merges pairs of runs
+// each merge is split into pieces at co-ranks of the output, so the last rounds stay parallel as well
+template <class T>
+void Sparse<T>::SortTriplets(vector<SparseValueTriplet<T> >& triplets, unsigned int nThreads)
+{
+	typedef SparseValueTriplet<T> Triplet;
+
+	ThreadPool& pool = ThreadPool::Global();
+	unsigned int threads = (nThreads == 0 || nThreads > pool.ThreadCount()) ? pool.ThreadCount() : nThreads;
+	unsigned int count = static_cast<unsigned int>(triplets.size());
+
+	if (threads <= 1)
+	{
+		stable_sort(triplets.begin(), triplets.end());
+		return;
+	}
+
+	unsigned int chunkSize = (count + threads - 1) / threads;
+	pool.ParallelFor(threads, [&](unsigned int chunk)
+	{
+		unsigned int begin = (chunk * chunkSize < count) ? chunk * chunkSize : count;
+		unsigned int end = (begin + chunkSize < count) ? begin + chunkSize : count;
+		stable_sort(triplets.begin() + begin, triplets.begin() + end);
+	}, threads);
+
+	vector<Triplet> buffer(count);
+	Triplet* source = triplets.data();
+	Triplet* target = buffer.data();
+
+	for (unsigned int width(chunkSize); width < count; width = (width > count / 2) ? count : 2 * width)
+	{
+		unsigned int merges = (count + 2 * width - 1) / (2 * width);
+		unsigned int pieces = (threads + merges - 1) / merges;
+
+		pool.ParallelFor(merges * pieces, [&](unsigned int task)
+		{
+			unsigned int begin = (task / pieces) * 2 * width;
+			unsigned int middle = (count - begin > width) ? begin + width : count;
+			unsigned int end = (count - middle > width) ? middle + width : count;
+			const Triplet* a = source + begin;
+			const Triplet* b = source + middle;
+			unsigned int aCount = middle - begin;
+			unsigned int bCount = end - middle;
+
+			// co-rank - how many of the first d outputs of the stable merge come from a
+			// ties go to a, so a[i - 1] <= b[d - i] and b[d - i - 1] < a[i]
+			auto coRank = [&](unsigned int d) -> unsigned int
+			{
+				unsigned int low = (d > bCount) ? d - bCount : 0;
+				unsigned int high = (d < aCount) ? d : aCount;
+				while (low < high)
+				{
+					unsigned int i = low + (high - low) / 2;
+					if (b[d - i - 1] < a[i])
+						high = i;
+					else
+						low = i + 1;
+				}
+				return low;
+			};
+
+			unsigned long long total = aCount + bCount;
+			unsigned int piece = task % pieces;
+			unsigned int first = static_cast<unsigned int>(total * piece / pieces);
+			unsigned int last = static_cast<unsigned int>(total * (piece + 1) / pieces);
+			unsigned int aFirst = coRank(first);
+			unsigned int aLast = coRank(last);
+
+			merge(a + aFirst, a + aLast, b + (first - aFirst), b + (last - aLast), target + begin + first);
+		}, threads);
+
+		swap(source, target);
+	}
+
+	if (source != triplets.data())
+		triplets.swap(buffer);
+}
+
+// runs of equal positions collapse into one entry summed in batch order
+// chunks count their run heads, a prefix sum gives every chunk its output range,
+// and every position of the row offsets is written by the entry that starts its row
+template <class T>
+void Sparse<T>::CompressSorted(const vector<SparseValueTriplet<T> >& sorted, unsigned int nThreads)
+{
+	ThreadPool& pool = ThreadPool::Global();
+	unsigned int threads = (nThreads == 0 || nThreads > pool.ThreadCount()) ? pool.ThreadCount() : nThreads;
+	unsigned int count = static_cast<unsigned int>(sorted.size());
+	unsigned int chunks = (count < threads) ? 1 : threads;
+	unsigned int chunkSize = (count + chunks - 1) / chunks;
+
+	vector<unsigned int> chunkOffsets(chunks + 1, 0);
+	pool.ParallelFor(chunks, [&](unsigned int chunk)
+	{
+		unsigned int begin = (chunk * chunkSize < count) ? chunk * chunkSize : count;
+		unsigned int end = (begin + chunkSize < count) ? begin + chunkSize : count;
+		unsigned int heads = 0;
+		for (unsigned int i(begin); i < end; i++)
+		{
+			if (i == 0 || !sorted[i].SamePosition(sorted[i - 1]))
+				heads++;
+		}
+		chunkOffsets[chunk + 1] = heads;
+	}, threads);
+
+	for (unsigned int chunk(0); chunk < chunks; chunk++)
+		chunkOffsets[chunk + 1] += chunkOffsets[chunk];
+
+	unsigned int nonZeros = chunkOffsets[chunks];
+	columnIndices.resize(nonZeros);
+	values.resize(nonZeros);
+	vector<unsigned int> entryRows(nonZeros);
+
+	pool.ParallelFor(chunks, [&](unsigned int chunk)
+	{
+		unsigned int begin = (chunk * chunkSize < count) ? chunk * chunkSize : count;
+		unsigned int end = (begin + chunkSize < count) ? begin + chunkSize : count;
+		unsigned int position = chunkOffsets[chunk];
+
+		// a run started in the previous chunk belongs to that chunk
+		unsigned int i = begin;
+		while (i < end && i > 0 && sorted[i].SamePosition(sorted[i - 1]))
+			i++;
+
+		while (i < end)
+		{
+			T sum = sorted[i].Value();
+			unsigned int next = i + 1;
+			while (next < count && sorted[next].SamePosition(sorted[i]))
+			{
+				sum += sorted[next].Value();
+				next++;
+			}
+
+			entryRows[position] = sorted[i].Row();
+			columnIndices[position] = sorted[i].Col();
+			values[position] = sum;
+			position++;
+			i = next;
+		}
+	}, threads);
+
+	rowOffsets.assign(nRows + 1, 0);
+	unsigned int entryChunkSize = (nonZeros + chunks - 1) / chunks;
+	pool.ParallelFor(chunks, [&](unsigned int chunk)
+	{
+		unsigned int begin = (chunk * entryChunkSize < nonZeros) ? chunk * entryChunkSize : nonZeros;
+		unsigned int end = (begin + entryChunkSize < nonZeros) ? begin + entryChunkSize : nonZeros;
+		for (unsigned int i(begin); i < end; i++)
+		{
+			unsigned int firstRow = (i == 0) ? 0 : entryRows[i - 1] + 1;
+			for (unsigned int row(firstRow); row <= entryRows[i]; row++)
+				rowOffsets[row] = i;
+		}
+	}, threads);
+
+	// rows after the last entry, and the end of the last row
+	unsigned int firstEmpty = (nonZeros == 0) ? 0 : entryRows[nonZeros - 1] + 1;
+	for (unsigned int row(firstEmpty); row <= nRows; row++)
+		rowOffsets[row] = nonZeros;
+}
+#pragma endregion
+
+
+#pragma region BUFFERED_INSERTS
+// the pending positions are all missing from the arrays, so every row is a merge of two runs without ties
+// the merged row offsets are the old ones plus the pending inserts of earlier rows
+template <class T>
+void Sparse<T>::Commit(unsigned int nThreads) const
+{
+	if (pending.empty())
+		return;
+
+	unsigned int count = static_cast<unsigned int>(pending.size());
+	unsigned long long total = static_cast<unsigned long long>(rowOffsets[nRows]) + count;
+
+	assert(total <= 0xFFFFFFFFull);
+
+	ThreadPool& pool = ThreadPool::Global();
+	unsigned int threads = (nThreads == 0 || nThreads > pool.ThreadCount()) ? pool.ThreadCount() : nThreads;
+	if (total < ParallelAssemblyThreshold)
+		threads = 1;
+
+	SortTriplets(pending, threads);
+
+	vector<unsigned int> offsets(nRows + 1);
+	unsigned int rowChunkSize = (nRows + threads) / threads;
+	pool.ParallelFor(threads, [&](unsigned int chunk)
+	{
+		unsigned int begin = (chunk * rowChunkSize <= nRows) ? chunk * rowChunkSize : nRows + 1;
+		unsigned int end = (begin + rowChunkSize <= nRows) ? begin + rowChunkSize : nRows + 1;
+		if (begin >= end)
+			return;
+
+		unsigned int before = static_cast<unsigned int>(lower_bound(pending.begin(), pending.end(), SparseValueTriplet<T>(begin, 0, T())) - pending.begin());
+		for (unsigned int row(begin); row < end; row++)
+		{
+			while (before < count && pending[before].Row() < row)
+				before++;
+			offsets[row] = rowOffsets[row] + before;
+		}
+	}, threads);
+
+	vector<unsigned int> mergedColumns(static_cast<size_t>(total));
+	vector<T> mergedValues(static_cast<size_t>(total));
+	auto partitionRow = [&](unsigned int part) -> unsigned int
+	{
+		if (part >= threads)
+			return nRows;
+		unsigned int target = static_cast<unsigned int>(total * part / threads);
+		return static_cast<unsigned int>(lower_bound(offsets.begin(), offsets.begin() + nRows, target) - offsets.begin());
+	};
+
+	pool.ParallelFor(threads, [&](unsigned int part)
+	{
+		unsigned int endRow = partitionRow(part + 1);
+		for (unsigned int row(partitionRow(part)); row < endRow; row++)
+		{
+			unsigned int entry = rowOffsets[row];
+			unsigned int entryEnd = rowOffsets[row + 1];
+			unsigned int insert = offsets[row] - rowOffsets[row];
+			unsigned int insertEnd = offsets[row + 1] - rowOffsets[row + 1];
+
+			for (unsigned int position(offsets[row]); position < offsets[row + 1]; position++)
+			{
+				if (insert == insertEnd || (entry < entryEnd && columnIndices[entry] < pending[insert].Col()))
+				{
+					mergedColumns[position] = columnIndices[entry];
+					mergedValues[position] = values[entry++];
+				}
+				else
+				{
+					mergedColumns[position] = pending[insert].Col();
+					mergedValues[position] = pending[insert++].Value();
+				}
+			}
+		}
+	}, threads);
+
+	rowOffsets.swap(offsets);
+	columnIndices.swap(mergedColumns);
+	values.swap(mergedValues);
+	pending.clear();
+	pendingIndex.clear();
+}
+
+template <class T>
+unsigned int Sparse<T>::PendingNonZeros() const
+{
+	return static_cast<unsigned int>(pending.size());
+}
+
+template <class T>
+unsigned long long Sparse<T>::PendingKey(unsigned int row, unsigned int col) const
+{
+	return static_cast<unsigned long long>(row) * nCols + col;
+}
+#pragma endregion
+
+
+#pragma region GETTERS_SETTERS
+template <class T>
+unsigned int Sparse<T>::Find(unsigned int row, unsigned int col, bool& found) const
+{
+	const unsigned int* rowBegin = columnIndices.data() + rowOffsets[row];
+	const unsigned int* rowEnd = columnIndices.data() + rowOffsets[row + 1];
+	const unsigned int* position = lower_bound(rowBegin, rowEnd, col);
+
+	found = (position != rowEnd && *position == col);
+	return static_cast<unsigned int>(position - columnIndices.data());
+}
+
+template <class T>
+unsigned int Sparse<T>::NonZeros() const
+{
+	return rowOffsets[nRows] + static_cast<unsigned int>(pending.size());
+}
+
+template <class T>
+unsigned int Sparse<T>::RowNonZeros(unsigned int row) const
+{
+	assert(row < nRows);
+
+	Commit();
+	return rowOffsets[row + 1] - rowOffsets[row];
+}
+
+template <class T>
+T Sparse<T>::GetValue(unsigned int row, unsigned int col) const
+{
+	assert(row < nRows && col < nCols);
+
+	bool found;
+	unsigned int position = Find(row, col, found);
+	if (found)
+		return values[position];
+	if (pending.empty())
+		return static_cast<T>(0);
+
+	auto inserted = pendingIndex.find(PendingKey(row, col));
+	return (inserted != pendingIndex.end()) ? pending[inserted->second].Value() : static_cast<T>(0);
+}
+
+template <class T>
+void Sparse<T>::SetValue(unsigned int row, unsigned int col, T value)
+{
+	assert(row < nRows && col < nCols);
+
+	bool found;
+	unsigned int position = Find(row, col, found);
+
+	if (found)
+	{
+		values[position] = value;
+		return;
+	}
+
+	unsigned long long key = PendingKey(row, col);
+	auto inserted = pendingIndex.find(key);
+
+	if (inserted != pendingIndex.end())
+	{
+		unsigned int index = inserted->second;
+		if (value != static_cast<T>(0))
+		{
+			pending[index] = SparseValueTriplet<T>(row, col, value);
+			return;
+		}
+
+		// zeroed before its commit - the last pending insert takes its slot
+		pendingIndex.erase(inserted);
+		if (index + 1 != pending.size())
+		{
+			pending[index] = pending.back();
+			pendingIndex[PendingKey(pending[index].Row(), pending[index].Col())] = index;
+		}
+		pending.pop_back();
+		return;
+	}
+
+	// zeros are implicit, nothing to store
+	if (value == static_cast<T>(0))
+		return;
+
+	pendingIndex.emplace(key, static_cast<unsigned int>(pending.size()));
+	pending.push_back(SparseValueTriplet<T>(row, col, value));
+
+	unsigned int limit = rowOffsets[nRows] / PendingCommitFraction;
+	if (pending.size() > ((limit > PendingCommitMinimum) ? limit : PendingCommitMinimum))
+		Commit();
+}
+
+template <class T>
+T Sparse<T>::operator()(unsigned int row, unsigned int col) const
+{
+	return GetValue(row, col);
+}
+
+template <class T>
+void Sparse<T>::operator()(unsigned int row, unsigned int col, T value)
+{
+	SetValue(row, col, value);
+}
+
+template <class T>
+const unsigned int* Sparse<T>::RowOffsets() const
+{
+	Commit();
+	return rowOffsets.data();
+}
+
+template <class T>
+const unsigned int* Sparse<T>::ColumnIndices() const
+{
+	Commit();
+	return columnIndices.data();
+}
+
+template <class T>
+const T* Sparse<T>::Values() const
+{
+	Commit();
+	return values.data();
+}
+
+template <class T>
+T* Sparse<T>::Values()
+{
+	Commit();
+	return values.data();
+}
+#pragma endregion
+
+
+#pragma region CONVERSIONS
+// rows are written whole, zeros and scattered nonzeros, so the storage is taken without the zero fill
+template <class T>
+Dense<T> Sparse<T>::ToDense(unsigned int nThreads) const
+{
+	Commit(nThreads);
+	Dense<T> dense(nRows, nCols, Uninitialized);
+	T* data = dense.Data();
+
+	unsigned int threads = ProductThreads(static_cast<unsigned long long>(nRows) * nCols, nThreads);
+	unsigned int chunkSize = (nRows + threads - 1) / threads;
+
+	ThreadPool::Global().ParallelFor(threads, [&](unsigned int chunk)
+	{
+		unsigned int begin = (chunk * chunkSize < nRows) ? chunk * chunkSize : nRows;
+		unsigned int end = (begin + chunkSize < nRows) ? begin + chunkSize : nRows;
+		for (unsigned int row(begin); row < end; row++)
+		{
+			T* denseRow = data + static_cast<size_t>(row) * nCols;
+			Simd::Fill(denseRow, static_cast<T>(0), nCols);
+			for (unsigned int entry(rowOffsets[row]); entry < rowOffsets[row + 1]; entry++)
+				denseRow[columnIndices[entry]] = values[entry];
+		}
+	}, threads);
+
+	return dense;
+}
+
+// declared in Dense.h - chunks of rows count their kept elements, the counts become row offsets,
+// and the same chunks write the columns and values
+template <class T>
+Sparse<T> Dense<T>::ToSparse(T threshold, unsigned int nThreads) const
+{
+	Sparse<T> sparse(nRows, nCols);
+	vector<unsigned int>& rowOffsets = sparse.rowOffsets;
+
+	ThreadPool& pool = ThreadPool::Global();
+	unsigned int threads = (nThreads == 0 || nThreads > pool.ThreadCount()) ? pool.ThreadCount() : nThreads;
+	if (static_cast<unsigned long long>(nRows) * nCols < Sparse<T>::ParallelProductThreshold)
+		threads = 1;
+	unsigned int chunkSize = (nRows + threads - 1) / threads;
+
+	// both comparisons always evaluated, so the test compiles without branches
+	auto kept = [threshold](T value) { return (value > threshold) | (value < -threshold); };
+
+	pool.ParallelFor(threads, [&](unsigned int chunk)
+	{
+		unsigned int begin = (chunk * chunkSize < nRows) ? chunk * chunkSize : nRows;
+		unsigned int end = (begin + chunkSize < nRows) ? begin + chunkSize : nRows;
+		for (unsigned int row(begin); row < end; row++)
+		{
+			const T* denseRow = matrixData + static_cast<size_t>(row) * nCols;
+			unsigned int count = 0;
+			for (unsigned int col(0); col < nCols; col++)
+				count += kept(denseRow[col]) ? 1 : 0;
+			rowOffsets[row + 1] = count;
+		}
+	}, threads);
+
+	unsigned long long total = 0;
+	for (unsigned int row(0); row < nRows; row++)
+	{
+		total += rowOffsets[row + 1];
+		rowOffsets[row + 1] = static_cast<unsigned int>(total);
+	}
+
+	assert(total <= 0xFFFFFFFFull);
+
+	sparse.columnIndices.resize(static_cast<size_t>(total));
+	sparse.values.resize(static_cast<size_t>(total));
+
+	// every element is written to a row of scratch and the position advanced only when it is kept -
+	// no branch to mispredict on scattered patterns - then the kept prefix is copied out
+	pool.ParallelFor(threads, [&](unsigned int chunk)
+	{
+		unsigned int begin = (chunk * chunkSize < nRows) ? chunk * chunkSize : nRows;
+		unsigned int end = (begin + chunkSize < nRows) ? begin + chunkSize : nRows;
+		vector<unsigned int> rowColumns(nCols);
+		vector<T> rowValues(nCols);
+
+		for (unsigned int row(begin); row < end; row++)
+		{
+			const T* denseRow = matrixData + static_cast<size_t>(row) * nCols;
+			unsigned int count = 0;
+			for (unsigned int col(0); col < nCols; col++)
+			{
+				rowColumns[count] = col;
+				rowValues[count] = denseRow[col];
+				count += kept(denseRow[col]) ? 1 : 0;
+			}
+
+			copy(rowColumns.begin(), rowColumns.begin() + count, sparse.columnIndices.begin() + rowOffsets[row]);
+			copy(rowValues.begin(), rowValues.begin() + count, sparse.values.begin() + rowOffsets[row]);
+		}
+	}, threads);
+
+	return sparse;
+}
+#pragma endregion
+
+
+#pragma region PRODUCTS
+// rows whose first nonzero lies in [part*nnz/parts, (part+1)*nnz/parts) - the last part also takes trailing empty rows
+template <class T>
+unsigned int Sparse<T>::PartitionRow(unsigned int part, unsigned int parts) const
+{
+	if (part >= parts)
+		return nRows;
+
+	unsigned int target = static_cast<unsigned int>(static_cast<unsigned long long>(NonZeros()) * part / parts);
+	return static_cast<unsigned int>(lower_bound(rowOffsets.begin(), rowOffsets.begin() + nRows, target) - rowOffsets.begin());
+}
+
+template <class T>
+unsigned int Sparse<T>::ProductThreads(unsigned long long work, unsigned int nThreads)
+{
+	unsigned int poolThreads = ThreadPool::Global().ThreadCount();
+	if (work < ParallelProductThreshold)
+		return 1;
+	return (nThreads == 0 || nThreads > poolThreads) ? poolThreads : nThreads;
+}
+
+template <class T>
+Dense<T> Sparse<T>::operator*(const Dense<T>& x) const
+{
+	assert(x.Rows() == nCols);
+
+	Commit();
+	double elements = static_cast<double>(nRows) * nCols;
+	MixedKernel kernel = MixedKernels::SelectProduct(nRows, nCols, NonZeros(), x.Cols());
+	MixedKernels::Record({ "sparse*dense", kernel, nRows, nCols, x.Cols(), (elements > 0) ? NonZeros() / elements : 0 });
+
+	if (kernel == MixedKernel::DenseGemm)
+		return ToDense() * x;
+
+	Dense<T> out;
+	MulInto(x, out);
+	return out;
+}
+
+// one right-hand side is a sparse matrix-vector product, more of them accumulate
+// every nonzero times a contiguous row of x into the output row
+template <class T>
+void Sparse<T>::MulInto(const Dense<T>& x, Dense<T>& out, unsigned int nThreads) const
+{
+	assert(x.Rows() == nCols);
+	assert(&x != &out);
+
+	Commit(nThreads);
+	unsigned int k = x.Cols();
+	out.Resize(nRows, k);
+
+	if (k == 1)
+	{
+		MulVectorInto(x.Data(), out.Data(), nThreads);
+		return;
+	}
+
+	unsigned int threads = ProductThreads(static_cast<unsigned long long>(NonZeros()) * k, nThreads);
+	const T* xData = x.Data();
+	T* outData = out.Data();
+
+	ThreadPool::Global().ParallelFor(threads, [&](unsigned int part)
+	{
+		unsigned int endRow = PartitionRow(part + 1, threads);
+		for (unsigned int row(PartitionRow(part, threads)); row < endRow; row++)
+		{
+			T* outRow = outData + static_cast<size_t>(row)*k;
+			Simd::Fill(outRow, static_cast<T>(0), k);
+
+			for (unsigned int entry(rowOffsets[row]); entry < rowOffsets[row + 1]; entry++)
+			{
+				T value = values[entry];
+				const T* xRow = xData + static_cast<size_t>(columnIndices[entry])*k;
+				for (unsigned int j(0); j < k; j++)
+					outRow[j] += value * xRow[j];
+			}
+		}
+	}, threads);
+}
+
+template <class T>
+void Sparse<T>::MulVectorInto(const T* x, T* y, unsigned int nThreads) const
+{
+	assert(x != y);
+
+	Commit(nThreads);
+	CsrMulVectorInto(rowOffsets.data(), columnIndices.data(), values.data(), nRows, nCols, x, y, nThreads);
+}
+
+// rows split as in PartitionRow, by the position of their first nonzero
+template <class T>
+void Sparse<T>::CsrMulVectorInto(const unsigned int* rowOffsets, const unsigned int* columnIndices, const T* values,
+	unsigned int rows, unsigned int cols, const T* x, T* y, unsigned int nThreads)
+{
+	unsigned int nonZeros = rowOffsets[rows];
+	unsigned int threads = ProductThreads(nonZeros, nThreads);
+	// the gather kernels index with signed 32 bit offsets
+	bool gather = (cols <= 0x7FFFFFFFu);
+
+	auto partitionRow = [&](unsigned int part) -> unsigned int
+	{
+		if (part >= threads)
+			return rows;
+		unsigned int target = static_cast<unsigned int>(static_cast<unsigned long long>(nonZeros) * part / threads);
+		return static_cast<unsigned int>(lower_bound(rowOffsets, rowOffsets + rows, target) - rowOffsets);
+	};
+
+	ThreadPool::Global().ParallelFor(threads, [&](unsigned int part)
+	{
+		unsigned int endRow = partitionRow(part + 1);
+		for (unsigned int row(partitionRow(part)); row < endRow; row++)
+		{
+			unsigned int begin = rowOffsets[row];
+			unsigned int count = rowOffsets[row + 1] - begin;
+
+			if (gather && count >= GatherRowThreshold)
+			{
+				y[row] = Simd::GatherDot(values + begin, columnIndices + begin, x, count);
+				continue;
+			}
+
+			T sum = static_cast<T>(0);
+			for (unsigned int entry(begin); entry < begin + count; entry++)
+				sum += values[entry] * x[columnIndices[entry]];
+			y[row] = sum;
+		}
+	}, threads);
+}
+
+// every row of out accumulates the rows of A picked by the nonzeros of the same row of a
+// rows of a are independent, so they are split evenly between threads
+template <class T>
+void Sparse<T>::LeftMulInto(const Dense<T>& a, Dense<T>& out, unsigned int nThreads) const
+{
+	assert(a.Cols() == nRows);
+	assert(&a != &out);
+
+	Commit(nThreads);
+	unsigned int m = a.Rows();
+	out.Resize(m, nCols);
+
+	unsigned int threads = ProductThreads(static_cast<unsigned long long>(NonZeros()) * m, nThreads);
+	unsigned int chunkSize = (m + threads - 1) / threads;
+	const T* aData = a.Data();
+	T* outData = out.Data();
+
+	ThreadPool::Global().ParallelFor(threads, [&](unsigned int chunk)
+	{
+		unsigned int begin = (chunk * chunkSize < m) ? chunk * chunkSize : m;
+		unsigned int end = (begin + chunkSize < m) ? begin + chunkSize : m;
+		for (unsigned int i(begin); i < end; i++)
+		{
+			const T* aRow = aData + static_cast<size_t>(i) * nRows;
+			T* outRow = outData + static_cast<size_t>(i) * nCols;
+			Simd::Fill(outRow, static_cast<T>(0), nCols);
+
+			for (unsigned int k(0); k < nRows; k++)
+			{
+				T scale = aRow[k];
+				if (scale == static_cast<T>(0))
+					continue;
+				for (unsigned int entry(rowOffsets[k]); entry < rowOffsets[k + 1]; entry++)
+					outRow[columnIndices[entry]] += scale * values[entry];
+			}
+		}
+	}, threads);
+}
+
+template <class T>
+void Sparse<T>::AddInto(const Dense<T>& x, Dense<T>& out, unsigned int nThreads) const
+{
+	assert(x.Rows() == nRows && x.Cols() == nCols);
+
+	Commit(nThreads);
+	if (&out != &x)
+		out = x;
+
+	unsigned int threads = ProductThreads(NonZeros(), nThreads);
+	T* outData = out.Data();
+
+	ThreadPool::Global().ParallelFor(threads, [&](unsigned int part)
+	{
+		unsigned int endRow = PartitionRow(part + 1, threads);
+		for (unsigned int row(PartitionRow(part, threads)); row < endRow; row++)
+		{
+			T* outRow = outData + static_cast<size_t>(row) * nCols;
+			for (unsigned int entry(rowOffsets[row]); entry < rowOffsets[row + 1]; entry++)
+				outRow[columnIndices[entry]] += values[entry];
+		}
+	}, threads);
+}
+#pragma endregion
+
+
+#pragma region MIXED_OPERATORS
+template <class T>
+Dense<T> Numero::DataTypes::operator*(const Dense<T>& a, const Sparse<T>& b)
+{
+	assert(a.Cols() == b.Rows());
+
+	b.Commit();
+	double elements = static_cast<double>(b.Rows()) * b.Cols();
+	MixedKernel kernel = MixedKernels::SelectProduct(b.Rows(), b.Cols(), b.NonZeros(), a.Rows());
+	MixedKernels::Record({ "dense*sparse", kernel, a.Rows(), a.Cols(), b.Cols(), (elements > 0) ? b.NonZeros() / elements : 0 });
+
+	if (kernel == MixedKernel::DenseGemm)
+		return a * b.ToDense();
+
+	Dense<T> out;
+	b.LeftMulInto(a, out);
+	return out;
+}
+
+// a sum has one sensible kernel - it is still recorded, so the log covers every mixed operation
+template <class T>
+Dense<T> Numero::DataTypes::operator+(const Sparse<T>& a, const Dense<T>& b)
+{
+	double elements = static_cast<double>(a.Rows()) * a.Cols();
+	MixedKernels::Record({ "sparse+dense", MixedKernel::Scatter, a.Rows(), 0, a.Cols(), (elements > 0) ? a.NonZeros() / elements : 0 });
+
+	Dense<T> out;
+	a.AddInto(b, out);
+	return out;
+}
+
+template <class T>
+Dense<T> Numero::DataTypes::operator+(const Dense<T>& a, const Sparse<T>& b)
+{
+	double elements = static_cast<double>(b.Rows()) * b.Cols();
+	MixedKernels::Record({ "dense+sparse", MixedKernel::Scatter, b.Rows(), 0, b.Cols(), (elements > 0) ? b.NonZeros() / elements : 0 });
+
+	Dense<T> out;
+	b.AddInto(a, out);
+	return out;
+}
+#pragma endregion
+
+
+#pragma region SPARSE_PRODUCTS
+template <class T>
+Sparse<T> Sparse<T>::operator*(const Sparse<T>& b) const
+{
+	Sparse<T> out;
+	MulInto(b, out);
+	return out;
+}
+
+template <class T>
+void Sparse<T>::MulInto(const Sparse<T>& b, Sparse<T>& out, unsigned int nThreads) const
+{
+	assert(nCols == b.nRows);
+	assert(&out != this && &out != &b);
+
+	Commit(nThreads);
+	b.Commit(nThreads);
+
+	// multiply-adds of every row, prefix summed - the rows are split between threads on this
+	vector<unsigned long long> work(nRows + 1, 0);
+	for (unsigned int row(0); row < nRows; row++)
+	{
+		unsigned long long products = 0;
+		for (unsigned int entry(rowOffsets[row]); entry < rowOffsets[row + 1]; entry++)
+			products += b.rowOffsets[columnIndices[entry] + 1] - b.rowOffsets[columnIndices[entry]];
+		work[row + 1] = work[row] + products;
+	}
+
+	unsigned int threads = ProductThreads(work[nRows], nThreads);
+	auto partitionRow = [&](unsigned int part) -> unsigned int
+	{
+		if (part >= threads)
+			return nRows;
+		unsigned long long target = work[nRows] / threads * part + work[nRows] % threads * part / threads;
+		return static_cast<unsigned int>(lower_bound(work.begin(), work.begin() + nRows, target) - work.begin());
+	};
+
+	vector<ProductWorkspace> workspaces(threads);
+	vector<unsigned long long> counts(nRows + 1, 0);
+	ThreadPool& pool = ThreadPool::Global();
+
+	pool.ParallelFor(threads, [&](unsigned int part)
+	{
+		workspaces[part].stamp = 0;
+		unsigned int endRow = partitionRow(part + 1);
+		for (unsigned int row(partitionRow(part)); row < endRow; row++)
+			counts[row + 1] = ProductRow(b, row, work[row + 1] - work[row], workspaces[part], nullptr, nullptr);
+	}, threads);
+
+	for (unsigned int row(0); row < nRows; row++)
+		counts[row + 1] += counts[row];
+
+	assert(counts[nRows] <= 0xFFFFFFFFull);
+
+	out.nRows = nRows;
+	out.nCols = b.nCols;
+	out.pending.clear();
+	out.pendingIndex.clear();
+	out.rowOffsets.resize(nRows + 1);
+	for (unsigned int row(0); row <= nRows; row++)
+		out.rowOffsets[row] = static_cast<unsigned int>(counts[row]);
+	out.columnIndices.resize(out.rowOffsets[nRows]);
+	out.values.resize(out.rowOffsets[nRows]);
+
+	pool.ParallelFor(threads, [&](unsigned int part)
+	{
+		unsigned int endRow = partitionRow(part + 1);
+		for (unsigned int row(partitionRow(part)); row < endRow; row++)
+		{
+			unsigned int begin = out.rowOffsets[row];
+			ProductRow(b, row, work[row + 1] - work[row], workspaces[part], out.columnIndices.data() + begin, out.values.data() + begin);
+		}
+	}, threads);
+}
+
+// the products of a row are summed in the order of the entries of A and then of b, whichever
+// accumulator is used - the sort only orders the output columns
+template <class T>
+unsigned int Sparse<T>::ProductRow(const Sparse<T>& b, unsigned int row, unsigned long long products, ProductWorkspace& workspace,
+	unsigned int* columns, T* sums) const
+{
+	const unsigned int Empty = 0xFFFFFFFFu;
+	bool numeric = (columns != nullptr);
+	workspace.columns.clear();
+
+	if (products == 0)
+		return 0;
+
+	if (products * DenseAccumulatorFraction >= b.nCols)
+	{
+		if (workspace.stamps.size() != b.nCols)
+		{
+			workspace.stamps.assign(b.nCols, 0);
+			workspace.stamp = 0;
+		}
+		if (numeric && workspace.dense.size() != b.nCols)
+			workspace.dense.resize(b.nCols);
+
+		// a new stamp empties the accumulator without touching it
+		if (++workspace.stamp == 0)
+		{
+			fill(workspace.stamps.begin(), workspace.stamps.end(), 0);
+			workspace.stamp = 1;
+		}
+
+		for (unsigned int entry(rowOffsets[row]); entry < rowOffsets[row + 1]; entry++)
+		{
+			unsigned int k = columnIndices[entry];
+			T scale = values[entry];
+			for (unsigned int bEntry(b.rowOffsets[k]); bEntry < b.rowOffsets[k + 1]; bEntry++)
+			{
+				unsigned int col = b.columnIndices[bEntry];
+				if (workspace.stamps[col] != workspace.stamp)
+				{
+					workspace.stamps[col] = workspace.stamp;
+					workspace.columns.push_back(col);
+					if (numeric)
+						workspace.dense[col] = scale * b.values[bEntry];
+				}
+				else if (numeric)
+					workspace.dense[col] += scale * b.values[bEntry];
+			}
+		}
+
+		size_t count = workspace.columns.size();
+		if (numeric && count * 16 >= b.nCols)
+		{
+			// dense enough that scanning the stamps in column order beats sorting
+			size_t i(0);
+			for (unsigned int col(0); col < b.nCols; col++)
+			{
+				if (workspace.stamps[col] == workspace.stamp)
+				{
+					columns[i] = col;
+					sums[i++] = workspace.dense[col];
+				}
+			}
+		}
+		else if (numeric)
+		{
+			sort(workspace.columns.begin(), workspace.columns.end());
+			for (size_t i(0); i < count; i++)
+			{
+				columns[i] = workspace.columns[i];
+				sums[i] = workspace.dense[workspace.columns[i]];
+			}
+		}
+		return static_cast<unsigned int>(count);
+	}
+
+	// linear probing in a power of two table holding at least twice the products,
+	// the top bits of a multiplicative hash pick the slot
+	unsigned int bits = 4;
+	while ((1ull << bits) < 2 * products)
+		bits++;
+	size_t capacity = size_t(1) << bits;
+	size_t mask = capacity - 1;
+	workspace.keys.assign(capacity, Empty);
+	if (numeric && workspace.hashed.size() < capacity)
+		workspace.hashed.resize(capacity);
+
+	for (unsigned int entry(rowOffsets[row]); entry < rowOffsets[row + 1]; entry++)
+	{
+		unsigned int k = columnIndices[entry];
+		T scale = values[entry];
+		for (unsigned int bEntry(b.rowOffsets[k]); bEntry < b.rowOffsets[k + 1]; bEntry++)
+		{
+			unsigned int col = b.columnIndices[bEntry];
+			size_t slot = (col * 2654435761u) >> (32 - bits);
+			while (workspace.keys[slot] != Empty && workspace.keys[slot] != col)
+				slot = (slot + 1) & mask;
+
+			if (workspace.keys[slot] == Empty)
+			{
+				workspace.keys[slot] = col;
+				workspace.columns.push_back(col);
+				if (numeric)
+					workspace.hashed[slot] = scale * b.values[bEntry];
+			}
+			else if (numeric)
+				workspace.hashed[slot] += scale * b.values[bEntry];
+		}
+	}
+
+	if (numeric)
+	{
+		sort(workspace.columns.begin(), workspace.columns.end());
+		for (size_t i(0); i < workspace.columns.size(); i++)
+		{
+			unsigned int col = workspace.columns[i];
+			size_t slot = (col * 2654435761u) >> (32 - bits);
+			while (workspace.keys[slot] != col)
+				slot = (slot + 1) & mask;
+			columns[i] = col;
+			sums[i] = workspace.hashed[slot];
+		}
+	}
+	return static_cast<unsigned int>(workspace.columns.size());
+}
+
+// counting sort by column - walking the rows in order keeps every row of the result ascending
+template <class T>
+Sparse<T> Sparse<T>::Transpose() const
+{
+	Commit();
+	Sparse<T> transposed(nCols, nRows);
+	unsigned int nonZeros = NonZeros();
+	transposed.columnIndices.resize(nonZeros);
+	transposed.values.resize(nonZeros);
+
+	for (unsigned int entry(0); entry < nonZeros; entry++)
+		transposed.rowOffsets[columnIndices[entry] + 1]++;
+	for (unsigned int col(0); col < nCols; col++)
+		transposed.rowOffsets[col + 1] += transposed.rowOffsets[col];
+
+	vector<unsigned int> next(transposed.rowOffsets.begin(), transposed.rowOffsets.end() - 1);
+	for (unsigned int row(0); row < nRows; row++)
+	{
+		for (unsigned int entry(rowOffsets[row]); entry < rowOffsets[row + 1]; entry++)
+		{
+			unsigned int position = next[columnIndices[entry]]++;
+			transposed.columnIndices[position] = row;
+			transposed.values[position] = values[entry];
+		}
+	}
+
+	return transposed;
+}
+#pragma endregion
+
+
+#pragma region IO
+// same layout as Dense::ToString, walking every row once instead of searching every element
+template <class T>
+string Sparse<T>::ToString() const
+{
+	Commit();
+	string text;
+	char buffer[TextFormat::ChunkSize];
+
+	// elements are asked for in row-major order, so one cursor walks the nonzeros
+	unsigned int entry = 0;
+	auto at = [&](unsigned int row, unsigned int col) -> T
+	{
+		if (entry < rowOffsets[row + 1] && columnIndices[entry] == col)
+			return values[entry++];
+		return static_cast<T>(0);
+	};
+	TextFormat::FormatMatrix<T>(nRows, nCols, at, buffer, sizeof(buffer), [&](const char* data, size_t length) { text.append(data, length); });
+	return text;
+}
+#pragma endregion
+
+#endif // !_SPARSE_CPP_
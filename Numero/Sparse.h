@@ -1,23 +1,177 @@
 #ifndef _SPARSE_H_
-#define _SPARSE_H
+#define _SPARSE_H_
 
 #include "../Numero.Definitions/DataTypeDefines.h"
+#include "Matrix.h"
+#include "SparseValueTriplet.h"
+#include "Dense.h"
+#include "MixedKernels.h"
+#include <vector>
+#include <unordered_map>
+#include <sstream>
 
 namespace Numero
 {
-    using namespace Definitions;
-
-    namespace DataTypes
-    {
-        template <class T>
-        class Sparse : Matrix<T>
-        {
-        private:
-            
-        public:
-            Sparse(unsigned int rows, unsigned int cols) : Matrix(rows, cols) {};
-        };
-    }
+	using namespace std;
+	using namespace Definitions;
+
+	namespace DataTypes
+	{
+		// Sparse class
+		// represents sparse matrix in compressed sparse row (CSR) storage
+		// implements matrix base class - element lookup is a binary search within the row
+		// built from batches of SparseValueTriplet, duplicates of a position are summed
+		// SetValue of a stored position writes in place, a new position waits in a side buffer of triplets
+		// that element reads consult, and is merged into the CSR arrays in one batch by Commit - called
+		// explicitly, once the buffer outgrows a fraction of the nonzeros, or by the first bulk read
+		// a bulk read of a const matrix with pending inserts therefore writes it: const access from several threads
+		// is safe only when nothing is pending, as after Commit(). any commit, including one a later SetValue
+		// triggers, invalidates the pointers returned by RowOffsets(), ColumnIndices() and Values()
+		template <class T>
+		class Sparse : Matrix<T>
+		{
+		private:
+			// mutable so that const bulk reads can commit pending inserts first
+			mutable vector<unsigned int> rowOffsets;	// row i occupies [rowOffsets[i], rowOffsets[i+1]) of the arrays below
+			mutable vector<unsigned int> columnIndices;	// ascending within every row
+			mutable vector<T> values;
+
+			// inserts of positions missing from the arrays above, at most one per position, never zero
+			mutable vector<SparseValueTriplet<T> > pending;
+			mutable unordered_map<unsigned long long, unsigned int> pendingIndex;	// row * cols + col -> index in pending
+
+			// position of (row, col) in columnIndices / values, or where it would be inserted
+			unsigned int Find(unsigned int row, unsigned int col, bool& found) const;
+			unsigned long long PendingKey(unsigned int row, unsigned int col) const;
+
+			// stable sort by position - chunks sorted in parallel, then merged in parallel rounds
+			static void SortTriplets(vector<SparseValueTriplet<T> >& triplets, unsigned int nThreads);
+			// builds the CSR arrays from sorted triplets, summing runs of the same position
+			void CompressSorted(const vector<SparseValueTriplet<T> >& sorted, unsigned int nThreads);
+
+			// first row of part `part` when the nonzeros are split into `parts` equal ranges
+			unsigned int PartitionRow(unsigned int part, unsigned int parts) const;
+			static unsigned int ProductThreads(unsigned long long work, unsigned int nThreads);
+
+			// per thread scratch of the sparse-sparse product - a dense accumulator over the columns
+			// of the result with generation stamps, and an open addressing table for short rows
+			struct ProductWorkspace
+			{
+				vector<unsigned int> stamps;
+				vector<T> dense;
+				vector<unsigned int> keys;
+				vector<T> hashed;
+				vector<unsigned int> columns;	// distinct columns of the current row, in order of appearance
+				unsigned int stamp;
+			};
+			// distinct columns of one row of A*b, written sorted with their sums when columns is not null
+			unsigned int ProductRow(const Sparse<T>& b, unsigned int row, unsigned long long products, ProductWorkspace& workspace,
+				unsigned int* columns, T* sums) const;
+		protected:
+			using Matrix<T>::nRows;
+			using Matrix<T>::nCols;
+
+			// Dense::ToSparse and the binary reader write the arrays directly
+			template <class U, unsigned int R, unsigned int C> friend class Dense;
+			friend class BinaryMatrix;
+		public:
+			typedef T ValueType;
+
+			// --- constructors
+			Sparse() : Matrix<T>(0, 0), rowOffsets(1, 0) {};
+			Sparse(unsigned int rows, unsigned int cols) : Matrix<T>(rows, cols), rowOffsets(rows + 1, 0) {};
+			Sparse(unsigned int rows, unsigned int cols, const vector<SparseValueTriplet<T> >& triplets, unsigned int nThreads = 0);
+			Sparse(unsigned int rows, unsigned int cols, const SparseValueTriplet<T>* triplets, unsigned int count, unsigned int nThreads = 0);
+
+			// replaces the contents with the sum of the triplets - nThreads as in ThreadPool::ParallelFor
+			// the summation order of duplicates follows their order in the batch, so results are deterministic
+			void Assemble(const SparseValueTriplet<T>* triplets, unsigned int count, unsigned int nThreads = 0);
+			// as above, sorting the batch in place instead of a copy of it - the batch is left sorted
+			void Assemble(vector<SparseValueTriplet<T> >& triplets, unsigned int nThreads = 0);
+
+			// batches below this many triplets are assembled on the calling thread
+			static const unsigned int ParallelAssemblyThreshold = 1 << 15;
+
+			// --- buffered inserts
+			// merges the pending inserts into the CSR arrays - rows are split between threads by their merged
+			// nonzero count and every row is a merge of two sorted runs, O(nnz + p log p) for p pending inserts
+			// the raw storage accessors and the products commit by themselves, so like SetValue a commit must not
+			// race with other access to the matrix - commit before sharing a matrix between threads
+			void Commit(unsigned int nThreads = 0) const;
+			unsigned int PendingNonZeros() const;
+
+			// SetValue commits once more than max(PendingCommitMinimum, committed nonzeros / PendingCommitFraction)
+			// inserts are pending, which keeps the merges amortized to a few copies per insert
+			static const unsigned int PendingCommitFraction = 16;
+			static const unsigned int PendingCommitMinimum = 1024;
+
+			// committed and pending nonzeros
+			unsigned int NonZeros() const;
+			unsigned int RowNonZeros(unsigned int row) const;
+			using Matrix<T>::Rows;
+			using Matrix<T>::Cols;
+
+			// --- base class implementations
+			// element reads look up the pending inserts when the arrays miss, SetValue of a missing position is buffered
+			virtual T GetValue(unsigned int row, unsigned int col) const;
+			virtual void SetValue(unsigned int row, unsigned int col, T value);
+			virtual T operator()(unsigned int row, unsigned int col) const;
+			virtual void operator()(unsigned int row, unsigned int col, T value);
+			virtual string ToString() const;
+
+			// --- conversion, every row expanded in parallel from its nonzeros
+			Dense<T> ToDense(unsigned int nThreads = 0) const;
+
+			// --- products with dense matrices, out = A*x for every column of x
+			// rows are split between threads by nonzero count, so a few long rows do not stall one thread
+			// out is resized as needed and keeps its buffer, and must not alias x
+			// the operator picks this kernel or ToDense and Gemm through MixedKernels::SelectProduct, see MixedKernels.h
+			Dense<T> operator*(const Dense<T>& x) const;
+			void MulInto(const Dense<T>& x, Dense<T>& out, unsigned int nThreads = 0) const;
+			// out = a*A - every row of a scales and adds the rows of A, out must not alias a
+			void LeftMulInto(const Dense<T>& a, Dense<T>& out, unsigned int nThreads = 0) const;
+			// out = A + x - x copied into out, which may be x itself, and the nonzeros added in parallel rows
+			void AddInto(const Dense<T>& x, Dense<T>& out, unsigned int nThreads = 0) const;
+			// y = A*x on raw vectors of Cols() and Rows() elements
+			void MulVectorInto(const T* x, T* y, unsigned int nThreads = 0) const;
+			// the same kernel on CSR arrays that no Sparse owns, such as a MappedSparse file
+			static void CsrMulVectorInto(const unsigned int* rowOffsets, const unsigned int* columnIndices, const T* values,
+				unsigned int rows, unsigned int cols, const T* x, T* y, unsigned int nThreads = 0);
+
+			// products below this many multiply-adds stay on the calling thread
+			static const unsigned int ParallelProductThreshold = 1 << 15;
+			// rows with at least this many nonzeros go through the SIMD gather kernel, shorter ones through a plain loop
+			static const unsigned int GatherRowThreshold = 8;
+
+			// --- products with sparse matrices, out = A*b
+			// a symbolic pass sizes every row of the result and a numeric pass fills it, both splitting the rows
+			// between threads by their multiply-add count. a row accumulates in a dense array when it has many
+			// products and in a hash table otherwise, and is written with ascending columns, so the result is
+			// the same for any thread count. sums that cancel stay as explicit zeros
+			Sparse<T> operator*(const Sparse<T>& b) const;
+			void MulInto(const Sparse<T>& b, Sparse<T>& out, unsigned int nThreads = 0) const;
+			// A' - A'*A is Transpose() * A
+			Sparse<T> Transpose() const;
+
+			// rows with at least b.Cols()/DenseAccumulatorFraction products use the dense accumulator
+			static const unsigned int DenseAccumulatorFraction = 16;
+
+			// raw CSR storage for kernels working on the compressed arrays - every accessor commits first, and the
+			// pointers stay valid until the next commit, which a SetValue of a missing position may trigger
+			const unsigned int* RowOffsets() const;
+			const unsigned int* ColumnIndices() const;
+			const T* Values() const;
+			T* Values();
+		};
+
+		// --- mixed operators with a dense result, the kernel choice is recorded through MixedKernels
+		template <class T>
+		Dense<T> operator*(const Dense<T>& a, const Sparse<T>& b);
+		template <class T>
+		Dense<T> operator+(const Sparse<T>& a, const Dense<T>& b);
+		template <class T>
+		Dense<T> operator+(const Dense<T>& a, const Sparse<T>& b);
+	}
 }
 
-#endif
+#endif // !_SPARSE_H_
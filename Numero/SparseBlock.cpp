@@ -0,0 +1,177 @@
+#ifndef _SPARSE_BLOCK_CPP_
+#define _SPARSE_BLOCK_CPP_
+
+#include <assert.h>
+#include <algorithm>
+#include "SparseBlock.h"
+#include "Sparse.cpp"
+#include "ThreadPool.h"
+#include "Simd.h"
+
+using namespace Numero;
+using namespace Numero::DataTypes;
+
+#pragma region CONSTRUCTION
+// two passes over chunks of block rows - the first counts the distinct tiles of every block row,
+// a prefix sum places them and the second fills them, every chunk with its own marker array
+template <class T>
+SparseBlock<T>::SparseBlock(const Sparse<T>& matrix, unsigned int blockRows, unsigned int blockCols, unsigned int nThreads)
+	: nRows(matrix.Rows()), nCols(matrix.Cols()), nonZeros(matrix.NonZeros()), blockRows(blockRows), blockCols(blockCols)
+{
+	assert(blockRows > 0 && blockRows <= MaxBlockRows && blockCols > 0);
+
+	const unsigned int* offsets = matrix.RowOffsets();
+	const unsigned int* columns = matrix.ColumnIndices();
+	const T* entries = matrix.Values();
+	size_t tileSize = static_cast<size_t>(blockRows) * blockCols;
+
+	unsigned int nBlockRows = (nRows + blockRows - 1) / blockRows;
+	unsigned int nBlockCols = (nCols + blockCols - 1) / blockCols;
+
+	ThreadPool& pool = ThreadPool::Global();
+	unsigned int threads = (nThreads == 0 || nThreads > pool.ThreadCount()) ? pool.ThreadCount() : nThreads;
+	unsigned int chunks = (nonZeros < ParallelProductThreshold || nBlockRows < threads) ? 1 : threads;
+	unsigned int chunkSize = (nBlockRows + chunks - 1) / chunks;
+
+	blockRowOffsets.assign(nBlockRows + 1, 0);
+	pool.ParallelFor(chunks, [&](unsigned int chunk)
+	{
+		unsigned int begin = (chunk * chunkSize < nBlockRows) ? chunk * chunkSize : nBlockRows;
+		unsigned int end = (begin + chunkSize < nBlockRows) ? begin + chunkSize : nBlockRows;
+		// marker[c] holds the last block row that used tile column c, offset by one
+		vector<unsigned int> marker(nBlockCols, 0);
+
+		for (unsigned int blockRow(begin); blockRow < end; blockRow++)
+		{
+			unsigned int tiles = 0;
+			unsigned int lastRow = (nRows - blockRow * blockRows > blockRows) ? (blockRow + 1) * blockRows : nRows;
+			for (unsigned int row(blockRow * blockRows); row < lastRow; row++)
+			{
+				for (unsigned int entry(offsets[row]); entry < offsets[row + 1]; entry++)
+				{
+					unsigned int tileColumn = columns[entry] / blockCols;
+					if (marker[tileColumn] != blockRow + 1)
+					{
+						marker[tileColumn] = blockRow + 1;
+						tiles++;
+					}
+				}
+			}
+			blockRowOffsets[blockRow + 1] = tiles;
+		}
+	}, chunks);
+
+	for (unsigned int blockRow(0); blockRow < nBlockRows; blockRow++)
+		blockRowOffsets[blockRow + 1] += blockRowOffsets[blockRow];
+
+	blockColumns.resize(blockRowOffsets[nBlockRows]);
+	blocks.assign(blockRowOffsets[nBlockRows] * tileSize, static_cast<T>(0));
+
+	pool.ParallelFor(chunks, [&](unsigned int chunk)
+	{
+		unsigned int begin = (chunk * chunkSize < nBlockRows) ? chunk * chunkSize : nBlockRows;
+		unsigned int end = (begin + chunkSize < nBlockRows) ? begin + chunkSize : nBlockRows;
+		vector<unsigned int> marker(nBlockCols, 0);
+		vector<unsigned int> slot(nBlockCols, 0);
+
+		for (unsigned int blockRow(begin); blockRow < end; blockRow++)
+		{
+			unsigned int firstRow = blockRow * blockRows;
+			unsigned int lastRow = (nRows - firstRow > blockRows) ? firstRow + blockRows : nRows;
+			unsigned int* tileColumns = blockColumns.data() + blockRowOffsets[blockRow];
+			unsigned int tiles = 0;
+
+			for (unsigned int row(firstRow); row < lastRow; row++)
+			{
+				for (unsigned int entry(offsets[row]); entry < offsets[row + 1]; entry++)
+				{
+					unsigned int tileColumn = columns[entry] / blockCols;
+					if (marker[tileColumn] != blockRow + 1)
+					{
+						marker[tileColumn] = blockRow + 1;
+						tileColumns[tiles++] = tileColumn;
+					}
+				}
+			}
+
+			sort(tileColumns, tileColumns + tiles);
+			for (unsigned int tile(0); tile < tiles; tile++)
+				slot[tileColumns[tile]] = blockRowOffsets[blockRow] + tile;
+
+			for (unsigned int row(firstRow); row < lastRow; row++)
+			{
+				for (unsigned int entry(offsets[row]); entry < offsets[row + 1]; entry++)
+				{
+					unsigned int col = columns[entry];
+					T* tile = blocks.data() + slot[col / blockCols] * tileSize;
+					tile[(col % blockCols) * blockRows + (row - firstRow)] = entries[entry];
+				}
+			}
+		}
+	}, chunks);
+}
+#pragma endregion
+
+
+#pragma region PRODUCTS
+template <class T>
+unsigned int SparseBlock<T>::PartitionBlockRow(unsigned int part, unsigned int parts) const
+{
+	unsigned int nBlockRows = static_cast<unsigned int>(blockRowOffsets.size() - 1);
+	if (part >= parts)
+		return nBlockRows;
+
+	unsigned int target = static_cast<unsigned int>(static_cast<unsigned long long>(blockRowOffsets[nBlockRows]) * part / parts);
+	return static_cast<unsigned int>(lower_bound(blockRowOffsets.begin(), blockRowOffsets.begin() + nBlockRows, target) - blockRowOffsets.begin());
+}
+
+template <class T>
+Dense<T> SparseBlock<T>::operator*(const Dense<T>& x) const
+{
+	Dense<T> out;
+	MulInto(x, out);
+	return out;
+}
+
+template <class T>
+void SparseBlock<T>::MulInto(const Dense<T>& x, Dense<T>& out, unsigned int nThreads) const
+{
+	assert(x.Rows() == nCols && x.Cols() == 1);
+	assert(&x != &out);
+
+	out.Resize(nRows, 1);
+	MulVectorInto(x.Data(), out.Data(), nThreads);
+}
+
+// every block row is computed into a local buffer, the rows past the end of the matrix are dropped
+template <class T>
+void SparseBlock<T>::MulVectorInto(const T* x, T* y, unsigned int nThreads) const
+{
+	assert(x != y);
+
+	ThreadPool& pool = ThreadPool::Global();
+	unsigned int poolThreads = pool.ThreadCount();
+	unsigned int threads = (blocks.size() < ParallelProductThreshold) ? 1 : ((nThreads == 0 || nThreads > poolThreads) ? poolThreads : nThreads);
+	size_t tileSize = static_cast<size_t>(blockRows) * blockCols;
+
+	pool.ParallelFor(threads, [&](unsigned int part)
+	{
+		T rowResult[MaxBlockRows];
+		unsigned int endBlockRow = PartitionBlockRow(part + 1, threads);
+
+		for (unsigned int blockRow(PartitionBlockRow(part, threads)); blockRow < endBlockRow; blockRow++)
+		{
+			unsigned int begin = blockRowOffsets[blockRow];
+			Simd::BlockRow(blocks.data() + begin * tileSize, blockColumns.data() + begin, blockRowOffsets[blockRow + 1] - begin,
+				x, nCols, blockRows, blockCols, rowResult);
+
+			unsigned int firstRow = blockRow * blockRows;
+			unsigned int count = (nRows - firstRow < blockRows) ? nRows - firstRow : blockRows;
+			for (unsigned int r(0); r < count; r++)
+				y[firstRow + r] = rowResult[r];
+		}
+	}, threads);
+}
+#pragma endregion
+
+#endif // !_SPARSE_BLOCK_CPP_
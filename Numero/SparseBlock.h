@@ -0,0 +1,65 @@
+#ifndef _SPARSE_BLOCK_H_
+#define _SPARSE_BLOCK_H_
+
+#include "../Numero.Definitions/DataTypeDefines.h"
+#include "Sparse.h"
+#include "Dense.h"
+#include <vector>
+
+namespace Numero
+{
+	using namespace std;
+	using namespace Definitions;
+
+	namespace DataTypes
+	{
+		// SparseBlock class
+		// block CSR copy of a Sparse matrix for matrix-vector products
+		// the matrix is cut into dense blockRows x blockCols tiles and only tiles holding a nonzero are stored,
+		// one column index per tile instead of one per entry - suits matrices with a natural block
+		// structure such as finite elements with several unknowns per node
+		template <class T>
+		class SparseBlock
+		{
+		private:
+			unsigned int nRows;
+			unsigned int nCols;
+			unsigned int nonZeros;
+			unsigned int blockRows;
+			unsigned int blockCols;
+			vector<unsigned int> blockRowOffsets;	// block row i owns tiles [blockRowOffsets[i], blockRowOffsets[i+1])
+			vector<unsigned int> blockColumns;		// ascending within every block row
+			vector<T> blocks;						// tiles column-major, blockRows*blockCols values each
+
+			// first block row of part `part` when the tiles are split into `parts` equal ranges
+			unsigned int PartitionBlockRow(unsigned int part, unsigned int parts) const;
+
+		public:
+			// tiles with more rows than this are not supported
+			static const unsigned int MaxBlockRows = 64;
+			// products below this many stored entries stay on the calling thread
+			static const unsigned int ParallelProductThreshold = 1 << 15;
+
+			// --- constructors
+			// edge tiles of matrices whose size is not a multiple of the tile are padded with zeros
+			SparseBlock(const Sparse<T>& matrix, unsigned int blockRows, unsigned int blockCols, unsigned int nThreads = 0);
+
+			unsigned int Rows() const { return nRows; }
+			unsigned int Cols() const { return nCols; }
+			unsigned int NonZeros() const { return nonZeros; }
+			unsigned int BlockRows() const { return blockRows; }
+			unsigned int BlockCols() const { return blockCols; }
+			unsigned int Blocks() const { return static_cast<unsigned int>(blockColumns.size()); }
+			// stored entries including the zeros of partly filled tiles
+			size_t StoredEntries() const { return blocks.size(); }
+
+			// --- matrix-vector products, y = A*x
+			// x must be a single column, out is resized as needed and keeps its buffer
+			void MulInto(const Dense<T>& x, Dense<T>& out, unsigned int nThreads = 0) const;
+			Dense<T> operator*(const Dense<T>& x) const;
+			void MulVectorInto(const T* x, T* y, unsigned int nThreads = 0) const;
+		};
+	}
+}
+
+#endif // !_SPARSE_BLOCK_H_
@@ -0,0 +1,847 @@
+#ifndef _SPARSE_CHOLESKY_CPP_
+#define _SPARSE_CHOLESKY_CPP_
+
+#include <assert.h>
+#include <cmath>
+#include <chrono>
+#include <set>
+#include <functional>
+#include <algorithm>
+#include "SparseCholesky.h"
+#include "Sparse.cpp"
+#include "Gemm.cpp"
+
+using namespace Numero;
+using namespace Numero::DataTypes;
+
+#pragma region ORDERING
+template <class T>
+void SparseCholesky<T>::Graph(const Sparse<T>& matrix, vector<unsigned int>& offsets, vector<unsigned int>& neighbours)
+{
+	const unsigned int size = matrix.Rows();
+	const unsigned int* rowOffsets = matrix.RowOffsets();
+	const unsigned int* columns = matrix.ColumnIndices();
+
+	// every off-diagonal entry is counted in its row and in its column, then duplicates are dropped
+	vector<unsigned int> degree(size + 1, 0);
+	for (unsigned int row(0); row < size; row++)
+	{
+		for (unsigned int entry(rowOffsets[row]); entry < rowOffsets[row + 1]; entry++)
+		{
+			if (columns[entry] == row)
+				continue;
+			degree[row + 1]++;
+			degree[columns[entry] + 1]++;
+		}
+	}
+	for (unsigned int row(0); row < size; row++)
+		degree[row + 1] += degree[row];
+
+	vector<unsigned int> cursor(degree.begin(), degree.end() - 1);
+	vector<unsigned int> all(degree[size]);
+	for (unsigned int row(0); row < size; row++)
+	{
+		for (unsigned int entry(rowOffsets[row]); entry < rowOffsets[row + 1]; entry++)
+		{
+			unsigned int col = columns[entry];
+			if (col == row)
+				continue;
+			all[cursor[row]++] = col;
+			all[cursor[col]++] = row;
+		}
+	}
+
+	offsets.assign(size + 1, 0);
+	neighbours.clear();
+	neighbours.reserve(all.size());
+	for (unsigned int row(0); row < size; row++)
+	{
+		unsigned int* begin = all.data() + degree[row];
+		unsigned int* end = all.data() + degree[row + 1];
+		sort(begin, end);
+		end = unique(begin, end);
+		neighbours.insert(neighbours.end(), begin, end);
+		offsets[row + 1] = static_cast<unsigned int>(neighbours.size());
+	}
+}
+
+// approximate minimum degree on the quotient graph - an eliminated node becomes an element standing for the clique
+// of its neighbours, so the graph never grows beyond A. every variable keeps its remaining variable neighbours and
+// its elements, elements covered by the new one are absorbed, and the degree is the bound of Amestoy, Davis and Duff,
+// |variables| + |new element| + the sum of |L_e - L_p| over the older elements
+// the node of least degree goes next, ties to the lowest index, so the order is deterministic
+// local maps the nodes of the subset to 0..count-1 and holds None elsewhere, neighbours outside the subset are ignored
+template <class T>
+void SparseCholesky<T>::MinimumDegree(const vector<unsigned int>& offsets, const vector<unsigned int>& neighbours,
+	const unsigned int* nodes, unsigned int count, const vector<unsigned int>& local, vector<unsigned int>& order)
+{
+	const unsigned int None = 0xFFFFFFFFu;
+	vector<vector<unsigned int> > variables(count);		// uneliminated neighbours not reached through an element
+	vector<vector<unsigned int> > elements(count);		// elements adjacent to a variable
+	vector<vector<unsigned int> > members(count);		// variables of an element, indexed by its pivot
+	vector<unsigned int> degree(count), mark(count, None), external(count), externalMark(count, None);
+	vector<char> eliminated(count, 0), absorbed(count, 0);
+	set<pair<unsigned int, unsigned int> > queue;
+
+	for (unsigned int a(0); a < count; a++)
+	{
+		unsigned int node = nodes[a];
+		for (unsigned int entry(offsets[node]); entry < offsets[node + 1]; entry++)
+		{
+			if (local[neighbours[entry]] != None)
+				variables[a].push_back(local[neighbours[entry]]);
+		}
+		degree[a] = static_cast<unsigned int>(variables[a].size());
+		queue.insert(make_pair(degree[a], a));
+	}
+
+	vector<unsigned int> kept;
+	for (unsigned int step(0); step < count; step++)
+	{
+		unsigned int p = queue.begin()->second;
+		queue.erase(queue.begin());
+		order.push_back(nodes[p]);
+		eliminated[p] = 1;
+
+		// the new element, the variables of p and of every element of p - those elements are absorbed
+		vector<unsigned int>& element = members[p];
+		mark[p] = step;
+		for (unsigned int v : variables[p])
+		{
+			if (!eliminated[v] && mark[v] != step)
+			{
+				mark[v] = step;
+				element.push_back(v);
+			}
+		}
+		for (unsigned int e : elements[p])
+		{
+			if (absorbed[e])
+				continue;
+			for (unsigned int v : members[e])
+			{
+				if (!eliminated[v] && mark[v] != step)
+				{
+					mark[v] = step;
+					element.push_back(v);
+				}
+			}
+			absorbed[e] = 1;
+			vector<unsigned int>().swap(members[e]);
+		}
+		vector<unsigned int>().swap(variables[p]);
+		vector<unsigned int>().swap(elements[p]);
+
+		// external[e] = |L_e - L_p| for the older elements next to the new one, those inside it are absorbed
+		for (unsigned int i : element)
+		{
+			for (unsigned int e : elements[i])
+			{
+				if (absorbed[e])
+					continue;
+				if (externalMark[e] != step)
+				{
+					externalMark[e] = step;
+					external[e] = static_cast<unsigned int>(members[e].size());
+				}
+				external[e]--;
+			}
+		}
+
+		unsigned int remaining = count - step - 1;
+		unsigned int elementSize = static_cast<unsigned int>(element.size());
+		for (unsigned int i : element)
+		{
+			unsigned int bound = elementSize - 1;
+
+			kept.clear();
+			for (unsigned int e : elements[i])
+			{
+				if (absorbed[e])
+					continue;
+				if (external[e] == 0)
+				{
+					absorbed[e] = 1;
+					vector<unsigned int>().swap(members[e]);
+					continue;
+				}
+				kept.push_back(e);
+				bound += external[e];
+			}
+			kept.push_back(p);
+			elements[i].swap(kept);
+
+			// variables now reached through the new element are dropped
+			kept.clear();
+			for (unsigned int v : variables[i])
+			{
+				if (!eliminated[v] && mark[v] != step)
+					kept.push_back(v);
+			}
+			variables[i].swap(kept);
+			bound += static_cast<unsigned int>(variables[i].size());
+
+			if (bound > remaining - 1)
+				bound = remaining - 1;
+			queue.erase(make_pair(degree[i], i));
+			degree[i] = bound;
+			queue.insert(make_pair(degree[i], i));
+		}
+	}
+}
+
+// a breadth first level structure is grown from a pseudo-peripheral node of every connected part and
+// its middle level becomes the separator - nodes of that level without a neighbour beyond it move to the near side
+// both sides are ordered recursively before the separator, parts of at most DissectionLeafSize nodes by minimum degree
+template <class T>
+void SparseCholesky<T>::NestedDissection(const vector<unsigned int>& offsets, const vector<unsigned int>& neighbours, vector<unsigned int>& order)
+{
+	const unsigned int None = 0xFFFFFFFFu;
+	unsigned int size = static_cast<unsigned int>(offsets.size() - 1);
+	vector<unsigned int> part(size, 0);		// label of the part being split, for membership tests
+	vector<unsigned int> level(size, None);
+	vector<unsigned int> local(size, None);
+	vector<unsigned int> queue;
+	unsigned int label = 0;
+
+	// breadth first search within the part `partLabel` from start, levels written to level[] - returns the last level
+	auto levels = [&](unsigned int start, unsigned int partLabel, vector<unsigned int>& visited) -> unsigned int
+	{
+		visited.clear();
+		visited.push_back(start);
+		level[start] = 0;
+		for (size_t head(0); head < visited.size(); head++)
+		{
+			unsigned int node = visited[head];
+			for (unsigned int entry(offsets[node]); entry < offsets[node + 1]; entry++)
+			{
+				unsigned int next = neighbours[entry];
+				if (part[next] == partLabel && level[next] == None)
+				{
+					level[next] = level[node] + 1;
+					visited.push_back(next);
+				}
+			}
+		}
+		return level[visited.back()];
+	};
+
+	// recursion depth follows the separator tree, about log2 of the size for meshes
+	function<void(vector<unsigned int>&)> dissect = [&](vector<unsigned int>& nodes)
+	{
+		unsigned int count = static_cast<unsigned int>(nodes.size());
+		if (count <= DissectionLeafSize)
+		{
+			for (unsigned int a(0); a < count; a++)
+				local[nodes[a]] = a;
+			MinimumDegree(offsets, neighbours, nodes.data(), count, local, order);
+			for (unsigned int a(0); a < count; a++)
+				local[nodes[a]] = None;
+			return;
+		}
+
+		unsigned int partLabel = ++label;
+		for (unsigned int node : nodes)
+			part[node] = partLabel;
+
+		// connected parts are ordered one after another
+		unsigned int lastLevel = levels(nodes[0], partLabel, queue);
+		if (queue.size() < count)
+		{
+			vector<vector<unsigned int> > components(1, queue);
+			for (unsigned int node : nodes)
+			{
+				if (level[node] != None)
+					continue;
+				components.push_back(vector<unsigned int>());
+				levels(node, partLabel, components.back());
+			}
+			for (unsigned int node : nodes)
+				level[node] = None;
+			for (vector<unsigned int>& component : components)
+				dissect(component);
+			return;
+		}
+
+		// pseudo-peripheral start - restart from the farthest node while the depth grows
+		for (unsigned int attempt(0); attempt < 4; attempt++)
+		{
+			unsigned int farthest = queue.back();
+			for (unsigned int node : nodes)
+				level[node] = None;
+			unsigned int depth = levels(farthest, partLabel, queue);
+			bool grown = depth > lastLevel;
+			lastLevel = depth;
+			if (!grown)
+				break;
+		}
+
+		if (lastLevel < 2)
+		{
+			for (unsigned int node : nodes)
+				level[node] = None;
+			for (unsigned int a(0); a < count; a++)
+				local[nodes[a]] = a;
+			MinimumDegree(offsets, neighbours, nodes.data(), count, local, order);
+			for (unsigned int a(0); a < count; a++)
+				local[nodes[a]] = None;
+			return;
+		}
+
+		// the separator level is the first one past half of the nodes, kept off both ends
+		vector<unsigned int> levelSizes(lastLevel + 1, 0);
+		for (unsigned int node : nodes)
+			levelSizes[level[node]]++;
+		unsigned int middle = 1;
+		for (unsigned int seen(levelSizes[0]); middle < lastLevel - 1 && seen + levelSizes[middle] <= count / 2; middle++)
+			seen += levelSizes[middle];
+
+		vector<unsigned int> before, after, separator;
+		for (unsigned int node : nodes)
+		{
+			if (level[node] < middle)
+				before.push_back(node);
+			else if (level[node] > middle)
+				after.push_back(node);
+			else
+			{
+				bool touchesAfter = false;
+				for (unsigned int entry(offsets[node]); entry < offsets[node + 1] && !touchesAfter; entry++)
+					touchesAfter = part[neighbours[entry]] == partLabel && level[neighbours[entry]] == middle + 1;
+				(touchesAfter ? separator : before).push_back(node);
+			}
+		}
+		for (unsigned int node : nodes)
+			level[node] = None;
+
+		vector<unsigned int>().swap(nodes);
+		dissect(before);
+		dissect(after);
+		order.insert(order.end(), separator.begin(), separator.end());
+	};
+
+	vector<unsigned int> all(size);
+	for (unsigned int node(0); node < size; node++)
+		all[node] = node;
+	order.clear();
+	order.reserve(size);
+	if (size > 0)
+		dissect(all);
+}
+#pragma endregion
+
+
+#pragma region ANALYSIS
+template <class T>
+SparseCholesky<T>::SparseCholesky(const Sparse<T>& pattern, CholeskyOrdering ordering)
+	: n(pattern.Rows()), nonZeros(pattern.NonZeros()), analysisSeconds(0), factorSeconds(0), flops(0), factorNonZeros(0),
+	factored(false), positiveDefinite(false)
+{
+	assert(pattern.Rows() == pattern.Cols());
+
+	Analyze(pattern, ordering);
+}
+
+// ordering, elimination tree by Liu's algorithm with path compression, postorder, column counts from the row
+// subtrees, supernode partition and the row structure of every supernode, then the position of every entry of A in L
+template <class T>
+void SparseCholesky<T>::Analyze(const Sparse<T>& matrix, CholeskyOrdering ordering)
+{
+	typedef chrono::steady_clock Clock;
+	Clock::time_point start = Clock::now();
+
+	vector<unsigned int> offsets, neighbours;
+	Graph(matrix, offsets, neighbours);
+
+	// --- fill-reducing ordering
+	if (ordering == CholeskyOrdering::NestedDissection)
+		NestedDissection(offsets, neighbours, permutation);
+	else if (ordering == CholeskyOrdering::MinimumDegree)
+	{
+		vector<unsigned int> all(n), local(n);
+		for (unsigned int node(0); node < n; node++)
+			all[node] = local[node] = node;
+		permutation.clear();
+		MinimumDegree(offsets, neighbours, all.data(), n, local, permutation);
+	}
+	else
+	{
+		permutation.resize(n);
+		for (unsigned int node(0); node < n; node++)
+			permutation[node] = node;
+	}
+
+	inversePermutation.resize(n);
+	for (unsigned int i(0); i < n; i++)
+		inversePermutation[permutation[i]] = i;
+
+	// --- elimination tree
+	parent.assign(n, n);
+	vector<unsigned int> ancestor(n, n);
+	for (unsigned int k(0); k < n; k++)
+	{
+		unsigned int node = permutation[k];
+		for (unsigned int entry(offsets[node]); entry < offsets[node + 1]; entry++)
+		{
+			unsigned int r = inversePermutation[neighbours[entry]];
+			if (r >= k)
+				continue;
+			while (ancestor[r] != n && ancestor[r] != k)
+			{
+				unsigned int next = ancestor[r];
+				ancestor[r] = k;
+				r = next;
+			}
+			if (ancestor[r] == n)
+			{
+				ancestor[r] = k;
+				parent[r] = k;
+			}
+		}
+	}
+
+	// --- postorder, so every subtree and every supernode is a contiguous range of columns
+	vector<unsigned int> head(n, n), next(n, n), postorder, stack;
+	postorder.reserve(n);
+	for (unsigned int j(n); j-- > 0;)
+	{
+		if (parent[j] != n)
+		{
+			next[j] = head[parent[j]];
+			head[parent[j]] = j;
+		}
+	}
+	for (unsigned int root(0); root < n; root++)
+	{
+		if (parent[root] != n)
+			continue;
+		stack.push_back(root);
+		while (!stack.empty())
+		{
+			unsigned int top = stack.back();
+			unsigned int child = head[top];
+			if (child != n)
+			{
+				head[top] = next[child];
+				stack.push_back(child);
+			}
+			else
+			{
+				postorder.push_back(top);
+				stack.pop_back();
+			}
+		}
+	}
+
+	vector<unsigned int> position(n), relabeled(n), relabeledParent(n);
+	for (unsigned int p(0); p < n; p++)
+		position[postorder[p]] = p;
+	for (unsigned int p(0); p < n; p++)
+	{
+		relabeled[p] = permutation[postorder[p]];
+		relabeledParent[p] = (parent[postorder[p]] == n) ? n : position[parent[postorder[p]]];
+	}
+	permutation.swap(relabeled);
+	parent.swap(relabeledParent);
+	for (unsigned int i(0); i < n; i++)
+		inversePermutation[permutation[i]] = i;
+
+	// --- column counts, every row k of L is the subtree of the elimination tree reached from the entries of row k of A
+	vector<unsigned int> counts(n, 1), marker(n, n);
+	for (unsigned int k(0); k < n; k++)
+	{
+		marker[k] = k;
+		unsigned int node = permutation[k];
+		for (unsigned int entry(offsets[node]); entry < offsets[node + 1]; entry++)
+		{
+			unsigned int j = inversePermutation[neighbours[entry]];
+			if (j >= k)
+				continue;
+			for (; marker[j] != k; j = parent[j])
+			{
+				counts[j]++;
+				marker[j] = k;
+			}
+		}
+	}
+
+	factorNonZeros = 0;
+	flops = 0;
+	for (unsigned int j(0); j < n; j++)
+	{
+		factorNonZeros += counts[j];
+		flops += static_cast<double>(counts[j]) * counts[j];
+	}
+
+	// --- supernodes, column j joins the supernode ending at j-1 when it is the parent of j-1 and either the
+	// structure nests exactly or the merged supernode stays narrow and at most a quarter zeros
+	superFirst.assign(1, 0);
+	unsigned int first = 0;
+	size_t actual = (n > 0) ? counts[0] : 0;
+	size_t zeros = 0;
+	for (unsigned int j(1); j < n; j++)
+	{
+		bool merge = false;
+		size_t width = j - first + 1;
+		size_t mergedZeros = 0;
+		if (parent[j - 1] == j)
+		{
+			size_t rows = (j - first) + counts[j];
+			size_t stored = width * rows - width * (width - 1) / 2;
+			mergedZeros = stored - (actual + counts[j]);
+			merge = (mergedZeros == zeros) || (width <= RelaxedSupernodeWidth && mergedZeros * 4 <= stored);
+		}
+
+		if (merge)
+		{
+			actual += counts[j];
+			zeros = mergedZeros;
+		}
+		else
+		{
+			superFirst.push_back(j);
+			first = j;
+			actual = counts[j];
+			zeros = 0;
+		}
+	}
+	superFirst.push_back(n);
+
+	unsigned int supernodes = static_cast<unsigned int>(superFirst.size() - 1);
+	columnSuper.resize(n);
+	for (unsigned int s(0); s < supernodes; s++)
+	{
+		for (unsigned int j(superFirst[s]); j < superFirst[s + 1]; j++)
+			columnSuper[j] = s;
+	}
+
+	// --- row structures, children before parents - the rows of A below the supernode and those of the children
+	vector<unsigned int> childHead(supernodes, supernodes), childNext(supernodes, supernodes);
+	for (unsigned int s(supernodes); s-- > 0;)
+	{
+		unsigned int up = parent[superFirst[s + 1] - 1];
+		if (up != n)
+		{
+			childNext[s] = childHead[columnSuper[up]];
+			childHead[columnSuper[up]] = s;
+		}
+	}
+
+	superRowOffsets.assign(1, 0);
+	superRows.clear();
+	superValueOffsets.assign(1, 0);
+	fill(marker.begin(), marker.end(), n);
+	for (unsigned int s(0); s < supernodes; s++)
+	{
+		unsigned int firstColumn = superFirst[s];
+		unsigned int lastColumn = superFirst[s + 1] - 1;
+		for (unsigned int j(firstColumn); j <= lastColumn; j++)
+			superRows.push_back(j);
+		size_t below = superRows.size();
+
+		for (unsigned int j(firstColumn); j <= lastColumn; j++)
+		{
+			unsigned int node = permutation[j];
+			for (unsigned int entry(offsets[node]); entry < offsets[node + 1]; entry++)
+			{
+				unsigned int i = inversePermutation[neighbours[entry]];
+				if (i > lastColumn && marker[i] != s)
+				{
+					marker[i] = s;
+					superRows.push_back(i);
+				}
+			}
+		}
+		for (unsigned int child(childHead[s]); child != supernodes; child = childNext[child])
+		{
+			for (unsigned int r(superRowOffsets[child]); r < superRowOffsets[child + 1]; r++)
+			{
+				unsigned int i = superRows[r];
+				if (i > lastColumn && marker[i] != s)
+				{
+					marker[i] = s;
+					superRows.push_back(i);
+				}
+			}
+		}
+		sort(superRows.begin() + below, superRows.end());
+
+		unsigned int rows = static_cast<unsigned int>(superRows.size() - superRowOffsets[s]);
+		assert(rows == lastColumn - firstColumn + counts[lastColumn]);
+		superRowOffsets.push_back(static_cast<unsigned int>(superRows.size()));
+		superValueOffsets.push_back(superValueOffsets[s] + static_cast<size_t>(rows) * (lastColumn - firstColumn + 1));
+	}
+
+	// --- assembly map
+	const unsigned int* rowOffsets = matrix.RowOffsets();
+	const unsigned int* columns = matrix.ColumnIndices();
+	assembly.resize(nonZeros);
+	for (unsigned int row(0); row < n; row++)
+	{
+		for (unsigned int entry(rowOffsets[row]); entry < rowOffsets[row + 1]; entry++)
+		{
+			unsigned int i = inversePermutation[row];
+			unsigned int j = inversePermutation[columns[entry]];
+			if (i < j)
+			{
+				assembly[entry] = NotAssembled;
+				continue;
+			}
+
+			unsigned int s = columnSuper[j];
+			const unsigned int* rowsBegin = superRows.data() + superRowOffsets[s];
+			const unsigned int* rowsEnd = superRows.data() + superRowOffsets[s + 1];
+			size_t index = lower_bound(rowsBegin, rowsEnd, i) - rowsBegin;
+			assembly[entry] = superValueOffsets[s] + static_cast<size_t>(j - superFirst[s]) * (rowsEnd - rowsBegin) + index;
+		}
+	}
+
+	values.clear();
+	factored = false;
+	positiveDefinite = false;
+	analysisSeconds = chrono::duration<double>(Clock::now() - start).count();
+}
+#pragma endregion
+
+
+#pragma region FACTORIZATION
+// c -= a * a(0:cols, :)' on column-major blocks, only the entries on and below the diagonal of c are needed
+// large blocks go through the Gemm engine one BlockSize wide column strip at a time, starting each strip at its
+// diagonal, so only the triangles within the diagonal blocks are computed in vain
+template <class T>
+void SparseCholesky<T>::SubtractProduct(unsigned int rows, unsigned int cols, unsigned int depth, const T* a, unsigned int lda,
+	T* c, unsigned int ldc, unsigned int nThreads)
+{
+	if (static_cast<unsigned long long>(rows) * cols * depth >= GemmUpdateThreshold)
+	{
+		for (unsigned int c0(0); c0 < cols; c0 += BlockSize)
+		{
+			unsigned int strip = (cols - c0 < BlockSize) ? cols - c0 : BlockSize;
+			Gemm<T>::Multiply(rows - c0, strip, depth,
+				static_cast<T>(-1),
+				a + c0, 1, lda,
+				a + c0, lda, 1,
+				static_cast<T>(1),
+				c + static_cast<size_t>(c0) * ldc + c0, 1, ldc,
+				nThreads);
+		}
+		return;
+	}
+
+	for (unsigned int col(0); col < cols; col++)
+	{
+		T* target = c + static_cast<size_t>(col) * ldc;
+		for (unsigned int k(0); k < depth; k++)
+		{
+			const T* source = a + static_cast<size_t>(k) * lda;
+			T factor = source[col];
+			if (factor == static_cast<T>(0))
+				continue;
+			for (unsigned int row(col); row < rows; row++)
+				target[row] -= source[row] * factor;
+		}
+	}
+}
+
+// blocked left-looking within BlockSize columns, right-looking between blocks through SubtractProduct
+template <class T>
+bool SparseCholesky<T>::FactorPanel(T* panel, unsigned int rows, unsigned int width, unsigned int nThreads)
+{
+	for (unsigned int k0(0); k0 < width; k0 += BlockSize)
+	{
+		unsigned int k1 = (width - k0 < BlockSize) ? width : k0 + BlockSize;
+
+		for (unsigned int j(k0); j < k1; j++)
+		{
+			T* column = panel + static_cast<size_t>(j) * rows;
+			for (unsigned int p(k0); p < j; p++)
+			{
+				const T* previous = panel + static_cast<size_t>(p) * rows;
+				T factor = previous[j];
+				for (unsigned int r(j); r < rows; r++)
+					column[r] -= previous[r] * factor;
+			}
+
+			if (!(column[j] > static_cast<T>(0)))
+				return false;
+			T pivot = sqrt(column[j]);
+			T inverse = static_cast<T>(1) / pivot;
+			column[j] = pivot;
+			for (unsigned int r(j + 1); r < rows; r++)
+				column[r] *= inverse;
+		}
+
+		if (k1 < width)
+		{
+			SubtractProduct(rows - k1, width - k1, k1 - k0, panel + static_cast<size_t>(k0) * rows + k1, rows,
+				panel + static_cast<size_t>(k1) * rows + k1, rows, nThreads);
+		}
+	}
+	return true;
+}
+
+// right-looking over the supernodes in order - A is scattered into the panels, then every supernode is factored
+// and its update L21*L21' is formed one target supernode at a time and added into the target panel
+template <class T>
+void SparseCholesky<T>::Factorize(const Sparse<T>& matrix, unsigned int nThreads)
+{
+	assert(matrix.Rows() == n && matrix.Cols() == n && matrix.NonZeros() == nonZeros);
+
+	typedef chrono::steady_clock Clock;
+	Clock::time_point start = Clock::now();
+
+	values.assign(superValueOffsets.back(), static_cast<T>(0));
+	const T* entries = matrix.Values();
+	for (unsigned int entry(0); entry < nonZeros; entry++)
+	{
+		if (assembly[entry] != NotAssembled)
+			values[assembly[entry]] = entries[entry];
+	}
+
+	unsigned int supernodes = Supernodes();
+	vector<T> update;
+	vector<unsigned int> relative;
+	positiveDefinite = true;
+
+	for (unsigned int s(0); s < supernodes && positiveDefinite; s++)
+	{
+		T* panel = values.data() + superValueOffsets[s];
+		const unsigned int* rows = superRows.data() + superRowOffsets[s];
+		unsigned int height = superRowOffsets[s + 1] - superRowOffsets[s];
+		unsigned int width = superFirst[s + 1] - superFirst[s];
+
+		if (!FactorPanel(panel, height, width, nThreads))
+		{
+			positiveDefinite = false;
+			break;
+		}
+
+		// the rows below the supernode, grouped by the supernode owning them as columns
+		for (unsigned int i(width); i < height;)
+		{
+			unsigned int target = columnSuper[rows[i]];
+			unsigned int targetEnd = superFirst[target + 1];
+			unsigned int g(i);
+			while (g < height && rows[g] < targetEnd)
+				g++;
+
+			unsigned int updateRows = height - i;
+			unsigned int updateCols = g - i;
+			update.assign(static_cast<size_t>(updateRows) * updateCols, static_cast<T>(0));
+			SubtractProduct(updateRows, updateCols, width, panel + i, height, update.data(), updateRows, nThreads);
+
+			// rows of this supernode are a subset of the rows of the target, both ascending
+			const unsigned int* targetRows = superRows.data() + superRowOffsets[target];
+			unsigned int targetHeight = superRowOffsets[target + 1] - superRowOffsets[target];
+			relative.resize(updateRows);
+			for (unsigned int r(0), p(0); r < updateRows; r++)
+			{
+				while (targetRows[p] != rows[i + r])
+					p++;
+				relative[r] = p;
+			}
+
+			T* targetPanel = values.data() + superValueOffsets[target];
+			for (unsigned int c(0); c < updateCols; c++)
+			{
+				T* column = targetPanel + static_cast<size_t>(rows[i + c] - superFirst[target]) * targetHeight;
+				const T* source = update.data() + static_cast<size_t>(c) * updateRows;
+				for (unsigned int r(c); r < updateRows; r++)
+					column[relative[r]] += source[r];
+			}
+
+			i = g;
+		}
+	}
+
+	factored = true;
+	factorSeconds = chrono::duration<double>(Clock::now() - start).count();
+}
+
+template <class T>
+bool SparseCholesky<T>::IsPositiveDefinite() const
+{
+	return factored && positiveDefinite;
+}
+#pragma endregion
+
+
+#pragma region SOLVE
+template <class T>
+Dense<T> SparseCholesky<T>::Solve(const Dense<T>& b) const
+{
+	Dense<T> x(b);
+	SolveInPlace(x);
+	return x;
+}
+
+// y = P*b, L*z = y by columns of the panels, L'*w = z in reverse, x = P'*w - all columns of b in one sweep
+template <class T>
+void SparseCholesky<T>::SolveInPlace(Dense<T>& b) const
+{
+	assert(IsPositiveDefinite());
+	assert(b.Rows() == n);
+
+	unsigned int k = b.Cols();
+	T* data = b.Data();
+	vector<T> y(static_cast<size_t>(n) * k);
+	for (unsigned int i(0); i < n; i++)
+		copy(data + static_cast<size_t>(permutation[i]) * k, data + static_cast<size_t>(permutation[i] + 1) * k, y.begin() + static_cast<size_t>(i) * k);
+
+	unsigned int supernodes = Supernodes();
+	for (unsigned int s(0); s < supernodes; s++)
+	{
+		const T* panel = values.data() + superValueOffsets[s];
+		const unsigned int* rows = superRows.data() + superRowOffsets[s];
+		unsigned int height = superRowOffsets[s + 1] - superRowOffsets[s];
+		unsigned int width = superFirst[s + 1] - superFirst[s];
+
+		for (unsigned int c(0); c < width; c++)
+		{
+			const T* column = panel + static_cast<size_t>(c) * height;
+			T* yj = y.data() + static_cast<size_t>(rows[c]) * k;
+			T inverse = static_cast<T>(1) / column[c];
+			for (unsigned int q(0); q < k; q++)
+				yj[q] *= inverse;
+
+			for (unsigned int r(c + 1); r < height; r++)
+			{
+				T l = column[r];
+				T* yr = y.data() + static_cast<size_t>(rows[r]) * k;
+				for (unsigned int q(0); q < k; q++)
+					yr[q] -= l * yj[q];
+			}
+		}
+	}
+
+	for (unsigned int s(supernodes); s-- > 0;)
+	{
+		const T* panel = values.data() + superValueOffsets[s];
+		const unsigned int* rows = superRows.data() + superRowOffsets[s];
+		unsigned int height = superRowOffsets[s + 1] - superRowOffsets[s];
+		unsigned int width = superFirst[s + 1] - superFirst[s];
+
+		for (unsigned int c(width); c-- > 0;)
+		{
+			const T* column = panel + static_cast<size_t>(c) * height;
+			T* yj = y.data() + static_cast<size_t>(rows[c]) * k;
+			for (unsigned int r(c + 1); r < height; r++)
+			{
+				T l = column[r];
+				const T* yr = y.data() + static_cast<size_t>(rows[r]) * k;
+				for (unsigned int q(0); q < k; q++)
+					yj[q] -= l * yr[q];
+			}
+
+			T inverse = static_cast<T>(1) / column[c];
+			for (unsigned int q(0); q < k; q++)
+				yj[q] *= inverse;
+		}
+	}
+
+	for (unsigned int i(0); i < n; i++)
+		copy(y.begin() + static_cast<size_t>(i) * k, y.begin() + static_cast<size_t>(i + 1) * k, data + static_cast<size_t>(permutation[i]) * k);
+}
+#pragma endregion
+
+#endif // !_SPARSE_CHOLESKY_CPP_
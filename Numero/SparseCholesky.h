@@ -0,0 +1,111 @@
+#ifndef _SPARSE_CHOLESKY_H_
+#define _SPARSE_CHOLESKY_H_
+
+#include "../Numero.Definitions/DataTypeDefines.h"
+#include "Sparse.h"
+#include "Dense.h"
+#include <vector>
+
+namespace Numero
+{
+	using namespace std;
+	using namespace Definitions;
+
+	namespace DataTypes
+	{
+		// fill-reducing orderings of the sparse Cholesky analysis
+		enum class CholeskyOrdering
+		{
+			Natural = 0,			// the rows as given
+			MinimumDegree = 1,		// approximate minimum degree on the quotient graph, suits small and irregular problems
+			NestedDissection = 2	// recursive level-structure separators, suits grids and meshes
+		};
+
+		// SparseCholesky class
+		// supernodal sparse Cholesky factorization, P*A*P' = L*L', for symmetric positive definite A
+		// the analysis (ordering, elimination tree, column counts, supernodes and the structure of L) is done once
+		// by the constructor, Factorize then computes the values for any matrix with the analysed pattern,
+		// so repeated factorizations of one pattern pay only the numeric phase
+		// columns with nested structure are grouped into supernodes stored as dense column-major panels -
+		// every supernode is factored and its update to the later columns is formed through the Gemm engine
+		template <class T>
+		class SparseCholesky
+		{
+		private:
+			unsigned int n;
+			unsigned int nonZeros;						// of the analysed matrix
+			vector<unsigned int> permutation;			// row i of P*A*P' is row permutation[i] of A
+			vector<unsigned int> inversePermutation;
+			vector<unsigned int> parent;				// elimination tree, n for the roots
+
+			vector<unsigned int> superFirst;			// supernode s holds the columns [superFirst[s], superFirst[s+1])
+			vector<unsigned int> columnSuper;			// supernode of every column
+			vector<unsigned int> superRowOffsets;		// rows of supernode s are [superRowOffsets[s], superRowOffsets[s+1]) of superRows
+			vector<unsigned int> superRows;				// ascending, the columns of the supernode first
+			vector<size_t> superValueOffsets;			// panel of supernode s starts at values[superValueOffsets[s]]
+			vector<size_t> assembly;					// position in values of every entry of A, NotAssembled for the upper triangle
+			vector<T> values;
+
+			double analysisSeconds;
+			double factorSeconds;
+			double flops;
+			size_t factorNonZeros;
+			bool factored;
+			bool positiveDefinite;
+
+			static const size_t NotAssembled = ~static_cast<size_t>(0);
+
+			// symmetric adjacency of the pattern without the diagonal, in CSR form
+			static void Graph(const Sparse<T>& matrix, vector<unsigned int>& offsets, vector<unsigned int>& neighbours);
+			// append the order of the nodes of a subset, local maps them to 0..count-1 and holds 0xFFFFFFFF elsewhere
+			static void MinimumDegree(const vector<unsigned int>& offsets, const vector<unsigned int>& neighbours,
+				const unsigned int* nodes, unsigned int count, const vector<unsigned int>& local, vector<unsigned int>& order);
+			static void NestedDissection(const vector<unsigned int>& offsets, const vector<unsigned int>& neighbours, vector<unsigned int>& order);
+
+			void Analyze(const Sparse<T>& matrix, CholeskyOrdering ordering);
+			// c -= a * a(0:cols, :)' on column-major blocks, on and below the diagonal of c
+			static void SubtractProduct(unsigned int rows, unsigned int cols, unsigned int depth, const T* a, unsigned int lda,
+				T* c, unsigned int ldc, unsigned int nThreads);
+			// dense Cholesky of a rows x width column-major panel in place - false on a non-positive pivot
+			static bool FactorPanel(T* panel, unsigned int rows, unsigned int width, unsigned int nThreads);
+
+		public:
+			// parts of the nested dissection at most this large are ordered by minimum degree
+			static const unsigned int DissectionLeafSize = 64;
+			// a column joins the supernode of its child with up to this many columns even if that stores a few zeros
+			static const unsigned int RelaxedSupernodeWidth = 16;
+			// panels are factored in blocks of this many columns
+			static const unsigned int BlockSize = 64;
+			// updates below this many multiply-adds use a plain loop instead of the Gemm engine
+			static const unsigned int GemmUpdateThreshold = 4096;
+
+			// --- constructors
+			// symbolic analysis of the pattern of a square matrix with both triangles stored
+			explicit SparseCholesky(const Sparse<T>& pattern, CholeskyOrdering ordering = CholeskyOrdering::NestedDissection);
+
+			// numeric factorization of a matrix with the analysed pattern, replacing the previous factors
+			// entries above the diagonal of P*A*P' are not read. nThreads as in ThreadPool::ParallelFor, used by the dense updates
+			void Factorize(const Sparse<T>& matrix, unsigned int nThreads = 0);
+			bool IsPositiveDefinite() const;
+
+			// solves A*X = B for every column of B with the current factors
+			Dense<T> Solve(const Dense<T>& b) const;
+			void SolveInPlace(Dense<T>& b) const;
+
+			// --- statistics
+			// nonzeros of L including the diagonal, and entries stored including the zeros of relaxed supernodes
+			size_t FactorNonZeros() const { return factorNonZeros; }
+			size_t StoredEntries() const { return values.size(); }
+			// multiply-adds of one numeric factorization, the sum of the squared column counts of L
+			double Flops() const { return flops; }
+			unsigned int Supernodes() const { return static_cast<unsigned int>(superFirst.size() - 1); }
+			double AnalysisSeconds() const { return analysisSeconds; }
+			double FactorSeconds() const { return factorSeconds; }
+
+			const vector<unsigned int>& Permutation() const { return permutation; }
+			const vector<unsigned int>& EliminationTree() const { return parent; }
+		};
+	}
+}
+
+#endif // !_SPARSE_CHOLESKY_H_
@@ -0,0 +1,152 @@
+#ifndef _SPARSE_SELL_CPP_
+#define _SPARSE_SELL_CPP_
+
+#include <assert.h>
+#include <algorithm>
+#include "SparseSell.h"
+#include "Sparse.cpp"
+#include "ThreadPool.h"
+#include "Simd.h"
+
+using namespace Numero;
+using namespace Numero::DataTypes;
+
+#pragma region CONSTRUCTION
+// windows are sorted in parallel, slice widths are summed on the calling thread
+// and the slices are filled in parallel, each one from the CSR rows it holds
+template <class T>
+SparseSell<T>::SparseSell(const Sparse<T>& matrix, unsigned int sliceHeight, unsigned int sortWindow, unsigned int nThreads)
+	: nRows(matrix.Rows()), nCols(matrix.Cols()), nonZeros(matrix.NonZeros()), sliceHeight(sliceHeight)
+{
+	assert(sliceHeight > 0 && sliceHeight <= MaxSliceHeight);
+
+	if (sortWindow == 0)
+		sortWindow = 1;
+	this->sortWindow = (sortWindow <= sliceHeight) ? sortWindow : ((sortWindow + sliceHeight - 1) / sliceHeight) * sliceHeight;
+
+	const unsigned int* offsets = matrix.RowOffsets();
+	const unsigned int* columns = matrix.ColumnIndices();
+	const T* entries = matrix.Values();
+	ThreadPool& pool = ThreadPool::Global();
+	unsigned int threads = (nonZeros < ParallelProductThreshold) ? 1 : nThreads;
+
+	// longest rows first inside every window, ties keep the order of the matrix
+	rowOrder.resize(nRows);
+	for (unsigned int row(0); row < nRows; row++)
+		rowOrder[row] = row;
+
+	unsigned int windows = (nRows + this->sortWindow - 1) / this->sortWindow;
+	if (this->sortWindow > 1)
+	{
+		pool.ParallelFor(windows, [&](unsigned int window)
+		{
+			unsigned int begin = window * this->sortWindow;
+			unsigned int end = (nRows - begin > this->sortWindow) ? begin + this->sortWindow : nRows;
+			stable_sort(rowOrder.begin() + begin, rowOrder.begin() + end, [&](unsigned int a, unsigned int b)
+			{
+				return offsets[a + 1] - offsets[a] > offsets[b + 1] - offsets[b];
+			});
+		}, threads);
+	}
+
+	unsigned int slices = (nRows + sliceHeight - 1) / sliceHeight;
+	sliceOffsets.assign(slices + 1, 0);
+	for (unsigned int slice(0); slice < slices; slice++)
+	{
+		unsigned int width = 0;
+		for (unsigned int r(slice * sliceHeight); r < nRows && r < (slice + 1) * sliceHeight; r++)
+		{
+			unsigned int length = offsets[rowOrder[r] + 1] - offsets[rowOrder[r]];
+			width = (length > width) ? length : width;
+		}
+		sliceOffsets[slice + 1] = sliceOffsets[slice] + static_cast<size_t>(width) * sliceHeight;
+	}
+
+	columnIndices.resize(sliceOffsets[slices]);
+	values.resize(sliceOffsets[slices]);
+
+	pool.ParallelFor(slices, [&](unsigned int slice)
+	{
+		size_t base = sliceOffsets[slice];
+		size_t width = (sliceOffsets[slice + 1] - base) / sliceHeight;
+
+		for (unsigned int r(0); r < sliceHeight; r++)
+		{
+			unsigned int position = slice * sliceHeight + r;
+			unsigned int begin = (position < nRows) ? offsets[rowOrder[position]] : 0;
+			unsigned int length = (position < nRows) ? offsets[rowOrder[position] + 1] - begin : 0;
+
+			for (size_t j(0); j < width; j++)
+			{
+				size_t target = base + j*sliceHeight + r;
+				columnIndices[target] = (j < length) ? columns[begin + j] : 0;
+				values[target] = (j < length) ? entries[begin + j] : static_cast<T>(0);
+			}
+		}
+	}, threads);
+}
+#pragma endregion
+
+
+#pragma region PRODUCTS
+template <class T>
+unsigned int SparseSell<T>::PartitionSlice(unsigned int part, unsigned int parts) const
+{
+	unsigned int slices = static_cast<unsigned int>(sliceOffsets.size() - 1);
+	if (part >= parts)
+		return slices;
+
+	size_t target = sliceOffsets[slices] * part / parts;
+	return static_cast<unsigned int>(lower_bound(sliceOffsets.begin(), sliceOffsets.begin() + slices, target) - sliceOffsets.begin());
+}
+
+template <class T>
+Dense<T> SparseSell<T>::operator*(const Dense<T>& x) const
+{
+	Dense<T> out;
+	MulInto(x, out);
+	return out;
+}
+
+template <class T>
+void SparseSell<T>::MulInto(const Dense<T>& x, Dense<T>& out, unsigned int nThreads) const
+{
+	assert(x.Rows() == nCols && x.Cols() == 1);
+	assert(&x != &out);
+
+	out.Resize(nRows, 1);
+	MulVectorInto(x.Data(), out.Data(), nThreads);
+}
+
+// every slice is computed into a local buffer and scattered to the rows it holds
+template <class T>
+void SparseSell<T>::MulVectorInto(const T* x, T* y, unsigned int nThreads) const
+{
+	assert(x != y);
+	assert(nCols <= 0x7FFFFFFFu);
+
+	ThreadPool& pool = ThreadPool::Global();
+	unsigned int poolThreads = pool.ThreadCount();
+	unsigned int threads = (values.size() < ParallelProductThreshold) ? 1 : ((nThreads == 0 || nThreads > poolThreads) ? poolThreads : nThreads);
+
+	pool.ParallelFor(threads, [&](unsigned int part)
+	{
+		T sliceResult[MaxSliceHeight];
+		unsigned int endSlice = PartitionSlice(part + 1, threads);
+
+		for (unsigned int slice(PartitionSlice(part, threads)); slice < endSlice; slice++)
+		{
+			size_t base = sliceOffsets[slice];
+			size_t width = (sliceOffsets[slice + 1] - base) / sliceHeight;
+			Simd::SellSlice(values.data() + base, columnIndices.data() + base, x, width, sliceHeight, sliceResult);
+
+			unsigned int first = slice * sliceHeight;
+			unsigned int count = (nRows - first < sliceHeight) ? nRows - first : sliceHeight;
+			for (unsigned int r(0); r < count; r++)
+				y[rowOrder[first + r]] = sliceResult[r];
+		}
+	}, threads);
+}
+#pragma endregion
+
+#endif // !_SPARSE_SELL_CPP_
@@ -0,0 +1,67 @@
+#ifndef _SPARSE_SELL_H_
+#define _SPARSE_SELL_H_
+
+#include "../Numero.Definitions/DataTypeDefines.h"
+#include "Sparse.h"
+#include "Dense.h"
+#include <vector>
+
+namespace Numero
+{
+	using namespace std;
+	using namespace Definitions;
+
+	namespace DataTypes
+	{
+		// SparseSell class
+		// sliced ELLPACK (SELL-C-sigma) copy of a Sparse matrix for matrix-vector products
+		// rows are sorted by length inside windows of sigma rows, then cut into slices of C rows
+		// that are padded to their longest row and stored column by column, so that one vector
+		// instruction handles the same entry of C rows - short irregular rows fill the vector lanes
+		// that a CSR row kernel leaves idle
+		template <class T>
+		class SparseSell
+		{
+		private:
+			unsigned int nRows;
+			unsigned int nCols;
+			unsigned int nonZeros;
+			unsigned int sliceHeight;				// C
+			unsigned int sortWindow;				// sigma
+			vector<unsigned int> rowOrder;			// sorted position -> row of the matrix
+			vector<size_t> sliceOffsets;			// slice s occupies [sliceOffsets[s], sliceOffsets[s+1]) of the arrays below
+			vector<unsigned int> columnIndices;		// padding entries point at column 0 with a zero value
+			vector<T> values;
+
+			// first slice of part `part` when the stored entries are split into `parts` equal ranges
+			unsigned int PartitionSlice(unsigned int part, unsigned int parts) const;
+
+		public:
+			// slices taller than this are not supported
+			static const unsigned int MaxSliceHeight = 64;
+			// products below this many stored entries stay on the calling thread
+			static const unsigned int ParallelProductThreshold = 1 << 15;
+
+			// --- constructors
+			// sliceHeight is best a multiple of the SIMD width, 8 suits AVX2 float and AVX-512 double
+			// sortWindow is rounded up to a multiple of sliceHeight, 1 keeps the row order of the matrix
+			explicit SparseSell(const Sparse<T>& matrix, unsigned int sliceHeight = 8, unsigned int sortWindow = 256, unsigned int nThreads = 0);
+
+			unsigned int Rows() const { return nRows; }
+			unsigned int Cols() const { return nCols; }
+			unsigned int NonZeros() const { return nonZeros; }
+			unsigned int SliceHeight() const { return sliceHeight; }
+			unsigned int SortWindow() const { return sortWindow; }
+			// stored entries including the padding - divided by NonZeros it is the fill overhead of the layout
+			size_t StoredEntries() const { return values.size(); }
+
+			// --- matrix-vector products, y = A*x
+			// x must be a single column, out is resized as needed and keeps its buffer
+			void MulInto(const Dense<T>& x, Dense<T>& out, unsigned int nThreads = 0) const;
+			Dense<T> operator*(const Dense<T>& x) const;
+			void MulVectorInto(const T* x, T* y, unsigned int nThreads = 0) const;
+		};
+	}
+}
+
+#endif // !_SPARSE_SELL_H_
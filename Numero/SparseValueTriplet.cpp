@@ -1,3 +1,6 @@
+#ifndef _SPARSE_VALUE_TRIPLET_CPP_
+#define _SPARSE_VALUE_TRIPLET_CPP_
+
 #include "SparseValueTriplet.h"
 
 using namespace Numero;
@@ -12,9 +15,33 @@ SparseValueTriplet<T>::SparseValueTriplet(unsigned int row, unsigned int col, T
 }
 
 template <class T>
-SparseValueTriplet<T>::SparseValueTriplet(SparseValueTriplet& other)
+unsigned int SparseValueTriplet<T>::Row() const
+{
+    return rowIndex;
+}
+
+template <class T>
+unsigned int SparseValueTriplet<T>::Col() const
 {
-    rowIndex = other.rowIndex;
-    columnIndex = other.columnIndex;
-    value = other.value;
-}
\ No newline at end of file
+    return columnIndex;
+}
+
+template <class T>
+T SparseValueTriplet<T>::Value() const
+{
+    return value;
+}
+
+template <class T>
+bool SparseValueTriplet<T>::operator<(const SparseValueTriplet& other) const
+{
+    return (rowIndex < other.rowIndex) || (rowIndex == other.rowIndex && columnIndex < other.columnIndex);
+}
+
+template <class T>
+bool SparseValueTriplet<T>::SamePosition(const SparseValueTriplet& other) const
+{
+    return rowIndex == other.rowIndex && columnIndex == other.columnIndex;
+}
+
+#endif // !_SPARSE_VALUE_TRIPLET_CPP_
@@ -9,6 +9,9 @@ namespace Numero
 
     namespace DataTypes
     {
+        // SparseValueTriplet class
+        // one (row, column, value) entry of a sparse matrix in coordinate form
+        // batches of triplets are the input of Sparse assembly - trivially copyable so they sort and move as raw memory
         template <class T>
         class SparseValueTriplet
         {
@@ -17,8 +20,16 @@ namespace Numero
             unsigned int columnIndex;
             T value;
         public:
+            SparseValueTriplet() : rowIndex(0), columnIndex(0), value() {};
             SparseValueTriplet(unsigned int row, unsigned int col, T value);
-            SparseValueTriplet(SparseValueTriplet& other);
+
+            unsigned int Row() const;
+            unsigned int Col() const;
+            T Value() const;
+
+            // row-major order of the position, the value does not take part
+            bool operator<(const SparseValueTriplet& other) const;
+            bool SamePosition(const SparseValueTriplet& other) const;
         };
     }
 }
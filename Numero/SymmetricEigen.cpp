@@ -0,0 +1,994 @@
+#ifndef _SYMMETRIC_EIGEN_CPP_
+#define _SYMMETRIC_EIGEN_CPP_
+
+#include <assert.h>
+#include <cmath>
+#include <limits>
+#include <algorithm>
+#include <chrono>
+#include <type_traits>
+#include "SymmetricEigen.h"
+#include "Dense.cpp"
+#include "Gemm.cpp"
+#include "Householder.cpp"
+#include "ThreadPool.h"
+
+using namespace Numero;
+using namespace Numero::DataTypes;
+
+#pragma region CONSTRUCTORS
+template <class T>
+SymmetricEigen<T>::SymmetricEigen(const Dense<T>& matrix, bool computeVectors, unsigned int nThreads)
+	: SymmetricEigen(matrix, true, false, 0, 0, static_cast<T>(0), static_cast<T>(0), computeVectors, nThreads)
+{
+}
+
+template <class T>
+SymmetricEigen<T> SymmetricEigen<T>::ByIndex(const Dense<T>& matrix, unsigned int first, unsigned int last,
+	bool computeVectors, unsigned int nThreads)
+{
+	assert(first <= last && last < matrix.Rows());
+
+	return SymmetricEigen<T>(matrix, false, false, first, last, static_cast<T>(0), static_cast<T>(0), computeVectors, nThreads);
+}
+
+template <class T>
+SymmetricEigen<T> SymmetricEigen<T>::ByValue(const Dense<T>& matrix, T lower, T upper, bool computeVectors, unsigned int nThreads)
+{
+	return SymmetricEigen<T>(matrix, false, true, 0, 0, lower, upper, computeVectors, nThreads);
+}
+
+template <class T>
+SymmetricEigen<T>::SymmetricEigen(const Dense<T>& matrix, bool all, bool byValue, unsigned int first, unsigned int last,
+	T lower, T upper, bool computeVectors, unsigned int nThreads)
+	: n(matrix.Rows()), reductionSeconds(0), solveSeconds(0), backTransformSeconds(0)
+{
+	static_assert(is_floating_point<T>::value, "symmetric eigensolver needs a floating point type");
+	assert(matrix.Rows() == matrix.Cols());
+
+	typedef chrono::steady_clock Clock;
+	Clock::time_point start = Clock::now();
+
+	Dense<T> reflectors(matrix);
+	vector<T> tau;
+	vector<T> d;
+	vector<T> e;
+	Tridiagonalize(reflectors, tau, d, e, nThreads);
+
+	Clock::time_point reduced = Clock::now();
+	reductionSeconds = chrono::duration<double>(reduced - start).count();
+	if (n == 0)
+		return;
+
+	if (byValue)
+	{
+		vector<T> e2(n - 1);
+		T largest = static_cast<T>(1);
+		for (unsigned int i(0); i + 1 < n; i++)
+		{
+			e2[i] = e[i] * e[i];
+			largest = max(largest, e2[i]);
+		}
+		T pivotMinimum = numeric_limits<T>::min() * largest;
+
+		first = SturmCount(d, e2, lower, pivotMinimum);
+		unsigned int end = SturmCount(d, e2, upper, pivotMinimum);
+		if (end <= first)
+		{
+			solveSeconds = chrono::duration<double>(Clock::now() - reduced).count();
+			return;
+		}
+		last = end - 1;
+	}
+
+	Dense<T> z;
+	if (all && !computeVectors)
+	{
+		values = d;
+		e.push_back(static_cast<T>(0));
+		TridiagonalQL(values.data(), e.data(), n, nullptr, 0);
+		sort(values.begin(), values.end());
+	}
+	else if (all)
+	{
+		DivideAndConquer(d, e, z, nThreads);
+		values = move(d);
+	}
+	else
+	{
+		Bisect(d, e, first, last, values, nThreads);
+		if (computeVectors)
+		{
+			z = Dense<T>(n, Count(), Uninitialized);
+			InverseIteration(d, e, values, z, nThreads);
+		}
+	}
+
+	Clock::time_point solved = Clock::now();
+	solveSeconds = chrono::duration<double>(solved - reduced).count();
+
+	if (computeVectors)
+	{
+		// Q = H(0)*H(1)*...*H(n-2), reflector i in row i with its implicit 1 at column i + 1
+		Householder<T>::Apply(reflectors.Data(), 1, n, static_cast<unsigned int>(tau.size()), 1, tau.data(),
+			z.Data(), n, z.Cols(), z.Cols(), nThreads);
+		vectors = move(z);
+	}
+	backTransformSeconds = chrono::duration<double>(Clock::now() - solved).count();
+}
+#pragma endregion
+
+
+#pragma region REDUCTION
+// the lower triangle is mirrored into the upper one, which the reduction then keeps current - rows are contiguous
+// from the diagonal on. after every panel the trailing matrix gets a -= [v w]*[w v]', one rank-2*BlockSize Gemm
+// for every block of TrailingRows rows, from its diagonal to the last column
+template <class T>
+void SymmetricEigen<T>::Tridiagonalize(Dense<T>& matrix, vector<T>& tau, vector<T>& diagonal, vector<T>& offDiagonal,
+	unsigned int nThreads)
+{
+	assert(matrix.Rows() == matrix.Cols());
+
+	unsigned int n = matrix.Rows();
+	T* a = matrix.Data();
+	for (unsigned int i(0); i < n; i++)
+		for (unsigned int j(0); j < i; j++)
+			a[static_cast<size_t>(j) * n + i] = a[static_cast<size_t>(i) * n + j];
+
+	tau.assign(n > 0 ? n - 1 : 0, static_cast<T>(0));
+	offDiagonal.assign(n > 0 ? n - 1 : 0, static_cast<T>(0));
+	diagonal.assign(n, static_cast<T>(0));
+
+	vector<T> v;
+	vector<T> w;
+	vector<T> vw;
+	vector<T> wv;
+	for (unsigned int k0(0); k0 < n; k0 += BlockSize)
+	{
+		unsigned int kb = (n - k0 < BlockSize) ? n - k0 : BlockSize;
+		ReducePanel(a, n, k0, kb, tau.data(), diagonal.data(), offDiagonal.data(), v, w, nThreads);
+
+		unsigned int start = k0 + kb;
+		unsigned int trailing = n - start;
+		if (trailing == 0)
+			continue;
+
+		// v and w start at row k0 + 1, the trailing matrix at row k0 + kb
+		unsigned int depth = 2 * kb;
+		vw.resize(static_cast<size_t>(trailing) * depth);
+		wv.resize(static_cast<size_t>(trailing) * depth);
+		for (unsigned int r(0); r < trailing; r++)
+		{
+			const T* vr = v.data() + static_cast<size_t>(kb - 1 + r) * kb;
+			const T* wr = w.data() + static_cast<size_t>(kb - 1 + r) * kb;
+			copy(vr, vr + kb, vw.data() + static_cast<size_t>(r) * depth);
+			copy(wr, wr + kb, vw.data() + static_cast<size_t>(r) * depth + kb);
+			copy(wr, wr + kb, wv.data() + static_cast<size_t>(r) * depth);
+			copy(vr, vr + kb, wv.data() + static_cast<size_t>(r) * depth + kb);
+		}
+
+		for (unsigned int r0(0); r0 < trailing; r0 += TrailingRows)
+		{
+			unsigned int rows = (trailing - r0 < TrailingRows) ? trailing - r0 : TrailingRows;
+			Gemm<T>::Multiply(rows, trailing - r0, depth,
+				static_cast<T>(-1),
+				vw.data() + static_cast<size_t>(r0) * depth, depth, 1,
+				wv.data() + static_cast<size_t>(r0) * depth, 1, depth,
+				static_cast<T>(1),
+				a + static_cast<size_t>(start + r0) * n + start + r0, n, 1,
+				nThreads);
+		}
+	}
+}
+
+// for every row j of the panel: apply the earlier reflectors of the panel to row j through v and w, generate
+// the reflector u of a(j, j+1:n) and w = tau*A*u - tau/2*(u'*tau*A*u)*u, where A*u is the product with the trailing
+// matrix as it was before the panel corrected by v and w - that product is the only O(n^2) step of a reflector
+template <class T>
+void SymmetricEigen<T>::ReducePanel(T* a, unsigned int n, unsigned int k0, unsigned int kb, T* tau, T* diagonal, T* offDiagonal,
+	vector<T>& v, vector<T>& w, unsigned int nThreads)
+{
+	unsigned int rows = n - k0 - 1;
+	v.assign(static_cast<size_t>(rows) * kb, static_cast<T>(0));
+	w.assign(static_cast<size_t>(rows) * kb, static_cast<T>(0));
+	vector<T> u(rows);
+	vector<T> p(rows);
+	vector<T> t1(kb);
+	vector<T> t2(kb);
+	vector<T> partial;
+
+	ThreadPool& pool = ThreadPool::Global();
+	unsigned int threads = (nThreads == 0 || nThreads > pool.ThreadCount()) ? pool.ThreadCount() : nThreads;
+
+	for (unsigned int i(0); i < kb; i++)
+	{
+		unsigned int j = k0 + i;
+		T* rowJ = a + static_cast<size_t>(j) * n;
+
+		if (i > 0)
+		{
+			const T* vj = v.data() + static_cast<size_t>(i - 1) * kb;
+			const T* wj = w.data() + static_cast<size_t>(i - 1) * kb;
+			for (unsigned int c(j); c < n; c++)
+			{
+				const T* vc = v.data() + static_cast<size_t>(c - k0 - 1) * kb;
+				const T* wc = w.data() + static_cast<size_t>(c - k0 - 1) * kb;
+				T sum = static_cast<T>(0);
+				for (unsigned int q(0); q < i; q++)
+					sum += vj[q] * wc[q] + wj[q] * vc[q];
+				rowJ[c] -= sum;
+			}
+		}
+
+		diagonal[j] = rowJ[j];
+		if (j + 1 == n)
+			break;
+
+		// H = I - tau*u*u' maps a(j, j+1:n) onto beta*e1, u(0) = 1 and u(1:) overwrites a(j, j+2:n)
+		unsigned int length = n - j - 1;
+		T alpha = rowJ[j + 1];
+		T tail = static_cast<T>(0);
+		for (unsigned int c(j + 2); c < n; c++)
+			tail += rowJ[c] * rowJ[c];
+
+		if (tail == static_cast<T>(0))
+		{
+			tau[j] = static_cast<T>(0);
+			offDiagonal[j] = alpha;
+		}
+		else
+		{
+			T beta = -copysign(sqrt(alpha * alpha + tail), alpha);
+			tau[j] = (beta - alpha) / beta;
+			T scale = static_cast<T>(1) / (alpha - beta);
+			for (unsigned int c(j + 2); c < n; c++)
+				rowJ[c] *= scale;
+			offDiagonal[j] = beta;
+		}
+
+		u[0] = static_cast<T>(1);
+		copy(rowJ + j + 2, rowJ + n, u.data() + 1);
+		for (unsigned int s(0); s < length; s++)
+			v[static_cast<size_t>(i + s) * kb + i] = u[s];
+		if (tau[j] == static_cast<T>(0))
+			continue;
+
+		// p = A(j+1:n, j+1:n)*u from the upper triangle - row r adds its dot product with u to p(r) and u(r) times
+		// itself to p(r+1:), so each chunk of rows but the first accumulates into a buffer of its own
+		// the chunks split the triangle into equal areas
+		const T* trailing = a + static_cast<size_t>(j + 1) * n + j + 1;
+		unsigned int chunks = (length >= ParallelReduction && threads > 1) ? threads : 1;
+		partial.assign(static_cast<size_t>(chunks - 1) * length, static_cast<T>(0));
+		fill(p.begin(), p.begin() + length, static_cast<T>(0));
+		pool.ParallelFor(chunks, [&](unsigned int chunk)
+		{
+			unsigned int begin = length - static_cast<unsigned int>(length * sqrt(static_cast<double>(chunks - chunk) / chunks));
+			unsigned int end = length - static_cast<unsigned int>(length * sqrt(static_cast<double>(chunks - chunk - 1) / chunks));
+			T* y = (chunk == 0) ? p.data() : partial.data() + static_cast<size_t>(chunk - 1) * length;
+			for (unsigned int r(begin); r < end; r++)
+			{
+				const T* row = trailing + static_cast<size_t>(r) * n;
+				T ur = u[r];
+				T sum = row[r] * ur;
+				for (unsigned int c(r + 1); c < length; c++)
+				{
+					sum += row[c] * u[c];
+					y[c] += row[c] * ur;
+				}
+				y[r] += sum;
+			}
+		}, chunks);
+		for (unsigned int chunk(1); chunk < chunks; chunk++)
+		{
+			const T* y = partial.data() + static_cast<size_t>(chunk - 1) * length;
+			for (unsigned int r(0); r < length; r++)
+				p[r] += y[r];
+		}
+
+		// p -= v*(w'*u) + w*(v'*u) over the earlier reflectors of the panel
+		if (i > 0)
+		{
+			fill(t1.begin(), t1.begin() + i, static_cast<T>(0));
+			fill(t2.begin(), t2.begin() + i, static_cast<T>(0));
+			for (unsigned int s(0); s < length; s++)
+			{
+				const T* vs = v.data() + static_cast<size_t>(i + s) * kb;
+				const T* ws = w.data() + static_cast<size_t>(i + s) * kb;
+				for (unsigned int q(0); q < i; q++)
+				{
+					t1[q] += ws[q] * u[s];
+					t2[q] += vs[q] * u[s];
+				}
+			}
+			for (unsigned int s(0); s < length; s++)
+			{
+				const T* vs = v.data() + static_cast<size_t>(i + s) * kb;
+				const T* ws = w.data() + static_cast<size_t>(i + s) * kb;
+				T sum = static_cast<T>(0);
+				for (unsigned int q(0); q < i; q++)
+					sum += vs[q] * t1[q] + ws[q] * t2[q];
+				p[s] -= sum;
+			}
+		}
+
+		T dot = static_cast<T>(0);
+		for (unsigned int s(0); s < length; s++)
+		{
+			p[s] *= tau[j];
+			dot += p[s] * u[s];
+		}
+		T gamma = -static_cast<T>(0.5) * tau[j] * dot;
+		for (unsigned int s(0); s < length; s++)
+			w[static_cast<size_t>(i + s) * kb + i] = p[s] + gamma * u[s];
+	}
+}
+#pragma endregion
+
+
+#pragma region TRIDIAGONAL_QL
+// implicit QL with Wilkinson shifts - a negligible e[m] splits the matrix, every sweep chases the bulge
+// from m up to l with Givens rotations
+template <class T>
+void SymmetricEigen<T>::TridiagonalQL(T* d, T* e, unsigned int count, T* z, size_t ldz)
+{
+	const T epsilon = numeric_limits<T>::epsilon();
+	const unsigned int maxIterations = 30;
+	if (count == 0)
+		return;
+	e[count - 1] = static_cast<T>(0);
+
+	for (unsigned int l(0); l < count; l++)
+	{
+		unsigned int iterations = 0;
+		unsigned int m;
+		do
+		{
+			for (m = l; m + 1 < count; m++)
+			{
+				T scale = abs(d[m]) + abs(d[m + 1]);
+				if (abs(e[m]) <= epsilon * scale)
+					break;
+			}
+			if (m == l || iterations++ == maxIterations)
+				break;
+
+			T g = (d[l + 1] - d[l]) / (static_cast<T>(2) * e[l]);
+			T r = hypot(g, static_cast<T>(1));
+			g = d[m] - d[l] + e[l] / (g + copysign(r, g));
+
+			T s = static_cast<T>(1);
+			T c = static_cast<T>(1);
+			T p = static_cast<T>(0);
+			bool underflow = false;
+			for (unsigned int i(m); i-- > l;)
+			{
+				T f = s * e[i];
+				T b = c * e[i];
+				r = hypot(f, g);
+				e[i + 1] = r;
+				if (r == static_cast<T>(0))
+				{
+					// the rotation split the matrix, restart from l
+					d[i + 1] -= p;
+					e[m] = static_cast<T>(0);
+					underflow = true;
+					break;
+				}
+				s = f / r;
+				c = g / r;
+				g = d[i + 1] - p;
+				r = (d[i] - g) * s + static_cast<T>(2) * c * b;
+				p = s * r;
+				d[i + 1] = g + p;
+				g = c * r - b;
+
+				if (z != nullptr)
+				{
+					for (unsigned int row(0); row < count; row++)
+					{
+						T* zRow = z + row * ldz;
+						T zNext = zRow[i + 1];
+						zRow[i + 1] = s * zRow[i] + c * zNext;
+						zRow[i] = c * zRow[i] - s * zNext;
+					}
+				}
+			}
+			if (underflow)
+				continue;
+
+			d[l] -= p;
+			e[l] = g;
+			e[m] = static_cast<T>(0);
+		} while (true);
+	}
+}
+#pragma endregion
+
+
+#pragma region DIVIDE_AND_CONQUER
+// the matrix is torn into halves down to DivideLeafSize, T = diag(T1, T2) + |beta|*v*v' with v = (.., 1, sign(beta), ..)
+// the leaves are solved by QL in parallel and the merges run bottom up, a whole level at a time - in parallel
+// across the merges while they outnumber the threads, otherwise one after the other with the threads inside
+template <class T>
+void SymmetricEigen<T>::DivideAndConquer(vector<T>& d, vector<T>& e, Dense<T>& q, unsigned int nThreads)
+{
+	unsigned int n = static_cast<unsigned int>(d.size());
+	q = Dense<T>(n, n);
+	T* data = q.Data();
+
+	// leaves as lo, hi pairs and merges as lo, mid, hi triples by depth
+	vector<unsigned int> leaves;
+	vector<vector<unsigned int>> levels;
+	vector<pair<unsigned int, unsigned int>> pending(1, make_pair(0u, n));
+	vector<unsigned int> depths(1, 0u);
+	while (!pending.empty())
+	{
+		unsigned int lo = pending.back().first;
+		unsigned int hi = pending.back().second;
+		unsigned int depth = depths.back();
+		pending.pop_back();
+		depths.pop_back();
+
+		if (hi - lo <= DivideLeafSize)
+		{
+			leaves.push_back(lo);
+			leaves.push_back(hi);
+			continue;
+		}
+
+		unsigned int mid = lo + (hi - lo) / 2;
+		if (levels.size() <= depth)
+			levels.resize(depth + 1);
+		levels[depth].push_back(lo);
+		levels[depth].push_back(mid);
+		levels[depth].push_back(hi);
+		pending.push_back(make_pair(lo, mid));
+		depths.push_back(depth + 1);
+		pending.push_back(make_pair(mid, hi));
+		depths.push_back(depth + 1);
+	}
+
+	// the tears, before the halves are solved
+	for (const vector<unsigned int>& level : levels)
+	{
+		for (size_t i(0); i < level.size(); i += 3)
+		{
+			T beta = abs(e[level[i + 1] - 1]);
+			d[level[i + 1] - 1] -= beta;
+			d[level[i + 1]] -= beta;
+		}
+	}
+
+	ThreadPool& pool = ThreadPool::Global();
+	unsigned int threads = (nThreads == 0 || nThreads > pool.ThreadCount()) ? pool.ThreadCount() : nThreads;
+
+	unsigned int leafCount = static_cast<unsigned int>(leaves.size() / 2);
+	pool.ParallelFor(leafCount, [&](unsigned int leaf)
+	{
+		unsigned int lo = leaves[2 * leaf];
+		unsigned int hi = leaves[2 * leaf + 1];
+		T* block = data + static_cast<size_t>(lo) * n + lo;
+		for (unsigned int i(0); i < hi - lo; i++)
+			block[static_cast<size_t>(i) * n + i] = static_cast<T>(1);
+
+		vector<T> coupling(e.begin() + lo, e.begin() + (hi - 1));
+		coupling.push_back(static_cast<T>(0));
+		TridiagonalQL(d.data() + lo, coupling.data(), hi - lo, block, n);
+	}, threads);
+
+	for (size_t depth(levels.size()); depth-- > 0;)
+	{
+		const vector<unsigned int>& level = levels[depth];
+		unsigned int merges = static_cast<unsigned int>(level.size() / 3);
+		if (merges >= threads)
+		{
+			pool.ParallelFor(merges, [&](unsigned int i)
+			{
+				unsigned int mid = level[3 * i + 1];
+				Merge(d.data(), data, n, level[3 * i], mid, level[3 * i + 2], e[mid - 1], 1);
+			}, threads);
+		}
+		else
+		{
+			for (unsigned int i(0); i < merges; i++)
+			{
+				unsigned int mid = level[3 * i + 1];
+				Merge(d.data(), data, n, level[3 * i], mid, level[3 * i + 2], e[mid - 1], threads);
+			}
+		}
+	}
+
+	// a single leaf is the whole matrix and still unsorted
+	if (levels.empty())
+	{
+		vector<unsigned int> order(n);
+		for (unsigned int i(0); i < n; i++)
+			order[i] = i;
+		sort(order.begin(), order.end(), [&](unsigned int x, unsigned int y) { return d[x] < d[y]; });
+
+		Dense<T> sorted(n, n, Uninitialized);
+		vector<T> sortedValues(n);
+		for (unsigned int row(0); row < n; row++)
+			for (unsigned int col(0); col < n; col++)
+				sorted.Data()[static_cast<size_t>(row) * n + col] = data[static_cast<size_t>(row) * n + order[col]];
+		for (unsigned int col(0); col < n; col++)
+			sortedValues[col] = d[order[col]];
+		q = move(sorted);
+		d = move(sortedValues);
+	}
+}
+
+// D + rho*z*z' with D the eigenvalues of both halves and z = Q'*v, the last row of Q1 and the first of Q2
+// 1. deflation as in LAPACK's laed2 - a negligible z(i) leaves d(i) and its vector as they are, and of two close
+//    poles a Givens rotation zeroes one z, whose rotated vector is then kept as it is
+// 2. every root of the secular equation 1 + rho*sum(z(i)^2 / (d(i) - x)) = 0 by safeguarded Newton, relative to
+//    the nearer pole so the differences d(i) - x keep their digits
+// 3. z recomputed from the roots (Gu and Eisenstat), so the vectors z(i) / (d(i) - x) are orthogonal to working
+//    precision, and the new columns of Q are the old ones times those vectors - one Gemm for each half
+template <class T>
+void SymmetricEigen<T>::Merge(T* d, T* q, size_t ldq, unsigned int lo, unsigned int mid, unsigned int hi, T beta, unsigned int nThreads)
+{
+	const T epsilon = numeric_limits<T>::epsilon();
+	unsigned int size = hi - lo;
+	unsigned int half = mid - lo;
+	T* block = q + lo * ldq + lo;
+	T* values = d + lo;
+
+	vector<T> z(size);
+	T sign = (beta < static_cast<T>(0)) ? static_cast<T>(-1) : static_cast<T>(1);
+	for (unsigned int c(0); c < half; c++)
+		z[c] = block[(half - 1) * ldq + c];
+	for (unsigned int c(half); c < size; c++)
+		z[c] = sign * block[half * ldq + c];
+
+	T norm2 = static_cast<T>(0);
+	for (unsigned int c(0); c < size; c++)
+		norm2 += z[c] * z[c];
+	T rho = abs(beta) * norm2;
+	T scale = static_cast<T>(1) / sqrt(norm2);
+	for (unsigned int c(0); c < size; c++)
+		z[c] *= scale;
+
+	// columns below half start in the upper half only, the others in the lower, rotations can mix them
+	vector<unsigned char> columnType(size);
+	for (unsigned int c(0); c < size; c++)
+		columnType[c] = (c < half) ? 0 : 1;
+
+	vector<unsigned int> order(size);
+	for (unsigned int c(0); c < size; c++)
+		order[c] = c;
+	sort(order.begin(), order.end(), [&](unsigned int x, unsigned int y) { return values[x] < values[y]; });
+
+	T largest = static_cast<T>(0);
+	for (unsigned int c(0); c < size; c++)
+		largest = max(largest, max(abs(values[c]), abs(z[c])));
+	T tolerance = static_cast<T>(8) * epsilon * largest;
+
+	vector<unsigned int> kept;			// columns of the secular equation, ascending poles
+	vector<unsigned int> deflated;		// columns whose vectors are final
+	unsigned int previous = size;
+	for (unsigned int s(0); s < size; s++)
+	{
+		unsigned int c = order[s];
+		if (rho * abs(z[c]) <= tolerance)
+		{
+			deflated.push_back(c);
+			continue;
+		}
+		if (previous == size)
+		{
+			previous = c;
+			continue;
+		}
+
+		T radius = hypot(z[previous], z[c]);
+		T cosine = z[c] / radius;
+		T sine = -z[previous] / radius;
+		T gap = values[c] - values[previous];
+		if (abs(gap * cosine * sine) > tolerance)
+		{
+			kept.push_back(previous);
+			previous = c;
+			continue;
+		}
+
+		z[c] = radius;
+		z[previous] = static_cast<T>(0);
+		if (columnType[c] != columnType[previous])
+		{
+			columnType[c] = 2;
+			columnType[previous] = 2;
+		}
+		for (unsigned int row(0); row < size; row++)
+		{
+			T* x = block + row * ldq + previous;
+			T* y = block + row * ldq + c;
+			T xValue = *x;
+			*x = cosine * xValue + sine * *y;
+			*y = cosine * *y - sine * xValue;
+		}
+		T deflatedValue = values[previous] * cosine * cosine + values[c] * sine * sine;
+		values[c] = values[previous] * sine * sine + values[c] * cosine * cosine;
+		values[previous] = deflatedValue;
+		deflated.push_back(previous);
+		previous = c;
+	}
+	if (previous != size)
+		kept.push_back(previous);
+
+	unsigned int k = static_cast<unsigned int>(kept.size());
+	vector<T> poles(k);
+	vector<T> weights(k);
+	T weightSum = static_cast<T>(0);
+	for (unsigned int i(0); i < k; i++)
+	{
+		poles[i] = values[kept[i]];
+		weights[i] = z[kept[i]] * z[kept[i]];
+		weightSum += weights[i];
+	}
+
+	// root j is poles[origin[j]] + shift[j]
+	vector<unsigned int> origin(k);
+	vector<T> shift(k);
+	ThreadPool& pool = ThreadPool::Global();
+	unsigned int secularThreads = (k >= ParallelSecular) ? nThreads : 1;
+	auto secular = [&](unsigned int o, T t, T& derivative)
+	{
+		T f = static_cast<T>(1);
+		derivative = static_cast<T>(0);
+		for (unsigned int i(0); i < k; i++)
+		{
+			T delta = (poles[i] - poles[o]) - t;
+			T term = weights[i] / delta;
+			f += rho * term;
+			derivative += rho * term / delta;
+		}
+		return f;
+	};
+
+	pool.ParallelFor(k, [&](unsigned int j)
+	{
+		T derivative;
+		T low;
+		T high;
+		unsigned int o = j;
+		if (j + 1 < k)
+		{
+			T halfGap = (poles[j + 1] - poles[j]) / static_cast<T>(2);
+			if (secular(j, halfGap, derivative) >= static_cast<T>(0))
+			{
+				low = static_cast<T>(0);
+				high = halfGap;
+			}
+			else
+			{
+				o = j + 1;
+				low = -halfGap;
+				high = static_cast<T>(0);
+			}
+		}
+		else
+		{
+			low = static_cast<T>(0);
+			high = rho * weightSum;
+		}
+
+		T t = (low + high) / static_cast<T>(2);
+		for (unsigned int iteration(0); iteration < 200; iteration++)
+		{
+			T f = secular(o, t, derivative);
+			if (f == static_cast<T>(0))
+				break;
+			if (f > static_cast<T>(0))
+				high = t;
+			else
+				low = t;
+
+			T next = t - f / derivative;
+			if (!(next > low && next < high))
+				next = low + (high - low) / static_cast<T>(2);
+			if (abs(next - t) <= static_cast<T>(2) * epsilon * abs(next) || high - low <= static_cast<T>(2) * epsilon * max(abs(low), abs(high)))
+			{
+				t = next;
+				break;
+			}
+			t = next;
+		}
+		origin[j] = o;
+		shift[j] = t;
+	}, secularThreads);
+
+	// z(i)^2 = prod_j (x(j) - d(i)) / (rho * prod_{j != i} (d(j) - d(i))), paired factor by factor
+	auto rootMinusPole = [&](unsigned int j, unsigned int i) { return (poles[origin[j]] - poles[i]) + shift[j]; };
+	vector<T> exact(k);
+	vector<T> u(static_cast<size_t>(k) * k);
+	pool.ParallelFor(k, [&](unsigned int i)
+	{
+		T product = rootMinusPole(i, i) / rho;
+		for (unsigned int j(0); j < k; j++)
+			if (j != i)
+				product *= rootMinusPole(j, i) / (poles[j] - poles[i]);
+		exact[i] = copysign(sqrt(abs(product)), z[kept[i]]);
+	}, secularThreads);
+
+	// u(i, j) = z(i) / (d(i) - x(j)), every column normalized
+	pool.ParallelFor(k, [&](unsigned int j)
+	{
+		T sum = static_cast<T>(0);
+		for (unsigned int i(0); i < k; i++)
+		{
+			T element = -exact[i] / rootMinusPole(j, i);
+			u[static_cast<size_t>(i) * k + j] = element;
+			sum += element * element;
+		}
+		T inverse = static_cast<T>(1) / sqrt(sum);
+		for (unsigned int i(0); i < k; i++)
+			u[static_cast<size_t>(i) * k + j] *= inverse;
+	}, secularThreads);
+
+	// new columns 0..k-1 from the kept ones, then the deflated columns
+	Dense<T> merged(size, size, Uninitialized);
+	T* out = merged.Data();
+	for (unsigned int part(0); part < 2; part++)
+	{
+		unsigned int rowBegin = (part == 0) ? 0 : half;
+		unsigned int rowCount = (part == 0) ? half : size - half;
+		vector<unsigned int> used;
+		for (unsigned int i(0); i < k; i++)
+			if (columnType[kept[i]] == part || columnType[kept[i]] == 2)
+				used.push_back(i);
+
+		unsigned int width = static_cast<unsigned int>(used.size());
+		vector<T> gathered(static_cast<size_t>(rowCount) * width);
+		vector<T> rows(static_cast<size_t>(width) * k);
+		for (unsigned int r(0); r < rowCount; r++)
+		{
+			const T* source = block + (rowBegin + r) * ldq;
+			for (unsigned int c(0); c < width; c++)
+				gathered[static_cast<size_t>(r) * width + c] = source[kept[used[c]]];
+		}
+		for (unsigned int c(0); c < width; c++)
+			copy(u.data() + static_cast<size_t>(used[c]) * k, u.data() + static_cast<size_t>(used[c] + 1) * k, rows.data() + static_cast<size_t>(c) * k);
+
+		if (k > 0)
+			Gemm<T>::Multiply(rowCount, k, width,
+				static_cast<T>(1),
+				gathered.data(), width, 1,
+				rows.data(), k, 1,
+				static_cast<T>(0),
+				out + static_cast<size_t>(rowBegin) * size, size, 1,
+				nThreads);
+	}
+
+	vector<T> mergedValues(size);
+	for (unsigned int j(0); j < k; j++)
+		mergedValues[j] = poles[origin[j]] + shift[j];
+	for (unsigned int i(0); i < deflated.size(); i++)
+	{
+		unsigned int c = deflated[i];
+		mergedValues[k + i] = values[c];
+		for (unsigned int row(0); row < size; row++)
+			out[static_cast<size_t>(row) * size + k + i] = block[row * ldq + c];
+	}
+
+	// ascending order back into the block of q
+	vector<unsigned int> position(size);
+	for (unsigned int c(0); c < size; c++)
+		position[c] = c;
+	sort(position.begin(), position.end(), [&](unsigned int x, unsigned int y) { return mergedValues[x] < mergedValues[y]; });
+	for (unsigned int row(0); row < size; row++)
+	{
+		T* target = block + row * ldq;
+		const T* source = out + static_cast<size_t>(row) * size;
+		for (unsigned int c(0); c < size; c++)
+			target[c] = source[position[c]];
+	}
+	for (unsigned int c(0); c < size; c++)
+		values[c] = mergedValues[position[c]];
+}
+#pragma endregion
+
+
+#pragma region BISECTION
+// count of the negative pivots of the LDL' factorization of T - x*I, with tiny pivots pushed to -pivotMinimum -
+// a zero pivot means x is an eigenvalue, so this counts the eigenvalues <= x
+template <class T>
+unsigned int SymmetricEigen<T>::SturmCount(const vector<T>& d, const vector<T>& e2, T x, T pivotMinimum)
+{
+	unsigned int count = 0;
+	T pivot = static_cast<T>(1);
+	for (size_t i(0); i < d.size(); i++)
+	{
+		pivot = d[i] - x - ((i > 0) ? e2[i - 1] / pivot : static_cast<T>(0));
+		if (abs(pivot) <= pivotMinimum)
+			pivot = -pivotMinimum;
+		if (pivot < static_cast<T>(0))
+			count++;
+	}
+	return count;
+}
+
+// every eigenvalue bisected on its own from the Gershgorin interval, in parallel
+template <class T>
+void SymmetricEigen<T>::Bisect(const vector<T>& d, const vector<T>& e, unsigned int first, unsigned int last,
+	vector<T>& result, unsigned int nThreads)
+{
+	const T epsilon = numeric_limits<T>::epsilon();
+	unsigned int n = static_cast<unsigned int>(d.size());
+
+	vector<T> e2(n - 1);
+	T largest = static_cast<T>(1);
+	T lowest = d[0];
+	T highest = d[0];
+	for (unsigned int i(0); i < n; i++)
+	{
+		T radius = ((i > 0) ? abs(e[i - 1]) : static_cast<T>(0)) + ((i + 1 < n) ? abs(e[i]) : static_cast<T>(0));
+		lowest = min(lowest, d[i] - radius);
+		highest = max(highest, d[i] + radius);
+		if (i + 1 < n)
+		{
+			e2[i] = e[i] * e[i];
+			largest = max(largest, e2[i]);
+		}
+	}
+	T pivotMinimum = numeric_limits<T>::min() * largest;
+	T margin = static_cast<T>(2) * epsilon * max(abs(lowest), abs(highest)) + pivotMinimum;
+	lowest -= margin;
+	highest += margin;
+
+	result.resize(last - first + 1);
+	ThreadPool::Global().ParallelFor(last - first + 1, [&](unsigned int index)
+	{
+		T low = lowest;
+		T high = highest;
+		while (high - low > static_cast<T>(2) * epsilon * max(abs(low), abs(high)) + pivotMinimum)
+		{
+			T middle = low + (high - low) / static_cast<T>(2);
+			if (middle <= low || middle >= high)
+				break;
+			if (SturmCount(d, e2, middle, pivotMinimum) > first + index)
+				high = middle;
+			else
+				low = middle;
+		}
+		result[index] = low + (high - low) / static_cast<T>(2);
+	}, nThreads);
+}
+
+// eigenvalues within ClusterGap * ||T|| of their neighbour form a cluster, whose vectors are computed in order and
+// orthogonalized against the earlier ones of the cluster after every solve - the clusters run in parallel
+// coincident eigenvalues are separated by a few ulps so the factorizations differ
+template <class T>
+void SymmetricEigen<T>::InverseIteration(const vector<T>& d, const vector<T>& e, const vector<T>& eigenvalues,
+	Dense<T>& z, unsigned int nThreads)
+{
+	const T epsilon = numeric_limits<T>::epsilon();
+	unsigned int n = static_cast<unsigned int>(d.size());
+	unsigned int count = static_cast<unsigned int>(eigenvalues.size());
+
+	T norm = static_cast<T>(0);
+	for (unsigned int i(0); i < n; i++)
+		norm = max(norm, abs(d[i]) + ((i > 0) ? abs(e[i - 1]) : static_cast<T>(0)) + ((i + 1 < n) ? abs(e[i]) : static_cast<T>(0)));
+	T clusterGap = static_cast<T>(ClusterGap) * norm;
+	T tiny = max(epsilon * norm, numeric_limits<T>::min());
+	T perturbation = static_cast<T>(10) * epsilon * max(norm, numeric_limits<T>::min());
+
+	vector<unsigned int> clusterStart(1, 0u);
+	for (unsigned int j(1); j < count; j++)
+		if (eigenvalues[j] - eigenvalues[j - 1] > clusterGap)
+			clusterStart.push_back(j);
+	clusterStart.push_back(count);
+
+	ThreadPool::Global().ParallelFor(static_cast<unsigned int>(clusterStart.size() - 1), [&](unsigned int cluster)
+	{
+		unsigned int begin = clusterStart[cluster];
+		unsigned int end = clusterStart[cluster + 1];
+		vector<T> found(static_cast<size_t>(end - begin) * n);
+		vector<T> u1(n);
+		vector<T> u2(n);
+		vector<T> u3(n);
+		vector<T> multiplier(n);
+		vector<unsigned char> swapped(n);
+		T previous = static_cast<T>(0);
+
+		for (unsigned int j(begin); j < end; j++)
+		{
+			T x = eigenvalues[j];
+			if (j > begin && x - previous < perturbation)
+				x = previous + perturbation;
+			previous = x;
+
+			// T - x*I = P*L*U with partial pivoting, U has two super diagonals
+			T diagonal = d[0] - x;
+			T upper = (n > 1) ? e[0] : static_cast<T>(0);
+			for (unsigned int i(0); i + 1 < n; i++)
+			{
+				T below = e[i];
+				T nextDiagonal = d[i + 1] - x;
+				T nextUpper = (i + 2 < n) ? e[i + 1] : static_cast<T>(0);
+				if (abs(diagonal) >= abs(below))
+				{
+					if (diagonal == static_cast<T>(0))
+						diagonal = tiny;
+					multiplier[i] = below / diagonal;
+					u1[i] = diagonal;
+					u2[i] = upper;
+					u3[i] = static_cast<T>(0);
+					swapped[i] = 0;
+					diagonal = nextDiagonal - multiplier[i] * upper;
+					upper = nextUpper;
+				}
+				else
+				{
+					multiplier[i] = diagonal / below;
+					u1[i] = below;
+					u2[i] = nextDiagonal;
+					u3[i] = nextUpper;
+					swapped[i] = 1;
+					diagonal = upper - multiplier[i] * nextDiagonal;
+					upper = -multiplier[i] * nextUpper;
+				}
+			}
+			u1[n - 1] = (diagonal == static_cast<T>(0)) ? tiny : diagonal;
+
+			T* iterate = found.data() + static_cast<size_t>(j - begin) * n;
+			unsigned int seed = 2654435761u * (j + 1);
+			for (unsigned int i(0); i < n; i++)
+			{
+				seed = seed * 1664525u + 1013904223u;
+				iterate[i] = static_cast<T>(seed >> 8) / static_cast<T>(1 << 24) - static_cast<T>(0.5);
+			}
+
+			for (unsigned int iteration(0); iteration < InverseIterations; iteration++)
+			{
+				for (unsigned int i(0); i + 1 < n; i++)
+				{
+					if (swapped[i])
+						swap(iterate[i], iterate[i + 1]);
+					iterate[i + 1] -= multiplier[i] * iterate[i];
+				}
+				for (unsigned int i(n); i-- > 0;)
+				{
+					T sum = iterate[i];
+					if (i + 1 < n)
+						sum -= u2[i] * iterate[i + 1];
+					if (i + 2 < n)
+						sum -= u3[i] * iterate[i + 2];
+					iterate[i] = sum / u1[i];
+				}
+
+				for (unsigned int pass(0); pass < 2; pass++)
+				{
+					for (unsigned int other(begin); other < j; other++)
+					{
+						const T* done = found.data() + static_cast<size_t>(other - begin) * n;
+						T dot = static_cast<T>(0);
+						for (unsigned int i(0); i < n; i++)
+							dot += done[i] * iterate[i];
+						for (unsigned int i(0); i < n; i++)
+							iterate[i] -= dot * done[i];
+					}
+
+					T largestElement = static_cast<T>(0);
+					for (unsigned int i(0); i < n; i++)
+						largestElement = max(largestElement, abs(iterate[i]));
+					T sum = static_cast<T>(0);
+					for (unsigned int i(0); i < n; i++)
+					{
+						iterate[i] /= largestElement;
+						sum += iterate[i] * iterate[i];
+					}
+					T inverse = static_cast<T>(1) / sqrt(sum);
+					for (unsigned int i(0); i < n; i++)
+						iterate[i] *= inverse;
+				}
+			}
+
+			for (unsigned int i(0); i < n; i++)
+				z.Data()[static_cast<size_t>(i) * count + j] = iterate[i];
+		}
+	}, nThreads);
+}
+#pragma endregion
+
+#endif // !_SYMMETRIC_EIGEN_CPP_
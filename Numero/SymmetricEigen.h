@@ -0,0 +1,107 @@
+#ifndef _SYMMETRIC_EIGEN_H_
+#define _SYMMETRIC_EIGEN_H_
+
+#include "../Numero.Definitions/DataTypeDefines.h"
+#include "Dense.h"
+#include <vector>
+
+namespace Numero
+{
+	using namespace std;
+	using namespace Definitions;
+
+	namespace DataTypes
+	{
+		// SymmetricEigen class
+		// eigenvalues and eigenvectors of a symmetric matrix, A = Z*diag(values)*Z', for floating point T
+		// the matrix is reduced to tridiagonal form Q'*A*Q by blocked Householder reflectors - every panel of
+		// BlockSize reflectors is accumulated as in LAPACK's latrd and the upper triangle of the trailing matrix gets one
+		// rank-2*BlockSize update through Gemm. the eigenproblem of the tridiagonal matrix is then solved
+		//	- all eigenvalues only - implicit QL, O(n^2)
+		//	- all eigenpairs - Cuppen's divide and conquer, with the Gu-Eisenstat secular equation vectors, so every
+		//	  merge is a Gemm of the child eigenvectors
+		//	- a subset by index or value range - bisection on Sturm counts and inverse iteration, with the
+		//	  vectors of close eigenvalues reorthogonalized against each other
+		// and the eigenvectors of the tridiagonal matrix are mapped back by the reflectors in compact WY form
+		// only the lower triangle of the matrix is read
+		template <class T>
+		class SymmetricEigen
+		{
+		private:
+			unsigned int n;
+			vector<T> values;				// ascending
+			Dense<T> vectors;				// n x Count(), column j belongs to values[j]
+			double reductionSeconds;
+			double solveSeconds;
+			double backTransformSeconds;
+
+			// the wanted eigenpairs, ascending indices first..last - all of them with first = 0, last = n - 1
+			SymmetricEigen(const Dense<T>& matrix, bool all, bool byValue, unsigned int first, unsigned int last,
+				T lower, T upper, bool computeVectors, unsigned int nThreads);
+
+			// panel of kb reflectors from row k0 of the symmetric a, upper triangle, v and w are (n - k0 - 1) x kb with the trailing
+			// matrix to be updated by a -= v*w' + w*v'
+			static void ReducePanel(T* a, unsigned int n, unsigned int k0, unsigned int kb, T* tau, T* diagonal, T* offDiagonal,
+				vector<T>& v, vector<T>& w, unsigned int nThreads);
+
+			// implicit QL on the tridiagonal matrix d, e (e[i] couples i and i + 1), rotating the columns of the
+			// count x count block z with row stride ldz when z is given. the eigenvalues are left unsorted in d
+			static void TridiagonalQL(T* d, T* e, unsigned int count, T* z, size_t ldz);
+			// all eigenpairs of the tridiagonal matrix, ascending - q is n x n
+			static void DivideAndConquer(vector<T>& d, vector<T>& e, Dense<T>& q, unsigned int nThreads);
+			// merges the solved halves [lo, mid) and [mid, hi) of the tear at mid of size beta
+			static void Merge(T* d, T* q, size_t ldq, unsigned int lo, unsigned int mid, unsigned int hi, T beta, unsigned int nThreads);
+
+			// eigenvalues below x
+			static unsigned int SturmCount(const vector<T>& d, const vector<T>& e2, T x, T pivotMinimum);
+			// eigenvalues first..last by bisection, and their eigenvectors by inverse iteration in the columns of z
+			static void Bisect(const vector<T>& d, const vector<T>& e, unsigned int first, unsigned int last,
+				vector<T>& result, unsigned int nThreads);
+			static void InverseIteration(const vector<T>& d, const vector<T>& e, const vector<T>& eigenvalues,
+				Dense<T>& z, unsigned int nThreads);
+
+		public:
+			// reflectors per panel of the reduction
+			static const unsigned int BlockSize = 32;
+			// rows of C in every Gemm of the trailing update, which covers the upper triangle block row by block row
+			static const unsigned int TrailingRows = 128;
+			// the matrix-vector product of a reflector is split across the pool from this many trailing rows
+			static const unsigned int ParallelReduction = 256;
+			// divide and conquer solves tridiagonal blocks of at most this size by QL
+			static const unsigned int DivideLeafSize = 32;
+			// secular equations of at least this many poles are solved in parallel
+			static const unsigned int ParallelSecular = 128;
+			// eigenvalues closer than this times the norm of the tridiagonal matrix share a cluster of inverse iteration
+			static constexpr double ClusterGap = 1e-3;
+			static const unsigned int InverseIterations = 3;
+
+			// --- constructors
+			// all eigenvalues, and the eigenvectors when computeVectors is set
+			explicit SymmetricEigen(const Dense<T>& matrix, bool computeVectors = true, unsigned int nThreads = 0);
+
+			// eigenpairs first..last, counted from the smallest eigenvalue
+			static SymmetricEigen ByIndex(const Dense<T>& matrix, unsigned int first, unsigned int last,
+				bool computeVectors = true, unsigned int nThreads = 0);
+			// eigenpairs with eigenvalues in (lower, upper]
+			static SymmetricEigen ByValue(const Dense<T>& matrix, T lower, T upper,
+				bool computeVectors = true, unsigned int nThreads = 0);
+
+			// reduction alone - on return the diagonal and off diagonal of the tridiagonal matrix Q'*A*Q,
+			// and the reflectors of Q in matrix, reflector i stored in row i from column i + 2 with an implicit 1 at i + 1
+			static void Tridiagonalize(Dense<T>& matrix, vector<T>& tau, vector<T>& diagonal, vector<T>& offDiagonal,
+				unsigned int nThreads = 0);
+
+			unsigned int Count() const { return static_cast<unsigned int>(values.size()); }
+			const vector<T>& Values() const { return values; }
+			// empty unless the vectors were computed
+			const Dense<T>& Vectors() const { return vectors; }
+
+			// --- statistics
+			double ReductionSeconds() const { return reductionSeconds; }
+			double SolveSeconds() const { return solveSeconds; }
+			double BackTransformSeconds() const { return backTransformSeconds; }
+		};
+	}
+}
+
+#endif // !_SYMMETRIC_EIGEN_H_
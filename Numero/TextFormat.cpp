@@ -0,0 +1,182 @@
+#ifndef _TEXT_FORMAT_CPP_
+#define _TEXT_FORMAT_CPP_
+
+#include <assert.h>
+#include <charconv>
+#include <cmath>
+#include <limits>
+#include <type_traits>
+#include "TextFormat.h"
+
+using namespace Numero;
+using namespace Numero::DataTypes;
+
+#pragma region VALUES
+template <class T>
+char* TextFormat::FormatValue(char* first, char* last, T value)
+{
+	if constexpr (is_same<T, bool>::value)
+	{
+		*first = value ? '1' : '0';
+		return first + 1;
+	}
+	else if constexpr (is_integral<T>::value)
+	{
+		// characters are numbers here, not letters
+		typedef typename conditional<is_signed<T>::value, long long, unsigned long long>::type Wide;
+		return to_chars(first, last, static_cast<Wide>(value)).ptr;
+	}
+	else
+	{
+		// the shortest text that reads back to value
+		return to_chars(first, last, value).ptr;
+	}
+}
+
+// floating point values through from_chars, integral ones as integers unless they are written with a fraction or exponent
+// integral values outside the range of T are rejected like malformed ones rather than narrowed
+template <class T>
+bool TextFormat::ParseValue(const char*& text, const char* end, T& value)
+{
+	if (text < end && *text == '+')
+		text++;
+
+	if constexpr (is_floating_point<T>::value)
+	{
+		from_chars_result parsed = from_chars(text, end, value);
+		if (parsed.ec != errc())
+			return false;
+		text = parsed.ptr;
+	}
+	else
+	{
+		typedef typename conditional<is_signed<T>::value, long long, unsigned long long>::type Wide;
+		Wide integer;
+		from_chars_result parsed = from_chars(text, end, integer);
+		if (parsed.ec == errc() && (parsed.ptr == end || (*parsed.ptr != '.' && *parsed.ptr != 'e' && *parsed.ptr != 'E')))
+		{
+			if (integer < static_cast<Wide>(numeric_limits<T>::min()) || integer > static_cast<Wide>(numeric_limits<T>::max()))
+				return false;
+			value = static_cast<T>(integer);
+			text = parsed.ptr;
+			return true;
+		}
+
+		// the fraction is dropped, the range of T is [min, 2^digits) - NaN fails both comparisons
+		double real;
+		parsed = from_chars(text, end, real);
+		if (parsed.ec != errc())
+			return false;
+		real = trunc(real);
+		if (!(real >= static_cast<double>(numeric_limits<T>::min()) && real < ldexp(1.0, numeric_limits<T>::digits)))
+			return false;
+		value = static_cast<T>(real);
+		text = parsed.ptr;
+	}
+	return true;
+}
+#pragma endregion
+
+
+#pragma region MATRICES
+template <class T, class At, class Sink>
+void TextFormat::FormatMatrix(unsigned int rows, unsigned int cols, At at, char* buffer, size_t size, Sink&& sink)
+{
+	assert(size >= MaxValueChars);
+
+	char* p = buffer;
+	char* end = buffer + size;
+	*p++ = '[';
+
+	if (rows == 0 || cols == 0)
+		*p++ = ']';
+
+	for (unsigned int row(0); row < rows; row++)
+	{
+		for (unsigned int col(0); col < cols; col++)
+		{
+			if (static_cast<size_t>(end - p) < MaxValueChars)
+			{
+				sink(static_cast<const char*>(buffer), static_cast<size_t>(p - buffer));
+				p = buffer;
+			}
+
+			p = FormatValue<T>(p, end, at(row, col));
+			if (col != cols - 1)
+				*p++ = ',';
+		}
+
+		*p++ = (row != rows - 1) ? ';' : ']';
+		if (row != rows - 1)
+			*p++ = '\n';
+	}
+
+	*p++ = '\n';
+	sink(static_cast<const char*>(buffer), static_cast<size_t>(p - buffer));
+}
+
+template <class T>
+bool TextFormat::ParseMatrix(const char* text, size_t length, vector<T>& values, unsigned int& rows, unsigned int& cols)
+{
+	const char* p = text;
+	const char* end = text + length;
+	auto skipSpace = [&]()
+	{
+		while (p < end && (*p == ' ' || *p == '\t' || *p == '\n' || *p == '\r'))
+			p++;
+	};
+
+	values.clear();
+	rows = 0;
+	cols = 0;
+
+	skipSpace();
+	if (p == end || *p++ != '[')
+		return false;
+	skipSpace();
+
+	if (p < end && *p == ']')
+	{
+		p++;
+		skipSpace();
+		return p == end;
+	}
+
+	size_t rowStart = 0;
+	while (true)
+	{
+		T value;
+		skipSpace();
+		if (!ParseValue(p, end, value))
+			return false;
+		values.push_back(value);
+		skipSpace();
+
+		if (p == end)
+			return false;
+
+		char separator = *p++;
+		if (separator == ',')
+			continue;
+		if (separator != ';' && separator != ']')
+			return false;
+
+		// a row ends - the first one sets the column count
+		size_t rowLength = values.size() - rowStart;
+		if (rows == 0)
+			cols = static_cast<unsigned int>(rowLength);
+		else if (rowLength != cols)
+			return false;
+		rows++;
+		rowStart = values.size();
+
+		if (separator == ']')
+			break;
+	}
+
+	skipSpace();
+	return p == end;
+}
+#pragma endregion
+
+#endif // !_TEXT_FORMAT_CPP_
@@ -0,0 +1,49 @@
+#ifndef _TEXT_FORMAT_H_
+#define _TEXT_FORMAT_H_
+
+#include "../Numero.Definitions/DataTypeDefines.h"
+#include <vector>
+#include <cstddef>
+
+namespace Numero
+{
+	using namespace std;
+	using namespace Definitions;
+
+	namespace DataTypes
+	{
+		// TextFormat class
+		// number formatting and parsing of the text interfaces, through to_chars and from_chars - no locale,
+		// no stream state and no allocation. floating point values are written in the shortest form that
+		// reads back to the same value, so a formatted matrix parses to the identical one
+		// the matrix syntax is the MATLAB style of ToString - "[a,b;" newline "c,d]" newline
+		class TextFormat
+		{
+		public:
+			// room for any one value with its separator and a line end
+			static const size_t MaxValueChars = 48;
+			// buffer of ToString and of formatting into a stream
+			static const size_t ChunkSize = 1 << 16;
+
+			// writes value at first and returns the end of it - [first, last) must hold MaxValueChars
+			template <class T>
+			static char* FormatValue(char* first, char* last, T value);
+			// parses one value at text and moves text past it, a leading + is accepted
+			// integral types also take a real written with a fraction or exponent, converted like a cast
+			template <class T>
+			static bool ParseValue(const char*& text, const char* end, T& value);
+
+			// formats rows x cols elements, at(row, col) called in row-major order, through buffer of size bytes
+			// (at least MaxValueChars) - sink(data, length) receives every filled chunk, the last one included
+			template <class T, class At, class Sink>
+			static void FormatMatrix(unsigned int rows, unsigned int cols, At at, char* buffer, size_t size, Sink&& sink);
+
+			// the elements of "[a,b;c,d]" in row-major order - white space is allowed around every token,
+			// every row must have the same length and "[]" is the empty matrix. false on any other text
+			template <class T>
+			static bool ParseMatrix(const char* text, size_t length, vector<T>& values, unsigned int& rows, unsigned int& cols);
+		};
+	}
+}
+
+#endif // !_TEXT_FORMAT_H_
@@ -0,0 +1,142 @@
+#include <algorithm>
+#include "ThreadPool.h"
+
+using namespace Numero;
+using namespace Numero::DataTypes;
+
+thread_local bool ThreadPool::insideTask = false;
+
+#pragma region CONSTRUCTION
+ThreadPool::ThreadPool(unsigned int nThreads)
+	: taskBody(nullptr), taskInvoker(nullptr), taskCount(0), nextIndex(0),
+	helperSlots(0), activeHelpers(0), generation(0), stopping(false)
+{
+	if (nThreads == 0)
+	{
+		nThreads = thread::hardware_concurrency();
+		if (nThreads == 0)
+			nThreads = 1;
+	}
+
+	workers.reserve(nThreads - 1);
+	for (unsigned int i(1); i < nThreads; i++)
+	{
+		workers.emplace_back(&ThreadPool::WorkerLoop, this);
+	}
+}
+
+ThreadPool::~ThreadPool()
+{
+	{
+		lock_guard<mutex> lock(stateMutex);
+		stopping = true;
+	}
+	wakeCondition.notify_all();
+
+	for (unsigned int i(0); i < workers.size(); i++)
+	{
+		workers[i].join();
+	}
+}
+
+ThreadPool& ThreadPool::Global()
+{
+	static ThreadPool pool;
+	return pool;
+}
+
+unsigned int ThreadPool::ThreadCount() const
+{
+	return static_cast<unsigned int>(workers.size()) + 1;
+}
+#pragma endregion
+
+
+#pragma region TASK_EXECUTION
+// publishes a task, works on it from the calling thread and waits for all helpers to leave
+void ThreadPool::Run(unsigned int count, const void* body, TaskInvoker invoker, unsigned int nThreads)
+{
+	if (count == 0)
+		return;
+
+	unsigned int threads = (nThreads == 0) ? ThreadCount() : min(nThreads, ThreadCount());
+	threads = min(threads, count);
+
+	// serial path - single thread requested, nested call, or another thread owns the pool right now
+	unique_lock<mutex> submitLock(submitMutex, defer_lock);
+	if (threads <= 1 || insideTask || !submitLock.try_lock())
+	{
+		for (unsigned int i(0); i < count; i++)
+		{
+			invoker(body, i);
+		}
+		return;
+	}
+
+	{
+		lock_guard<mutex> lock(stateMutex);
+		taskBody = body;
+		taskInvoker = invoker;
+		taskCount = count;
+		nextIndex.store(0);
+		helperSlots = threads - 1;
+		activeHelpers = 0;
+		generation++;
+	}
+	wakeCondition.notify_all();
+
+	insideTask = true;
+	Drain();
+	insideTask = false;
+
+	// close the task to late joiners, then wait for the helpers already inside
+	unique_lock<mutex> lock(stateMutex);
+	helperSlots = 0;
+	doneCondition.wait(lock, [this] { return activeHelpers == 0; });
+	taskBody = nullptr;
+	taskInvoker = nullptr;
+}
+
+// takes indices from the shared counter until the task is exhausted
+void ThreadPool::Drain()
+{
+	for (;;)
+	{
+		unsigned int index = nextIndex.fetch_add(1);
+		if (index >= taskCount)
+			break;
+
+		taskInvoker(taskBody, index);
+	}
+}
+
+void ThreadPool::WorkerLoop()
+{
+	unique_lock<mutex> lock(stateMutex);
+	unsigned long long seenGeneration = generation;
+
+	for (;;)
+	{
+		wakeCondition.wait(lock, [this, &seenGeneration] { return stopping || generation != seenGeneration; });
+		if (stopping)
+			return;
+
+		seenGeneration = generation;
+		if (helperSlots == 0)
+			continue;
+
+		helperSlots--;
+		activeHelpers++;
+		lock.unlock();
+
+		insideTask = true;
+		Drain();
+		insideTask = false;
+
+		lock.lock();
+		activeHelpers--;
+		if (activeHelpers == 0)
+			doneCondition.notify_all();
+	}
+}
+#pragma endregion
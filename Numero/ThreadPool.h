@@ -0,0 +1,78 @@
+#ifndef _THREAD_POOL_H_
+#define _THREAD_POOL_H_
+
+#include "../Numero.Definitions/DataTypeDefines.h"
+#include <vector>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <atomic>
+
+namespace Numero
+{
+	using namespace std;
+	using namespace Definitions;
+
+	namespace DataTypes
+	{
+		// ThreadPool class
+		// fixed set of worker threads reused by all parallel library operations
+		// the calling thread always takes part in the work, so a pool of N threads owns N-1 workers
+		class ThreadPool
+		{
+		private:
+			typedef void(*TaskInvoker)(const void* body, unsigned int index);
+
+			vector<thread> workers;
+
+			mutex submitMutex;
+			mutex stateMutex;
+			condition_variable wakeCondition;
+			condition_variable doneCondition;
+
+			// current task - valid between publication and the last helper leaving
+			const void* taskBody;
+			TaskInvoker taskInvoker;
+			unsigned int taskCount;
+			atomic<unsigned int> nextIndex;
+			unsigned int helperSlots;
+			unsigned int activeHelpers;
+			unsigned long long generation;
+			bool stopping;
+
+			static thread_local bool insideTask;
+
+			template <class Body>
+			static void Invoke(const void* body, unsigned int index) { (*static_cast<const Body*>(body))(index); }
+
+			void Run(unsigned int count, const void* body, TaskInvoker invoker, unsigned int nThreads);
+			void Drain();
+			void WorkerLoop();
+
+		public:
+			// --- constructors / destructor
+			explicit ThreadPool(unsigned int nThreads = 0);
+			~ThreadPool();
+
+			ThreadPool(const ThreadPool&) = delete;
+			ThreadPool& operator=(const ThreadPool&) = delete;
+
+			// library wide pool, sized from hardware concurrency on first use
+			static ThreadPool& Global();
+
+			// number of threads taking part in a task, including the caller
+			unsigned int ThreadCount() const;
+
+			// calls body(i) for every i in [0, count) using at most nThreads threads (0 - all of them)
+			// indices are handed out dynamically, body must not throw
+			// nested calls from inside a task run serially on the calling thread
+			template <class Body>
+			void ParallelFor(unsigned int count, const Body& body, unsigned int nThreads = 0)
+			{
+				Run(count, &body, &Invoke<Body>, nThreads);
+			}
+		};
+	}
+}
+
+#endif // !_THREAD_POOL_H_
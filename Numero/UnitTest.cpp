@@ -1,10 +1,167 @@
 #include "Dense.cpp"
+#include "Sparse.cpp"
+#include "SparseSell.cpp"
+#include "SparseBlock.cpp"
+#include "Krylov.cpp"
+#include "SparseCholesky.cpp"
+#include "MatrixMarket.cpp"
+#include "BinaryMatrix.cpp"
+#include "QR.cpp"
+#include "SymmetricEigen.cpp"
+#include "SVD.cpp"
 #include <iostream>
-#include <ctime>
+#include <cmath>
+#include <cstdlib>
+#include <new>
+#include <atomic>
+#include <algorithm>
 
 using namespace std;
 using namespace Numero::DataTypes;
 
+// global allocation counters, used to check that warmed up *Into loops do not allocate
+static atomic<size_t> allocationCount(0);
+static atomic<size_t> allocatedBytes(0);
+
+void* operator new(size_t size)
+{
+	allocationCount++;
+	allocatedBytes += size;
+
+	void* memory = malloc(size ? size : 1);
+	if (memory == nullptr)
+		throw bad_alloc();
+	return memory;
+}
+
+void* operator new[](size_t size)
+{
+	return operator new(size);
+}
+
+// kept out of line so that GCC does not pair the inlined free() with operator new and warn
+#if defined(__GNUC__)
+__attribute__((noinline))
+#endif
+void operator delete(void* memory) noexcept
+{
+	free(memory);
+}
+
+void operator delete[](void* memory) noexcept
+{
+	operator delete(memory);
+}
+
+void operator delete(void* memory, size_t) noexcept
+{
+	operator delete(memory);
+}
+
+void operator delete[](void* memory, size_t) noexcept
+{
+	operator delete(memory);
+}
+
+// runs every element-wise kernel of type T at every supported instruction set level
+// and checks the results against the scalar level
+template <class T>
+void TestSimdKernels(const char* typeName, unsigned int size)
+{
+	Dense<T> a(size, size);
+	Dense<T> b(size, size);
+	for (unsigned int i(0); i < a.Numel(); i++)
+	{
+		a.Data()[i] = static_cast<T>((i % 17) * 0.37 - 2);
+		b.Data()[i] = static_cast<T>((i % 11) * 1.13 + 1);
+	}
+
+	Dense<T> reference[5];
+	Dense<T> out;
+	SimdLevel detected = Simd::Detected();
+
+	for (int level(0); level <= static_cast<int>(detected); level++)
+	{
+		SimdLevel active = Simd::SetActive(static_cast<SimdLevel>(level));
+		bool identical = true;
+
+		for (unsigned int kernel(0); kernel < 5; kernel++)
+		{
+			switch (kernel)
+			{
+			case 0: out.Resize(size, size); out.ResetToConstant(static_cast<T>(3)); break;
+			case 1: a.CopyAddScalarInto(static_cast<T>(3), out); break;
+			case 2: a.CopyMulScalarInto(static_cast<T>(3), out); break;
+			case 3: a.CopyAddMatrixInto(b, out); break;
+			case 4: a.MulElementwiseInto(b, out); break;
+			}
+
+			if (level == 0)
+				reference[kernel] = out;
+			else
+				identical = identical && equal(out.Data(), out.Data() + out.Numel(), reference[kernel].Data());
+		}
+		if (level != 0)
+			cout << typeName << " " << Simd::LevelName(active) << (identical ? " identical to scalar" : " DIFFERS from scalar") << endl;
+	}
+
+	Simd::SetActive(detected);
+}
+
+// |b - A*x| / |b| computed directly, independent of the residual the solver reports
+template <class Operator>
+double RelativeResidual(const Operator& a, const Dense<double>& b, const Dense<double>& x)
+{
+	Dense<double> ax(b.Rows(), 1);
+	a.MulVectorInto(x.Data(), ax.Data());
+	double residual = 0, norm = 0;
+	for (unsigned int i(0); i < b.Rows(); i++)
+	{
+		residual += (b.Data()[i] - ax.Data()[i]) * (b.Data()[i] - ax.Data()[i]);
+		norm += b.Data()[i] * b.Data()[i];
+	}
+	return sqrt(residual / norm);
+}
+
+// 5-point Laplacian on a side x side grid, plus a first order upwind convection term when convection is not zero
+Sparse<double> GridMatrix(unsigned int side, double convection)
+{
+	vector<SparseValueTriplet<double> > triplets;
+	for (unsigned int i(0); i < side; i++)
+	{
+		for (unsigned int j(0); j < side; j++)
+		{
+			unsigned int row = i * side + j;
+			triplets.push_back(SparseValueTriplet<double>(row, row, 4 + convection));
+			if (i > 0) triplets.push_back(SparseValueTriplet<double>(row, row - side, -1 - convection));
+			if (i + 1 < side) triplets.push_back(SparseValueTriplet<double>(row, row + side, -1));
+			if (j > 0) triplets.push_back(SparseValueTriplet<double>(row, row - 1, -1));
+			if (j + 1 < side) triplets.push_back(SparseValueTriplet<double>(row, row + 1, -1));
+		}
+	}
+	return Sparse<double>(side * side, side * side, triplets);
+}
+
+// selection hook of the mixed operator test - selections with fields out of range are counted apart
+static unsigned int mixedSelections = 0;
+static unsigned int malformedSelections = 0;
+// largest element-wise difference of two matrices of the same shape
+double MaxDifference(const Dense<double>& a, const Dense<double>& b)
+{
+	double difference = 0;
+	for (unsigned int i(0); i < a.Numel(); i++)
+		difference = max(difference, abs(a.Data()[i] - b.Data()[i]));
+	return difference;
+}
+
+static void CountSelection(const MixedSelection& selection)
+{
+	mixedSelections++;
+	if (selection.operation == nullptr || selection.rows == 0 || selection.cols == 0
+		|| selection.density < 0 || selection.density > 1)
+		malformedSelections++;
+}
+
 int main()
 {
 	// define and initialize matrix
@@ -41,16 +198,18 @@ int main()
 	toInverse(2, 2, 1);
 
 	cout << "matrix to inverse:" << endl << toInverse.ToString();
-	Dense<float> inv(3, 3);
-	clock_t begin = clock();
-	for (int i(0); i < 1000; i++)
-	{
-		inv = toInverse.InverseByMinors();
-	}
-	clock_t end = clock();
-	double elapsed_secs = double(end - begin) / CLOCKS_PER_SEC;
+	Dense<float> inv = toInverse.InverseByMinors();
 	cout << inv.ToString();
-	cout << "time to inverse: " << elapsed_secs << endl;
+
+	// same inverse on the fixed-size type
+	Dense<float, 3, 3> fixedToInverse(toInverse);
+	cout << "fixed-size inverse:" << endl << fixedToInverse.Inverse().ToString();
+
+	// fixed-size determinant, inverse and transpose are usable at compile time
+	constexpr Dense<double, 2, 2> constantMatrix(4.0, 7.0, 2.0, 6.0);
+	static_assert(constantMatrix.Determinant() == 10.0, "constexpr determinant");
+	static_assert((constantMatrix * constantMatrix.Inverse()).Trace() == 2.0, "constexpr inverse");
+	static_assert(constantMatrix.Transpose().At(0, 1) == 2.0, "constexpr transpose");
 
 	// define another matrix
 	Dense<int> another3x4(3, 4);
@@ -78,29 +237,40 @@ int main()
 	a.ResetToConstant(17);
 	b.ResetToConstant(50);
 
-	int cyclesComparison = 10000;
-
-	begin = clock();
-	for (int i(0); i < cyclesComparison; i++)
-	{
-		Dense<int> mult = a.MulNaive(b);
-	}
-	end = clock();
-	elapsed_secs = double(end - begin);
-	cout << "using naive multiplication: " << elapsed_secs << endl;
-
-	begin = clock();
-	for (int i(0); i < cyclesComparison; i++)
-	{
-		Dense<int> mult = a.MulTransposed(b);
-	}
-	end = clock();
-	elapsed_secs = double(end - begin);
-	cout << "using transposed multiplication: " << elapsed_secs << endl;
+	// naive, transposed and fixed-size products must agree
+	a(0, 0, 3);
+	Dense<int> naiveMult = a.MulNaive(b);
+	Dense<int> transposedMult = a.MulTransposed(b);
+	Dense<int, 2, 2> fixedA(a);
+	Dense<int, 2, 2> fixedB(b);
+	Dense<int, 2, 2> fixedMult = fixedA * fixedB;
+	int productDifference = 0;
+	for (int i(0); i < aSize; i++)
+		for (int j(0); j < aSize; j++)
+			productDifference += abs(naiveMult(i, j) - transposedMult(i, j)) + abs(naiveMult(i, j) - fixedMult(i, j));
+	cout << "naive vs transposed vs fixed-size 2x2 products, difference (should be 0): " << productDifference << endl;
+	cout << "fixed-size product converted to a dynamic matrix:" << endl << Dense<int>(fixedA * fixedB).ToString();
 
 	cout << "multiplication of the two above matrices:" << endl;
 	//cout << mult.ToString();
 
+	// test blocked multiplication against the naive product
+	Dense<double> gemmA(37, 53);
+	Dense<double> gemmB(53, 29);
+	for (unsigned int i(0); i < 37; i++)
+		for (unsigned int j(0); j < 53; j++)
+			gemmA(i, j, (double)((i * 7 + j * 3) % 11) - 5);
+	for (unsigned int i(0); i < 53; i++)
+		for (unsigned int j(0); j < 29; j++)
+			gemmB(i, j, (double)((i * 5 + j * 2) % 13) - 6);
+	Dense<double> gemmNaive = gemmA.MulNaive(gemmB);
+	Dense<double> gemmBlocked = gemmA * gemmB;
+	double gemmMaxDiff = 0;
+	for (unsigned int i(0); i < 37; i++)
+		for (unsigned int j(0); j < 29; j++)
+			gemmMaxDiff = max(gemmMaxDiff, abs(gemmNaive(i, j) - gemmBlocked(i, j)));
+	cout << "blocked vs naive multiplication max difference (should be 0): " << gemmMaxDiff << endl;
+
 	// test operator overload for multiplying by scalar
 	Dense<int> mulBy10 = simple3x3 * 10;
 	cout << "Matrix: " << endl << simple3x3.ToString();
@@ -156,6 +326,60 @@ int main()
 	d.AddMatrix(e);
 	cout << "sum of a+b in a:" << endl << d.ToString();
 
+	// test fused element-wise expressions
+	Dense<int> fused = d + e * 2 - 1;
+	cout << "fused d + e*2 - 1:" << endl << fused.ToString();
+	Dense<int> productPlus = simple3x3 * simple3x3 + simple3x3;
+	cout << "product inside an expression (A*A + A):" << endl << productPlus.ToString();
+
+	// test zero-copy views
+	DenseView<int> subView = simple3x3.SubMatrixView(1, 2, 1, 2);
+	cout << "sub matrix view of rows and columns 2 and 3:" << endl << subView.ToString();
+	cout << "trace of sub matrix view: " << subView.Trace() << endl;
+	cout << "transpose view:" << endl << simple3x3.TransposeView().ToString();
+	cout << "diagonal view:" << endl << simple3x3.DiagonalView().ToString();
+	cout << "materialized transpose view of sub matrix view:" << endl << subView.Transpose().Materialize().ToString();
+	Dense<int> viewSum = simple3x3.TransposeView() + simple3x3;
+	cout << "A' + A through a view:" << endl << viewSum.ToString();
+
+	// assigning an expression that reads the destination through a moving view must not corrupt it
+	Dense<int> aliased(simple3x3);
+	aliased = aliased.TransposeView() + simple3x3;
+	bool aliasedCorrect = true;
+	for (unsigned int row(0); row < 3; row++)
+		for (unsigned int col(0); col < 3; col++)
+			aliasedCorrect = aliasedCorrect && (aliased(row, col) == viewSum(row, col));
+	cout << "A = A' + A evaluated correctly: " << (aliasedCorrect ? "yes" : "no") << endl;
+
+	// products with transposed views go to the Gemm engine without copying the operand
+	Dense<double> viewA(300, 200);
+	Dense<double> viewB(300, 100);
+	for (unsigned int i(0); i < viewA.Numel(); i++)
+		viewA.Data()[i] = (i % 13) * 0.25 - 1;
+	for (unsigned int i(0); i < viewB.Numel(); i++)
+		viewB.Data()[i] = (i % 7) * 0.5 - 1.5;
+	Dense<double> viewProduct = viewA.TransposeView() * viewB;
+	Dense<double> copyProduct = viewA.Transpose() * viewB;
+	double viewError = 0;
+	for (unsigned int i(0); i < viewProduct.Numel(); i++)
+		viewError = max(viewError, abs(viewProduct.Data()[i] - copyProduct.Data()[i]));
+	cout << "A'*B through views vs Transpose()*B, max error: " << viewError << endl;
+
+	Dense<double> blockProduct = viewA.SubMatrixView(10, 109, 20, 69) * viewB.SubMatrixView(0, 49, 5, 54).Transpose().Transpose();
+	Dense<double> blockCopy = viewA.SubMatrix(10, 109, 20, 69) * viewB.SubMatrix(0, 49, 5, 54);
+	double blockError = 0;
+	for (unsigned int i(0); i < blockProduct.Numel(); i++)
+		blockError = max(blockError, abs(blockProduct.Data()[i] - blockCopy.Data()[i]));
+	cout << "sub matrix view product vs SubMatrix() product, max error: " << blockError << endl;
+
+	// test the element-wise kernels of every instruction set level
+	// the odd size leaves a scalar tail after the vector loops
+	cout << "detected instruction set: " << Simd::LevelName(Simd::Detected()) << endl;
+	TestSimdKernels<float>("float", 1023);
+	TestSimdKernels<double>("double", 1023);
+	TestSimdKernels<int>("int", 1023);
+	TestSimdKernels<float>("float (small)", 63);
+
 	// test trace function
 	int trace = simple3x3.Trace();
 	cout << "trace: " << trace << endl;
@@ -211,6 +435,110 @@ int main()
 	cout << simple5x5.ToString();
 	cout << "determinant (should be 24): " << simple5x5.Determinant() << endl;
 
+	// test LU factorization
+	Dense<double> luMatrix(5, 5);
+	for (unsigned int i(0); i < 5; i++)
+		for (unsigned int j(0); j < 5; j++)
+			luMatrix(i, j, (i == j) ? 4.0 : 1.0 / (1.0 + i + j));
+	luMatrix(0, 0, 0.0);
+	LU<double> lu(luMatrix);
+	Dense<double> luRhs(5, 2);
+	luRhs.ResetToConstant(1);
+	Dense<double> luSolution = lu.Solve(luRhs);
+	Dense<double> luResidual = luMatrix.MulNaive(luSolution);
+	double luMaxResidual = 0;
+	for (unsigned int i(0); i < 5; i++)
+		for (unsigned int j(0); j < 2; j++)
+			luMaxResidual = max(luMaxResidual, abs(luResidual(i, j) - 1.0));
+	cout << "LU solve max residual (should be ~0): " << luMaxResidual << endl;
+	cout << "LU determinant: " << lu.Determinant() << endl;
+	cout << "determinant through Dense (should be the same): " << luMatrix.Determinant() << endl;
+
+	// test cofactor vs LU determinant
+	unsigned int detSizes[] = { 3, 6, 9 };
+	for (unsigned int detSize : detSizes)
+	{
+		Dense<double> detMatrix(detSize, detSize);
+		for (unsigned int i(0); i < detSize; i++)
+			for (unsigned int j(0); j < detSize; j++)
+				detMatrix(i, j, (i == j) ? 2.0 : 1.0 / (1.0 + i + j));
+
+		double luDet = LU<double>(detMatrix).Determinant();
+		double cofactorDet = detMatrix.DeterminantByCofactors();
+		cout << "determinant of " << detSize << "x" << detSize << " - LU vs cofactors relative difference: "
+			<< abs(luDet - cofactorDet) / abs(cofactorDet) << endl;
+	}
+
+	// test Bareiss elimination - exact against cofactors on small integer matrices, a zero leading pivot,
+	// overflow detection on a lower triangular matrix with a huge determinant, and the same matrices modulo a prime
+	typedef ModularInteger<2147483629> Modular;
+	unsigned int bareissSeed = 777;
+	auto nextEntry = [&](int range) {
+		bareissSeed = bareissSeed * 1664525 + 1013904223;
+		return static_cast<int>((bareissSeed >> 8) % (2 * range + 1)) - range;
+	};
+	bool bareissExact = true;
+	for (unsigned int detSize(4); detSize <= 8; detSize++)
+	{
+		Dense<int> detMatrix(detSize, detSize);
+		for (unsigned int i(0); i < detMatrix.Numel(); i++)
+			detMatrix.Data()[i] = nextEntry(9);
+		if (detSize == 6)
+			detMatrix(0, 0, 0);
+		int cofactorDet = detMatrix.DeterminantByCofactors();
+		bareissExact = bareissExact && (detMatrix.Determinant() == cofactorDet)
+			&& (Bareiss<int, Modular>(detMatrix).Determinant() == Modular(cofactorDet));
+	}
+	Dense<int> permutation(5, 5);
+	for (unsigned int i(0); i < 5; i++)
+		permutation(i, (i + 2) % 5, 1);
+
+	unsigned int triangularSize = 40;
+	Dense<int> triangular(triangularSize, triangularSize);
+	Modular diagonalProduct(1);
+	for (unsigned int i(0); i < triangularSize; i++)
+	{
+		for (unsigned int j(0); j < i; j++)
+			triangular(i, j, nextEntry(50));
+		triangular(i, i, 1000 + i);
+		diagonalProduct = diagonalProduct * Modular(1000 + i);
+	}
+	Bareiss<int> wideTriangular(triangular);
+	Bareiss<int, Modular> modularTriangular(triangular);
+
+	Dense<int> largeMatrix(300, 300);
+	for (unsigned int i(0); i < largeMatrix.Numel(); i++)
+		largeMatrix.Data()[i] = nextEntry(1000);
+	bool modularIdentical = (Bareiss<int, Modular>(largeMatrix, 1).Determinant() == Bareiss<int, Modular>(largeMatrix).Determinant());
+
+	// minors beyond 64 bits with a determinant that fits - U*L of unit triangular factors, and unsigned elements
+	// above LLONG_MAX, both left to the elimination modulo 2^bits
+	unsigned int unimodularSize = 20;
+	Dense<int> upper(unimodularSize, unimodularSize);
+	Dense<int> lower(unimodularSize, unimodularSize);
+	for (unsigned int i(0); i < unimodularSize; i++)
+	{
+		upper(i, i, 1);
+		lower(i, i, 1);
+		for (unsigned int j(i + 1); j < unimodularSize; j++)
+		{
+			upper(i, j, nextEntry(3));
+			lower(j, i, nextEntry(3));
+		}
+	}
+	Dense<int> unimodular = upper * lower;
+	Dense<unsigned long long> wrapping(4, 4);
+	for (unsigned int i(0); i < wrapping.Numel(); i++)
+		wrapping.Data()[i] = static_cast<unsigned long long>(nextEntry(1000)) * 0x9E3779B97F4A7C15ull;
+	bool wrappingExact = Bareiss<int>(unimodular).Overflow() && unimodular.Determinant() == 1
+		&& Bareiss<unsigned long long>(wrapping).Overflow() && wrapping.Determinant() == wrapping.DeterminantByCofactors();
+
+	cout << "Bareiss determinant matches cofactors and modular: " << (bareissExact ? "yes" : "no") << ", 5x5 cyclic permutation (should be 1): "
+		<< permutation.Determinant() << ", 40x40 overflow detected: " << (wideTriangular.Overflow() ? "yes" : "no")
+		<< ", modular matches diagonal product: " << ((modularTriangular.Determinant() == diagonalProduct && !modularTriangular.Overflow()) ? "yes" : "no")
+		<< ", 300x300 modular parallel identical to serial: " << (modularIdentical ? "yes" : "no")
+		<< ", overflowing minors exact modulo 2^bits: " << (wrappingExact ? "yes" : "no") << endl;
+
 	// test diagonal function
 	cout << "matrix:" << endl;
 	cout << simple5x5.ToString();
@@ -252,6 +580,71 @@ int main()
 	cout << "horizontal concatenation of normal and transposed matrix:" << endl;
 	cout << horConcat.ToString();
 
+	// test move construction and assignment
+	Dense<int> moveSource = simple3x3;
+	Dense<int> moveTarget(std::move(moveSource));
+	cout << "moved matrix:" << endl << moveTarget.ToString();
+	cout << "moved-from matrix size (should be 0): " << moveSource.Numel() << endl;
+	moveSource = std::move(moveTarget);
+	cout << "moved back:" << endl << moveSource.ToString();
+
+	// test that a warmed up loop of *Into calls does not allocate - neither through operator new nor from the
+	// aligned pool, which serves the Dense storage without operator new
+	Dense<double> loopA(64, 64);
+	Dense<double> loopB(64, 64);
+	Dense<double> loopSum, loopScaled, loopProduct, loopTransposed, loopSub, loopConcat, loopMinor;
+	loopA.ResetToConstant(1);
+	loopB.ResetToConstant(0.5);
+	for (unsigned int pass(0); pass < 2; pass++)
+	{
+		size_t bytesBefore = allocatedBytes;
+		size_t countBefore = allocationCount;
+		AlignedAllocator::ResetStats();
+
+		for (unsigned int i(0); i < 10; i++)
+		{
+			loopA.CopyAddMatrixInto(loopB, loopSum);
+			loopSum.CopyMulScalarInto(0.5, loopScaled);
+			loopScaled.MulInto(loopB, loopProduct);
+			loopProduct.TransposeInto(loopTransposed);
+			loopTransposed.SubMatrixInto(0, 31, 0, 31, loopSub);
+			loopSub.MinorInto(0, 0, loopMinor);
+			loopA.ConcatRowsInto(loopB, loopConcat);
+			loopA = loopProduct;
+		}
+
+		// the first pass sizes the buffers, the second one must not allocate
+		if (pass == 1)
+		{
+			AllocatorStats loopStats = AlignedAllocator::Stats();
+			cout << "allocations in steady state (should be 0): " << allocationCount - countBefore
+				<< ", bytes: " << allocatedBytes - bytesBefore
+				<< ", aligned pool requests (should be 0): " << loopStats.hits + loopStats.misses << endl;
+		}
+	}
+
+	// test that temporaries are recycled by the aligned pool once their shapes have been seen
+	cout << "storage alignment (should be 0): " << reinterpret_cast<size_t>(loopA.Data()) % AlignedAllocator::Alignment << endl;
+	for (unsigned int pass(0); pass < 2; pass++)
+	{
+		AlignedAllocator::ResetStats();
+
+		for (unsigned int i(0); i < 100; i++)
+		{
+			Dense<double> transposed = loopA.Transpose();
+			Dense<double> scaled = transposed.CopyMulScalar(2.0);
+			Dense<double> summed = scaled.CopyAddMatrix(loopB);
+			Dense<double> zeros(64, 64);
+		}
+
+		AllocatorStats stats = AlignedAllocator::Stats();
+		if (pass == 1)
+		{
+			cout << "pool in steady state - hits: " << stats.hits << ", misses (should be 0): " << stats.misses
+				<< ", bytes live: " << stats.bytesLive << ", bytes cached: " << stats.bytesCached << endl;
+		}
+	}
+
 	// test submatrix function
 	Dense<int> sub = simple3x3.SubMatrix(0, 1, 0, 1);
 	cout << "sub matrix of rows and columns 1 and 2:" << endl;
@@ -293,6 +686,691 @@ int main()
 	cout << "column 1 multiplied by 2:" << endl;
 	cout << simple3x3.ToString();
 
+	// test sparse assembly from triplets - duplicates of a position are summed
+	vector<SparseValueTriplet<int> > smallTriplets;
+	smallTriplets.push_back(SparseValueTriplet<int>(2, 3, 4));
+	smallTriplets.push_back(SparseValueTriplet<int>(0, 0, 1));
+	smallTriplets.push_back(SparseValueTriplet<int>(2, 3, 5));
+	smallTriplets.push_back(SparseValueTriplet<int>(1, 4, 7));
+	smallTriplets.push_back(SparseValueTriplet<int>(0, 2, 2));
+	Sparse<int> smallSparse(4, 5, smallTriplets);
+	cout << "sparse matrix assembled from 5 triplets, (3,4) given twice:" << endl << smallSparse.ToString();
+	cout << "non zeros (should be 4): " << smallSparse.NonZeros() << ", element (3,4) (should be 9): " << smallSparse(2, 3) << endl;
+
+	// test sparse SetValue on existing and missing positions
+	smallSparse(3, 1, 6);
+	smallSparse(0, 2, 3);
+	cout << "after setting (4,2) to 6 and (1,3) to 3:" << endl << smallSparse.ToString();
+
+	// test parallel assembly against the serial one and a reference accumulation
+	unsigned int assemblySize = 3000;
+	vector<SparseValueTriplet<int> > largeTriplets;
+	Dense<int> reference(assemblySize, assemblySize);
+	unsigned int seed = 12345;
+	for (unsigned int i(0); i < 200000; i++)
+	{
+		seed = seed * 1664525 + 1013904223;
+		unsigned int row = (seed >> 8) % assemblySize;
+		seed = seed * 1664525 + 1013904223;
+		unsigned int col = (seed >> 8) % assemblySize;
+		int value = static_cast<int>(i % 7) - 3;
+		largeTriplets.push_back(SparseValueTriplet<int>(row, col, value));
+		reference(row, col, reference(row, col) + value);
+	}
+	Sparse<int> serialSparse(assemblySize, assemblySize, largeTriplets, 1);
+	Sparse<int> parallelSparse(assemblySize, assemblySize, largeTriplets);
+	bool assemblyIdentical = (serialSparse.NonZeros() == parallelSparse.NonZeros())
+		&& equal(serialSparse.RowOffsets(), serialSparse.RowOffsets() + assemblySize + 1, parallelSparse.RowOffsets())
+		&& equal(serialSparse.ColumnIndices(), serialSparse.ColumnIndices() + serialSparse.NonZeros(), parallelSparse.ColumnIndices())
+		&& equal(serialSparse.Values(), serialSparse.Values() + serialSparse.NonZeros(), parallelSparse.Values());
+	bool assemblyCorrect = true;
+	for (unsigned int row(0); row < assemblySize; row++)
+		for (unsigned int col(0); col < assemblySize; col++)
+			assemblyCorrect = assemblyCorrect && (parallelSparse(row, col) == reference(row, col));
+	cout << "parallel assembly identical to serial: " << (assemblyIdentical ? "yes" : "no")
+		<< ", matches reference: " << (assemblyCorrect ? "yes" : "no") << endl;
+
+	// test buffered inserts - reads see pending entries, a zeroed pending entry is dropped, a serial and a parallel
+	// commit of the same buffer are identical, and later updates commit on their own past the limit
+	Sparse<int> bufferedSparse(parallelSparse);
+	bool pendingReads = true;
+	auto update = [&](unsigned int i)
+	{
+		seed = seed * 1664525 + 1013904223;
+		unsigned int row = (seed >> 8) % assemblySize;
+		seed = seed * 1664525 + 1013904223;
+		unsigned int col = (seed >> 8) % assemblySize;
+		int value = (i % 5 == 0) ? 0 : static_cast<int>(i % 11) - 5;
+		bufferedSparse(row, col, value);
+		reference(row, col, value);
+		pendingReads = pendingReads && (bufferedSparse(row, col) == value);
+	};
+	for (unsigned int i(0); i < 4000; i++)
+		update(i);
+	unsigned int pendingCount = bufferedSparse.PendingNonZeros();
+	Sparse<int> serialCommit(bufferedSparse);
+	serialCommit.Commit(1);
+	bufferedSparse.Commit();
+	bool commitIdentical = (serialCommit.NonZeros() == bufferedSparse.NonZeros()) && (bufferedSparse.PendingNonZeros() == 0)
+		&& equal(serialCommit.RowOffsets(), serialCommit.RowOffsets() + assemblySize + 1, bufferedSparse.RowOffsets())
+		&& equal(serialCommit.ColumnIndices(), serialCommit.ColumnIndices() + serialCommit.NonZeros(), bufferedSparse.ColumnIndices())
+		&& equal(serialCommit.Values(), serialCommit.Values() + serialCommit.NonZeros(), bufferedSparse.Values());
+	for (unsigned int i(4000); i < 400000; i++)
+		update(i);
+	bool bufferedCorrect = true;
+	for (unsigned int row(0); row < assemblySize; row++)
+		for (unsigned int col(0); col < assemblySize; col++)
+			bufferedCorrect = bufferedCorrect && (bufferedSparse(row, col) == reference(row, col));
+	cout << "buffered inserts, " << pendingCount << " pending after 4000 updates, reads before commit correct: " << (pendingReads ? "yes" : "no")
+		<< ", parallel commit identical to serial: " << (commitIdentical ? "yes" : "no") << ", 400000 updates match reference: "
+		<< (bufferedCorrect ? "yes" : "no") << ", still pending: " << bufferedSparse.PendingNonZeros() << endl;
+
+	// test sparse products against the dense ones - rows of 1 to 64 nonzeros cover the plain loop,
+	// the gather kernels and their tails, at every instruction set level
+	unsigned int productSize = 1500;
+	vector<SparseValueTriplet<double> > productTriplets;
+	for (unsigned int row(0); row < productSize; row++)
+	{
+		for (unsigned int i(0); i < 1 + (row * 7) % 64; i++)
+		{
+			seed = seed * 1664525 + 1013904223;
+			productTriplets.push_back(SparseValueTriplet<double>(row, (seed >> 8) % productSize, (seed % 1000) * 0.001 - 0.5));
+		}
+	}
+	Sparse<double> productSparse(productSize, productSize, productTriplets);
+	Dense<double> productDense(productSize, productSize);
+	for (const SparseValueTriplet<double>& triplet : productTriplets)
+		productDense(triplet.Row(), triplet.Col(), productSparse(triplet.Row(), triplet.Col()));
+	Dense<double> productRhs(productSize, 5);
+	for (unsigned int i(0); i < productRhs.Numel(); i++)
+		productRhs.Data()[i] = (i % 17) * 0.125 - 1;
+	Dense<double> productVector = productRhs.SubMatrix(0, productSize - 1, 0, 0);
+	Dense<double> denseProduct = productDense * productRhs;
+	Dense<double> denseVectorProduct = productDense * productVector;
+
+	SimdLevel detectedLevel = Simd::Detected();
+	for (int level(0); level <= static_cast<int>(detectedLevel); level++)
+	{
+		SimdLevel active = Simd::SetActive(static_cast<SimdLevel>(level));
+		Dense<double> sparseVectorProduct;
+		productSparse.MulInto(productVector, sparseVectorProduct);
+		double spmvError = 0;
+		for (unsigned int i(0); i < productSize; i++)
+			spmvError = max(spmvError, abs(sparseVectorProduct.Data()[i] - denseVectorProduct.Data()[i]));
+		cout << "sparse matrix-vector product vs dense, " << Simd::LevelName(active) << " max error: " << spmvError << endl;
+	}
+	Simd::SetActive(detectedLevel);
+
+	// test the SELL-C-sigma and block CSR layouts against CSR - 1500 rows leave a partial slice for C = 16
+	// and the block matrix of 3x3 node blocks leaves partial edge tiles when cut into 4x4 tiles
+	unsigned int nodes = 401;
+	unsigned int blockSize = 3 * nodes;
+	vector<SparseValueTriplet<double> > blockTriplets;
+	for (unsigned int node(0); node < nodes; node++)
+	{
+		unsigned int neighbours[3] = { node, (node + 1) % nodes, (node * 37 + 11) % nodes };
+		for (unsigned int neighbour : neighbours)
+			for (unsigned int i(0); i < 9; i++)
+			{
+				seed = seed * 1664525 + 1013904223;
+				blockTriplets.push_back(SparseValueTriplet<double>(3 * node + i / 3, 3 * neighbour + i % 3, (seed % 1000) * 0.001 - 0.5));
+			}
+	}
+	Sparse<double> blockSparse(blockSize, blockSize, blockTriplets);
+	Dense<double> blockVector(blockSize, 1);
+	for (unsigned int i(0); i < blockSize; i++)
+		blockVector.Data()[i] = (i % 13) * 0.25 - 1.5;
+	Dense<double> productReference = productSparse * productVector;
+	Dense<double> blockReference = blockSparse * blockVector;
+
+	SparseSell<double> sell(productSparse, 16, 128);
+	SparseBlock<double> blockExact(blockSparse, 3, 3);
+	SparseBlock<double> blockEdge(blockSparse, 4, 4);
+	cout << "SELL-16-128 stores " << sell.StoredEntries() << " entries for " << sell.NonZeros() << " non zeros, "
+		<< "3x3 block CSR " << blockExact.StoredEntries() << " for " << blockExact.NonZeros() << ", 4x4 block CSR " << blockEdge.StoredEntries() << endl;
+
+	for (int level(0); level <= static_cast<int>(detectedLevel); level++)
+	{
+		SimdLevel active = Simd::SetActive(static_cast<SimdLevel>(level));
+		Dense<double> sellProduct = sell * productVector;
+		Dense<double> blockExactProduct = blockExact * blockVector;
+		Dense<double> blockEdgeProduct = blockEdge * blockVector;
+		double sellError = 0, blockError = 0;
+		for (unsigned int i(0); i < productSize; i++)
+			sellError = max(sellError, abs(sellProduct.Data()[i] - productReference.Data()[i]));
+		for (unsigned int i(0); i < blockSize; i++)
+			blockError = max(blockError, max(abs(blockExactProduct.Data()[i] - blockReference.Data()[i]), abs(blockEdgeProduct.Data()[i] - blockReference.Data()[i])));
+		cout << "SELL and block CSR products vs CSR, " << Simd::LevelName(active) << " max errors: " << sellError << ", " << blockError << endl;
+	}
+	Simd::SetActive(detectedLevel);
+
+	Dense<double> sparseProduct = productSparse * productRhs;
+	double spmmError = 0;
+	for (unsigned int i(0); i < sparseProduct.Numel(); i++)
+		spmmError = max(spmmError, abs(sparseProduct.Data()[i] - denseProduct.Data()[i]));
+	cout << "sparse matrix times 5 right-hand sides vs dense, max error: " << spmmError << endl;
+
+	// test sparse-sparse products against the dense ones - short rows of the 1500x1500 matrix take the hash
+	// accumulator and long ones the dense accumulator, and the result must not depend on the thread count
+	Sparse<double> sparseSquare = productSparse * productSparse;
+	Sparse<double> serialSquare;
+	productSparse.MulInto(productSparse, serialSquare, 1);
+	Dense<double> denseSquare = productDense * productDense;
+	double spgemmError = 0;
+	for (unsigned int row(0); row < productSize; row++)
+		for (unsigned int col(0); col < productSize; col++)
+			spgemmError = max(spgemmError, abs(sparseSquare(row, col) - denseSquare(row, col)));
+	bool spgemmIdentical = (sparseSquare.NonZeros() == serialSquare.NonZeros())
+		&& equal(sparseSquare.ColumnIndices(), sparseSquare.ColumnIndices() + sparseSquare.NonZeros(), serialSquare.ColumnIndices())
+		&& equal(sparseSquare.Values(), sparseSquare.Values() + sparseSquare.NonZeros(), serialSquare.Values());
+	cout << "sparse A*A vs dense, max error: " << spgemmError << ", parallel identical to serial: " << (spgemmIdentical ? "yes" : "NO") << endl;
+
+	Sparse<double> normalSparse = productSparse.Transpose() * productSparse;
+	Dense<double> normalDense = productDense.Transpose() * productDense;
+	double normalError = 0;
+	for (unsigned int row(0); row < productSize; row++)
+		for (unsigned int col(0); col < productSize; col++)
+			normalError = max(normalError, abs(normalSparse(row, col) - normalDense(row, col)));
+	cout << "sparse A'*A vs dense, max error: " << normalError << endl;
+
+	Dense<int> smallRhs(5, 2);
+	smallRhs.ResetToConstant(1);
+	cout << "sparse 4x5 matrix times ones:" << endl << (smallSparse * smallRhs).ToString();
+
+	// test conversions both ways and the mixed operators - a 20% dense matrix should stay in the sparse rows,
+	// a full one with many right-hand sides should go through Gemm, and every choice reaches the hook
+	Dense<double> mixedDense(300, 200);
+	for (unsigned int i(0); i < mixedDense.Numel(); i++)
+	{
+		seed = seed * 1664525 + 1013904223;
+		mixedDense.Data()[i] = ((seed >> 8) % 5 == 0) ? ((seed >> 12) % 1000) * 0.001 - 0.5 : 0;
+	}
+	Sparse<double> mixedSparse = mixedDense.ToSparse();
+	Dense<double> mixedBack = mixedSparse.ToDense();
+	bool conversionExact = equal(mixedDense.Data(), mixedDense.Data() + mixedDense.Numel(), mixedBack.Data());
+	Sparse<double> mixedSerial = mixedDense.ToSparse(0, 1);
+	bool conversionIdentical = (mixedSerial.NonZeros() == mixedSparse.NonZeros())
+		&& equal(mixedSerial.ColumnIndices(), mixedSerial.ColumnIndices() + mixedSerial.NonZeros(), mixedSparse.ColumnIndices());
+	unsigned int keptAbove = mixedDense.ToSparse(0.25).NonZeros();
+	cout << "dense to sparse and back exact: " << (conversionExact ? "yes" : "no") << ", parallel identical to serial: " << (conversionIdentical ? "yes" : "no")
+		<< ", density " << mixedSparse.NonZeros() / 60000.0 << ", magnitudes above 0.25: " << keptAbove << endl;
+
+	MixedKernels::SelectionHook previousHook = MixedKernels::SetHook(CountSelection);
+	Dense<double> manyRhs(200, 64);
+	Dense<double> manyLhs(64, 300);
+	Dense<double> oneRhs(200, 1);
+	for (unsigned int i(0); i < manyRhs.Numel(); i++)
+		manyRhs.Data()[i] = manyLhs.Data()[i % manyLhs.Numel()] = (i % 13) * 0.1 - 0.6;
+	for (unsigned int i(0); i < oneRhs.Numel(); i++)
+		oneRhs.Data()[i] = (i % 7) * 0.2;
+
+	Dense<double> fullDense = mixedDense.CopyAddScalar(1);
+	Sparse<double> fullSparse = fullDense.ToSparse();
+
+	double mixedError = 0;
+	Dense<double> mixedProduct = fullSparse * manyRhs;
+	Dense<double> mixedReference = fullDense * manyRhs;
+	const char* manyKernel = MixedKernels::KernelName(MixedKernels::LastSelection().kernel);
+	for (unsigned int i(0); i < mixedProduct.Numel(); i++)
+		mixedError = max(mixedError, abs(mixedProduct.Data()[i] - mixedReference.Data()[i]));
+	mixedProduct = mixedSparse * manyRhs;
+	mixedReference = mixedDense * manyRhs;
+	const char* sparseKernel = MixedKernels::KernelName(MixedKernels::LastSelection().kernel);
+	for (unsigned int i(0); i < mixedProduct.Numel(); i++)
+		mixedError = max(mixedError, abs(mixedProduct.Data()[i] - mixedReference.Data()[i]));
+	mixedProduct = fullSparse * oneRhs;
+	mixedReference = fullDense * oneRhs;
+	const char* oneKernel = MixedKernels::KernelName(MixedKernels::LastSelection().kernel);
+	for (unsigned int i(0); i < mixedProduct.Numel(); i++)
+		mixedError = max(mixedError, abs(mixedProduct.Data()[i] - mixedReference.Data()[i]));
+	mixedProduct = manyLhs * fullSparse;
+	mixedReference = manyLhs * fullDense;
+	const char* leftKernel = MixedKernels::KernelName(MixedKernels::LastSelection().kernel);
+	for (unsigned int i(0); i < mixedProduct.Numel(); i++)
+		mixedError = max(mixedError, abs(mixedProduct.Data()[i] - mixedReference.Data()[i]));
+	Dense<double> leftRows = manyLhs.SubMatrix(0, 0, 0, 299);
+	mixedProduct = leftRows * mixedSparse;
+	mixedReference = leftRows * mixedDense;
+	const char* leftOneKernel = MixedKernels::KernelName(MixedKernels::LastSelection().kernel);
+	for (unsigned int i(0); i < mixedProduct.Numel(); i++)
+		mixedError = max(mixedError, abs(mixedProduct.Data()[i] - mixedReference.Data()[i]));
+	mixedProduct = mixedSparse + mixedDense;
+	mixedReference = mixedDense + mixedSparse;
+	for (unsigned int i(0); i < mixedProduct.Numel(); i++)
+		mixedError = max(mixedError, max(abs(mixedProduct.Data()[i] - 2 * mixedDense.Data()[i]), abs(mixedReference.Data()[i] - 2 * mixedDense.Data()[i])));
+	MixedKernels::SetHook(previousHook);
+	cout << "mixed operators max error: " << mixedError << ", full matrix with 64 right-hand sides: " << manyKernel << ", one: " << oneKernel
+		<< ", 20% dense with 64: " << sparseKernel << ", 64 left rows: " << leftKernel << ", one row of 20% dense: " << leftOneKernel
+		<< ", selections seen by the hook (should be 7): " << mixedSelections << ", malformed (should be 0): " << malformedSelections << endl;
+
+	// test the iterative solvers - the symmetric Poisson matrix with CG and every preconditioner,
+	// a nonsymmetric convection-diffusion matrix with BiCGSTAB and GMRES, and a dense operator
+	// 190x190 grid points are enough for the parallel vector kernels to engage
+	Sparse<double> poisson = GridMatrix(190, 0);
+	Dense<double> poissonRhs(poisson.Rows(), 1);
+	for (unsigned int i(0); i < poissonRhs.Rows(); i++)
+		poissonRhs.Data()[i] = 1 + (i % 7) * 0.1;
+
+	KrylovOptions krylovOptions;
+	krylovOptions.maxIterations = 2000;
+	unsigned int callbackCalls = 0;
+	krylovOptions.callback = [&](unsigned int, double, double) { callbackCalls++; };
+
+	Dense<double> solution;
+	KrylovResult plain = Krylov::ConjugateGradient(poisson, poissonRhs, solution, krylovOptions);
+	cout << "CG on 190x190 Poisson: " << plain.iterations << " iterations, converged " << plain.converged
+		<< ", residual " << RelativeResidual(poisson, poissonRhs, solution) << ", callback calls match: " << (callbackCalls == plain.iterations ? "yes" : "NO") << endl;
+
+	krylovOptions.nThreads = 1;
+	Dense<double> serialSolution;
+	Krylov::ConjugateGradient(poisson, poissonRhs, serialSolution, krylovOptions);
+	cout << "CG with one thread identical to the pool: " << (equal(solution.Data(), solution.Data() + solution.Numel(), serialSolution.Data()) ? "yes" : "NO") << endl;
+	krylovOptions.nThreads = 0;
+
+	Dense<double> jacobiSolution;
+	KrylovResult jacobi = Krylov::ConjugateGradient(poisson, poissonRhs, jacobiSolution, JacobiPreconditioner<double>(poisson), krylovOptions);
+	Dense<double> ssorSolution;
+	KrylovResult ssor = Krylov::ConjugateGradient(poisson, poissonRhs, ssorSolution, SsorPreconditioner<double>(poisson, 1.5), krylovOptions);
+	Dense<double> iluSolution;
+	KrylovResult ilu = Krylov::ConjugateGradient(poisson, poissonRhs, iluSolution, Ilu0Preconditioner<double>(poisson), krylovOptions);
+	cout << "preconditioned CG iterations - Jacobi " << jacobi.iterations << ", SSOR " << ssor.iterations << ", ILU(0) " << ilu.iterations
+		<< ", residuals " << RelativeResidual(poisson, poissonRhs, jacobiSolution) << ", " << RelativeResidual(poisson, poissonRhs, ssorSolution)
+		<< ", " << RelativeResidual(poisson, poissonRhs, iluSolution) << endl;
+
+	Sparse<double> convection = GridMatrix(100, 2);
+	Dense<double> convectionRhs(convection.Rows(), 1);
+	convectionRhs.ResetToConstant(1);
+	Ilu0Preconditioner<double> convectionIlu(convection);
+	Dense<double> bicgSolution, gmresSolution, gmresIluSolution;
+	KrylovResult bicg = Krylov::BiCgStab(convection, convectionRhs, bicgSolution, convectionIlu, krylovOptions);
+	KrylovResult gmres = Krylov::Gmres(convection, convectionRhs, gmresSolution, krylovOptions);
+	KrylovResult gmresIlu = Krylov::Gmres(convection, convectionRhs, gmresIluSolution, convectionIlu, krylovOptions);
+	cout << "convection-diffusion - BiCGSTAB+ILU(0) " << bicg.iterations << " iterations, residual " << RelativeResidual(convection, convectionRhs, bicgSolution)
+		<< "; GMRES(30) " << gmres.iterations << ", residual " << RelativeResidual(convection, convectionRhs, gmresSolution)
+		<< "; GMRES(30)+ILU(0) " << gmresIlu.iterations << ", residual " << RelativeResidual(convection, convectionRhs, gmresIluSolution) << endl;
+
+	Dense<double> denseSystem(200, 200);
+	for (unsigned int row(0); row < 200; row++)
+		for (unsigned int col(0); col < 200; col++)
+			denseSystem(row, col, (row == col) ? 210.0 : 1.0 / (1 + row + col));
+	Dense<double> denseRhs(200, 1);
+	denseRhs.ResetToConstant(1);
+	Dense<double> denseSolution;
+	KrylovResult denseCg = Krylov::ConjugateGradient(denseSystem, denseRhs, denseSolution, JacobiPreconditioner<double>(denseSystem), krylovOptions);
+	cout << "CG on a dense 200x200 system: " << denseCg.iterations << " iterations, residual " << RelativeResidual(denseSystem, denseRhs, denseSolution) << endl;
+
+	Dense<double> shortRhs(199, 1);
+	Dense<double> untouched(200, 1);
+	untouched.ResetToConstant(7);
+	KrylovOptions noRestart = krylovOptions;
+	noRestart.restart = 0;
+	KrylovResult mismatched = Krylov::BiCgStab(denseSystem, shortRhs, untouched, krylovOptions);
+	KrylovResult restartless = Krylov::Gmres(denseSystem, denseRhs, untouched, noRestart);
+	cout << "mismatched sizes and a zero restart not converged: " << (!mismatched.converged && !restartless.converged
+		&& mismatched.iterations == 0 && restartless.iterations == 0 && untouched(0, 0) == 7 ? "yes" : "NO") << endl;
+
+	// test the sparse Cholesky - every ordering on the Poisson matrix, a refactorization of the same pattern
+	// with new values, several right hand sides at once and a matrix that is not positive definite
+	const char* orderingNames[] = { "natural", "minimum degree", "nested dissection" };
+	for (CholeskyOrdering ordering : { CholeskyOrdering::Natural, CholeskyOrdering::MinimumDegree, CholeskyOrdering::NestedDissection })
+	{
+		SparseCholesky<double> cholesky(poisson, ordering);
+		cholesky.Factorize(poisson);
+		Dense<double> directSolution = cholesky.Solve(poissonRhs);
+		cout << "sparse Cholesky, " << orderingNames[static_cast<int>(ordering)] << " ordering: nnz(L) " << cholesky.FactorNonZeros()
+			<< ", " << cholesky.Supernodes() << " supernodes, " << cholesky.Flops() << " flops, residual " << RelativeResidual(poisson, poissonRhs, directSolution) << endl;
+	}
+
+	SparseCholesky<double> poissonCholesky(poisson);
+	Sparse<double> scaledPoisson(poisson);
+	for (unsigned int entry(0); entry < scaledPoisson.NonZeros(); entry++)
+		scaledPoisson.Values()[entry] *= 2;
+	for (unsigned int row(0); row < scaledPoisson.Rows(); row++)
+		scaledPoisson(row, row, 8 + (row % 3) * 0.5);
+	poissonCholesky.Factorize(scaledPoisson);
+	Dense<double> twoRhs(poisson.Rows(), 2);
+	for (unsigned int i(0); i < poisson.Rows(); i++)
+	{
+		twoRhs(i, 0, poissonRhs.Data()[i]);
+		twoRhs(i, 1, 1.0);
+	}
+	Dense<double> twoSolutions = poissonCholesky.Solve(twoRhs);
+	Dense<double> firstColumn(poisson.Rows(), 1), secondColumn(poisson.Rows(), 1), onesRhs(poisson.Rows(), 1);
+	onesRhs.ResetToConstant(1);
+	for (unsigned int i(0); i < poisson.Rows(); i++)
+	{
+		firstColumn.Data()[i] = twoSolutions(i, 0);
+		secondColumn.Data()[i] = twoSolutions(i, 1);
+	}
+	cout << "refactorized with new values, two right hand sides - residuals " << RelativeResidual(scaledPoisson, poissonRhs, firstColumn)
+		<< ", " << RelativeResidual(scaledPoisson, onesRhs, secondColumn) << endl;
+
+	Sparse<double> shifted(poisson);
+	for (unsigned int row(0); row < shifted.Rows(); row++)
+		shifted(row, row, -1.0);
+	poissonCholesky.Factorize(shifted);
+	cout << "indefinite matrix reported: " << (poissonCholesky.IsPositiveDefinite() ? "NO" : "yes") << endl;
+
+	// test the Matrix Market reader - every kind of banner from memory, a file round trip through the
+	// memory mapped reader, a body large enough for the parallel parser and malformed input
+	const char symmetricText[] = "%%MatrixMarket matrix coordinate real symmetric\n% lower triangle\n3 3 4\n1 1 2.5\n2 1 -1\n3 2 +1e-1\n3 3 4\n";
+	const char skewText[] = "%%MatrixMarket matrix array integer skew-symmetric\n3 3\n1\n2\n3\n";
+	const char patternText[] = "%%MatrixMarket matrix coordinate pattern general\r\n2 3 2\r\n1 3\r\n2 1\r\n";
+	Sparse<double> symmetricMarket;
+	Dense<int> skewMarket;
+	Dense<double> patternMarket;
+	bool parsed = MatrixMarket::ParseSparse(symmetricText, sizeof(symmetricText) - 1, symmetricMarket)
+		&& MatrixMarket::ParseDense(skewText, sizeof(skewText) - 1, skewMarket) && MatrixMarket::ParseDense(patternText, sizeof(patternText) - 1, patternMarket);
+	cout << "Matrix Market banners parsed: " << (parsed ? "yes" : "NO") << ", symmetric (1,2) " << symmetricMarket(0, 1) << " (3,2) " << symmetricMarket(2, 1)
+		<< ", skew (1,3) " << skewMarket(0, 2) << " (3,1) " << skewMarket(2, 0) << ", pattern (1,3) " << patternMarket(0, 2) << endl;
+
+	const char truncatedText[] = "%%MatrixMarket matrix coordinate real general\n2 2 3\n1 1 1\n2 2 x\n";
+	const char outOfRangeText[] = "%%MatrixMarket matrix coordinate real general\n2 2 1\n3 1 1\n";
+	Sparse<double> rejected;
+	const char trailingText[] = "%%MatrixMarket matrix coordinate real general\n4 4 2\n1 1 1\n% entries\n3 4 1.5garbage\n";
+	const char extraText[] = "%%MatrixMarket matrix coordinate real general\n4 4 2\n1 1 1\n3 4 1.5 7\n";
+	const char extraArrayText[] = "%%MatrixMarket matrix array real general\n2 1\n1\n2 3\n";
+	size_t trailingLine, extraLine, extraArrayLine;
+	Dense<double> rejectedDense;
+	bool trailingRejected = !MatrixMarket::ParseSparse(trailingText, sizeof(trailingText) - 1, rejected, 0, &trailingLine);
+	bool extraRejected = !MatrixMarket::ParseSparse(extraText, sizeof(extraText) - 1, rejected, 0, &extraLine);
+	bool extraArrayRejected = !MatrixMarket::ParseDense(extraArrayText, sizeof(extraArrayText) - 1, rejectedDense, 0, &extraArrayLine);
+	cout << "malformed input rejected: " << (!MatrixMarket::ParseSparse(truncatedText, sizeof(truncatedText) - 1, rejected)
+		&& !MatrixMarket::ParseSparse(outOfRangeText, sizeof(outOfRangeText) - 1, rejected) && !MatrixMarket::ReadSparse("missing.mtx", rejected) ? "yes" : "NO")
+		<< ", text after the value rejected at line " << (trailingRejected ? to_string(trailingLine) : "NONE") << " (5), "
+		<< (extraRejected ? to_string(extraLine) : "NONE") << " (4), " << (extraArrayRejected ? to_string(extraArrayLine) : "NONE") << " (4)" << endl;
+
+	Sparse<double> marketPoisson;
+	Dense<double> marketDense;
+	bool roundTrip = MatrixMarket::WriteSparse("unittest_poisson.mtx", poisson) && MatrixMarket::ReadSparse("unittest_poisson.mtx", marketPoisson)
+		&& MatrixMarket::WriteDense("unittest_dense.mtx", denseSystem) && MatrixMarket::ReadDense("unittest_dense.mtx", marketDense);
+	Sparse<double> serialPoisson;
+	MappedFile poissonFile("unittest_poisson.mtx");
+	MatrixMarket::ParseSparse(poissonFile.Data(), poissonFile.Size(), serialPoisson, 1);
+	size_t poissonBytes = poissonFile.Size();
+	poissonFile.Close();
+	remove("unittest_poisson.mtx");
+	remove("unittest_dense.mtx");
+	cout << "Matrix Market round trip of " << poissonBytes << " bytes: " << (roundTrip && marketPoisson.NonZeros() == poisson.NonZeros()
+		&& equal(poisson.Values(), poisson.Values() + poisson.NonZeros(), marketPoisson.Values())
+		&& equal(poisson.ColumnIndices(), poisson.ColumnIndices() + poisson.NonZeros(), marketPoisson.ColumnIndices())
+		&& equal(denseSystem.Data(), denseSystem.Data() + denseSystem.Numel(), marketDense.Data()) ? "exact" : "DIFFERS")
+		<< ", one thread identical: " << (equal(serialPoisson.Values(), serialPoisson.Values() + serialPoisson.NonZeros(), marketPoisson.Values()) ? "yes" : "NO") << endl;
+
+	// test the binary format - copying reads and mapped matrices against the originals, a dense matrix streamed
+	// in row blocks, and files of another element type, another layout or an unfinished writer rejected
+	Dense<double> binaryDense;
+	Sparse<double> binaryPoisson;
+	bool binaryRoundTrip = BinaryMatrix::WriteDense("unittest_dense.nbm", denseSystem) && BinaryMatrix::ReadDense("unittest_dense.nbm", binaryDense)
+		&& BinaryMatrix::WriteSparse("unittest_poisson.nbm", poisson) && BinaryMatrix::ReadSparse("unittest_poisson.nbm", binaryPoisson);
+	MappedDense<double> mappedDense("unittest_dense.nbm");
+	MappedSparse<double> mappedPoisson("unittest_poisson.nbm");
+	vector<double> mappedProduct(poisson.Rows()), poissonProduct(poisson.Rows());
+	mappedPoisson.MulVectorInto(poissonRhs.Data(), mappedProduct.data());
+	poisson.MulVectorInto(poissonRhs.Data(), poissonProduct.data());
+	cout << "binary round trip: " << (binaryRoundTrip && equal(denseSystem.Data(), denseSystem.Data() + denseSystem.Numel(), binaryDense.Data())
+		&& binaryPoisson.NonZeros() == poisson.NonZeros() && equal(poisson.Values(), poisson.Values() + poisson.NonZeros(), binaryPoisson.Values())
+		&& equal(poisson.RowOffsets(), poisson.RowOffsets() + poisson.Rows() + 1, binaryPoisson.RowOffsets()) ? "exact" : "DIFFERS")
+		<< ", mapped dense trace " << mappedDense.View().Trace() << " (should be " << denseSystem.Trace() << ")"
+		<< ", mapped sparse (1,2) " << mappedPoisson.GetValue(0, 1) << " product identical: " << (mappedProduct == poissonProduct ? "yes" : "NO")
+		<< ", data aligned: " << (reinterpret_cast<size_t>(mappedDense.Data()) % BinaryMatrix::Alignment == 0 ? "yes" : "NO") << endl;
+
+	Dense<int> streamed(37, 5);
+	for (unsigned int i(0); i < streamed.Numel(); i++)
+		streamed.Data()[i] = static_cast<int>(i * 7) - 100;
+	BinaryDenseWriter<int> streamWriter("unittest_stream.nbm", 37, 5);
+	bool streamWritten = true;
+	for (unsigned int row(0); row < 37; row += 8)
+		streamWritten = streamWriter.WriteRows(streamed.Data() + row * 5, min(8u, 37 - row)) && streamWritten;
+	streamWritten = !streamWriter.WriteRows(streamed.Data(), 1) && streamWriter.Close() && streamWritten;
+	Dense<int> streamedRead;
+	Dense<float> wrongType;
+	Sparse<double> wrongLayout;
+	{
+		BinarySparseWriter<double> unfinished("unittest_unfinished.nbm", 3, 3, 2);
+		const unsigned int column = 1;
+		const double one = 1;
+		unfinished.WriteRow(&column, &one, 1);
+	}
+	cout << "binary streamed in row blocks: " << (streamWritten && BinaryMatrix::ReadDense("unittest_stream.nbm", streamedRead)
+		&& equal(streamed.Data(), streamed.Data() + streamed.Numel(), streamedRead.Data()) ? "exact" : "DIFFERS")
+		<< ", other element type, layout and unfinished file rejected: " << (!BinaryMatrix::ReadDense("unittest_dense.nbm", wrongType)
+		&& !BinaryMatrix::ReadSparse("unittest_dense.nbm", wrongLayout) && !MappedSparse<double>("unittest_unfinished.nbm").IsOpen() ? "yes" : "NO") << endl;
+	mappedDense.Close();
+	mappedPoisson.Close();
+	remove("unittest_dense.nbm");
+	remove("unittest_poisson.nbm");
+	remove("unittest_stream.nbm");
+	remove("unittest_unfinished.nbm");
+
+	// test the text format - ToString parses back to identical values, chunked formatting through the smallest
+	// buffer and into a stream produce the same text, and free white space is accepted while ragged rows are not
+	Dense<double> awkward(7, 9);
+	unsigned int awkwardSeed = 11;
+	for (unsigned int i(0); i < awkward.Numel(); i++)
+	{
+		awkwardSeed = awkwardSeed * 1664525 + 1013904223;
+		awkward.Data()[i] = (static_cast<int>(awkwardSeed >> 8) - (1 << 23)) / 3.0 * pow(10.0, static_cast<int>(i % 41) - 20);
+	}
+	awkward(0, 0, 0.1);
+	awkward(0, 1, -0.0);
+	awkward(0, 2, 5e-324);
+	string awkwardText = awkward.ToString();
+	Dense<double> awkwardParsed;
+	string chunked;
+	char smallBuffer[TextFormat::MaxValueChars];
+	awkward.Format(smallBuffer, sizeof(smallBuffer), [&](const char* data, size_t length) { chunked.append(data, length); });
+	ostringstream awkwardStream;
+	awkward.Format(awkwardStream);
+	cout << "text round trip of shortest doubles: " << (Dense<double>::Parse(awkwardText, awkwardParsed)
+		&& equal(awkward.Data(), awkward.Data() + awkward.Numel(), awkwardParsed.Data()) ? "exact" : "DIFFERS")
+		<< ", chunked and stream formatting identical: " << (chunked == awkwardText && awkwardStream.str() == awkwardText ? "yes" : "NO") << endl;
+
+	Dense<int> spaced, empty, ragged;
+	bool spacedParsed = Dense<int>::Parse(" [ 1 , -2 ,+3 ;\r\n 4,5,6 ]\n", spaced) && Dense<int>::Parse("[]", empty);
+	cout << "parsed with white space: " << (spacedParsed ? spaced.ToString() : "NO\n") << "empty " << empty.Rows() << "x" << empty.Cols()
+		<< ", ragged rows, junk and unclosed rejected: " << (!Dense<int>::Parse("[1,2;3]", ragged) && !Dense<int>::Parse("[1,2]x", ragged)
+		&& !Dense<int>::Parse("[1,2;3,4", ragged) && !Dense<int>::Parse("[1,,2]", ragged) ? "yes" : "NO") << endl;
+
+	Dense<int> limits;
+	Dense<unsigned int> unsignedRange;
+	bool limitsParsed = Dense<int>::Parse("[2147483647,-2147483648,-2.5e1]", limits) && limits(0, 0) == 2147483647
+		&& limits(0, 1) == -2147483647 - 1 && limits(0, 2) == -25;
+	bool outOfRangeRejected = !Dense<int>::Parse("[2147483648]", limits) && !Dense<int>::Parse("[-2147483649]", limits)
+		&& !Dense<int>::Parse("[3e10]", limits) && !Dense<unsigned int>::Parse("[-1]", unsignedRange)
+		&& !Dense<unsigned int>::Parse("[4294967296]", unsignedRange) && !Dense<int>::Parse("[99999999999999999999]", limits);
+	cout << "int limits parsed: " << (limitsParsed ? "yes" : "NO") << ", out of range integers rejected: " << (outOfRangeRejected ? "yes" : "NO") << endl;
+
+	// test the QR factorization - Q*R reproduces A with orthonormal Q across two panels, least squares agrees
+	// with the normal equations, column pivoting finds the rank of a product of thin factors, and TSQR agrees with QR
+	auto randomMatrix = [](unsigned int rows, unsigned int cols, unsigned int seed)
+	{
+		Dense<double> random(rows, cols);
+		for (unsigned int i(0); i < random.Numel(); i++)
+		{
+			seed = seed * 1664525 + 1013904223;
+			random.Data()[i] = (seed >> 8) / 16777216.0 - 0.5;
+		}
+		return random;
+	};
+
+	Dense<double> tall = randomMatrix(300, 45, 5);
+	Dense<double> tallRhs = randomMatrix(300, 3, 6);
+	QR<double> tallQR(tall);
+	Dense<double> thinQ = tallQR.Q();
+	Dense<double> identity45(45, 45);
+	for (unsigned int i(0); i < 45; i++)
+		identity45(i, i, 1.0);
+	Dense<double> normalMatrix = tall.Transpose() * tall;
+	Dense<double> normalSolution = LU<double>(normalMatrix).Solve(tall.Transpose() * tallRhs);
+	Dense<double> qrSolution = tallQR.Solve(tallRhs);
+	cout << "QR of 300x45: |Q*R - A| " << (MaxDifference(thinQ * tallQR.R(), tall) < 1e-13 ? "< 1e-13" : "LARGE")
+		<< ", |Q'*Q - I| " << (MaxDifference(thinQ.Transpose() * thinQ, identity45) < 1e-13 ? "< 1e-13" : "LARGE")
+		<< ", least squares matches normal equations: " << (MaxDifference(qrSolution, normalSolution) < 1e-10 ? "yes" : "NO")
+		<< ", rank " << tallQR.Rank() << endl;
+
+	Dense<double> deficient = randomMatrix(70, 12, 7) * randomMatrix(12, 40, 8);
+	QR<double> pivotedQR(deficient, true);
+	QR<double> plainQR(deficient);
+	Dense<double> permuted(70, 40);
+	for (unsigned int j(0); j < 40; j++)
+	{
+		for (unsigned int i(0); i < 70; i++)
+			permuted(i, j, deficient(i, pivotedQR.Permutation()[j]));
+	}
+	Dense<double> consistentRhs = deficient * randomMatrix(40, 1, 9);
+	Dense<double> basicSolution = pivotedQR.Solve(consistentRhs);
+	cout << "column pivoted QR of a rank 12 70x40 product: rank " << pivotedQR.Rank() << " (unpivoted bound " << plainQR.Rank() << ")"
+		<< ", |Q*R - A*P| " << (MaxDifference(pivotedQR.Q() * pivotedQR.R(), permuted) < 1e-13 ? "< 1e-13" : "LARGE")
+		<< ", basic solution residual " << (MaxDifference(deficient * basicSolution, consistentRhs) < 1e-12 ? "< 1e-12" : "LARGE") << endl;
+
+	Dense<double> skinny = randomMatrix(20000, 8, 10);
+	Dense<double> skinnyRhs = randomMatrix(20000, 2, 11);
+	Dense<double> tsqrSolution = QR<double>::SolveTallSkinny(skinny, skinnyRhs);
+	Dense<double> skinnySolution = QR<double>(skinny).Solve(skinnyRhs);
+	cout << "TSQR of 20000x8 matches QR: " << (MaxDifference(tsqrSolution, skinnySolution) < 1e-12 ? "yes" : "NO")
+		<< ", LeastSquares matches QR: " << (MaxDifference(LeastSquares(skinny, skinnyRhs), skinnySolution) < 1e-12 ? "yes" : "NO")
+		<< ", a right hand side of the wrong height gives empty solutions: " << (tallQR.Solve(skinnyRhs).Rows() == 0
+		&& QR<double>::SolveTallSkinny(skinny, tallRhs).Rows() == 0 && LeastSquares(tall, skinnyRhs).Rows() == 0 ? "yes" : "NO") << endl;
+
+	// test the symmetric eigensolver - divide and conquer vectors of a 200x200 matrix and of one with eigenvalues
+	// of multiplicity 25 (all deflation), the values alone by QL, and subsets by index and value range
+	auto eigenResidual = [](const Dense<double>& matrix, const vector<double>& values, const Dense<double>& vectors)
+	{
+		Dense<double> scaled(vectors);
+		for (unsigned int i(0); i < scaled.Rows(); i++)
+			for (unsigned int j(0); j < scaled.Cols(); j++)
+				scaled(i, j, scaled(i, j) * values[j]);
+		Dense<double> identity(vectors.Cols(), vectors.Cols());
+		for (unsigned int i(0); i < vectors.Cols(); i++)
+			identity(i, i, 1.0);
+		return max(MaxDifference(matrix * vectors, scaled), MaxDifference(vectors.Transpose() * vectors, identity));
+	};
+
+	Dense<double> halfSymmetric = randomMatrix(200, 200, 12);
+	Dense<double> symmetric = halfSymmetric + halfSymmetric.Transpose();
+	SymmetricEigen<double> eigen(symmetric);
+	SymmetricEigen<double> eigenValues(symmetric, false);
+	double valueDifference = 0;
+	for (unsigned int i(0); i < 200; i++)
+		valueDifference = max(valueDifference, abs(eigen.Values()[i] - eigenValues.Values()[i]));
+	cout << "symmetric eigen of 200x200: |A*Z - Z*D|, |Z'*Z - I| " << (eigenResidual(symmetric, eigen.Values(), eigen.Vectors()) < 1e-12 ? "< 1e-12" : "LARGE")
+		<< ", ascending: " << (is_sorted(eigen.Values().begin(), eigen.Values().end()) ? "yes" : "NO")
+		<< ", values alone match: " << (valueDifference < 1e-12 ? "yes" : "NO") << endl;
+
+	Dense<double> basis = QR<double>(randomMatrix(100, 100, 13)).Q();
+	Dense<double> repeated = basis;
+	for (unsigned int i(0); i < 100; i++)
+		for (unsigned int j(0); j < 100; j++)
+			repeated(i, j, repeated(i, j) * static_cast<double>(j % 4));
+	repeated = repeated * basis.Transpose();
+	SymmetricEigen<double> repeatedEigen(repeated);
+	SymmetricEigen<double> repeatedSubset = SymmetricEigen<double>::ByIndex(repeated, 20, 54);
+	cout << "eigenvalues 0, 1, 2, 3 of multiplicity 25: smallest and largest within 1e-12: "
+		<< (abs(repeatedEigen.Values()[0]) < 1e-12 && abs(repeatedEigen.Values()[99] - 3) < 1e-12 ? "yes" : "NO")
+		<< ", |A*Z - Z*D|, |Z'*Z - I| " << (eigenResidual(repeated, repeatedEigen.Values(), repeatedEigen.Vectors()) < 1e-12 ? "< 1e-12" : "LARGE")
+		<< ", pairs 20..54 by inverse iteration " << (eigenResidual(repeated, repeatedSubset.Values(), repeatedSubset.Vectors()) < 1e-12 ? "< 1e-12" : "LARGE") << endl;
+
+	SymmetricEigen<double> byIndex = SymmetricEigen<double>::ByIndex(symmetric, 10, 19);
+	double indexDifference = 0;
+	for (unsigned int i(0); i < byIndex.Count(); i++)
+		indexDifference = max(indexDifference, abs(byIndex.Values()[i] - eigen.Values()[10 + i]));
+	SymmetricEigen<double> byValue = SymmetricEigen<double>::ByValue(symmetric, -1.0, 1.0, false);
+	unsigned int inRange = static_cast<unsigned int>(count_if(eigen.Values().begin(), eigen.Values().end(), [](double x) { return x > -1.0 && x <= 1.0; }));
+	cout << "eigenpairs 10..19 by bisection: " << byIndex.Count() << " match: " << (indexDifference < 1e-12 ? "yes" : "NO")
+		<< ", |A*Z - Z*D|, |Z'*Z - I| " << (eigenResidual(symmetric, byIndex.Values(), byIndex.Vectors()) < 1e-12 ? "< 1e-12" : "LARGE")
+		<< ", eigenvalues in (-1, 1]: " << byValue.Count() << " of " << inRange << endl;
+
+	// eigenvalues exactly on the bounds - the lower one is excluded and the upper one included
+	Dense<double> onBounds(4, 4);
+	for (unsigned int i(0); i < 4; i++)
+		onBounds(i, i, static_cast<double>(i) - 1.0);
+	SymmetricEigen<double> boundDiagonal = SymmetricEigen<double>::ByValue(onBounds, -1.0, 1.0, false);
+	Dense<double> pair(2, 2);
+	pair(0, 0, 2.0);
+	pair(0, 1, 1.0);
+	pair(1, 0, 1.0);
+	pair(1, 1, 2.0);
+	SymmetricEigen<double> boundPair = SymmetricEigen<double>::ByValue(pair, 1.0, 3.0, false);
+	cout << "eigenvalues -1, 0, 1, 2 in (-1, 1]: " << boundDiagonal.Count()
+		<< (boundDiagonal.Count() == 2 && abs(boundDiagonal.Values()[0]) < 1e-14 && abs(boundDiagonal.Values()[1] - 1.0) < 1e-14 ? " (0 and 1)" : " (WRONG)")
+		<< ", eigenvalues 1, 3 in (1, 3]: " << boundPair.Count()
+		<< (boundPair.Count() == 1 && abs(boundPair.Values()[0] - 3.0) < 1e-14 ? " (3)" : " (WRONG)") << endl;
+
+
+	// test the SVD - U*S*V' reproduces A with orthonormal U and V for square, tall (QR first) and wide shapes, the
+	// singular values of a symmetric matrix are its absolute eigenvalues, the pseudoinverse of a rank deficient matrix
+	// meets the Penrose conditions, and the randomized truncated SVD finds the leading values of a decaying spectrum
+	auto svdResidual = [](const Dense<double>& matrix, const SVD<double>& svd)
+	{
+		Dense<double> scaled(svd.U());
+		for (unsigned int i(0); i < scaled.Rows(); i++)
+			for (unsigned int j(0); j < svd.Count(); j++)
+				scaled(i, j, scaled(i, j) * svd.Values()[j]);
+		Dense<double> leading = scaled.SubMatrix(0, scaled.Rows() - 1, 0, svd.Count() - 1);
+		Dense<double> right = svd.V().SubMatrix(0, svd.V().Rows() - 1, 0, svd.Count() - 1);
+		Dense<double> uIdentity(svd.U().Cols(), svd.U().Cols());
+		for (unsigned int i(0); i < svd.U().Cols(); i++)
+			uIdentity(i, i, 1.0);
+		Dense<double> vIdentity(svd.V().Cols(), svd.V().Cols());
+		for (unsigned int i(0); i < svd.V().Cols(); i++)
+			vIdentity(i, i, 1.0);
+		return max(MaxDifference(leading * right.Transpose(), matrix), max(MaxDifference(svd.U().Transpose() * svd.U(), uIdentity),
+			MaxDifference(svd.V().Transpose() * svd.V(), vIdentity)));
+	};
+
+	Dense<double> squarish = randomMatrix(100, 70, 14);
+	Dense<double> tallSvdMatrix = randomMatrix(300, 40, 15);
+	Dense<double> wide = randomMatrix(60, 130, 16);
+	SVD<double> squarishSvd(squarish, SvdVectors::Full);
+	SVD<double> tallSvd(tallSvdMatrix);
+	SVD<double> wideSvd(wide, SvdVectors::Full);
+	SVD<double> wideValues(wide, SvdVectors::None);
+	double svdValueDifference = 0;
+	for (unsigned int i(0); i < 60; i++)
+		svdValueDifference = max(svdValueDifference, abs(wideSvd.Values()[i] - wideValues.Values()[i]));
+	cout << "SVD of 100x70 full, 300x40 thin and 60x130 full: |U*S*V' - A|, |U'*U - I|, |V'*V - I| "
+		<< (max(svdResidual(squarish, squarishSvd), max(svdResidual(tallSvdMatrix, tallSvd), svdResidual(wide, wideSvd))) < 1e-12 ? "< 1e-12" : "LARGE")
+		<< ", U of 100x70 is " << squarishSvd.U().Rows() << "x" << squarishSvd.U().Cols()
+		<< ", descending: " << (is_sorted(tallSvd.Values().rbegin(), tallSvd.Values().rend()) ? "yes" : "NO")
+		<< ", values alone match: " << (svdValueDifference < 1e-12 ? "yes" : "NO")
+		<< ", converged: " << ((squarishSvd.Converged() && tallSvd.Converged() && wideSvd.Converged() && wideValues.Converged()) ? "yes" : "NO") << endl;
+
+	vector<double> absoluteEigenvalues(eigen.Values());
+	for (double& value : absoluteEigenvalues)
+		value = abs(value);
+	sort(absoluteEigenvalues.begin(), absoluteEigenvalues.end(), greater<double>());
+	SVD<double> symmetricSvd(symmetric, SvdVectors::None);
+	double absoluteDifference = 0;
+	for (unsigned int i(0); i < 200; i++)
+		absoluteDifference = max(absoluteDifference, abs(symmetricSvd.Values()[i] - absoluteEigenvalues[i]));
+	cout << "singular values of the symmetric 200x200 are its absolute eigenvalues: " << (absoluteDifference < 1e-12 ? "yes" : "NO") << endl;
+
+	Dense<double> pseudoInverse = deficient.PseudoInverse();
+	Dense<double> product = deficient * pseudoInverse;
+	Dense<double> backProduct = pseudoInverse * deficient;
+	SVD<double> deficientSvd(deficient);
+	double penrose = max(max(MaxDifference(product * deficient, deficient), MaxDifference(backProduct * pseudoInverse, pseudoInverse)),
+		max(MaxDifference(product.Transpose(), product), MaxDifference(backProduct.Transpose(), backProduct)));
+	Dense<double> square = randomMatrix(30, 30, 17);
+	cout << "pseudoinverse of the rank 12 70x40 product: rank " << deficientSvd.Rank() << ", Penrose conditions " << (penrose < 1e-12 ? "< 1e-12" : "LARGE")
+		<< ", Solve matches: " << (MaxDifference(deficientSvd.Solve(consistentRhs), pseudoInverse * consistentRhs) < 1e-12 ? "yes" : "NO")
+		<< ", nonsingular 30x30 matches InverseByMinors: " << (MaxDifference(square.PseudoInverse(), square.InverseByMinors()) < 1e-10 ? "yes" : "NO")
+		<< ", empty without vectors or for a wrong height: " << (symmetricSvd.PseudoInverse().Rows() == 0 && symmetricSvd.Solve(denseRhs).Rows() == 0
+		&& deficientSvd.Solve(denseRhs).Rows() == 0 ? "yes" : "NO") << endl;
+
+	Dense<double> leftBasis = QR<double>(randomMatrix(200, 120, 18)).Q();
+	Dense<double> rightBasis = QR<double>(randomMatrix(120, 120, 19)).Q();
+	for (unsigned int i(0); i < 200; i++)
+		for (unsigned int j(0); j < 120; j++)
+			leftBasis(i, j, leftBasis(i, j) * pow(0.5, static_cast<double>(j)));
+	Dense<double> decaying = leftBasis * rightBasis.Transpose();
+	SVD<double> truncated = SVD<double>::Truncated(decaying, 10);
+	double truncatedDifference = 0;
+	for (unsigned int i(0); i < truncated.Count(); i++)
+		truncatedDifference = max(truncatedDifference, abs(truncated.Values()[i] - pow(0.5, static_cast<double>(i))));
+	cout << "randomized SVD of rank 10 of a 200x120 spectrum 2^-i: " << truncated.Count() << " values within 1e-12: " << (truncatedDifference < 1e-12 ? "yes" : "NO")
+		<< ", U is " << truncated.U().Rows() << "x" << truncated.U().Cols() << ", V is " << truncated.V().Rows() << "x" << truncated.V().Cols() << endl;
 
 	return 0;
 }
\ No newline at end of file